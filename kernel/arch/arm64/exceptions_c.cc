@@ -21,6 +21,7 @@
 #include <arch/thread.h>
 #include <arch/user_copy.h>
 #include <kernel/interrupt.h>
+#include <kernel/percpu.h>
 #include <kernel/thread.h>
 #include <pretty/hexdump.h>
 #include <vm/fault.h>
@@ -418,7 +419,10 @@ extern "C" void arm64_irq(iframe_t* iframe, uint exception_flags) {
   int_handler_start(&state);
 
   kcounter_add(exceptions_irq, 1);
+  // The platform timer is one of the interrupts dispatched here.
+  get_local_percpu()->irq_frame = iframe;
   platform_irq(iframe);
+  get_local_percpu()->irq_frame = nullptr;
 
   bool do_preempt = int_handler_finish(&state);
 
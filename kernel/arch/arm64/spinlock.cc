@@ -7,6 +7,7 @@
 #include <arch/ops.h>
 #include <arch/spinlock.h>
 #include <kernel/atomic.h>
+#include <kernel/spinlock.h>
 
 // We need to disable thread safety analysis in this file, since we're
 // implementing the locks themselves.  Without this, the header-level
@@ -16,6 +17,12 @@ void arch_spin_lock(spin_lock_t* lock) TA_NO_THREAD_SAFETY_ANALYSIS {
   unsigned long val = arch_curr_cpu_num() + 1;
   uint64_t temp;
 
+  if (unlikely(__atomic_load_n(&lock->value, __ATOMIC_RELAXED) & SPIN_LOCK_QUEUED)) {
+    spin_lock_queued(lock, val);
+    WRITE_PERCPU_FIELD32(num_spinlocks, READ_PERCPU_FIELD32(num_spinlocks) + 1);
+    return;
+  }
+
   __asm__ volatile(
       "sevl;"
       "1: wfe;"
@@ -33,6 +40,14 @@ int arch_spin_trylock(spin_lock_t* lock) TA_NO_THREAD_SAFETY_ANALYSIS {
   unsigned long val = arch_curr_cpu_num() + 1;
   uint64_t out;
 
+  if (unlikely(__atomic_load_n(&lock->value, __ATOMIC_RELAXED) & SPIN_LOCK_QUEUED)) {
+    out = spin_trylock_queued(lock, val);
+    if (out == 0) {
+      WRITE_PERCPU_FIELD32(num_spinlocks, READ_PERCPU_FIELD32(num_spinlocks) + 1);
+    }
+    return (int)out;
+  }
+
   __asm__ volatile(
       "ldaxr   %[out], [%[lock]];"
       "cbnz    %[out], 1f;"
@@ -50,5 +65,9 @@ int arch_spin_trylock(spin_lock_t* lock) TA_NO_THREAD_SAFETY_ANALYSIS {
 
 void arch_spin_unlock(spin_lock_t* lock) TA_NO_THREAD_SAFETY_ANALYSIS {
   WRITE_PERCPU_FIELD32(num_spinlocks, READ_PERCPU_FIELD32(num_spinlocks) - 1);
+  if (unlikely(__atomic_load_n(&lock->value, __ATOMIC_RELAXED) & SPIN_LOCK_QUEUED)) {
+    spin_unlock_queued(lock);
+    return;
+  }
   __atomic_store_n(&lock->value, 0UL, __ATOMIC_SEQ_CST);
 }
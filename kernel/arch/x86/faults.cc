@@ -29,6 +29,7 @@
 #include <arch/x86/registers.h>
 #include <fbl/auto_call.h>
 #include <kernel/interrupt.h>
+#include <kernel/percpu.h>
 #include <kernel/thread.h>
 #include <pretty/hexdump.h>
 #include <vm/fault.h>
@@ -388,7 +389,9 @@ static void handle_exception_types(x86_iframe_t* frame) {
       break;
     }
     case X86_INT_APIC_TIMER: {
+      get_local_percpu()->irq_frame = frame;
       apic_timer_interrupt_handler();
+      get_local_percpu()->irq_frame = nullptr;
       apic_issue_eoi();
       break;
     }
@@ -8,6 +8,7 @@
 
 #include <arch/arch_ops.h>
 #include <arch/spinlock.h>
+#include <kernel/spinlock.h>
 
 void arch_spin_lock(spin_lock_t *lock) TA_NO_THREAD_SAFETY_ANALYSIS {
   struct x86_percpu *percpu = x86_get_percpu();
@@ -16,6 +17,10 @@ void arch_spin_lock(spin_lock_t *lock) TA_NO_THREAD_SAFETY_ANALYSIS {
   unsigned long expected = 0;
   while (unlikely(!__atomic_compare_exchange_n(&lock->value, &expected, val, false,
                                                __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))) {
+    if (expected & SPIN_LOCK_QUEUED) {
+      spin_lock_queued(lock, val);
+      break;
+    }
     expected = 0;
     do {
       arch::Yield();
@@ -32,6 +37,9 @@ int arch_spin_trylock(spin_lock_t *lock) TA_NO_THREAD_SAFETY_ANALYSIS {
 
   __atomic_compare_exchange_n(&lock->value, &expected, val, false, __ATOMIC_ACQUIRE,
                               __ATOMIC_RELAXED);
+  if (unlikely(expected & SPIN_LOCK_QUEUED)) {
+    expected = spin_trylock_queued(lock, val);
+  }
   if (expected == 0) {
     percpu->num_spinlocks++;
   }
@@ -41,5 +49,9 @@ int arch_spin_trylock(spin_lock_t *lock) TA_NO_THREAD_SAFETY_ANALYSIS {
 
 void arch_spin_unlock(spin_lock_t *lock) TA_NO_THREAD_SAFETY_ANALYSIS {
   x86_get_percpu()->num_spinlocks--;
+  if (unlikely(__atomic_load_n(&lock->value, __ATOMIC_RELAXED) & SPIN_LOCK_QUEUED)) {
+    spin_unlock_queued(lock);
+    return;
+  }
   __atomic_store_n(&lock->value, 0UL, __ATOMIC_RELEASE);
 }
@@ -18,6 +18,7 @@
 #include <kernel/topology.h>
 #include <ktl/unique_ptr.h>
 #include <lk/init.h>
+#include <vm/pmm.h>
 
 #define LOCAL_TRACE 0
 
@@ -445,19 +446,63 @@ static constexpr zbi_topology_node_t kFallbackTopology = {
 };
 // clang-format on
 
+// Returns the logical id of the cpu with |apic_id| in the system topology.
+bool LogicalIdForApicId(uint32_t apic_id, cpu_num_t* logical_id) {
+  for (const auto* node : system_topology::GetSystemTopology().processors()) {
+    const auto& processor = node->entity.processor;
+    for (size_t i = 0; i < processor.architecture_info.x86.apic_id_count; i++) {
+      if (processor.architecture_info.x86.apic_ids[i] == apic_id) {
+        *logical_id = processor.logical_ids[i];
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Tells the pmm which NUMA node the memory and the cpus of each proximity domain belong to.
+// The memory of domains without cpus stays in node 0.
+void SetPmmNumaNodes(const AcpiTables& acpi_tables) {
+  uint32_t domains_with_memory_set = 0;
+  acpi_tables.VisitCpuNumaPairs([&domains_with_memory_set](const AcpiNumaDomain& domain,
+                                                           uint32_t apic_id) {
+    if (domain.domain >= PMM_MAX_NUMA_NODES) {
+      return;
+    }
+    if (!(domains_with_memory_set & (1u << domain.domain))) {
+      domains_with_memory_set |= 1u << domain.domain;
+      for (size_t i = 0; i < domain.memory_count; i++) {
+        pmm_set_numa_range(domain.domain, domain.memory[i].base_address, domain.memory[i].length);
+      }
+    }
+    cpu_num_t logical_id;
+    if (LogicalIdForApicId(apic_id, &logical_id)) {
+      pmm_set_cpu_numa_node(logical_id, domain.domain);
+    }
+  });
+  if (pmm_num_numa_nodes() > 1) {
+    dprintf(INFO, "System topology: pmm uses %u NUMA nodes\n", pmm_num_numa_nodes());
+  }
+}
+
 zx_status_t GenerateAndInitSystemTopology() {
   const AcpiTableProvider table_provider;
   fbl::Vector<zbi_topology_node_t> topology;
 
-  const auto status =
-      x86::GenerateFlatTopology(cpu_id::CpuId(), AcpiTables(&table_provider), &topology);
+  auto status = x86::GenerateFlatTopology(cpu_id::CpuId(), AcpiTables(&table_provider), &topology);
   if (status != ZX_OK) {
     dprintf(CRITICAL, "ERROR: failed to generate flat topology from cpuid and acpi data! : %d\n",
             status);
     return status;
   }
 
-  return system_topology::Graph::InitializeSystemTopology(topology.data(), topology.size());
+  status = system_topology::Graph::InitializeSystemTopology(topology.data(), topology.size());
+  if (status != ZX_OK) {
+    return status;
+  }
+
+  SetPmmNumaNodes(AcpiTables(&table_provider));
+  return ZX_OK;
 }
 
 }  // namespace
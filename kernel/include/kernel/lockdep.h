@@ -20,6 +20,7 @@ using lockdep::Guard;
 using lockdep::GuardMultiple;
 using lockdep::Lock;
 using lockdep::LockFlagsActiveListDisabled;
+using lockdep::LockFlagsHoldStatsDisabled;
 using lockdep::LockFlagsReportingDisabled;
 using lockdep::LockFlagsTrackingDisabled;
 
@@ -33,7 +33,8 @@ class TA_CAP("mutex") Mutex {
   // No moving or copying allowed.
   DISALLOW_COPY_ASSIGN_AND_MOVE(Mutex);
 
-  // The maximum duration to spin before falling back to blocking.
+  // The maximum duration to spin before falling back to blocking. The actual
+  // spin duration adapts to how long recent spinners waited for this mutex.
   // TODO(ZX-4873): Decide how to make this configurable per device/platform
   // and describe how to optimize this value.
   static constexpr zx_duration_t SPIN_MAX_DURATION = ZX_USEC(150);
@@ -59,10 +60,21 @@ class TA_CAP("mutex") Mutex {
   static constexpr uint32_t MAGIC = 0x6D757478;  // 'mutx'
   static constexpr uintptr_t STATE_FREE = 0u;
   static constexpr uintptr_t STATE_FLAG_CONTESTED = 1u;
+  // Set in spin_head_ while a releaser is handing the mutex to the head spinner.
+  static constexpr uintptr_t SPIN_HEAD_CLAIMED = 1u;
 
   template <ThreadLockState TLS>
   void ReleaseInternal(const bool allow_reschedule) TA_REL() __TA_NO_THREAD_SAFETY_ANALYSIS;
 
+  // Spins until the mutex is acquired, becomes contested, or the spin budget
+  // runs out. Returns true if the mutex was acquired.
+  bool Spin(uintptr_t new_mutex_state, zx_duration_t spin_max_duration);
+
+  // Passes the mutex from its uncontested holder, whose state is |owner_state|, directly to the
+  // spinner at the head of the queue. Returns false if nobody is spinning on the mutex or it has
+  // become contested.
+  bool HandOffToSpinner(uintptr_t owner_state);
+
   // Accessors to extract the holder pointer from the val member
   uintptr_t val() const { return val_.load(ktl::memory_order_relaxed); }
 
@@ -73,7 +85,23 @@ class TA_CAP("mutex") Mutex {
   Thread* holder() const { return holder_from_val(val()); }
 
   fbl::Canary<MAGIC> magic_;
+
+  // The tail of the queue of spinning waiters, as the number of its cpu plus
+  // one, or zero if nobody is spinning. Only the head of the queue spins on
+  // val_; the others spin on their cpu's queue node.
+  ktl::atomic<uint32_t> spinner_tail_{0};
+
+  // The state the head spinner would store in val_ when it acquires the mutex, or zero if nobody
+  // is spinning on val_. A releaser sets SPIN_HEAD_CLAIMED while it hands the mutex over, and
+  // clears the whole value once done.
+  ktl::atomic<uintptr_t> spin_head_{0};
+
   ktl::atomic<uintptr_t> val_{STATE_FREE};
+
+  // Recent wait in ticks of spinners that acquired the mutex, or zero if the
+  // last spinner gave up. Used to size the spin budget of later spinners.
+  ktl::atomic<uint32_t> spin_hint_{0};
+
   OwnedWaitQueue wait_;
 };
 
@@ -33,7 +33,7 @@ struct percpu {
   percpu operator=(const percpu&) = delete;
 
   // per cpu timer queue
-  struct list_node timer_queue;
+  TimerTree timer_queue;
 
   // per cpu preemption timer; ZX_TIME_INFINITE means not set
   zx_time_t preempt_timer_deadline;
@@ -66,6 +66,10 @@ struct percpu {
   // kernel counters arena
   int64_t* counters;
 
+  // The state interrupted by the timer interrupt being handled on this cpu, or
+  // null if unknown. Lets the sampling profiler record what was running.
+  iframe_t* irq_frame = nullptr;
+
   // dpc context
   // Whether the DPC system has been initialized for this cpu.
   bool dpc_initialized;
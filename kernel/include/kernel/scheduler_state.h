@@ -268,6 +268,10 @@ class SchedulerState {
 
   // Flag indicating whether this thread is associated with a run queue.
   bool active_{false};
+
+  // Flag indicating whether this thread entered the run queue by waking up or
+  // migrating, rather than by being preempted. Cleared when the thread runs.
+  bool woken_{false};
 };
 
 #endif  // ZIRCON_KERNEL_INCLUDE_KERNEL_SCHEDULER_STATE_H_
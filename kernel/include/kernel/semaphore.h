@@ -36,6 +36,10 @@ class Semaphore {
   // of ZX_ERR_INTERNAL_INTR errors if the thread had a signal delivered.
   zx_status_t Wait(const Deadline& deadline);
 
+  // If the count is positive, decrement the count by exactly one and return
+  // true. Otherwise return false without waiting.
+  bool TryWait();
+
   // Observe the current internal count of the semaphore.
   uint64_t count() {
     Guard<spin_lock_t, IrqSave> guard{ThreadLock::Get()};
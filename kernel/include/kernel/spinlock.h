@@ -16,6 +16,28 @@
 
 __BEGIN_CDECLS
 
+// The low 32 bits of a spin_lock_t's value hold the number of the cpu holding the lock plus one, or
+// zero if the lock is not held. Locks initialized with QUEUED_SPIN_LOCK_INITIAL_VALUE also have
+// SPIN_LOCK_QUEUED set, and hold the number of the cpu at the tail of the queue of waiters plus
+// one, or zero if there are no waiters, above SPIN_LOCK_TAIL_SHIFT.
+//
+// Waiters on a queued lock acquire it in the order they arrived, and each spins on its own cache
+// line rather than on the lock. This costs an extra atomic operation or two per acquisition, so
+// it is only worthwhile for heavily contended locks.
+#define SPIN_LOCK_HOLDER_MASK 0xffffffffUL
+#define SPIN_LOCK_TAIL_SHIFT 32
+#define SPIN_LOCK_TAIL_MASK (0x7fffffffUL << SPIN_LOCK_TAIL_SHIFT)
+#define SPIN_LOCK_QUEUED (1UL << 63)
+
+#define QUEUED_SPIN_LOCK_INITIAL_VALUE \
+  (spin_lock_t) { SPIN_LOCK_QUEUED }
+
+// Slow paths used by the arch spinlock implementations for queued locks. |val| is the current
+// cpu number plus one.
+void spin_lock_queued(spin_lock_t* lock, unsigned long val) TA_ACQ(lock);
+int spin_trylock_queued(spin_lock_t* lock, unsigned long val) TA_TRY_ACQ(false, lock);
+void spin_unlock_queued(spin_lock_t* lock) TA_REL(lock);
+
 /* returns true if |lock| is held by the current CPU;
  * interrupts should be disabled before calling */
 static inline bool spin_lock_held(spin_lock_t* lock) { return arch_spin_lock_held(lock); }
@@ -37,6 +59,10 @@ static inline void spin_unlock(spin_lock_t* lock) TA_REL(lock) { arch_spin_unloc
 
 static inline void spin_lock_init(spin_lock_t* lock) { *lock = SPIN_LOCK_INITIAL_VALUE; }
 
+static inline void spin_lock_init_queued(spin_lock_t* lock) {
+  *lock = QUEUED_SPIN_LOCK_INITIAL_VALUE;
+}
+
 // which cpu currently holds the spin lock
 // returns UINT_MAX if not held
 static inline uint spin_lock_holder_cpu(spin_lock_t* lock) {
@@ -81,7 +107,14 @@ __END_CDECLS
 
 class TA_CAP("mutex") SpinLock {
  public:
+  // Tag for constructing a queued SpinLock, for example:
+  //
+  //     DECLARE_SPINLOCK(MyType) lock_{SpinLock::Queued{}};
+  //
+  struct Queued {};
+
   constexpr SpinLock() = default;
+  explicit constexpr SpinLock(Queued) : spinlock_(QUEUED_SPIN_LOCK_INITIAL_VALUE) {}
   void Acquire() TA_ACQ() { spin_lock(&spinlock_); }
   bool TryAcquire() TA_TRY_ACQ(false) { return spin_trylock(&spinlock_); }
   void Release() TA_REL() { spin_unlock(&spinlock_); }
@@ -36,6 +36,7 @@ struct Thread;
 // fwd decls
 class OwnedWaitQueue;
 class ThreadDispatcher;
+struct thread_stats_page;
 
 enum thread_state {
   THREAD_INITIAL = 0,
@@ -63,6 +64,7 @@ typedef void (*thread_trampoline_routine)() __NO_RETURN;
 #define THREAD_SIGNAL_KILL                   (1 << 0)
 #define THREAD_SIGNAL_SUSPEND                (1 << 1)
 #define THREAD_SIGNAL_POLICY_EXCEPTION       (1 << 2)
+#define THREAD_SIGNAL_SAMPLE                 (1 << 3)
 // clang-format on
 
 #define THREAD_MAGIC (0x74687264)  // 'thrd'
@@ -203,6 +205,14 @@ struct Thread {
   zx_duration_t Runtime() const;
   // Last cpu this thread was running on, or INVALID_CPU if it has never run.
   cpu_num_t LastCpu() const TA_EXCL(thread_lock);
+
+  // Set the page to which the thread's runtime statistics are published, or
+  // nullptr to stop publishing them. The page must stay mapped until the
+  // thread has been joined or forgotten, or until it is replaced.
+  void SetStatsPage(thread_stats_page* page) TA_EXCL(thread_lock);
+  // Publish the thread's runtime statistics to its stats page, if it has one.
+  // Called by the scheduler whenever the thread is switched to or away from.
+  void PublishStatsLocked(bool switched_to) TA_REQ(thread_lock);
   // Return true if thread has been signaled.
   bool IsSignaled() { return signals_ != 0; }
   bool IsIdle() const { return !!(flags_ & THREAD_FLAG_IDLE); }
@@ -233,6 +243,9 @@ struct Thread {
 
     static void SignalPolicyException();
 
+    // Requests a sample of the user stack on the way back to user mode.
+    static void SignalSample();
+
     // Process pending signals, may never return because of kill signal.
     static void ProcessPendingSignals(GeneralRegsSource source, void* gregs);
 
@@ -491,6 +504,10 @@ struct Thread {
 
   // Provides a way to execute a custom logic when a thread must be migrated between CPUs.
   MigrateFn migrate_fn_;
+
+  // If set, the page to which the scheduler publishes the thread's runtime
+  // statistics. See |SetStatsPage|.
+  thread_stats_page* stats_page_ TA_GUARDED(thread_lock) = nullptr;
 };
 
 // For the moment, the arch-specific current thread implementations need to come here, after the
@@ -11,8 +11,11 @@
 
 #include <kernel/lockdep.h>
 
+// The thread lock is held across context switches and released by the guard
+// of the thread switched to, so lockstat only records its wait times.
 extern spin_lock_t thread_lock;
 DECLARE_SINGLETON_LOCK_WRAPPER(ThreadLock, thread_lock,
-                               (LockFlagsReportingDisabled | LockFlagsTrackingDisabled));
+                               (LockFlagsReportingDisabled | LockFlagsTrackingDisabled |
+                                LockFlagsHoldStatsDisabled));
 
 #endif  // ZIRCON_KERNEL_INCLUDE_KERNEL_THREAD_LOCK_H_
@@ -14,6 +14,7 @@
 #include <zircon/types.h>
 
 #include <fbl/canary.h>
+#include <fbl/intrusive_wavl_tree.h>
 #include <kernel/deadline.h>
 #include <kernel/spinlock.h>
 
@@ -24,17 +25,34 @@
 // - Setting and canceling timers is not thread safe and cannot be done concurrently.
 // - Timer::cancel() may spin waiting for a pending timer to complete on another cpu.
 
-// For now, Timers are structs with standard layout. Eventually, the list_node inside will no longer
-// force that requirement, and this can become a class with private members.
-struct Timer {
+// For now, Timers are structs with public members. Eventually, this can become a class with private
+// members.
+struct Timer : public fbl::WAVLTreeContainable<Timer*> {
   using Callback = void (*)(Timer*, zx_time_t now, void* arg);
 
+  // Timers are kept in per-cpu trees ordered by scheduled time. Timers with the same scheduled
+  // time, which is common because of slack coalescing, are ordered by when they were queued.
+  struct Key {
+    zx_time_t scheduled_time;
+    uint64_t sequence;
+
+    bool operator<(const Key& other) const {
+      return scheduled_time < other.scheduled_time ||
+             (scheduled_time == other.scheduled_time && sequence < other.sequence);
+    }
+    bool operator==(const Key& other) const {
+      return scheduled_time == other.scheduled_time && sequence == other.sequence;
+    }
+  };
+
   static constexpr uint32_t kMagic = fbl::magic("timr");
   uint32_t magic_ = kMagic;
 
-  struct list_node node_ = LIST_INITIAL_CLEARED_VALUE;
-
   zx_time_t scheduled_time_ = 0;
+  // Breaks ties between timers with the same scheduled time. Assigned when queued.
+  uint64_t sequence_ = 0;
+  // The cpu whose queue this timer is in. Only valid while InContainer().
+  uint queued_cpu_ = 0;
   // Stores the applied slack adjustment from the ideal scheduled_time.
   zx_duration_t slack_ = 0;
   Callback callback_ = nullptr;
@@ -90,8 +108,13 @@ struct Timer {
   // timer cancel, which is needed in a few special cases.
   // returns ZX_OK if spinlock was acquired, ZX_ERR_TIMED_OUT if timer was canceled.
   zx_status_t TrylockOrCancel(spin_lock_t* lock) TA_TRY_ACQ(false, lock);
+
+  Key GetKey() const { return {scheduled_time_, sequence_}; }
 };
 
+// A cpu's queue of pending timers, ordered by deadline.
+using TimerTree = fbl::WAVLTree<Timer::Key, Timer*>;
+
 struct TimerQueue {
   // Preemption Timers
   //
@@ -29,15 +29,34 @@
 #include <zircon/time.h>
 #include <zircon/types.h>
 
+#include <kernel/align.h>
+#include <kernel/auto_preempt_disabler.h>
 #include <kernel/sched.h>
 #include <kernel/thread.h>
 #include <kernel/thread_lock.h>
+#include <ktl/algorithm.h>
 #include <ktl/type_traits.h>
 
 #define LOCAL_TRACE 0
 
 namespace {
 
+// Spinning waiters queue up MCS style so that only the head of the queue
+// spins on the mutex word, and the others spin on a node local to their cpu.
+// Spinners keep preemption disabled while queued, so each cpu needs a single
+// node.
+struct SpinnerNode {
+  ktl::atomic<SpinnerNode*> next;
+  ktl::atomic<bool> is_head;
+} __CPU_ALIGN;
+
+SpinnerNode spinner_nodes[SMP_MAX_CPUS];
+
+// The spin budget is this multiple of the recent wait of successful spinners,
+// but never less than the floor below or more than the caller's maximum.
+constexpr zx_ticks_t kSpinHintMultiplier = 2;
+constexpr zx_duration_t kMinAdaptiveSpinDuration = ZX_USEC(10);
+
 enum class KernelMutexTracingLevel {
   None,       // No tracing is ever done.  All code drops out at compile time.
   Contested,  // Trace events are only generated when mutexes are contested.
@@ -143,31 +162,13 @@ void Mutex::Acquire(zx_duration_t spin_max_duration) {
   }
 
   // Faster path: Spin on the mutex until it is either released, contested, or
-  // the max spin time is reached.
-  // TODO(ZX-4873): Optimize cache pressure of spinners and default spin max.
-  const affine::Ratio time_to_ticks = platform_get_ticks_to_time_ratio().Inverse();
-  const zx_ticks_t spin_until_ticks =
-      affine::utils::ClampAdd(current_ticks(), time_to_ticks.Scale(spin_max_duration));
-  do {
-    old_mutex_state = STATE_FREE;
-    if (likely(val_.compare_exchange_strong(old_mutex_state, new_mutex_state,
-                                            ktl::memory_order_seq_cst,
-                                            ktl::memory_order_seq_cst))) {
-      // Same as above in the fastest path: leave accounting to later contending
-      // threads.
-      KTracer{}.KernelMutexUncontestedAcquire(this);
-      return;
-    }
-
-    // Stop spinning if the mutex is or becomes contested. All spinners convert
-    // to blocking when the first one reaches the max spin duration.
-    if (old_mutex_state & STATE_FLAG_CONTESTED) {
-      break;
-    }
-
-    // Give the arch a chance to relax the CPU.
-    arch::Yield();
-  } while (current_ticks() < spin_until_ticks);
+  // the spin budget runs out.
+  if (spin_max_duration > 0 && Spin(new_mutex_state, spin_max_duration)) {
+    // Same as above in the fastest path: leave accounting to later contending
+    // threads.
+    KTracer{}.KernelMutexUncontestedAcquire(this);
+    return;
+  }
 
   if ((LK_DEBUGLEVEL > 0) && unlikely(this->IsHeld())) {
     panic("Mutex::Acquire: thread %p (%s) tried to acquire mutex %p it already owns.\n", ct,
@@ -219,11 +220,140 @@ void Mutex::Acquire(zx_duration_t spin_max_duration) {
   }
 }
 
+bool Mutex::Spin(uintptr_t new_mutex_state, zx_duration_t spin_max_duration) {
+  const affine::Ratio time_to_ticks = platform_get_ticks_to_time_ratio().Inverse();
+  const zx_ticks_t start_ticks = current_ticks();
+
+  // Size the budget from the recent waits of spinners that got the mutex, so
+  // that spinners give up early on a mutex that is usually held briefly but
+  // happens to be held for a long time now. A hint of zero means the last
+  // spinner gave up and the estimate can't be trusted, so spin the maximum.
+  zx_ticks_t spin_ticks = time_to_ticks.Scale(spin_max_duration);
+  const uint32_t hint = spin_hint_.load(ktl::memory_order_relaxed);
+  if (hint != 0) {
+    spin_ticks =
+        ktl::min(spin_ticks, ktl::max(kSpinHintMultiplier * hint,
+                                      time_to_ticks.Scale(kMinAdaptiveSpinDuration)));
+  }
+  const zx_ticks_t spin_until_ticks = affine::utils::ClampAdd(start_ticks, spin_ticks);
+
+  AutoPreemptDisabler<APDInitialState::PREEMPT_DISABLED> preempt_disabler;
+
+  // Join the tail of the spinner queue. If there was a spinner ahead of us,
+  // link ourselves behind it and wait for it to hand us the head of the queue.
+  const cpu_num_t cpu = arch_curr_cpu_num();
+  SpinnerNode* const node = &spinner_nodes[cpu];
+  node->next.store(nullptr, ktl::memory_order_relaxed);
+  node->is_head.store(false, ktl::memory_order_relaxed);
+  const uint32_t prev = spinner_tail_.exchange(cpu + 1, ktl::memory_order_acq_rel);
+  if (prev != 0) {
+    spinner_nodes[prev - 1].next.store(node, ktl::memory_order_release);
+    while (!node->is_head.load(ktl::memory_order_acquire)) {
+      arch::Yield();
+    }
+  }
+
+  // We are at the head of the queue. Let releasers hand us the mutex
+  // directly, and spin on the mutex itself. All spinners convert to blocking
+  // once the mutex is contested, which happens when the first of them runs out
+  // of budget and blocks.
+  spin_head_.store(new_mutex_state, ktl::memory_order_release);
+  bool acquired = false;
+  do {
+    uintptr_t old_mutex_state = STATE_FREE;
+    if (likely(val_.compare_exchange_strong(old_mutex_state, new_mutex_state,
+                                            ktl::memory_order_seq_cst,
+                                            ktl::memory_order_seq_cst))) {
+      acquired = true;
+      break;
+    }
+
+    // The holder handed the mutex to us as it released it.
+    if (old_mutex_state == new_mutex_state) {
+      acquired = true;
+      break;
+    }
+
+    if (old_mutex_state & STATE_FLAG_CONTESTED) {
+      break;
+    }
+
+    // Give the arch a chance to relax the CPU.
+    arch::Yield();
+  } while (current_ticks() < spin_until_ticks);
+
+  // Stop accepting handoffs. If a releaser has already claimed us, wait for
+  // it to finish, after which val_ tells whether it handed us the mutex.
+  uintptr_t published = new_mutex_state;
+  if (!spin_head_.compare_exchange_strong(published, 0, ktl::memory_order_acq_rel,
+                                          ktl::memory_order_acquire)) {
+    while (spin_head_.load(ktl::memory_order_acquire) != 0) {
+      arch::Yield();
+    }
+    acquired = val_.load(ktl::memory_order_seq_cst) == new_mutex_state;
+  }
+
+  // Leave the queue. If we are not the tail, hand the head of the queue to
+  // the next spinner, which may not have linked itself behind us yet.
+  uint32_t tail = cpu + 1;
+  if (!spinner_tail_.compare_exchange_strong(tail, 0, ktl::memory_order_release,
+                                             ktl::memory_order_relaxed)) {
+    SpinnerNode* next;
+    while ((next = node->next.load(ktl::memory_order_acquire)) == nullptr) {
+      arch::Yield();
+    }
+    next->is_head.store(true, ktl::memory_order_release);
+  }
+
+  if (acquired) {
+    const zx_ticks_t waited = current_ticks() - start_ticks;
+    const uint32_t sample = static_cast<uint32_t>(ktl::clamp<zx_ticks_t>(waited, 1, UINT32_MAX));
+    // Keep a running average of 3/4 of the old hint and 1/4 of the new sample.
+    const uint64_t new_hint = hint == 0 ? sample : (3 * uint64_t{hint} + sample) / 4;
+    spin_hint_.store(static_cast<uint32_t>(ktl::max<uint64_t>(new_hint, 1)),
+                     ktl::memory_order_relaxed);
+  } else {
+    spin_hint_.store(0, ktl::memory_order_relaxed);
+  }
+
+  return acquired;
+}
+
+bool Mutex::HandOffToSpinner(uintptr_t owner_state) {
+  // The head spinner waits for us between claiming it and clearing the claim,
+  // so don't let anything run on this cpu in between.
+  spin_lock_saved_state_t irq_state;
+  arch_interrupt_save(&irq_state, SPIN_LOCK_FLAG_INTERRUPTS);
+
+  bool handed_off = false;
+  uintptr_t head = spin_head_.load(ktl::memory_order_acquire);
+  if (head != 0 && !(head & SPIN_HEAD_CLAIMED) &&
+      spin_head_.compare_exchange_strong(head, head | SPIN_HEAD_CLAIMED,
+                                         ktl::memory_order_acq_rel, ktl::memory_order_relaxed)) {
+    // This only fails if a thread has blocked on the mutex since it was
+    // acquired, in which case the spinner stops spinning too.
+    handed_off = val_.compare_exchange_strong(owner_state, head, ktl::memory_order_seq_cst,
+                                              ktl::memory_order_seq_cst);
+    spin_head_.store(0, ktl::memory_order_release);
+  }
+
+  arch_interrupt_restore(irq_state, SPIN_LOCK_FLAG_INTERRUPTS);
+  return handed_off;
+}
+
 // Shared implementation of release
 template <Mutex::ThreadLockState TLS>
 void Mutex::ReleaseInternal(const bool allow_reschedule) {
   Thread* ct = Thread::Current::Get();
 
+  // If a thread is spinning on the mutex, pass the mutex to it directly
+  // rather than letting it race new acquirers for the free mutex.
+  if (spin_head_.load(ktl::memory_order_relaxed) != 0 &&
+      HandOffToSpinner(reinterpret_cast<uintptr_t>(ct))) {
+    KTracer{}.KernelMutexUncontestedRelease(this);
+    return;
+  }
+
   // Try the fast path.  Assume that we are locked, but uncontested.
   uintptr_t old_mutex_state = reinterpret_cast<uintptr_t>(ct);
   if (likely(val_.compare_exchange_strong(old_mutex_state, STATE_FREE, ktl::memory_order_seq_cst,
@@ -8,6 +8,8 @@
 
 #include <kernel/mutex.h>
 
+#include "../tests/lock_contention.h"
+
 namespace {
 
 bool mutex_lock_unlock() {
@@ -83,6 +85,25 @@ bool mutex_assert_held_compile_test() {
   END_TEST;
 }
 
+bool mutex_contention() {
+  BEGIN_TEST;
+
+  Mutex mutex;
+  auto acquire_release = [&mutex](zx_duration_t spin_max_duration) {
+    return [&mutex, spin_max_duration](uint64_t* total) TA_NO_THREAD_SAFETY_ANALYSIS {
+      mutex.Acquire(spin_max_duration);
+      (*total)++;
+      mutex.Release();
+    };
+  };
+
+  EXPECT_TRUE(lock_contention::Run("mutex without spinning", acquire_release(0)));
+  EXPECT_TRUE(
+      lock_contention::Run("mutex with spinning", acquire_release(Mutex::SPIN_MAX_DURATION)));
+
+  END_TEST;
+}
+
 }  // namespace
 
 UNITTEST_START_TESTCASE(mutex_tests)
@@ -90,4 +111,5 @@ UNITTEST("mutex_lock_unlock", mutex_lock_unlock)
 UNITTEST("mutex_is_held", mutex_is_held)
 UNITTEST("mutex_assert_held", mutex_assert_held)
 UNITTEST("mutex_assert_held_compile_test", mutex_assert_held_compile_test)
+UNITTEST("mutex_contention", mutex_contention)
 UNITTEST_END_TESTCASE(mutex_tests, "mutex", "Mutex tests")
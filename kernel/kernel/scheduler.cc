@@ -32,6 +32,7 @@
 #include <kernel/thread.h>
 #include <kernel/thread_lock.h>
 #include <ktl/algorithm.h>
+#include <ktl/iterator.h>
 #include <ktl/move.h>
 #include <vm/vm.h>
 
@@ -78,8 +79,91 @@ KCOUNTER(latency_counter, "thread.latency_accum")
 KCOUNTER(runnable_counter, "thread.runnable_accum")
 KCOUNTER(samples_counter, "thread.samples_accum")
 
+// Histograms of scheduler behavior. Each bucket is a counter named
+// "<histogram>.<lower bound>", with the lower bound zero-padded so that the
+// buckets sort in order. This keeps the histograms always on, per-CPU, and
+// readable through the kcounter VMOs.
+
+// Defines |var| as the buckets of a histogram of microseconds: [0, 1), then
+// log2 buckets [1, 2), [2, 4), ... up to [65536, inf).
+#define SCHED_US_HISTOGRAM(var, name)                                    \
+  KCOUNTER(var##_0, name ".000000")                                      \
+  KCOUNTER(var##_1, name ".000001")                                      \
+  KCOUNTER(var##_2, name ".000002")                                      \
+  KCOUNTER(var##_3, name ".000004")                                      \
+  KCOUNTER(var##_4, name ".000008")                                      \
+  KCOUNTER(var##_5, name ".000016")                                      \
+  KCOUNTER(var##_6, name ".000032")                                      \
+  KCOUNTER(var##_7, name ".000064")                                      \
+  KCOUNTER(var##_8, name ".000128")                                      \
+  KCOUNTER(var##_9, name ".000256")                                      \
+  KCOUNTER(var##_10, name ".000512")                                     \
+  KCOUNTER(var##_11, name ".001024")                                     \
+  KCOUNTER(var##_12, name ".002048")                                     \
+  KCOUNTER(var##_13, name ".004096")                                     \
+  KCOUNTER(var##_14, name ".008192")                                     \
+  KCOUNTER(var##_15, name ".016384")                                     \
+  KCOUNTER(var##_16, name ".032768")                                     \
+  KCOUNTER(var##_17, name ".065536")                                     \
+  namespace {                                                            \
+  const Counter* const var[] = {                                         \
+      &var##_0,  &var##_1,  &var##_2,  &var##_3,  &var##_4,  &var##_5,   \
+      &var##_6,  &var##_7,  &var##_8,  &var##_9,  &var##_10, &var##_11,  \
+      &var##_12, &var##_13, &var##_14, &var##_15, &var##_16, &var##_17}; \
+  }  // anonymous namespace
+
+// The time from a thread waking up or migrating to this CPU until it runs.
+SCHED_US_HISTOGRAM(wakeup_latency_histogram, "sched.wakeup_latency_us")
+
+// How late a deadline thread was descheduled after its deadline, with part of
+// its capacity still unused. Each sample is a deadline miss.
+SCHED_US_HISTOGRAM(deadline_miss_histogram, "sched.deadline_miss_us")
+
+// The percentage of its time slice a thread used before it was descheduled,
+// in buckets of 10%. Threads preempted at the end of their time slice count
+// in the last bucket.
+KCOUNTER(slice_utilization_0, "sched.slice_utilization_pct.000")
+KCOUNTER(slice_utilization_1, "sched.slice_utilization_pct.010")
+KCOUNTER(slice_utilization_2, "sched.slice_utilization_pct.020")
+KCOUNTER(slice_utilization_3, "sched.slice_utilization_pct.030")
+KCOUNTER(slice_utilization_4, "sched.slice_utilization_pct.040")
+KCOUNTER(slice_utilization_5, "sched.slice_utilization_pct.050")
+KCOUNTER(slice_utilization_6, "sched.slice_utilization_pct.060")
+KCOUNTER(slice_utilization_7, "sched.slice_utilization_pct.070")
+KCOUNTER(slice_utilization_8, "sched.slice_utilization_pct.080")
+KCOUNTER(slice_utilization_9, "sched.slice_utilization_pct.090")
+KCOUNTER(slice_utilization_10, "sched.slice_utilization_pct.100")
+
+// The number of runnable threads on this CPU, including the running thread,
+// sampled at every reschedule that changes the running thread or starts a new
+// time slice. The buckets are [0], [1], [2, 4), [4, 8), ... up to [32, inf).
+KCOUNTER(run_queue_depth_0, "sched.run_queue_depth.00")
+KCOUNTER(run_queue_depth_1, "sched.run_queue_depth.01")
+KCOUNTER(run_queue_depth_2, "sched.run_queue_depth.02")
+KCOUNTER(run_queue_depth_3, "sched.run_queue_depth.04")
+KCOUNTER(run_queue_depth_4, "sched.run_queue_depth.08")
+KCOUNTER(run_queue_depth_5, "sched.run_queue_depth.16")
+KCOUNTER(run_queue_depth_6, "sched.run_queue_depth.32")
+
 namespace {
 
+const Counter* const slice_utilization_histogram[] = {
+    &slice_utilization_0, &slice_utilization_1, &slice_utilization_2, &slice_utilization_3,
+    &slice_utilization_4, &slice_utilization_5, &slice_utilization_6, &slice_utilization_7,
+    &slice_utilization_8, &slice_utilization_9, &slice_utilization_10};
+
+const Counter* const run_queue_depth_histogram[] = {
+    &run_queue_depth_0, &run_queue_depth_1, &run_queue_depth_2, &run_queue_depth_3,
+    &run_queue_depth_4, &run_queue_depth_5, &run_queue_depth_6};
+
+// Counts |value| in a histogram whose first bucket holds zero and whose bucket
+// i > 0 holds [2^(i-1), 2^i). The last bucket also holds every larger value.
+template <size_t N>
+void AddToLog2Histogram(const Counter* const (&histogram)[N], int64_t value) {
+  const size_t bucket = value <= 0 ? 0 : 64 - __builtin_clzll(value);
+  histogram[ktl::min(bucket, N - 1)]->Add(1);
+}
+
 // Conversion table entry. Scales the integer argument to a fixed-point weight
 // in the interval (0.0, 1.0].
 struct WeightTableEntry {
@@ -435,6 +519,8 @@ void Scheduler::UpdateCounters(SchedDuration queue_time_ns) {
   runnable_counter.Add(runnable_fair_task_count_ + runnable_deadline_task_count_);
   latency_counter.Add(queue_time_ns.raw_value());
   samples_counter.Add(1);
+  AddToLog2Histogram(run_queue_depth_histogram,
+                     runnable_fair_task_count_ + runnable_deadline_task_count_);
 }
 
 // Selects a thread to run. Performs any necessary maintenanace if the current
@@ -719,6 +805,11 @@ void Scheduler::RescheduleCommon(SchedTime now, EndTraceCallback end_outer_trace
 
   const bool timeslice_expired = total_runtime_ns >= current_state->time_slice_ns_;
 
+  // Requeuing the current thread below consumes its time slice and may start a
+  // new deadline period, so keep the values the histograms need.
+  const SchedDuration current_time_slice_ns = current_state->time_slice_ns_;
+  const SchedTime current_finish_time_ns = current_state->finish_time_;
+
   // Select a thread to run.
   Thread* const next_thread =
       EvaluateNextThread(now, current_thread, timeslice_expired, total_runtime_ns);
@@ -773,6 +864,23 @@ void Scheduler::RescheduleCommon(SchedTime now, EndTraceCallback end_outer_trace
                          Round<uint64_t>(total_deadline_utilization_));
   }
 
+  // Account for the time slice of the current thread when it ends, whether it
+  // expired, the thread blocked, or another thread preempted it.
+  if (!current_thread->IsIdle() && (timeslice_expired || current_thread != next_thread)) {
+    const int64_t utilization_pct =
+        current_time_slice_ns > SchedDuration{0}
+            ? total_runtime_ns.raw_value() * 100 / current_time_slice_ns.raw_value()
+            : 100;
+    slice_utilization_histogram[ktl::clamp<int64_t>(utilization_pct / 10, 0, 10)]->Add(1);
+
+    // A deadline thread that still has capacity at its deadline missed it.
+    if (IsDeadlineThread(current_thread) && now >= current_finish_time_ns &&
+        total_runtime_ns < current_time_slice_ns) {
+      AddToLog2Histogram(deadline_miss_histogram,
+                         (now - current_finish_time_ns).raw_value() / ZX_USEC(1));
+    }
+  }
+
   // Always call to handle races between reschedule IPIs and changes to the run
   // queue.
   mp_prepare_current_cpu_idle_state(next_thread->IsIdle());
@@ -821,6 +929,10 @@ void Scheduler::RescheduleCommon(SchedTime now, EndTraceCallback end_outer_trace
     // entered the run queue.
     const SchedDuration queue_time_ns = now - next_state->last_started_running_;
     UpdateCounters(queue_time_ns);
+    if (next_state->woken_) {
+      next_state->woken_ = false;
+      AddToLog2Histogram(wakeup_latency_histogram, queue_time_ns.raw_value() / ZX_USEC(1));
+    }
 
     next_state->last_started_running_ = now;
     start_of_current_time_slice_ns_ = now;
@@ -853,6 +965,9 @@ void Scheduler::RescheduleCommon(SchedTime now, EndTraceCallback end_outer_trace
 
     TraceContextSwitch(current_thread, next_thread, current_cpu);
 
+    current_thread->PublishStatsLocked(false);
+    next_thread->PublishStatsLocked(true);
+
     SCHED_LTRACEF("current=(%s, flags 0x%#x) next=(%s, flags 0x%#x)\n", current_thread->name_,
                   current_thread->flags_, next_thread->name_, next_thread->flags_);
 
@@ -1113,6 +1228,7 @@ void Scheduler::Insert(SchedTime now, Thread* thread) {
       DEBUG_ASSERT(runnable_deadline_task_count_ != 0);
     }
 
+    state->woken_ = true;
     QueueThread(thread, Placement::Insertion, now);
   }
 }
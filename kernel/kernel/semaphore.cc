@@ -46,3 +46,13 @@ zx_status_t Semaphore::Wait(const Deadline& deadline) {
   current_thread->interruptable_ = false;
   return ret;
 }
+
+bool Semaphore::TryWait() {
+  Guard<spin_lock_t, IrqSave> guard{ThreadLock::Get()};
+
+  if (count_ == 0) {
+    return false;
+  }
+  --count_;
+  return true;
+}
@@ -0,0 +1,123 @@
+// Copyright 2020 The Fuchsia Authors
+//
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT
+
+// Queued spinlocks.
+//
+// A queued lock is an MCS lock packed into a spin_lock_t: rather than a
+// pointer to the last waiter, the lock word holds the number of the cpu at
+// the tail of the queue, and each cpu has a single queue node. A cpu only
+// uses its node while it waits for a lock, and it waits for at most one lock
+// at a time since spinlocks are acquired with interrupts disabled.
+//
+// The waiter at the head of the queue spins on the lock word. Every other
+// waiter spins on its own node until its predecessor takes the lock and
+// hands it the head of the queue.
+
+#include <assert.h>
+#include <lib/arch/intrin.h>
+
+#include <arch/ops.h>
+#include <kernel/align.h>
+#include <kernel/spinlock.h>
+
+namespace {
+
+struct QueueNode {
+  QueueNode* next;
+  bool is_head;
+} __CPU_ALIGN;
+
+QueueNode queue_nodes[SMP_MAX_CPUS];
+
+inline unsigned long load(spin_lock_t* lock) {
+  return __atomic_load_n(&lock->value, __ATOMIC_RELAXED);
+}
+
+inline bool compare_exchange(spin_lock_t* lock, unsigned long* expected, unsigned long desired) {
+  return __atomic_compare_exchange_n(&lock->value, expected, desired, false, __ATOMIC_ACQUIRE,
+                                     __ATOMIC_RELAXED);
+}
+
+}  // anonymous namespace
+
+// We need to disable thread safety analysis in this file, since we're
+// implementing the locks themselves.
+
+void spin_lock_queued(spin_lock_t* lock, unsigned long val) TA_NO_THREAD_SAFETY_ANALYSIS {
+  DEBUG_ASSERT(arch_ints_disabled());
+  DEBUG_ASSERT(val > 0 && val <= SMP_MAX_CPUS);
+
+  // Take the lock right away if it is free and nobody is waiting for it.
+  unsigned long value = load(lock);
+  while ((value & ~SPIN_LOCK_QUEUED) == 0) {
+    if (compare_exchange(lock, &value, value | val)) {
+      return;
+    }
+  }
+
+  QueueNode* node = &queue_nodes[val - 1];
+  __atomic_store_n(&node->next, nullptr, __ATOMIC_RELAXED);
+  __atomic_store_n(&node->is_head, false, __ATOMIC_RELAXED);
+
+  // Join the tail of the queue.
+  const unsigned long tail = val << SPIN_LOCK_TAIL_SHIFT;
+  while (!__atomic_compare_exchange_n(&lock->value, &value, (value & ~SPIN_LOCK_TAIL_MASK) | tail,
+                                      false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+  }
+
+  // If there was a waiter ahead of us, link ourselves behind it and wait for
+  // it to hand us the head of the queue.
+  const unsigned long prev = (value & SPIN_LOCK_TAIL_MASK) >> SPIN_LOCK_TAIL_SHIFT;
+  if (prev != 0) {
+    __atomic_store_n(&queue_nodes[prev - 1].next, node, __ATOMIC_RELEASE);
+    while (!__atomic_load_n(&node->is_head, __ATOMIC_ACQUIRE)) {
+      arch::Yield();
+    }
+  }
+
+  // We are at the head of the queue, so we are next to take the lock once it
+  // is released. If we are also the tail, the queue is empty once we have it.
+  value = load(lock);
+  bool last;
+  for (;;) {
+    if (value & SPIN_LOCK_HOLDER_MASK) {
+      arch::Yield();
+      value = load(lock);
+      continue;
+    }
+    last = (value & SPIN_LOCK_TAIL_MASK) == tail;
+    if (compare_exchange(lock, &value, last ? (SPIN_LOCK_QUEUED | val) : (value | val))) {
+      break;
+    }
+  }
+  if (last) {
+    return;
+  }
+
+  // Hand the head of the queue to the next waiter, which may not have linked
+  // itself behind us yet.
+  QueueNode* next;
+  while ((next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE)) == nullptr) {
+    arch::Yield();
+  }
+  __atomic_store_n(&next->is_head, true, __ATOMIC_RELEASE);
+}
+
+int spin_trylock_queued(spin_lock_t* lock, unsigned long val) TA_NO_THREAD_SAFETY_ANALYSIS {
+  // Fail if the lock is held or has waiters, which would otherwise be overtaken.
+  unsigned long value = load(lock);
+  while ((value & ~SPIN_LOCK_QUEUED) == 0) {
+    if (compare_exchange(lock, &value, value | val)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+void spin_unlock_queued(spin_lock_t* lock) TA_NO_THREAD_SAFETY_ANALYSIS {
+  // Waiters may be changing the tail concurrently, so only clear the holder.
+  __atomic_fetch_and(&lock->value, ~SPIN_LOCK_HOLDER_MASK, __ATOMIC_RELEASE);
+}
@@ -8,6 +8,8 @@
 
 #include <kernel/spinlock.h>
 
+#include "../tests/lock_contention.h"
+
 namespace {
 
 bool spinlock_lock_unlock() {
@@ -87,6 +89,49 @@ bool spinlock_assert_held_compile_test() {
   END_TEST;
 }
 
+bool spinlock_queued() {
+  BEGIN_TEST;
+
+  SpinLock spinlock{SpinLock::Queued{}};
+  spin_lock_saved_state_t state;
+
+  EXPECT_FALSE(spinlock.IsHeld(), "Lock not held");
+  spinlock.AcquireIrqSave(state);
+  EXPECT_TRUE(spinlock.IsHeld(), "Lock held");
+  EXPECT_EQ(arch_curr_cpu_num(), spin_lock_holder_cpu(spinlock.GetInternal()));
+  spinlock.ReleaseIrqRestore(state);
+  EXPECT_FALSE(spinlock.IsHeld(), "Lock not held");
+
+  arch_interrupt_save(&state, SPIN_LOCK_FLAG_INTERRUPTS);
+  EXPECT_FALSE(spinlock.TryAcquire(), "Lock acquired");
+  EXPECT_TRUE(spinlock.IsHeld(), "Lock held");
+  spinlock.Release();
+  arch_interrupt_restore(state, SPIN_LOCK_FLAG_INTERRUPTS);
+
+  END_TEST;
+}
+
+bool spinlock_contention() {
+  BEGIN_TEST;
+
+  auto acquire_release = [](SpinLock* lock) {
+    return [lock](uint64_t* total) TA_NO_THREAD_SAFETY_ANALYSIS {
+      spin_lock_saved_state_t irq_state;
+      lock->AcquireIrqSave(irq_state);
+      (*total)++;
+      lock->ReleaseIrqRestore(irq_state);
+    };
+  };
+
+  SpinLock spinlock;
+  EXPECT_TRUE(lock_contention::Run("spinlock", acquire_release(&spinlock)));
+
+  SpinLock queued{SpinLock::Queued{}};
+  EXPECT_TRUE(lock_contention::Run("queued spinlock", acquire_release(&queued)));
+
+  END_TEST;
+}
+
 }  // namespace
 
 UNITTEST_START_TESTCASE(spinlock_tests)
@@ -94,4 +139,6 @@ UNITTEST("spinlock_lock_unlock", spinlock_lock_unlock)
 UNITTEST("spinlock_is_held", spinlock_is_held)
 UNITTEST("spinlock_assert_held", spinlock_assert_held)
 UNITTEST("spinlock_assert_held_compile_test", spinlock_assert_held_compile_test)
+UNITTEST("spinlock_queued", spinlock_queued)
+UNITTEST("spinlock_contention", spinlock_contention)
 UNITTEST_END_TESTCASE(spinlock_tests, "spinlock", "SpinLock tests")
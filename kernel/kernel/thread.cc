@@ -25,6 +25,8 @@
 #include <lib/heap.h>
 #include <lib/ktrace.h>
 #include <lib/lazy_init/lazy_init.h>
+#include <lib/sampler.h>
+#include <lib/userabi/thread-stats.h>
 #include <lib/version.h>
 #include <platform.h>
 #include <stdio.h>
@@ -75,7 +77,10 @@ KCOUNTER(thread_resume_count, "thread.resume")
 static lazy_init::LazyInit<Thread::List> thread_list;
 
 // master thread spinlock
-spin_lock_t thread_lock __CPU_ALIGN_EXCLUSIVE = SPIN_LOCK_INITIAL_VALUE;
+//
+// Every cpu takes it on every reschedule, so it is queued to keep acquisition fair under
+// contention.
+spin_lock_t thread_lock __CPU_ALIGN_EXCLUSIVE = QUEUED_SPIN_LOCK_INITIAL_VALUE;
 
 // local routines
 static void thread_exit_locked(Thread* current_thread, int retcode) __NO_RETURN;
@@ -388,6 +393,12 @@ void Thread::Current::SignalPolicyException() {
   t->signals_ |= THREAD_SIGNAL_POLICY_EXCEPTION;
 }
 
+void Thread::Current::SignalSample() {
+  Thread* t = Thread::Current::Get();
+  Guard<spin_lock_t, IrqSave> guard{ThreadLock::Get()};
+  t->signals_ |= THREAD_SIGNAL_SAMPLE;
+}
+
 zx_status_t Thread::Join(int* out_retcode, zx_time_t deadline) {
   DEBUG_ASSERT(magic_ == THREAD_MAGIC);
 
@@ -799,6 +810,19 @@ void Thread::Current::ProcessPendingSignals(GeneralRegsSource source, void* greg
     return;
   }
 
+  // A sample is not a debugger-visible action, so take it before the other
+  // signals and without saving the general registers.
+  if (current_thread->signals_ & THREAD_SIGNAL_SAMPLE) {
+    {
+      Guard<spin_lock_t, IrqSave> guard{ThreadLock::Get()};
+      current_thread->signals_ &= ~THREAD_SIGNAL_SAMPLE;
+    }
+    sampler::SampleUser(source, gregs);
+    if (current_thread->signals_ == 0) {
+      return;
+    }
+  }
+
   // grab the thread lock so we can safely look at the signal mask
   Guard<spin_lock_t, IrqSave> guard{ThreadLock::Get()};
 
@@ -1081,6 +1105,42 @@ cpu_num_t Thread::LastCpu() const {
   return scheduler_state_.last_cpu_;
 }
 
+/**
+ * @brief Set the page to which the runtime statistics of the thread are
+ * published, and publish the current statistics to it.
+ */
+void Thread::SetStatsPage(thread_stats_page* page) {
+  Guard<spin_lock_t, IrqSave> guard{ThreadLock::Get()};
+  stats_page_ = page;
+  PublishStatsLocked(false);
+}
+
+/**
+ * @brief Publish the runtime statistics of the thread to its stats page.
+ *
+ * The page is a sequence lock read by the vDSO without entering the kernel,
+ * so the sequence number is odd for the duration of the update.
+ */
+void Thread::PublishStatsLocked(bool switched_to) {
+  thread_stats_page* page = stats_page_;
+  if (likely(page == nullptr)) {
+    return;
+  }
+
+  const uint64_t sequence = page->sequence;
+  __atomic_store_n(&page->sequence, sequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  page->runtime = scheduler_state_.runtime_ns();
+  page->running_since = state_ == THREAD_RUNNING ? scheduler_state_.last_started_running() : 0;
+  if (switched_to) {
+    page->context_switches++;
+  }
+  page->last_cpu = scheduler_state_.last_cpu_;
+
+  __atomic_store_n(&page->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
 /**
  * @brief Construct a thread t around the current running state
  *
@@ -7,6 +7,7 @@
 
 #include <assert.h>
 #include <debug.h>
+#include <inttypes.h>
 #include <lib/unittest/unittest.h>
 #include <pow2.h>
 #include <zircon/errors.h>
@@ -24,6 +25,7 @@
 #include <ktl/atomic.h>
 #include <ktl/popcount.h>
 #include <ktl/unique_ptr.h>
+#include <vm/kstack.h>
 
 #include "zircon/time.h"
 
@@ -423,6 +425,89 @@ bool set_migrate_ready_threads_test() {
   END_TEST;
 }
 
+int return_zero(void*) { return 0; }
+
+// A joined thread leaves its stack in the cache of the joining cpu, so the
+// next thread created there reuses it.
+bool kernel_stack_reuse_test() {
+  BEGIN_TEST;
+
+  Thread* const current_thread = Thread::Current::Get();
+  const cpu_mask_t original_affinity = current_thread->GetCpuAffinity();
+  const cpu_num_t cpu = arch_curr_cpu_num();
+  current_thread->SetCpuAffinity(cpu_num_to_mask(cpu));
+  auto auto_call = fbl::MakeAutoCall([current_thread, original_affinity]() {
+    current_thread->SetCpuAffinity(original_affinity);
+  });
+
+  // Start from an empty cache, so that the stack of the first thread is the
+  // only one the second thread can take.
+  KernelStack::TrimCache();
+  EXPECT_EQ(0u, KernelStack::CachedCount(cpu));
+
+  Thread* first =
+      Thread::Create("kernel_stack_reuse_first", return_zero, nullptr, DEFAULT_PRIORITY);
+  ASSERT_NONNULL(first, "thread_create failed.");
+  const vaddr_t first_stack = first->stack_.base();
+  first->Resume();
+  int retcode;
+  ASSERT_EQ(first->Join(&retcode, ZX_TIME_INFINITE), ZX_OK, "Failed to join thread.");
+  EXPECT_EQ(1u, KernelStack::CachedCount(cpu), "The exited stack was not cached.");
+
+  Thread* second =
+      Thread::Create("kernel_stack_reuse_second", return_zero, nullptr, DEFAULT_PRIORITY);
+  ASSERT_NONNULL(second, "thread_create failed.");
+  EXPECT_EQ(0u, KernelStack::CachedCount(cpu), "The cached stack was not reused.");
+  EXPECT_EQ(first_stack, second->stack_.base(), "The cached stack was not reused.");
+  second->Resume();
+  ASSERT_EQ(second->Join(&retcode, ZX_TIME_INFINITE), ZX_OK, "Failed to join thread.");
+
+  // Trimming leaves nothing to reuse, so the next thread maps a new stack.
+  KernelStack::TrimCache();
+  EXPECT_EQ(0u, KernelStack::CachedCount(cpu));
+  Thread* third =
+      Thread::Create("kernel_stack_reuse_third", return_zero, nullptr, DEFAULT_PRIORITY);
+  ASSERT_NONNULL(third, "thread_create failed.");
+  third->Resume();
+  ASSERT_EQ(third->Join(&retcode, ZX_TIME_INFINITE), ZX_OK, "Failed to join thread.");
+
+  END_TEST;
+}
+
+// Measures creating, running and joining a thread that returns immediately,
+// with and without cached stacks.
+bool thread_create_join_benchmark() {
+  BEGIN_TEST;
+
+  constexpr int kIterations = 1000;
+  auto run = [](const char* name, bool trim) {
+    zx_duration_t total = 0;
+    for (int i = 0; i < kIterations; i++) {
+      if (trim) {
+        KernelStack::TrimCache();
+      }
+      const zx_time_t start = current_time();
+      Thread* thread = Thread::Create(name, return_zero, nullptr, DEFAULT_PRIORITY);
+      if (thread == nullptr) {
+        return false;
+      }
+      thread->Resume();
+      int retcode;
+      if (thread->Join(&retcode, ZX_TIME_INFINITE) != ZX_OK) {
+        return false;
+      }
+      total = zx_duration_add_duration(total, zx_time_sub_time(current_time(), start));
+    }
+    printf("\n%s: %" PRId64 " ns per thread create and join\n", name, total / kIterations);
+    return true;
+  };
+
+  EXPECT_TRUE(run("thread_create_join_uncached", true));
+  EXPECT_TRUE(run("thread_create_join_cached", false));
+
+  END_TEST;
+}
+
 }  // namespace
 
 UNITTEST_START_TESTCASE(thread_tests)
@@ -434,4 +519,6 @@ UNITTEST("thread_empty_soft_affinity_mask", thread_empty_soft_affinity_mask)
 UNITTEST("thread_conflicting_soft_and_hard_affinity", thread_conflicting_soft_and_hard_affinity)
 UNITTEST("set_migrate_fn_test", set_migrate_fn_test)
 UNITTEST("set_migrate_ready_threads_test", set_migrate_ready_threads_test)
+UNITTEST("kernel_stack_reuse_test", kernel_stack_reuse_test)
+UNITTEST("thread_create_join_benchmark", thread_create_join_benchmark)
 UNITTEST_END_TESTCASE(thread_tests, "thread", "thread tests")
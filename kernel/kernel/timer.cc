@@ -31,7 +31,6 @@
 #include <stdlib.h>
 #include <trace.h>
 #include <zircon/compiler.h>
-#include <zircon/listnode.h>
 #include <zircon/time.h>
 #include <zircon/types.h>
 
@@ -69,6 +68,9 @@ namespace {
 spin_lock_t timer_lock __CPU_ALIGN_EXCLUSIVE = SPIN_LOCK_INITIAL_VALUE;
 DECLARE_SINGLETON_LOCK_WRAPPER(TimerLock, timer_lock);
 
+// Orders timers with the same scheduled time. Protected by timer_lock.
+uint64_t timer_sequence;
+
 affine::Ratio gTicksToTime;
 uint64_t gTicksPerSecond;
 
@@ -110,116 +112,84 @@ static void insert_timer_in_queue(uint cpu, Timer* timer, zx_time_t earliest_dea
   DEBUG_ASSERT(arch_ints_disabled());
   LTRACEF("timer %p, cpu %u, scheduled %" PRIi64 "\n", timer, cpu, timer->scheduled_time_);
 
-  // For inserting the timer we consider several cases. In general we
-  // want to coalesce with the current timer unless we can prove that
+  TimerTree& queue = percpu::Get(cpu).timer_queue;
+
+  // For inserting the timer we consider its neighbors in the queue. In
+  // general we want to coalesce with the previous timer unless we can prove
   // either that:
-  //  1- there is no slack overlap with current timer OR
+  //  1- there is no slack overlap with the previous timer OR
   //  2- the next timer is a better fit.
   //
   // In diagrams that follow
-  // - Let |e| be the current (existing) timer deadline
+  // - Let |p| be the deadline of the last timer scheduled before |t|, if any
   // - Let |t| be the deadline of the timer we are inserting
-  // - Let |n| be the next timer deadline if any
-  // - Let |x| be the end of the list (not a timer)
+  // - Let |n| be the deadline of the first timer scheduled at or after |t|, if any
   // - Let |(| and |)| the earliest_deadline and latest_deadline.
   //
-  Timer* entry;
-
-  list_for_every_entry (&percpu::Get(cpu).timer_queue, entry, Timer, node_) {
-    if (entry->scheduled_time_ > latest_deadline) {
-      // New timer latest is earlier than the current timer.
-      // Just add upfront as is, without slack.
-      //
-      //   ---------t---)--e-------------------------------> time
-      //
-      timer->slack_ = 0ll;
-      list_add_before(&entry->node_, &timer->node_);
-      return;
-    }
-
-    if (entry->scheduled_time_ >= timer->scheduled_time_) {
-      //  New timer slack overlaps and is to the left (or equal). We
-      //  coalesce with current by scheduling late.
-      //
-      //  --------(----t---e-)----------------------------> time
-      //
-      timer->slack_ = zx_time_sub_time(entry->scheduled_time_, timer->scheduled_time_);
-      timer->scheduled_time_ = entry->scheduled_time_;
-      kcounter_add(timer_coalesced_counter, 1);
-      list_add_after(&entry->node_, &timer->node_);
-      return;
-    }
-
-    if (entry->scheduled_time_ < earliest_deadline) {
-      // new timer earliest is later than the current timer. This case
-      // is handled in a future iteration.
-      //
-      //   ----------------e--(---t-----------------------> time
-      //
-      continue;
-    }
-
-    // New timer is to the right of current timer and there is overlap
-    // with the current timer, but could the next timer (if any) be
-    // a better fit?
+  TimerTree::iterator next = queue.lower_bound({timer->scheduled_time_, 0});
+  TimerTree::iterator prev = next;
+  --prev;
+
+  const Timer* target = nullptr;
+  if (prev.IsValid() && prev->scheduled_time_ >= earliest_deadline) {
+    // New timer is to the right of the previous timer and there is overlap
+    // with it, but could the next timer (if any) be a better fit?
     //
-    //  -------------(--e---t-----?-------------------> time
+    //  -------------(--p---t-----?-------------------> time
     //
-
-    const Timer* next = list_next_type(&percpu::Get(cpu).timer_queue, &entry->node_, Timer, node_);
-
-    if (next != NULL) {
-      if (next->scheduled_time_ <= timer->scheduled_time_) {
-        // The new timer is to the right of the next timer. There is no
-        // chance the current timer is a better fit.
+    target = &*prev;
+    if (next.IsValid()) {
+      if (next->scheduled_time_ == timer->scheduled_time_) {
+        // The new timer has the same deadline as the next timer.
         //
-        //  -------------(--e---n---t----------------------> time
+        //  -------------(--p---tn-------------------------> time
         //
-        continue;
-      }
-
-      if (next->scheduled_time_ < latest_deadline) {
+        target = &*next;
+      } else if (next->scheduled_time_ < latest_deadline) {
         // There is slack overlap with the next timer, and also with the
-        // current timer. Which coalescing is a better match?
+        // previous timer. Which coalescing is a better match?
         //
-        //  --------------(-e---t---n-)-----------------------> time
+        //  --------------(-p---t---n-)-----------------------> time
         //
-        zx_duration_t delta_entry =
-            zx_time_sub_time(timer->scheduled_time_, entry->scheduled_time_);
+        zx_duration_t delta_prev = zx_time_sub_time(timer->scheduled_time_, prev->scheduled_time_);
         zx_duration_t delta_next = zx_time_sub_time(next->scheduled_time_, timer->scheduled_time_);
-        if (delta_next < delta_entry) {
-          // New timer is closer to the next timer, handle it in the
-          // next iteration.
-          continue;
+        if (delta_next < delta_prev) {
+          target = &*next;
         }
       }
     }
-
-    // Handles the remaining cases, note that there is overlap with
-    // the current timer.
-    //
-    //  1- this is the last timer (next == NULL) or
-    //  2- there is no overlap with the next timer, or
-    //  3- there is overlap with both current and next but
-    //     current is closer.
+  } else if (next.IsValid() && next->scheduled_time_ <= latest_deadline) {
+    //  New timer slack overlaps with the next timer. We coalesce with it by
+    //  scheduling late.
     //
-    //  So we coalesce by scheduling early.
+    //  --------(----t---n-)----------------------------> time
     //
-    timer->slack_ = zx_time_sub_time(entry->scheduled_time_, timer->scheduled_time_);
-    timer->scheduled_time_ = entry->scheduled_time_;
+    target = &*next;
+  }
+
+  if (target != nullptr) {
+    // Coalesce by scheduling early or late, recording the adjustment.
+    timer->slack_ = zx_time_sub_time(target->scheduled_time_, timer->scheduled_time_);
+    timer->scheduled_time_ = target->scheduled_time_;
     kcounter_add(timer_coalesced_counter, 1);
-    list_add_after(&entry->node_, &timer->node_);
-    return;
+  } else {
+    // There is no overlap with either neighbor. Add the timer as is, without
+    // slack.
+    //
+    //   ----p---(---t---)--n--------------------------> time
+    //
+    timer->slack_ = 0;
   }
 
-  // Walked off the end of the list and there was no overlap.
-  timer->slack_ = 0;
-  list_add_tail(&percpu::Get(cpu).timer_queue, &timer->node_);
+  // Timers with the same deadline fire in the order in which they were queued.
+  timer->sequence_ = timer_sequence++;
+  timer->queued_cpu_ = cpu;
+  queue.insert(timer);
 }
 
 Timer::~Timer() {
-  // Ensure that we are not on any cpu's list.
-  ZX_DEBUG_ASSERT(!list_in_list(&node_));
+  // Ensure that we are not on any cpu's queue.
+  ZX_DEBUG_ASSERT(!InContainer());
   // Ensure that we are not active on some cpu.
   ZX_DEBUG_ASSERT(active_cpu_ == -1);
 }
@@ -233,8 +203,8 @@ void Timer::Set(const Deadline& deadline, Callback callback, void* arg) {
   DEBUG_ASSERT(deadline.slack().mode() <= TIMER_SLACK_LATE);
   DEBUG_ASSERT(deadline.slack().amount() >= 0);
 
-  if (list_in_list(&node_)) {
-    panic("timer %p already in list\n", this);
+  if (InContainer()) {
+    panic("timer %p already in queue\n", this);
   }
 
   const zx_time_t latest_deadline = deadline.latest();
@@ -266,7 +236,7 @@ void Timer::Set(const Deadline& deadline, Callback callback, void* arg) {
   insert_timer_in_queue(cpu, this, earliest_deadline, latest_deadline);
   kcounter_add(timer_created_counter, 1);
 
-  if (list_peek_head_type(&percpu::Get(cpu).timer_queue, Timer, node_) == this) {
+  if (&percpu::Get(cpu).timer_queue.front() == this) {
     // we just modified the head of the timer queue
     update_platform_timer(cpu, deadline.when());
   }
@@ -321,14 +291,17 @@ bool Timer::Cancel() {
   bool callback_not_running;
 
   // if the timer is in a queue, remove it and adjust hardware timers if needed
-  if (list_in_list(&node_)) {
+  if (InContainer()) {
     callback_not_running = true;
 
-    // save a copy of the old head of the queue so later we can see if we modified the head
-    Timer* oldhead = list_peek_head_type(&percpu::Get(cpu).timer_queue, Timer, node_);
+    TimerTree& queue = percpu::Get(queued_cpu_).timer_queue;
+
+    // see if we are the head of the queue so later we can see if we modified the head
+    const bool was_head = &queue.front() == this;
+    const bool was_local = queued_cpu_ == cpu;
 
     // remove our timer from the queue
-    list_delete(&node_);
+    queue.erase(*this);
     kcounter_add(timer_canceled_counter, 1);
 
     // TODO(cpu): if  after removing |timer| there is one other single timer with
@@ -337,11 +310,10 @@ bool Timer::Cancel() {
 
     // see if we've just modified the head of this cpu's timer queue.
     // if we modified another cpu's queue, we'll just let it fire and sort itself out
-    if (unlikely(oldhead == this)) {
+    if (unlikely(was_head && was_local)) {
       // timer we're canceling was at head of queue, see if we should update platform timer
-      Timer* newhead = list_peek_head_type(&percpu::Get(cpu).timer_queue, Timer, node_);
-      if (newhead) {
-        update_platform_timer(cpu, newhead->scheduled_time_);
+      if (!queue.is_empty()) {
+        update_platform_timer(cpu, queue.front().scheduled_time_);
       } else if (percpu::Get(cpu).next_timer_deadline == ZX_TIME_INFINITE) {
         LTRACEF("clearing old hw timer, preempt timer not set, nothing in the queue\n");
         platform_stop_timer();
@@ -388,12 +360,13 @@ void timer_tick(zx_time_t now) {
 
   Guard<spin_lock_t, NoIrqSave> guard{TimerLock::Get()};
 
+  TimerTree& queue = percpu::Get(cpu).timer_queue;
   for (;;) {
     // see if there's an event to process
-    timer = list_peek_head_type(&percpu::Get(cpu).timer_queue, Timer, node_);
-    if (likely(timer == 0)) {
+    if (likely(queue.is_empty())) {
       break;
     }
+    timer = &queue.front();
     LTRACEF("next item on timer queue %p at %" PRIi64 " now %" PRIi64 " (%p, arg %p)\n", timer,
             timer->scheduled_time_, now, timer->callback_, timer->arg_);
     if (likely(now < timer->scheduled_time_)) {
@@ -405,7 +378,7 @@ void timer_tick(zx_time_t now) {
     DEBUG_ASSERT_MSG(timer && timer->magic_ == Timer::kMagic,
                      "ASSERT: timer failed magic check: timer %p, magic 0x%x\n", timer,
                      (uint)timer->magic_);
-    list_delete(&timer->node_);
+    queue.erase(*timer);
 
     // mark the timer busy
     timer->active_cpu_ = cpu;
@@ -432,9 +405,8 @@ void timer_tick(zx_time_t now) {
 
   // get the deadline of the event at the head of the queue (if any)
   zx_time_t deadline = ZX_TIME_INFINITE;
-  timer = list_peek_head_type(&percpu::Get(cpu).timer_queue, Timer, node_);
-  if (timer) {
-    deadline = timer->scheduled_time_;
+  if (!queue.is_empty()) {
+    deadline = queue.front().scheduled_time_;
 
     // has to be the case or it would have fired already
     DEBUG_ASSERT(deadline > now);
@@ -470,12 +442,13 @@ void TimerQueue::TransitionOffCpu(uint old_cpu) {
   Guard<spin_lock_t, IrqSave> guard{TimerLock::Get()};
   uint cpu = arch_curr_cpu_num();
 
-  Timer* old_head = list_peek_head_type(&percpu::Get(cpu).timer_queue, Timer, node_);
+  TimerTree& queue = percpu::Get(cpu).timer_queue;
+  TimerTree& old_queue = percpu::Get(old_cpu).timer_queue;
+  const Timer* old_head = queue.is_empty() ? nullptr : &queue.front();
 
-  Timer *entry = NULL, *tmp_entry = NULL;
   // Move all timers from old_cpu to this cpu
-  list_for_every_entry_safe (&percpu::Get(old_cpu).timer_queue, entry, tmp_entry, Timer, node_) {
-    list_delete(&entry->node_);
+  while (!old_queue.is_empty()) {
+    Timer* entry = old_queue.pop_front();
     // We lost the original asymmetric slack information so when we combine them
     // with the other timer queue they are not coalesced again.
     // TODO(cpu): figure how important this case is.
@@ -485,10 +458,9 @@ void TimerQueue::TransitionOffCpu(uint old_cpu) {
     // created.
   }
 
-  Timer* new_head = list_peek_head_type(&percpu::Get(cpu).timer_queue, Timer, node_);
-  if (new_head != NULL && new_head != old_head) {
+  if (!queue.is_empty() && &queue.front() != old_head) {
     // we just modified the head of the timer queue
-    update_platform_timer(cpu, new_head->scheduled_time_);
+    update_platform_timer(cpu, queue.front().scheduled_time_);
   }
 
   // the old cpu has no tasks left, so reset the deadlines
@@ -506,10 +478,10 @@ void TimerQueue::ThawPercpu(void) {
   percpu::Get(cpu).next_timer_deadline = ZX_TIME_INFINITE;
   zx_time_t deadline = percpu::Get(cpu).preempt_timer_deadline;
 
-  Timer* t = list_peek_head_type(&percpu::Get(cpu).timer_queue, Timer, node_);
-  if (t) {
-    if (t->scheduled_time_ < deadline) {
-      deadline = t->scheduled_time_;
+  const TimerTree& queue = percpu::Get(cpu).timer_queue;
+  if (!queue.is_empty()) {
+    if (queue.front().scheduled_time_ < deadline) {
+      deadline = queue.front().scheduled_time_;
     }
   }
 
@@ -529,19 +501,18 @@ void PrintTimerQueues(char* buf, size_t len) {
       if (ptr >= len) {
         return;
       }
-      Timer* t;
       zx_time_t last = now;
-      list_for_every_entry (&percpu::Get(i).timer_queue, t, Timer, node_) {
-        zx_duration_t delta_now = zx_time_sub_time(t->scheduled_time_, now);
-        zx_duration_t delta_last = zx_time_sub_time(t->scheduled_time_, last);
+      for (const Timer& t : percpu::Get(i).timer_queue) {
+        zx_duration_t delta_now = zx_time_sub_time(t.scheduled_time_, now);
+        zx_duration_t delta_last = zx_time_sub_time(t.scheduled_time_, last);
         ptr += snprintf(buf + ptr, len - ptr,
                         "\ttime %" PRIi64 " delta_now %" PRIi64 " delta_last %" PRIi64
                         " func %p arg %p\n",
-                        t->scheduled_time_, delta_now, delta_last, t->callback_, t->arg_);
+                        t.scheduled_time_, delta_now, delta_last, t.callback_, t.arg_);
         if (ptr >= len) {
           return;
         }
-        last = t->scheduled_time_;
+        last = t.scheduled_time_;
       }
     }
   }
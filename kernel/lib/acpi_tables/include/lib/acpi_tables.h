@@ -198,6 +198,7 @@ zx_status_t AcpiTables::VisitCpuNumaPairs(V visitor) const {
       }
 
       DEBUG_ASSERT(cpu->ProximityDomain < kMaxNumaDomains);
+      domains[cpu->ProximityDomain].domain = cpu->ProximityDomain;
       visitor(domains[cpu->ProximityDomain], cpu->ApicId);
     }
   }
@@ -0,0 +1,104 @@
+// Copyright 2020 The Fuchsia Authors
+//
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT
+
+#ifndef ZIRCON_KERNEL_LIB_COUNTERS_INCLUDE_LIB_COUNTER_SNAPSHOT_H_
+#define ZIRCON_KERNEL_LIB_COUNTERS_INCLUDE_LIB_COUNTER_SNAPSHOT_H_
+
+#include <lib/counter-vmo-abi.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+// This file provides a userland helper for reading the counters VMOs described
+// in counter-vmo-abi.h.
+
+namespace counters {
+
+// A copy of the per-CPU values of every counter at a point in time.
+//
+// Taking a snapshot reads each per-CPU slot of the arena exactly once, with no
+// synchronization with the kernel, so it never stalls the CPUs updating the
+// counters. The result is not a consistent cut across counters or CPUs, but
+// each value is one that its slot actually held while the snapshot was taken,
+// so deltas of kSum counters between snapshots are exact per CPU.
+class Snapshot {
+ public:
+  Snapshot() = default;
+
+  // Copies the values of the first |num_cpus| CPUs out of |arena|, which must
+  // have the layout described by |desc|. |desc| must outlive the snapshot.
+  // |timestamp| is recorded to compute rates between snapshots.
+  void Take(const DescriptorVmo& desc, const volatile int64_t* arena, size_t num_cpus,
+            int64_t timestamp) {
+    desc_ = &desc;
+    num_cpus_ = std::min<size_t>(num_cpus, desc.max_cpus);
+    timestamp_ = timestamp;
+
+    const size_t num_counters = desc.num_counters();
+    values_.resize(num_cpus_ * num_counters);
+    for (size_t i = 0; i < values_.size(); ++i) {
+      values_[i] = arena[i];
+    }
+  }
+
+  bool is_valid() const { return desc_ != nullptr; }
+  size_t num_counters() const { return desc_ ? desc_->num_counters() : 0; }
+  size_t num_cpus() const { return num_cpus_; }
+  int64_t timestamp() const { return timestamp_; }
+
+  const Descriptor& descriptor(size_t counter) const { return desc_->descriptor_table[counter]; }
+
+  // Returns the value of |counter| on |cpu|.
+  int64_t Value(size_t counter, size_t cpu) const {
+    return values_[cpu * num_counters() + counter];
+  }
+
+  // Returns the value of |counter| aggregated over all CPUs according to its
+  // type.
+  int64_t Value(size_t counter) const {
+    const Type type = descriptor(counter).type;
+    int64_t value = num_cpus_ > 0 ? Value(counter, 0) : 0;
+    for (size_t cpu = 1; cpu < num_cpus_; ++cpu) {
+      const int64_t cpu_value = Value(counter, cpu);
+      switch (type) {
+        case Type::kMin:
+          value = std::min(value, cpu_value);
+          break;
+        case Type::kMax:
+          value = std::max(value, cpu_value);
+          break;
+        case Type::kSum:
+        default:
+          value += cpu_value;
+          break;
+      }
+    }
+    return value;
+  }
+
+  // Returns the change of |counter| on |cpu| since |earlier|, which must have
+  // been taken from the same counters VMOs.
+  int64_t Delta(const Snapshot& earlier, size_t counter, size_t cpu) const {
+    return Value(counter, cpu) - earlier.Value(counter, cpu);
+  }
+
+  // Returns the change of the aggregated value of |counter| since |earlier|.
+  int64_t Delta(const Snapshot& earlier, size_t counter) const {
+    return Value(counter) - earlier.Value(counter);
+  }
+
+ private:
+  const DescriptorVmo* desc_ = nullptr;
+  size_t num_cpus_ = 0;
+  int64_t timestamp_ = 0;
+  std::vector<int64_t> values_;
+};
+
+}  // namespace counters
+
+#endif  // ZIRCON_KERNEL_LIB_COUNTERS_INCLUDE_LIB_COUNTER_SNAPSHOT_H_
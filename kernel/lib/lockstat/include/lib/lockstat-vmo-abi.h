@@ -0,0 +1,57 @@
+// Copyright 2020 The Fuchsia Authors
+//
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT
+
+#ifndef ZIRCON_KERNEL_LIB_LOCKSTAT_INCLUDE_LIB_LOCKSTAT_VMO_ABI_H_
+#define ZIRCON_KERNEL_LIB_LOCKSTAT_INCLUDE_LIB_LOCKSTAT_VMO_ABI_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// This file describes how the kernel exposes its lock statistics to userland.
+// Like the kcounters VMOs, this is a PRIVATE UNSTABLE ABI that may change at
+// any time and is only meant for tools built from source with the kernel.
+
+namespace lockstat {
+
+// Statistics for one lock class on one CPU. Times are in ticks.
+struct Stats {
+  uint64_t acquisitions;
+  uint64_t contentions;
+  uint64_t total_wait;
+  uint64_t max_wait;
+  uint64_t total_hold;
+  uint64_t max_hold;
+};
+
+struct Descriptor {
+  char name[128];
+};
+
+struct VmoHeader {
+  // PA_VMO_KERNEL_FILE with this name has the VmoHeader layout.
+  static constexpr char kVmoName[] = "lockstat";
+
+  // This is time_t as of writing.  Change it when changing this layout.
+  static constexpr uint64_t kMagic = 1602806400;
+
+  uint64_t magic;             // kMagic
+  uint64_t max_cpus;          // SMP_MAX_CPUS
+  uint64_t max_classes;       // Stride of each per-CPU array of Stats.
+  uint64_t num_classes;       // Number of valid entries in each array.
+  uint64_t ticks_per_second;  // Scale of the times in Stats.
+
+  // Byte offset from the start of the VMO of Descriptor[max_classes], indexed
+  // by lock class ordinal.
+  uint64_t descriptor_offset;
+
+  // Byte offset from the start of the VMO of Stats[max_cpus][max_classes],
+  // indexed by CPU number and then lock class ordinal.
+  uint64_t stats_offset;
+};
+
+}  // namespace lockstat
+
+#endif  // ZIRCON_KERNEL_LIB_LOCKSTAT_INCLUDE_LIB_LOCKSTAT_VMO_ABI_H_
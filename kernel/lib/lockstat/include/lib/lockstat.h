@@ -0,0 +1,35 @@
+// Copyright 2020 The Fuchsia Authors
+//
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT
+
+#ifndef ZIRCON_KERNEL_LIB_LOCKSTAT_INCLUDE_LIB_LOCKSTAT_H_
+#define ZIRCON_KERNEL_LIB_LOCKSTAT_INCLUDE_LIB_LOCKSTAT_H_
+
+#include <lib/lockstat-vmo-abi.h>
+#include <zircon/types.h>
+
+#include <fbl/ref_ptr.h>
+#include <lockdep/common.h>
+
+class VmObject;
+
+// Lock statistics are collected per lock class by the lockdep Guard when the
+// kernel is built with enable_lock_stat = true. Times are measured in ticks and
+// accumulated per CPU; the accessors below sum them over all CPUs.
+namespace lockstat {
+
+// Returns the statistics for the given lock class summed over all CPUs.
+// Returns false if the lock class has no statistics slot.
+bool GetStats(lockdep::LockClassId id, Stats* stats);
+
+// Clears the statistics of every lock class.
+void Reset();
+
+// Returns a VMO wrapping the live statistics, with the VmoHeader layout.
+zx_status_t GetVmo(fbl::RefPtr<VmObject>* vmo);
+
+}  // namespace lockstat
+
+#endif  // ZIRCON_KERNEL_LIB_LOCKSTAT_INCLUDE_LIB_LOCKSTAT_H_
@@ -0,0 +1,275 @@
+// Copyright 2020 The Fuchsia Authors
+//
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT
+
+#include <inttypes.h>
+#include <lib/affine/ratio.h>
+#include <lib/console.h>
+#include <lib/counters.h>
+#include <lib/lockstat.h>
+#include <platform.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <arch/ops.h>
+#include <fbl/alloc_checker.h>
+#include <ktl/algorithm.h>
+#include <ktl/atomic.h>
+#include <ktl/unique_ptr.h>
+#include <lk/init.h>
+#include <lockdep/lockdep.h>
+#include <vm/vm.h>
+#include <vm/vm_object_paged.h>
+
+#if WITH_LOCK_STAT
+
+namespace {
+
+// The maximum number of lock classes with statistics. Lock classes with higher
+// ordinals are counted in lockstat.dropped instead.
+constexpr size_t kMaxClasses = 256;
+
+// Acquisitions that wait at least this long are counted as contended. The
+// lockdep Guard only sees the total time spent in the lock policy, so this
+// threshold separates the cost of an uncontended acquisition from waiting.
+constexpr zx_duration_t kContendedThreshold = ZX_NSEC(250);
+
+// The statistics live in a single page-aligned region that is exported to
+// userland as a VMO with the VmoHeader layout.
+struct alignas(PAGE_SIZE) Arena {
+  lockstat::VmoHeader header;
+  lockstat::Descriptor descriptors[kMaxClasses];
+  lockstat::Stats stats[SMP_MAX_CPUS][kMaxClasses];
+};
+
+Arena arena;
+
+// Whether statistics are being collected. Set once the lock classes and the
+// platform timer are initialized and toggled by the lockstat command.
+ktl::atomic<bool> collecting{false};
+
+uint64_t contended_threshold_ticks;
+
+KCOUNTER(lockstat_dropped, "lockstat.dropped")
+
+// Returns the statistics slot of the given lock class for the current CPU.
+// The thread may migrate after the CPU number is read, so the slot is only
+// updated with atomic operations.
+lockstat::Stats* CurrentSlot(lockdep::LockClassId id) {
+  const size_t ordinal = lockdep::LockClassState::GetOrdinal(id);
+  if (ordinal >= kMaxClasses) {
+    lockstat_dropped.Add(1);
+    return nullptr;
+  }
+  return &arena.stats[arch_curr_cpu_num()][ordinal];
+}
+
+void Add(uint64_t* value, uint64_t delta) { __atomic_fetch_add(value, delta, __ATOMIC_RELAXED); }
+
+void Max(uint64_t* value, uint64_t candidate) {
+  uint64_t current = __atomic_load_n(value, __ATOMIC_RELAXED);
+  while (candidate > current && !__atomic_compare_exchange_n(value, &current, candidate, true,
+                                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+uint64_t Load(const uint64_t* value) { return __atomic_load_n(value, __ATOMIC_RELAXED); }
+
+void Clear(uint64_t* value) { __atomic_store_n(value, 0, __ATOMIC_RELAXED); }
+
+void LockStatInit(unsigned /*level*/) {
+  const size_t num_classes = ktl::min(lockdep::LockClassState::Count(), kMaxClasses);
+  for (auto& state : lockdep::LockClassState::Iter()) {
+    if (state.ordinal() < kMaxClasses) {
+      strlcpy(arena.descriptors[state.ordinal()].name, state.name(),
+              sizeof(arena.descriptors[state.ordinal()].name));
+    }
+  }
+
+  arena.header = {
+      .magic = lockstat::VmoHeader::kMagic,
+      .max_cpus = SMP_MAX_CPUS,
+      .max_classes = kMaxClasses,
+      .num_classes = num_classes,
+      .ticks_per_second = static_cast<uint64_t>(ticks_per_second()),
+      .descriptor_offset = offsetof(Arena, descriptors),
+      .stats_offset = offsetof(Arena, stats),
+  };
+
+  contended_threshold_ticks =
+      platform_get_ticks_to_time_ratio().Inverse().Scale(kContendedThreshold);
+  collecting.store(true, ktl::memory_order_relaxed);
+}
+
+zx_duration_t TicksToNanoseconds(uint64_t ticks) {
+  return platform_get_ticks_to_time_ratio().Scale(static_cast<int64_t>(ticks));
+}
+
+// Prints the lock classes with the most total wait time.
+void DumpStats(size_t count) {
+  struct Entry {
+    const char* name;
+    lockstat::Stats stats;
+  };
+
+  const size_t num_classes = arena.header.num_classes;
+  fbl::AllocChecker ac;
+  ktl::unique_ptr<Entry[]> entries{new (&ac) Entry[num_classes]};
+  if (!ac.check()) {
+    printf("lockstat: out of memory\n");
+    return;
+  }
+
+  size_t num_entries = 0;
+  for (auto& state : lockdep::LockClassState::Iter()) {
+    if (state.ordinal() >= kMaxClasses) {
+      continue;
+    }
+    Entry& entry = entries[num_entries];
+    lockstat::GetStats(state.id(), &entry.stats);
+    if (entry.stats.acquisitions != 0) {
+      entry.name = state.name();
+      num_entries++;
+    }
+  }
+  ktl::stable_sort(entries.get(), entries.get() + num_entries,
+                   [](const Entry& a, const Entry& b) {
+                     return a.stats.total_wait > b.stats.total_wait;
+                   });
+
+  printf("%12s %10s %14s %12s %14s %12s  %s\n", "acquired", "contended", "wait total ns",
+         "wait max ns", "hold total ns", "hold max ns", "lock class");
+  for (size_t i = 0; i < ktl::min(count, num_entries); i++) {
+    const lockstat::Stats& stats = entries[i].stats;
+    printf("%12" PRIu64 " %10" PRIu64 " %14" PRId64 " %12" PRId64 " %14" PRId64 " %12" PRId64
+           "  %s\n",
+           stats.acquisitions, stats.contentions, TicksToNanoseconds(stats.total_wait),
+           TicksToNanoseconds(stats.max_wait), TicksToNanoseconds(stats.total_hold),
+           TicksToNanoseconds(stats.max_hold), entries[i].name);
+  }
+  if (lockstat_dropped.Value() != 0) {
+    printf("Some lock classes exceeded the table size of %zu and were not recorded.\n",
+           kMaxClasses);
+  }
+}
+
+int CommandLockStat(int argc, const cmd_args* argv, uint32_t flags) {
+  if (argc < 2) {
+    printf("Not enough arguments:\n");
+  usage:
+    printf("%s dump [count]      : dump the lock classes with the most wait time\n", argv[0].str);
+    printf("%s reset             : clear the statistics\n", argv[0].str);
+    printf("%s start             : start collecting statistics\n", argv[0].str);
+    printf("%s stop              : stop collecting statistics\n", argv[0].str);
+    return -1;
+  }
+
+  if (strcmp(argv[1].str, "dump") == 0) {
+    DumpStats(argc > 2 ? argv[2].u : 20);
+  } else if (strcmp(argv[1].str, "reset") == 0) {
+    lockstat::Reset();
+  } else if (strcmp(argv[1].str, "start") == 0) {
+    collecting.store(true, ktl::memory_order_relaxed);
+  } else if (strcmp(argv[1].str, "stop") == 0) {
+    collecting.store(false, ktl::memory_order_relaxed);
+  } else {
+    printf("Unrecognized subcommand: '%s'\n", argv[1].str);
+    goto usage;
+  }
+
+  return 0;
+}
+
+}  // anonymous namespace
+
+STATIC_COMMAND_START
+STATIC_COMMAND("lockstat", "kernel lock contention statistics", &CommandLockStat)
+STATIC_COMMAND_END(lockstat)
+
+LK_INIT_HOOK(lockstat, LockStatInit, LK_INIT_LEVEL_THREADING)
+
+namespace lockstat {
+
+bool GetStats(lockdep::LockClassId id, Stats* stats) {
+  const size_t ordinal = lockdep::LockClassState::GetOrdinal(id);
+  if (ordinal >= kMaxClasses) {
+    return false;
+  }
+
+  *stats = {};
+  for (uint cpu = 0; cpu < arch_max_num_cpus(); cpu++) {
+    const Stats& slot = arena.stats[cpu][ordinal];
+    stats->acquisitions += Load(&slot.acquisitions);
+    stats->contentions += Load(&slot.contentions);
+    stats->total_wait += Load(&slot.total_wait);
+    stats->max_wait = ktl::max(stats->max_wait, Load(&slot.max_wait));
+    stats->total_hold += Load(&slot.total_hold);
+    stats->max_hold = ktl::max(stats->max_hold, Load(&slot.max_hold));
+  }
+  return true;
+}
+
+// Updates racing with the reset may survive it, which is acceptable for
+// diagnostic statistics.
+void Reset() {
+  for (auto& cpu_stats : arena.stats) {
+    for (auto& slot : cpu_stats) {
+      Clear(&slot.acquisitions);
+      Clear(&slot.contentions);
+      Clear(&slot.total_wait);
+      Clear(&slot.max_wait);
+      Clear(&slot.total_hold);
+      Clear(&slot.max_hold);
+    }
+  }
+}
+
+zx_status_t GetVmo(fbl::RefPtr<VmObject>* vmo) {
+  zx_status_t status = VmObjectPaged::CreateFromWiredPages(&arena, sizeof(arena), false, vmo);
+  if (status != ZX_OK) {
+    return status;
+  }
+  (*vmo)->set_name(VmoHeader::kVmoName, sizeof(VmoHeader::kVmoName) - 1);
+  return ZX_OK;
+}
+
+}  // namespace lockstat
+
+namespace lockdep {
+
+uint64_t SystemLockStatTimestamp() { return current_ticks(); }
+
+void SystemLockStatAcquire(LockClassId id, uint64_t wait_time) {
+  if (!collecting.load(ktl::memory_order_relaxed)) {
+    return;
+  }
+  lockstat::Stats* slot = CurrentSlot(id);
+  if (slot == nullptr) {
+    return;
+  }
+  Add(&slot->acquisitions, 1);
+  if (wait_time >= contended_threshold_ticks) {
+    Add(&slot->contentions, 1);
+  }
+  Add(&slot->total_wait, wait_time);
+  Max(&slot->max_wait, wait_time);
+}
+
+void SystemLockStatRelease(LockClassId id, uint64_t hold_time) {
+  if (!collecting.load(ktl::memory_order_relaxed)) {
+    return;
+  }
+  lockstat::Stats* slot = CurrentSlot(id);
+  if (slot == nullptr) {
+    return;
+  }
+  Add(&slot->total_hold, hold_time);
+  Max(&slot->max_hold, hold_time);
+}
+
+}  // namespace lockdep
+
+#endif  // WITH_LOCK_STAT
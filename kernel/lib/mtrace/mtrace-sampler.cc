@@ -0,0 +1,53 @@
+// Copyright 2020 The Fuchsia Authors
+//
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT
+
+#include <lib/sampler.h>
+#include <lib/zircon-internal/mtrace.h>
+
+#include "lib/mtrace.h"
+#include "trace.h"
+
+#define LOCAL_TRACE 0
+
+zx_status_t mtrace_sampler_control(uint32_t action, uint32_t options, user_inout_ptr<void> arg,
+                                   size_t size) {
+  LTRACEF("action %u, options 0x%x, arg %p, size 0x%zx\n", action, options, arg.get(), size);
+
+  switch (action) {
+    case MTRACE_SAMPLER_INIT: {
+      sampler::Config config;
+      if (options != 0 || size != sizeof(config))
+        return ZX_ERR_INVALID_ARGS;
+      zx_status_t status = arg.reinterpret<sampler::Config>().copy_from_user(&config);
+      if (status != ZX_OK)
+        return status;
+      return sampler::Init(config);
+    }
+
+    case MTRACE_SAMPLER_START:
+      if (options != 0 || size != 0)
+        return ZX_ERR_INVALID_ARGS;
+      return sampler::Start();
+
+    case MTRACE_SAMPLER_STOP:
+      if (options != 0 || size != 0)
+        return ZX_ERR_INVALID_ARGS;
+      sampler::Stop();
+      return ZX_OK;
+
+    case MTRACE_SAMPLER_READ:
+      return sampler::Read(options, arg, size);
+
+    case MTRACE_SAMPLER_FINI:
+      if (options != 0 || size != 0)
+        return ZX_ERR_INVALID_ARGS;
+      sampler::Fini();
+      return ZX_OK;
+
+    default:
+      return ZX_ERR_INVALID_ARGS;
+  }
+}
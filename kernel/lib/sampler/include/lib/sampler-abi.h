@@ -0,0 +1,60 @@
+// Copyright 2020 The Fuchsia Authors
+//
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT
+
+#ifndef ZIRCON_KERNEL_LIB_SAMPLER_INCLUDE_LIB_SAMPLER_ABI_H_
+#define ZIRCON_KERNEL_LIB_SAMPLER_INCLUDE_LIB_SAMPLER_ABI_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zircon/types.h>
+
+// This file describes the data exchanged with the sampling profiler through
+// zx_mtrace_control(MTRACE_KIND_SAMPLER, ...). Like the kcounters VMOs, this
+// is a PRIVATE UNSTABLE ABI that may change at any time and is only meant for
+// tools built from source with the kernel.
+
+namespace sampler {
+
+// The argument of MTRACE_SAMPLER_INIT.
+struct Config {
+  // Time between two samples on each CPU.
+  zx_duration_t period;
+  // Size in bytes of the sample buffer of each CPU.
+  uint64_t buffer_size;
+};
+
+// The per-CPU buffer read by MTRACE_SAMPLER_READ starts with this header and
+// is followed by |size| bytes of Records.
+struct BufferHeader {
+  uint64_t size;
+  // Samples that did not fit in the buffer.
+  uint64_t dropped;
+};
+
+// Flags of a Record.
+constexpr uint32_t kRecordUser = 1u << 0;  // The frames are user addresses.
+
+// The maximum number of frames in a Record.
+constexpr uint32_t kMaxFrames = 32;
+
+// One sample. Records are 8-byte aligned and followed by |num_frames| program
+// counters, innermost first. A sample of a thread running in user mode holds
+// its user stack; a sample of a thread running in the kernel holds its kernel
+// stack.
+struct Record {
+  zx_time_t time;
+  zx_koid_t pid;  // ZX_KOID_INVALID for kernel threads.
+  zx_koid_t tid;  // ZX_KOID_INVALID for kernel threads.
+  uint32_t flags;
+  uint32_t num_frames;
+  uint64_t frames[];
+
+  constexpr size_t size() const { return sizeof(Record) + num_frames * sizeof(frames[0]); }
+};
+
+}  // namespace sampler
+
+#endif  // ZIRCON_KERNEL_LIB_SAMPLER_INCLUDE_LIB_SAMPLER_ABI_H_
@@ -0,0 +1,44 @@
+// Copyright 2020 The Fuchsia Authors
+//
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT
+
+#ifndef ZIRCON_KERNEL_LIB_SAMPLER_INCLUDE_LIB_SAMPLER_H_
+#define ZIRCON_KERNEL_LIB_SAMPLER_INCLUDE_LIB_SAMPLER_H_
+
+#include <arch.h>
+#include <lib/sampler-abi.h>
+#include <lib/user_copy/user_ptr.h>
+#include <zircon/types.h>
+
+// The sampling profiler periodically records the stack of the thread running
+// on each CPU into a per-CPU buffer. Samples are taken from a per-CPU timer,
+// which fires from the platform timer interrupt and so needs no PMU support.
+//
+// A thread interrupted in the kernel has its kernel stack walked right away. A
+// thread interrupted in user mode has its user stack walked on its way back to
+// user mode, where reading user memory cannot block the interrupt handler.
+namespace sampler {
+
+// Allocates the per-CPU buffers. Sampling must be stopped.
+zx_status_t Init(const Config& config);
+
+// Starts or stops taking samples on every CPU.
+zx_status_t Start();
+void Stop();
+
+// Copies the BufferHeader and the samples of |cpu| to |out|, truncated to
+// |size| bytes. Sampling must be stopped.
+zx_status_t Read(uint32_t cpu, user_out_ptr<void> out, size_t size);
+
+// Frees the per-CPU buffers, stopping sampling if needed.
+void Fini();
+
+// Takes the user stack sample requested for the current thread, given its
+// user register state. Called on the way back to user mode.
+void SampleUser(GeneralRegsSource source, void* gregs);
+
+}  // namespace sampler
+
+#endif  // ZIRCON_KERNEL_LIB_SAMPLER_INCLUDE_LIB_SAMPLER_H_
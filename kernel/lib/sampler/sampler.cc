@@ -0,0 +1,317 @@
+// Copyright 2020 The Fuchsia Authors
+//
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT
+
+#include <lib/sampler.h>
+#include <platform.h>
+#include <string.h>
+#include <trace.h>
+
+#include <arch/user_copy.h>
+#include <fbl/alloc_checker.h>
+#include <kernel/mp.h>
+#include <kernel/mutex.h>
+#include <kernel/percpu.h>
+#include <kernel/spinlock.h>
+#include <kernel/thread.h>
+#include <kernel/timer.h>
+#include <ktl/algorithm.h>
+#include <ktl/atomic.h>
+#include <ktl/unique_ptr.h>
+#include <vm/vm.h>
+
+#if defined(__x86_64__)
+#include <arch/x86/general_regs.h>
+#include <arch/x86/iframe.h>
+#elif defined(__aarch64__)
+#include <arch/arm64/iframe.h>
+#endif
+
+#define LOCAL_TRACE 0
+
+namespace {
+
+// Bounds on the configuration accepted from userland.
+constexpr zx_duration_t kMinPeriod = ZX_USEC(10);
+constexpr uint64_t kMaxBufferSize = 64 * 1024 * 1024;
+
+struct CpuState {
+  Timer timer;
+  // The samples taken on this cpu. Only written by this cpu, with interrupts
+  // disabled.
+  ktl::unique_ptr<uint8_t[]> buffer;
+  size_t size = 0;
+  uint64_t dropped = 0;
+};
+
+CpuState cpu_states[SMP_MAX_CPUS];
+
+// Serializes the control operations.
+DECLARE_SINGLETON_MUTEX(SamplerLock);
+
+bool initialized TA_GUARDED(SamplerLock::Get()) = false;
+
+// Whether samples are being taken. Checked with interrupts disabled before
+// every write to a buffer, so once Stop() has synchronized with every cpu no
+// buffer changes anymore.
+ktl::atomic<bool> running{false};
+
+// Read by the timer callbacks, which cannot take SamplerLock. Only changed
+// while stopped.
+zx_duration_t sample_period;
+size_t buffer_size;
+
+bool GetUserRegs(GeneralRegsSource source, void* gregs, uintptr_t* pc, uintptr_t* fp) {
+  switch (source) {
+    case GeneralRegsSource::Iframe: {
+      const iframe_t* frame = static_cast<const iframe_t*>(gregs);
+#if defined(__x86_64__)
+      *pc = frame->ip;
+      *fp = frame->rbp;
+#elif defined(__aarch64__)
+      *pc = frame->elr;
+      *fp = frame->r[29];
+#endif
+      return true;
+    }
+#if defined(__x86_64__)
+    case GeneralRegsSource::Syscall: {
+      const auto* regs = static_cast<const x86_syscall_general_regs_t*>(gregs);
+      *pc = regs->rip;
+      *fp = regs->rbp;
+      return true;
+    }
+#endif
+    default:
+      return false;
+  }
+}
+
+void GetInterruptedRegs(const iframe_t* frame, uintptr_t* pc, uintptr_t* fp) {
+#if defined(__x86_64__)
+  *pc = frame->ip;
+  *fp = frame->rbp;
+#elif defined(__aarch64__)
+  *pc = frame->elr;
+  *fp = frame->r[29];
+#endif
+}
+
+// Appends a sample of the current thread to the buffer of the current cpu.
+void Append(uint32_t flags, zx_time_t time, const uint64_t* frames, uint32_t num_frames) {
+  DEBUG_ASSERT(arch_ints_disabled());
+  if (!running.load(ktl::memory_order_relaxed)) {
+    return;
+  }
+
+  CpuState& state = cpu_states[arch_curr_cpu_num()];
+  const Thread* thread = Thread::Current::Get();
+
+  sampler::Record record;
+  record.time = time;
+  record.pid = thread->user_pid_;
+  record.tid = thread->user_tid_;
+  record.flags = flags;
+  record.num_frames = num_frames;
+  const size_t size = record.size();
+  if (state.size + size > buffer_size) {
+    state.dropped++;
+    return;
+  }
+  memcpy(&state.buffer[state.size], &record, sizeof(record));
+  memcpy(&state.buffer[state.size + sizeof(record)], frames, num_frames * sizeof(frames[0]));
+  state.size += size;
+}
+
+// Records the kernel stack of the current thread, which was interrupted at
+// |pc| with frame pointer |fp|. Only frames within the thread's kernel stack
+// are followed, so this is safe in interrupt context.
+void SampleKernel(zx_time_t now, uintptr_t pc, uintptr_t fp) {
+  const Thread* thread = Thread::Current::Get();
+  const vaddr_t stack_base = thread->stack_.base();
+  const vaddr_t stack_top = thread->stack_.top();
+
+  uint64_t frames[sampler::kMaxFrames];
+  uint32_t num_frames = 0;
+  frames[num_frames++] = pc;
+  while (WITH_FRAME_POINTERS && num_frames < sampler::kMaxFrames && fp >= stack_base &&
+         fp <= stack_top - 2 * sizeof(uintptr_t) && IS_ALIGNED(fp, sizeof(uintptr_t))) {
+    const uintptr_t* frame = reinterpret_cast<const uintptr_t*>(fp);
+    if (frame[1] == 0) {
+      break;
+    }
+    frames[num_frames++] = frame[1];
+    if (frame[0] <= fp) {
+      break;
+    }
+    fp = frame[0];
+  }
+  Append(0, now, frames, num_frames);
+}
+
+void SampleTimerCallback(Timer* timer, zx_time_t now, void* arg) {
+  if (!running.load(ktl::memory_order_relaxed)) {
+    return;
+  }
+
+  // The interrupted state is only known when the timer fired from the
+  // platform timer interrupt.
+  const iframe_t* frame = get_local_percpu()->irq_frame;
+  if (frame != nullptr) {
+    uintptr_t pc, fp;
+    GetInterruptedRegs(frame, &pc, &fp);
+    if (is_user_address(pc)) {
+      Thread::Current::SignalSample();
+    } else {
+      SampleKernel(now, pc, fp);
+    }
+  }
+
+  timer->Set(Deadline::no_slack(zx_time_add_duration(now, sample_period)), SampleTimerCallback,
+             arg);
+}
+
+void StartLocal(void*) {
+  Timer& timer = cpu_states[arch_curr_cpu_num()].timer;
+  timer.Set(Deadline::no_slack(zx_time_add_duration(current_time(), sample_period)),
+            SampleTimerCallback, nullptr);
+}
+
+// Runs with interrupts disabled on each cpu, so the local timer callback is
+// not running and no sample is being appended.
+void StopLocal(void*) { cpu_states[arch_curr_cpu_num()].timer.Cancel(); }
+
+void StopLocked() TA_REQ(SamplerLock::Get()) {
+  if (running.exchange(false)) {
+    mp_sync_exec(MP_IPI_TARGET_ALL, 0, StopLocal, nullptr);
+  }
+}
+
+}  // anonymous namespace
+
+namespace sampler {
+
+zx_status_t Init(const Config& new_config) {
+  if (new_config.period < kMinPeriod || new_config.buffer_size < sizeof(Record) ||
+      new_config.buffer_size > kMaxBufferSize) {
+    return ZX_ERR_INVALID_ARGS;
+  }
+
+  Guard<Mutex> guard{SamplerLock::Get()};
+  if (running.load()) {
+    return ZX_ERR_BAD_STATE;
+  }
+
+  for (uint cpu = 0; cpu < arch_max_num_cpus(); cpu++) {
+    CpuState& state = cpu_states[cpu];
+    fbl::AllocChecker ac;
+    state.buffer.reset(new (&ac) uint8_t[new_config.buffer_size]);
+    if (!ac.check()) {
+      for (uint i = 0; i <= cpu; i++) {
+        cpu_states[i].buffer.reset();
+      }
+      initialized = false;
+      return ZX_ERR_NO_MEMORY;
+    }
+    state.size = 0;
+    state.dropped = 0;
+  }
+
+  sample_period = new_config.period;
+  buffer_size = new_config.buffer_size;
+  initialized = true;
+  return ZX_OK;
+}
+
+zx_status_t Start() {
+  Guard<Mutex> guard{SamplerLock::Get()};
+  if (!initialized) {
+    return ZX_ERR_BAD_STATE;
+  }
+  if (running.exchange(true)) {
+    return ZX_OK;
+  }
+  mp_sync_exec(MP_IPI_TARGET_ALL, 0, StartLocal, nullptr);
+  return ZX_OK;
+}
+
+void Stop() {
+  Guard<Mutex> guard{SamplerLock::Get()};
+  StopLocked();
+}
+
+zx_status_t Read(uint32_t cpu, user_out_ptr<void> out, size_t size) {
+  Guard<Mutex> guard{SamplerLock::Get()};
+  if (!initialized || running.load()) {
+    return ZX_ERR_BAD_STATE;
+  }
+  if (cpu >= arch_max_num_cpus()) {
+    return ZX_ERR_INVALID_ARGS;
+  }
+  if (size < sizeof(BufferHeader)) {
+    return ZX_ERR_BUFFER_TOO_SMALL;
+  }
+
+  const CpuState& state = cpu_states[cpu];
+  const BufferHeader header = {.size = state.size, .dropped = state.dropped};
+  zx_status_t status = out.reinterpret<BufferHeader>().copy_to_user(header);
+  if (status != ZX_OK) {
+    return status;
+  }
+  const size_t data_size = ktl::min(size - sizeof(header), state.size);
+  return out.byte_offset(sizeof(header))
+      .reinterpret<uint8_t>()
+      .copy_array_to_user(state.buffer.get(), data_size);
+}
+
+void Fini() {
+  Guard<Mutex> guard{SamplerLock::Get()};
+  StopLocked();
+  for (auto& state : cpu_states) {
+    state.buffer.reset();
+    state.size = 0;
+    state.dropped = 0;
+  }
+  initialized = false;
+}
+
+void SampleUser(GeneralRegsSource source, void* gregs) {
+  if (!running.load(ktl::memory_order_relaxed)) {
+    return;
+  }
+  uintptr_t pc, fp;
+  if (!GetUserRegs(source, gregs, &pc, &fp)) {
+    return;
+  }
+
+  // Walk the user frame pointers without faulting in memory, stopping at the
+  // first frame that cannot be read.
+  uint64_t frames[kMaxFrames];
+  uint32_t num_frames = 0;
+  frames[num_frames++] = pc;
+  while (num_frames < kMaxFrames && fp != 0 && IS_ALIGNED(fp, sizeof(uintptr_t)) &&
+         is_user_address(fp)) {
+    uintptr_t frame[2];
+    if (arch_copy_from_user_capture_faults(frame, reinterpret_cast<const void*>(fp), sizeof(frame))
+            .status != ZX_OK) {
+      break;
+    }
+    if (frame[1] == 0) {
+      break;
+    }
+    frames[num_frames++] = frame[1];
+    if (frame[0] <= fp) {
+      break;
+    }
+    fp = frame[0];
+  }
+
+  spin_lock_saved_state_t state;
+  arch_interrupt_save(&state, SPIN_LOCK_FLAG_INTERRUPTS);
+  Append(kRecordUser, current_time(), frames, num_frames);
+  arch_interrupt_restore(state, SPIN_LOCK_FLAG_INTERRUPTS);
+}
+
+}  // namespace sampler
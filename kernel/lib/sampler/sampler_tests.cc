@@ -0,0 +1,76 @@
+// Copyright 2020 The Fuchsia Authors
+//
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT
+
+#include <lib/sampler.h>
+#include <lib/unittest/unittest.h>
+#include <lib/unittest/user_memory.h>
+#include <platform.h>
+#include <string.h>
+
+#include <fbl/alloc_checker.h>
+#include <fbl/auto_call.h>
+#include <ktl/unique_ptr.h>
+
+namespace {
+
+using testing::UserMemory;
+
+constexpr size_t kBufferSize = 64 * 1024;
+
+// Runs the sampler while this thread spins in the kernel, and checks that the
+// sample timer recorded kernel stacks.
+bool sampler_records_kernel_samples() {
+  BEGIN_TEST;
+
+  ASSERT_EQ(ZX_OK, sampler::Init({.period = ZX_USEC(100), .buffer_size = kBufferSize}));
+  auto cleanup = fbl::MakeAutoCall([] { sampler::Fini(); });
+
+  ASSERT_EQ(ZX_OK, sampler::Start());
+  const zx_time_t deadline = zx_time_add_duration(current_time(), ZX_MSEC(20));
+  while (current_time() < deadline) {
+  }
+  sampler::Stop();
+
+  const size_t read_size = sizeof(sampler::BufferHeader) + kBufferSize;
+  ktl::unique_ptr<UserMemory> user_memory = UserMemory::Create(read_size);
+  ASSERT_NONNULL(user_memory);
+  fbl::AllocChecker ac;
+  ktl::unique_ptr<uint8_t[]> buffer(new (&ac) uint8_t[read_size]);
+  ASSERT_TRUE(ac.check());
+
+  uint64_t kernel_samples = 0;
+  for (uint32_t cpu = 0; cpu < arch_max_num_cpus(); cpu++) {
+    ASSERT_EQ(ZX_OK, sampler::Read(cpu, user_memory->user_out<void>(), read_size));
+    ASSERT_EQ(ZX_OK, user_memory->VmoRead(buffer.get(), 0, read_size));
+
+    sampler::BufferHeader header;
+    memcpy(&header, buffer.get(), sizeof(header));
+    ASSERT_LE(header.size, kBufferSize);
+
+    const uint8_t* data = buffer.get() + sizeof(header);
+    for (size_t offset = 0; offset < header.size;) {
+      sampler::Record record;
+      ASSERT_LE(offset + sizeof(record), header.size);
+      memcpy(&record, data + offset, sizeof(record));
+      ASSERT_GT(record.num_frames, 0u);
+      ASSERT_LE(record.num_frames, sampler::kMaxFrames);
+      ASSERT_LE(offset + record.size(), header.size);
+      if (!(record.flags & sampler::kRecordUser)) {
+        kernel_samples++;
+      }
+      offset += record.size();
+    }
+  }
+  EXPECT_GT(kernel_samples, 0u);
+
+  END_TEST;
+}
+
+}  // namespace
+
+UNITTEST_START_TESTCASE(sampler_tests)
+UNITTEST("sampler_records_kernel_samples", sampler_records_kernel_samples)
+UNITTEST_END_TESTCASE(sampler_tests, "sampler", "Sampling profiler tests")
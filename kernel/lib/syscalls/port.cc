@@ -13,6 +13,7 @@
 
 #include <fbl/alloc_checker.h>
 #include <fbl/ref_ptr.h>
+#include <ktl/algorithm.h>
 #include <object/handle.h>
 #include <object/port_dispatcher.h>
 #include <object/process_dispatcher.h>
@@ -94,6 +95,54 @@ zx_status_t sys_port_wait(zx_handle_t handle, zx_time_t deadline,
   return ZX_OK;
 }
 
+// zx_status_t zx_port_wait_many
+zx_status_t sys_port_wait_many(zx_handle_t handle, zx_time_t deadline,
+                               user_out_ptr<zx_port_packet_t> packets_out, size_t num_packets,
+                               user_out_ptr<size_t> actual_out) {
+  LTRACEF("handle %x num_packets %zu\n", handle, num_packets);
+
+  if (num_packets == 0)
+    return ZX_ERR_INVALID_ARGS;
+
+  auto up = ProcessDispatcher::GetCurrent();
+
+  fbl::RefPtr<PortDispatcher> port;
+  zx_status_t status = up->GetDispatcherWithRights(handle, ZX_RIGHT_READ, &port);
+  if (status != ZX_OK)
+    return status;
+
+  // Larger requests are clamped rather than rejected, so callers can pass the size of their
+  // buffer without knowing the limit. The limit keeps the staging array small enough for the
+  // kernel stack.
+  static_assert(ZX_PORT_WAIT_MANY_MAX_PACKETS <= 16u);
+  num_packets = ktl::min(num_packets, ZX_PORT_WAIT_MANY_MAX_PACKETS);
+  zx_port_packet_t pp[ZX_PORT_WAIT_MANY_MAX_PACKETS];
+
+  const Deadline slackDeadline(deadline, up->GetTimerSlackPolicy());
+
+  ktrace(TAG_PORT_WAIT, (uint32_t)port->get_koid(), 0, 0, 0);
+
+  size_t actual = 0;
+  zx_status_t st = port->DequeueMany(slackDeadline, pp, num_packets, &actual);
+
+  ktrace(TAG_PORT_WAIT_DONE, (uint32_t)port->get_koid(), st, 0, 0);
+
+  if (st != ZX_OK)
+    return st;
+
+  status = packets_out.copy_array_to_user(pp, actual);
+  if (status != ZX_OK)
+    return status;
+
+  if (actual_out) {
+    status = actual_out.copy_to_user(actual);
+    if (status != ZX_OK)
+      return status;
+  }
+
+  return ZX_OK;
+}
+
 // zx_status_t zx_port_cancel
 zx_status_t sys_port_cancel(zx_handle_t handle, zx_handle_t source, uint64_t key) {
   auto up = ProcessDispatcher::GetCurrent();
@@ -30,6 +30,7 @@
 #include <object/suspend_token_dispatcher.h>
 #include <object/thread_dispatcher.h>
 #include <object/vm_address_region_dispatcher.h>
+#include <object/vm_object_dispatcher.h>
 
 #include "priv.h"
 
@@ -158,6 +159,27 @@ zx_status_t sys_thread_read_state(zx_handle_t handle, uint32_t kind, user_out_pt
   return thread->ReadState(static_cast<zx_thread_state_topic_t>(kind), buffer, buffer_size);
 }
 
+// zx_status_t zx_thread_get_stats_vmo
+zx_status_t sys_thread_get_stats_vmo(zx_handle_t handle, user_out_handle* out) {
+  LTRACEF("handle %x\n", handle);
+
+  auto up = ProcessDispatcher::GetCurrent();
+
+  fbl::RefPtr<ThreadDispatcher> thread;
+  zx_status_t status = up->GetDispatcherWithRights(handle, ZX_RIGHT_INSPECT, &thread);
+  if (status != ZX_OK)
+    return status;
+
+  KernelHandle<VmObjectDispatcher> kernel_handle;
+  zx_rights_t rights;
+  status = thread->GetStatsVmo(&kernel_handle, &rights);
+  if (status != ZX_OK)
+    return status;
+
+  // The page is written by the kernel only.
+  return out->make(ktl::move(kernel_handle), ZX_RIGHTS_BASIC | ZX_RIGHT_READ | ZX_RIGHT_MAP);
+}
+
 // zx_status_t zx_thread_write_state
 zx_status_t sys_thread_write_state(zx_handle_t handle, uint32_t kind,
                                    user_in_ptr<const void> buffer, size_t buffer_size) {
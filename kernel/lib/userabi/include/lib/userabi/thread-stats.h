@@ -0,0 +1,44 @@
+// Copyright 2020 The Fuchsia Authors
+//
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT
+
+#ifndef ZIRCON_KERNEL_LIB_USERABI_INCLUDE_LIB_USERABI_THREAD_STATS_H_
+#define ZIRCON_KERNEL_LIB_USERABI_INCLUDE_LIB_USERABI_THREAD_STATS_H_
+
+// This file is used both in the kernel and in the vDSO implementation.
+// So it must be compatible with both the kernel and userland header
+// environments.  It must use only the basic types so that struct
+// layouts match exactly in both contexts.
+
+#include <stdint.h>
+#include <zircon/time.h>
+
+// The layout of the page returned by zx_thread_get_stats_vmo.  The kernel
+// updates it when the thread is switched to or away from, and the vDSO reads
+// it in zx_thread_read_stats.  Userland code outside the vDSO must not depend
+// on this layout.
+//
+// The page is a sequence lock: the kernel increments |sequence| before and
+// after each update, so readers retry while it is odd or if it changed while
+// they were reading.
+struct thread_stats_page {
+  uint64_t sequence;
+
+  // Runtime accumulated by the thread up to |running_since|.
+  zx_duration_t runtime;
+
+  // The time at which the thread was last switched to, if it is still
+  // running, or zero if it is not.
+  zx_time_t running_since;
+
+  // The number of times the thread has been switched to.
+  uint64_t context_switches;
+
+  // The CPU the thread last ran on.
+  uint32_t last_cpu;
+  uint32_t reserved;
+};
+
+#endif  // ZIRCON_KERNEL_LIB_USERABI_INCLUDE_LIB_USERABI_THREAD_STATS_H_
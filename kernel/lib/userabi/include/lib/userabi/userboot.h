@@ -54,6 +54,9 @@ enum HandleIndex : uint32_t {
 #if ENABLE_ENTROPY_COLLECTOR_TEST
   kEntropyTestData,
 #endif
+#if WITH_LOCK_STAT
+  kLockStat,
+#endif
 
   kFirstInstrumentationData,
   kHandleCount = kFirstInstrumentationData + InstrumentationData::vmo_count()
@@ -25,14 +25,15 @@
 // |++ cache lines sizes (2)
 // |++ ticks to mono ratio (2)
 // |
-// + 3 64-bit integers
+// + 4 64-bit integers
 // | ticks_per_second (1)
 // | physmem amount (1)
+// | mutex spin duration (1)
 // | version_string_len
 // |
 // + max version string size (64 bytes)
 //
-#define VDSO_CONSTANTS_SIZE ((8 * 4) + (3 * 8) + MAX_VERSION_STRING_SIZE)
+#define VDSO_CONSTANTS_SIZE ((8 * 4) + (4 * 8) + MAX_VERSION_STRING_SIZE)
 
 #ifndef __ASSEMBLER__
 
@@ -81,6 +82,11 @@ struct vdso_constants {
   // Total amount of physical memory in the system, in bytes.
   uint64_t physmem;
 
+  // How long a contended userspace mutex should spin waiting for its owner
+  // before blocking in zx_futex_wait.  Zero when spinning cannot help, such as
+  // on systems with a single CPU.
+  zx_duration_t mutex_spin_duration;
+
   // Actual length of .version_string, not including the NUL terminator.
   uint64_t version_string_len;
 
@@ -41,6 +41,10 @@
 #include <lib/crypto/entropy/quality_test.h>
 #endif
 
+#if WITH_LOCK_STAT
+#include <lib/lockstat.h>
+#endif
+
 static_assert(userboot::kCmdlineMax == Cmdline::kCmdlineMax);
 
 namespace {
@@ -241,6 +245,15 @@ void bootstrap_vmos(Handle** handles) {
   status = get_vmo_handle(ktl::move(kcounters_vmo), true, nullptr, &handles[kCounters]);
   ASSERT(status == ZX_OK);
 
+#if WITH_LOCK_STAT
+  // Lock statistics live data.
+  fbl::RefPtr<VmObject> lockstat_vmo;
+  status = lockstat::GetVmo(&lockstat_vmo);
+  ASSERT(status == ZX_OK);
+  status = get_vmo_handle(ktl::move(lockstat_vmo), true, nullptr, &handles[kLockStat]);
+  ASSERT(status == ZX_OK);
+#endif
+
   status = InstrumentationData::GetVmos(&handles[kFirstInstrumentationData]);
   ASSERT(status == ZX_OK);
 }
@@ -236,6 +236,11 @@ const VDso* VDso::Create(KernelHandle<VmObjectDispatcher>* vmo_kernel_handles) {
   ASSERT(ticks_to_mono_ratio.numerator() != 0);
   ASSERT(ticks_to_mono_ratio.denominator() != 0);
 
+  // An owner can only release a mutex while a waiter spins if they run on
+  // different CPUs, so there is no point in spinning on a uniprocessor.
+  const zx_duration_t mutex_spin_duration =
+      arch_max_num_cpus() > 1 ? ZX_NSEC(gCmdline.GetUInt64("vdso.mutex_spin_ns", 5000)) : 0;
+
   // Initialize the constants that should be visible to the vDSO.
   // Rather than assigning each member individually, do this with
   // struct assignment and a compound literal so that the compiler
@@ -254,6 +259,7 @@ const VDso* VDso::Create(KernelHandle<VmObjectDispatcher>* vmo_kernel_handles) {
       ticks_to_mono_ratio.numerator(),
       ticks_to_mono_ratio.denominator(),
       pmm_count_total_bytes(),
+      mutex_spin_duration,
       strlen(version_string()),
       "",
   };
@@ -24,6 +24,7 @@
 #include <object/port_dispatcher.h>
 #include <platform/crashlog.h>
 #include <platform/halt_helper.h>
+#include <vm/kstack.h>
 
 static Executor gExecutor;
 
@@ -176,6 +177,11 @@ static int oom_thread(void* unused) {
       prev_mem_event_idx = idx;
       prev_mem_state_eval_time = time_now;
 
+      // Give back the memory of the kernel stacks cached for new threads.
+      if (idx < PressureLevel::kNormal) {
+        KernelStack::TrimCache();
+      }
+
       // If we're below the out-of-memory watermark, trigger OOM behavior.
       if (idx == 0) {
         on_oom();
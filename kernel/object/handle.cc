@@ -171,6 +171,7 @@ void Handle::TearDown() {
   // process_id to already have been cleared by the process dispatcher before the handle got to
   // this point.
   DEBUG_ASSERT(process_id() == ZX_KOID_INVALID);
+  DEBUG_ASSERT(cache() == nullptr);
 
   // Explicitly reset the dispatcher to drop the reference, if this deletes the dispatcher then
   // many things could ultimately happen and so it is important that this be outside the lock.
@@ -34,6 +34,7 @@ struct HandleDestroyer {
 // ownership of the Handle and deletes it whenever it falls out of scope.
 using HandleOwner = ktl::unique_ptr<Handle, HandleDestroyer>;
 
+class HandleCache;
 class HandleTableArena;
 
 // A Handle is how a specific process refers to a specific Dispatcher.
@@ -56,6 +57,25 @@ class Handle final {
   // Returns true if this handle has all of the desired rights bits set.
   bool HasRights(zx_rights_t desired) const { return (rights_ & desired) == desired; }
 
+  // Returns the HandleCache holding this handle, if any. A handle is held by at
+  // most one cache; see HandleCache.
+  HandleCache* cache() const { return cache_.load(ktl::memory_order_relaxed); }
+
+  // Records that |cache| holds this handle. Returns false if another cache
+  // already does.
+  bool ClaimCache(HandleCache* cache) {
+    HandleCache* expected = nullptr;
+    return cache_.compare_exchange_strong(expected, cache, ktl::memory_order_relaxed,
+                                          ktl::memory_order_relaxed) ||
+           expected == cache;
+  }
+
+  // Records that |cache| no longer holds this handle.
+  void ReleaseCache(HandleCache* cache) {
+    DEBUG_ASSERT(this->cache() == cache);
+    cache_.store(nullptr, ktl::memory_order_relaxed);
+  }
+
   // Returns a value that can be decoded by Handle::FromU32() to derive a
   // pointer to this instance.  ProcessDispatcher will XOR this with its
   // |handle_rand_| to create the zx_handle_t value that user space sees.
@@ -125,6 +145,11 @@ class Handle final {
   friend HandleTableArena;
 
   NodeState node_state_;
+
+  // The HandleCache holding this handle, if any. Claimed with the handle table
+  // lock held for reading, and released with it held for reading by the owner
+  // of the cache or for writing by anyone.
+  ktl::atomic<HandleCache*> cache_{nullptr};
 };
 
 class HandleTableArena {
@@ -0,0 +1,144 @@
+// Copyright 2020 The Fuchsia Authors
+//
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT
+
+#ifndef ZIRCON_KERNEL_OBJECT_INCLUDE_OBJECT_HANDLE_CACHE_H_
+#define ZIRCON_KERNEL_OBJECT_INCLUDE_OBJECT_HANDLE_CACHE_H_
+
+#include <lib/arch/intrin.h>
+#include <stdint.h>
+#include <zircon/types.h>
+
+#include <fbl/intrusive_double_list.h>
+#include <fbl/ref_ptr.h>
+#include <kernel/auto_preempt_disabler.h>
+#include <ktl/atomic.h>
+#include <object/dispatcher.h>
+#include <object/handle.h>
+
+// A cache of the handles a thread looked up recently in its process, which
+// lets the thread skip the handle table lock when it uses a handle again.
+//
+// A handle never changes while it is in a handle table, so a cached lookup
+// stays correct until the handle leaves the table. A handle is held by at most
+// one cache at a time, which it records, and the process drops the handle from
+// that cache as the handle leaves the table, under the handle table lock. So an
+// entry only exists while its handle is in the table, the reference it holds
+// never keeps a dispatcher alive longer than the handle does, and removing a
+// handle touches a single cache, however many threads the process has.
+//
+// Entries are filled by the owning thread with the handle table lock held, and
+// dropped by any thread with the handle table lock held for writing. Hits take
+// no lock: the owning thread flags that it is reading an entry, and a thread
+// dropping an entry waits for the flag to clear before releasing the entry's
+// dispatcher.
+class HandleCache : public fbl::DoublyLinkedListable<HandleCache*> {
+ public:
+  static constexpr size_t kNumEntries = 4;
+
+  HandleCache() = default;
+  HandleCache(const HandleCache&) = delete;
+  HandleCache& operator=(const HandleCache&) = delete;
+
+  // Returns true and the dispatcher and rights of |value| if it is cached.
+  // Only called by the owning thread.
+  bool Lookup(zx_handle_t value, fbl::RefPtr<Dispatcher>* dispatcher, zx_rights_t* rights) {
+    // Don't keep a thread dropping an entry waiting on a preempted reader.
+    AutoPreemptDisabler<APDInitialState::PREEMPT_ALLOWED> preempt_disabler;
+    preempt_disabler.Disable();
+    reading_.store(true, ktl::memory_order_seq_cst);
+    const Entry& entry = entries_[Index(value)];
+    const bool hit = entry.value.load(ktl::memory_order_seq_cst) == value;
+    if (hit) {
+      *dispatcher = entry.dispatcher;
+      *rights = entry.rights;
+    }
+    reading_.store(false, ktl::memory_order_release);
+    return hit;
+  }
+
+  // Caches a lookup of |handle|, whose value is |value|, unless another cache
+  // holds it. Only called by the owning thread, with the handle table lock
+  // held since the lookup, so that the handle cannot have left the table
+  // meanwhile.
+  void Insert(zx_handle_t value, Handle* handle) {
+    Entry& entry = entries_[Index(value)];
+    if (entry.handle == handle || !handle->ClaimCache(this)) {
+      return;
+    }
+    // The evicted dispatcher is still referenced by its handle, so releasing
+    // it here never destroys it. The owning thread is the only reader, so
+    // the entry can be overwritten without waiting.
+    if (entry.handle != nullptr) {
+      entry.handle->ReleaseCache(this);
+    }
+    entry.value.store(value, ktl::memory_order_relaxed);
+    entry.rights = handle->rights();
+    entry.dispatcher = handle->dispatcher();
+    entry.handle = handle;
+  }
+
+  // Drops |handle|, whose value is |value|, which this cache holds. Must be
+  // called with the handle table lock held for writing as the handle leaves
+  // the table, which excludes a concurrent Insert.
+  void Remove(zx_handle_t value, Handle* handle) {
+    Entry& entry = entries_[Index(value)];
+    DEBUG_ASSERT(entry.handle == handle);
+    Drop(&entry);
+  }
+
+  // Drops every entry. Must be called with the handle table lock held for
+  // writing, while the handles of the entries are still referenced.
+  void Clear() {
+    for (Entry& entry : entries_) {
+      if (entry.handle != nullptr) {
+        Drop(&entry);
+      }
+    }
+  }
+
+  // Whether the cache is in its process's list of caches, and whether it has
+  // been taken out of it for good as its thread exits. Only accessed by the
+  // owning thread.
+  bool registered() const { return registered_; }
+  bool retired() const { return retired_; }
+  void set_registered(bool registered) {
+    registered_ = registered;
+    retired_ = retired_ || !registered;
+  }
+
+ private:
+  struct Entry {
+    ktl::atomic<zx_handle_t> value{ZX_HANDLE_INVALID};
+    zx_rights_t rights = 0;
+    fbl::RefPtr<Dispatcher> dispatcher;
+    Handle* handle = nullptr;
+  };
+
+  // The low bits of a handle value are fixed, and the bits above them come
+  // from the randomized handle table index.
+  static size_t Index(zx_handle_t value) { return (value >> kHandleReservedBits) % kNumEntries; }
+
+  void Drop(Entry* entry) {
+    // Once the value is cleared, a new lookup misses. Wait out a lookup which
+    // may have matched the old value before releasing what it copies.
+    entry->value.store(ZX_HANDLE_INVALID, ktl::memory_order_seq_cst);
+    while (reading_.load(ktl::memory_order_seq_cst)) {
+      arch::Yield();
+    }
+    entry->handle->ReleaseCache(this);
+    entry->handle = nullptr;
+    entry->rights = 0;
+    entry->dispatcher.reset();
+  }
+
+  // Set while the owning thread is reading an entry in Lookup.
+  ktl::atomic<bool> reading_{false};
+  Entry entries_[kNumEntries];
+  bool registered_ = false;
+  bool retired_ = false;
+};
+
+#endif  // ZIRCON_KERNEL_OBJECT_INCLUDE_OBJECT_HANDLE_CACHE_H_
@@ -173,7 +173,7 @@ class PortObserver final : public StateObserver {
 // linked list and case 3 uses |interrupt_packets_| linked list.
 //
 // The threads that wish to receive notifications block on Dequeue() (which
-// maps to zx_port_wait()) and will receive packets from any of the four sources
+// maps to zx_port_wait()) or DequeueMany() (zx_port_wait_many()) and will receive packets from any of the four sources
 // depending on what kind of object the port has been 'bound' to.
 //
 // When a packet from any of the sources arrives to the port, one waiting
@@ -197,6 +197,10 @@ class PortDispatcher final : public SoloDispatcher<PortDispatcher, ZX_DEFAULT_PO
   zx_status_t QueueUser(const zx_port_packet_t& packet);
   bool QueueInterruptPacket(PortInterruptPacket* port_packet, zx_time_t timestamp);
   zx_status_t Dequeue(const Deadline& deadline, zx_port_packet_t* packet);
+  // Waits like Dequeue() for the first packet, then also takes up to |count| - 1 packets which
+  // are already queued without waiting for more.
+  zx_status_t DequeueMany(const Deadline& deadline, zx_port_packet_t* packets, size_t count,
+                          size_t* actual);
   bool RemoveInterruptPacket(PortInterruptPacket* port_packet);
 
   // This method determines the observer's fate. Upon return, one of the following will have
@@ -225,6 +229,10 @@ class PortDispatcher final : public SoloDispatcher<PortDispatcher, ZX_DEFAULT_PO
  private:
   explicit PortDispatcher(uint32_t options);
 
+  // Pops the next packet after a count has been taken from |sema_|. Returns false if the packet
+  // was removed from the queue before it could be popped.
+  bool PopPacket(zx_port_packet_t* out_packet);
+
   const uint32_t options_;
   Semaphore sema_;
   bool zero_handles_ TA_GUARDED(get_lock());
@@ -21,6 +21,7 @@
 #include <kernel/mutex.h>
 #include <kernel/thread.h>
 #include <ktl/array.h>
+#include <ktl/atomic.h>
 #include <ktl/forward.h>
 #include <ktl/span.h>
 #include <object/dispatcher.h>
@@ -355,21 +356,12 @@ class ProcessDispatcher final
   zx_status_t GetDispatcherWithRightsImpl(zx_handle_t handle_value, zx_rights_t desired_rights,
                                           fbl::RefPtr<T>* out_dispatcher, zx_rights_t* out_rights,
                                           bool skip_policy) {
-    bool has_desired_rights;
     zx_rights_t rights;
     fbl::RefPtr<Dispatcher> generic_dispatcher;
+    if (!LookupHandle(handle_value, skip_policy, &generic_dispatcher, &rights))
+      return ZX_ERR_BAD_HANDLE;
 
-    {
-      // Scope utilized to reduce lock duration.
-      Guard<BrwLockPi, BrwLockPi::Reader> guard{&handle_table_lock_};
-      Handle* handle = GetHandleLocked(handle_value, skip_policy);
-      if (!handle)
-        return ZX_ERR_BAD_HANDLE;
-
-      has_desired_rights = handle->HasRights(desired_rights);
-      rights = handle->rights();
-      generic_dispatcher = handle->dispatcher();
-    }
+    const bool has_desired_rights = (rights & desired_rights) == desired_rights;
 
     fbl::RefPtr<T> dispatcher = DownCastDispatcher<T>(&generic_dispatcher);
 
@@ -407,6 +399,18 @@ class ProcessDispatcher final
   zx_status_t GetDispatcherInternal(zx_handle_t handle_value, fbl::RefPtr<Dispatcher>* dispatcher,
                                     zx_rights_t* rights);
 
+  // Looks up the dispatcher and rights of |handle_value|. When the current
+  // thread belongs to this process, the lookup is served from its HandleCache
+  // if possible, without taking |handle_table_lock_|, and otherwise cached.
+  // Returns false if the handle does not belong to this process.
+  bool LookupHandle(zx_handle_t handle_value, bool skip_policy,
+                    fbl::RefPtr<Dispatcher>* dispatcher, zx_rights_t* rights);
+
+  // Adds the HandleCache of a thread of this process to |handle_caches_|, or
+  // removes and clears it for good. Called by the thread itself.
+  void RegisterHandleCache(HandleCache* cache);
+  void UnregisterHandleCache(HandleCache* cache);
+
   void OnProcessStartForJobDebugger(ThreadDispatcher* t, const arch_exception_context_t* context);
 
   // Thread lifecycle support.
@@ -453,6 +457,10 @@ class ProcessDispatcher final
   // advance or invalidate any cursors that might point to the handles being removed.
   uint32_t handle_table_count_ TA_GUARDED(handle_table_lock_) = 0;
   HandleList handle_table_ TA_GUARDED(handle_table_lock_);
+  // The HandleCaches of the threads of this process, which are cleared before
+  // the handle table is torn down. A handle leaving |handle_table_| is dropped
+  // from the one cache holding it, if any.
+  fbl::DoublyLinkedList<HandleCache*> handle_caches_ TA_GUARDED(handle_table_lock_);
   // A list of cursors that contain pointers to elements of handle_table_.
   fbl::DoublyLinkedList<HandleCursor*> handle_table_cursors_ TA_GUARDED(handle_table_lock_);
 
@@ -29,7 +29,9 @@
 #include <object/exception_dispatcher.h>
 #include <object/exceptionate.h>
 #include <object/handle.h>
+#include <object/handle_cache.h>
 #include <object/thread_state.h>
+#include <object/vm_object_dispatcher.h>
 #include <vm/vm_address_region.h>
 
 class ProcessDispatcher;
@@ -103,6 +105,10 @@ class ThreadDispatcher final : public SoloDispatcher<ThreadDispatcher, ZX_DEFAUL
   // accessors
   ProcessDispatcher* process() const { return process_.get(); }
 
+  // The handles of the process this thread looked up recently. Only used from
+  // ProcessDispatcher.
+  HandleCache& handle_cache() { return handle_cache_; }
+
   // Returns true if the thread is dying or dead. Threads never return to a previous state
   // from dying/dead so once this is true it will never flip back to false.
   bool IsDyingOrDead() const TA_EXCL(get_lock());
@@ -155,6 +161,12 @@ class ThreadDispatcher final : public SoloDispatcher<ThreadDispatcher, ZX_DEFAUL
   // Fetch per thread stats for userspace.
   zx_status_t GetStatsForUserspace(zx_info_thread_stats_t* info);
 
+  // Fetch a dispatcher for the VMO to which the thread's stats are continuously published,
+  // creating the VMO on first use. The VMO holds a single |thread_stats_page|, which the vDSO
+  // reads without entering the kernel.
+  zx_status_t GetStatsVmo(KernelHandle<VmObjectDispatcher>* handle, zx_rights_t* rights)
+      TA_EXCL(get_lock());
+
   // For debugger usage.
   zx_status_t ReadState(zx_thread_state_topic_t state_kind, user_out_ptr<void> buffer,
                         size_t buffer_size);
@@ -269,9 +281,18 @@ class ThreadDispatcher final : public SoloDispatcher<ThreadDispatcher, ZX_DEFAUL
   // only when this reference count reaches 0.
   int suspend_count_ TA_GUARDED(get_lock()) = 0;
 
+  // The VMO backing the core thread's stats page, if userspace has asked for it. It is
+  // pinned for its whole lifetime, and outlives the core thread's use of it since the
+  // core thread is joined or forgotten before the dispatcher's members are destroyed.
+  fbl::RefPtr<VmObject> stats_vmo_ TA_GUARDED(get_lock());
+
   // Used to protect thread name read/writes
   mutable DECLARE_SPINLOCK(ThreadDispatcher) name_lock_;
 
+  // Filled by the thread itself, and emptied by its process as handles leave
+  // the handle table.
+  HandleCache handle_cache_;
+
   // Per-thread structure used while waiting in a ChannelDispatcher::Call.
   // Needed to support the requirements of being able to interrupt a Call
   // in order to suspend a thread.
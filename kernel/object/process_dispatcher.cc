@@ -35,6 +35,8 @@
 
 KCOUNTER(dispatcher_process_create_count, "dispatcher.process.create")
 KCOUNTER(dispatcher_process_destroy_count, "dispatcher.process.destroy")
+KCOUNTER(handle_cache_hit_count, "handles.cache.hit")
+KCOUNTER(handle_cache_miss_count, "handles.cache.miss")
 
 constexpr uint32_t kHandleMustBeOneMask = ((0x1u << kHandleReservedBits) - 1);
 static_assert(kHandleMustBeOneMask == ZX_HANDLE_FIXED_BITS_MASK,
@@ -420,6 +422,11 @@ void ProcessDispatcher::FinishDeadTransition() {
       handle.set_process_id(ZX_KOID_INVALID);
     }
     handle_table_count_ = 0;
+    // Every thread has exited, and so unregistered its cache, but drop any
+    // cached lookup while the handles still hold their dispatchers.
+    for (auto& cache : handle_caches_) {
+      cache.Clear();
+    }
     to_clean.swap(handle_table_);
   }
 
@@ -521,6 +528,13 @@ HandleOwner ProcessDispatcher::RemoveHandleLocked(Handle* handle) {
   }
   handle_table_.erase(*handle);
   handle_table_count_--;
+
+  // Drop the handle from the cache holding it, if any, so that no thread can
+  // use it anymore and no cache keeps its dispatcher alive. |handle| still holds
+  // the dispatcher, so this never destroys it under the lock.
+  if (HandleCache* cache = handle->cache()) {
+    cache->Remove(MapHandleToValue(handle), handle);
+  }
   return HandleOwner(handle);
 }
 
@@ -561,17 +575,65 @@ zx_koid_t ProcessDispatcher::GetKoidForHandle(zx_handle_t handle_value) {
 zx_status_t ProcessDispatcher::GetDispatcherInternal(zx_handle_t handle_value,
                                                      fbl::RefPtr<Dispatcher>* dispatcher,
                                                      zx_rights_t* rights) {
-  Guard<BrwLockPi, BrwLockPi::Reader> guard{&handle_table_lock_};
-  Handle* handle = GetHandleLocked(handle_value);
-  if (!handle)
+  zx_rights_t handle_rights;
+  if (!LookupHandle(handle_value, false, dispatcher, &handle_rights))
     return ZX_ERR_BAD_HANDLE;
 
-  *dispatcher = handle->dispatcher();
   if (rights)
-    *rights = handle->rights();
+    *rights = handle_rights;
   return ZX_OK;
 }
 
+bool ProcessDispatcher::LookupHandle(zx_handle_t handle_value, bool skip_policy,
+                                     fbl::RefPtr<Dispatcher>* dispatcher, zx_rights_t* rights) {
+  // Only the threads of this process cache its handles. A cached handle is
+  // still in the table, so a hit is as good as a lookup under the lock.
+  ThreadDispatcher* current = ThreadDispatcher::GetCurrent();
+  HandleCache* cache = nullptr;
+  if (current != nullptr && current->process() == this && !current->handle_cache().retired()) {
+    cache = &current->handle_cache();
+  }
+  if (cache != nullptr && cache->Lookup(handle_value, dispatcher, rights)) {
+    handle_cache_hit_count.Add(1);
+    return true;
+  }
+
+  if (cache != nullptr && !cache->registered()) {
+    RegisterHandleCache(cache);
+  }
+
+  Guard<BrwLockPi, BrwLockPi::Reader> guard{&handle_table_lock_};
+  Handle* handle = GetHandleLocked(handle_value, skip_policy);
+  if (!handle)
+    return false;
+
+  *dispatcher = handle->dispatcher();
+  *rights = handle->rights();
+
+  // The handle cannot leave the table, and so the cache, while the lock is held.
+  if (cache != nullptr) {
+    handle_cache_miss_count.Add(1);
+    cache->Insert(handle_value, handle);
+  }
+  return true;
+}
+
+void ProcessDispatcher::RegisterHandleCache(HandleCache* cache) {
+  Guard<BrwLockPi, BrwLockPi::Writer> guard{&handle_table_lock_};
+  DEBUG_ASSERT(!cache->registered() && !cache->retired());
+  handle_caches_.push_back(cache);
+  cache->set_registered(true);
+}
+
+void ProcessDispatcher::UnregisterHandleCache(HandleCache* cache) {
+  Guard<BrwLockPi, BrwLockPi::Writer> guard{&handle_table_lock_};
+  if (cache->registered()) {
+    cache->Clear();
+    handle_caches_.erase(*cache);
+  }
+  cache->set_registered(false);
+}
+
 void ProcessDispatcher::GetInfo(zx_info_process_t* info) const {
   canary_.Assert();
 
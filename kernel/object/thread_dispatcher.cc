@@ -10,6 +10,7 @@
 #include <err.h>
 #include <inttypes.h>
 #include <lib/counters.h>
+#include <lib/userabi/thread-stats.h>
 #include <platform.h>
 #include <string.h>
 #include <trace.h>
@@ -28,6 +29,7 @@
 #include <object/job_dispatcher.h>
 #include <object/process_dispatcher.h>
 #include <vm/kstack.h>
+#include <vm/physmap.h>
 #include <vm/vm.h>
 #include <vm/vm_address_region.h>
 #include <vm/vm_aspace.h>
@@ -380,6 +382,10 @@ void ThreadDispatcher::Exiting() {
   // gets the PEER_CLOSED signal.
   exceptionate_.Shutdown();
 
+  // Drop the dispatchers cached by our handle lookups, which may include this
+  // thread's own, and stop our process from dropping handles from the cache.
+  process_->UnregisterHandleCache(&handle_cache_);
+
   // remove ourselves from our parent process's view
   process_->RemoveThread(this);
 
@@ -600,6 +606,42 @@ zx_status_t ThreadDispatcher::GetStatsForUserspace(zx_info_thread_stats_t* info)
   return ZX_OK;
 }
 
+zx_status_t ThreadDispatcher::GetStatsVmo(KernelHandle<VmObjectDispatcher>* handle,
+                                          zx_rights_t* rights) {
+  canary_.Assert();
+
+  LTRACE_ENTRY_OBJ;
+  Guard<Mutex> guard{get_lock()};
+
+  if (!stats_vmo_) {
+    // Contiguous VMOs are pinned for their whole lifetime, so the page can be
+    // written through the physmap from the scheduler.
+    static_assert(sizeof(thread_stats_page) <= PAGE_SIZE);
+    fbl::RefPtr<VmObject> vmo;
+    zx_status_t status = VmObjectPaged::CreateContiguous(PMM_ALLOC_FLAG_ANY, PAGE_SIZE, 0, &vmo);
+    if (status != ZX_OK) {
+      return status;
+    }
+    paddr_t pa;
+    status = vmo->Lookup(
+        0, PAGE_SIZE,
+        [](void* context, size_t offset, size_t index, paddr_t pa) {
+          *static_cast<paddr_t*>(context) = pa;
+          return ZX_OK;
+        },
+        &pa);
+    if (status != ZX_OK) {
+      return status;
+    }
+    vmo->set_name("thread-stats", sizeof("thread-stats") - 1);
+
+    stats_vmo_ = ktl::move(vmo);
+    core_thread_->SetStatsPage(static_cast<thread_stats_page*>(paddr_to_physmap(pa)));
+  }
+
+  return VmObjectDispatcher::Create(stats_vmo_, handle, rights);
+}
+
 zx_status_t ThreadDispatcher::GetExceptionReport(zx_exception_report_t* report) {
   canary_.Assert();
 
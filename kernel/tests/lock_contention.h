@@ -0,0 +1,99 @@
+// Copyright 2020 The Fuchsia Authors
+//
+// Use of this source code is governed by a MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT
+
+#ifndef ZIRCON_KERNEL_TESTS_LOCK_CONTENTION_H_
+#define ZIRCON_KERNEL_TESTS_LOCK_CONTENTION_H_
+
+#include <inttypes.h>
+#include <lib/unittest/unittest.h>
+#include <stdio.h>
+
+#include <fbl/alloc_checker.h>
+#include <kernel/mp.h>
+#include <kernel/thread.h>
+#include <ktl/algorithm.h>
+#include <ktl/atomic.h>
+#include <ktl/unique_ptr.h>
+
+namespace lock_contention {
+
+template <typename AcquireRelease>
+struct State {
+  AcquireRelease* acquire_release;
+  ktl::atomic<bool> start;
+  ktl::atomic<bool> stop;
+  uint64_t total;
+  uint64_t acquisitions[SMP_MAX_CPUS];
+};
+
+template <typename AcquireRelease>
+int Worker(void* arg) {
+  auto state = static_cast<State<AcquireRelease>*>(arg);
+  const cpu_num_t cpu = arch_curr_cpu_num();
+  uint64_t acquisitions = 0;
+  while (!state->start.load()) {
+  }
+  while (!state->stop.load()) {
+    (*state->acquire_release)(&state->total);
+    acquisitions++;
+  }
+  state->acquisitions[cpu] = acquisitions;
+  return 0;
+}
+
+// Hammers a lock from every cpu, then reports the throughput and how evenly the
+// acquisitions were spread across cpus.
+//
+// |acquire_release| is called in a loop on each cpu with a pointer to a shared
+// counter, which it must increment while holding the lock under test.
+template <typename AcquireRelease>
+bool Run(const char* name, AcquireRelease acquire_release) {
+  BEGIN_TEST;
+
+  fbl::AllocChecker ac;
+  auto state = ktl::make_unique<State<AcquireRelease>>(&ac);
+  ASSERT_TRUE(ac.check());
+  state->acquire_release = &acquire_release;
+
+  Thread* threads[SMP_MAX_CPUS] = {};
+  const cpu_mask_t online = mp_get_online_mask();
+  for (cpu_num_t cpu = 0; cpu < SMP_MAX_CPUS; cpu++) {
+    if (online & cpu_num_to_mask(cpu)) {
+      threads[cpu] = Thread::Create(name, Worker<AcquireRelease>, state.get(), DEFAULT_PRIORITY);
+      ASSERT_NONNULL(threads[cpu]);
+      threads[cpu]->SetCpuAffinity(cpu_num_to_mask(cpu));
+      threads[cpu]->Resume();
+    }
+  }
+
+  constexpr zx_duration_t kDuration = ZX_MSEC(100);
+  state->start.store(true);
+  Thread::Current::SleepRelative(kDuration);
+  state->stop.store(true);
+
+  uint64_t sum = 0;
+  uint64_t min = UINT64_MAX;
+  uint64_t max = 0;
+  for (cpu_num_t cpu = 0; cpu < SMP_MAX_CPUS; cpu++) {
+    if (threads[cpu] != nullptr) {
+      threads[cpu]->Join(nullptr, ZX_TIME_INFINITE);
+      const uint64_t acquisitions = state->acquisitions[cpu];
+      sum += acquisitions;
+      min = ktl::min(min, acquisitions);
+      max = ktl::max(max, acquisitions);
+    }
+  }
+  EXPECT_EQ(sum, state->total);
+
+  printf("%s: %" PRIu64 " acquisitions/ms, per-cpu min %" PRIu64 " max %" PRIu64 "\n", name,
+         sum / (kDuration / ZX_MSEC(1)), min, max);
+
+  END_TEST;
+}
+
+}  // namespace lock_contention
+
+#endif  // ZIRCON_KERNEL_TESTS_LOCK_CONTENTION_H_
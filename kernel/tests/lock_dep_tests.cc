@@ -4,8 +4,10 @@
 // license that can be found in the LICENSE file or at
 // https://opensource.org/licenses/MIT
 
+#include <lib/lockstat.h>
 #include <lib/unittest/unittest.h>
 #include <lib/zircon-internal/thread_annotations.h>
+#include <platform.h>
 #include <stdint.h>
 
 #include <kernel/mutex.h>
@@ -887,3 +889,80 @@ UNITTEST("lock_dep_static_analysis_tests", lock_dep_static_analysis_tests)
 UNITTEST_END_TESTCASE(lock_dep_tests, "lock_dep_tests", "lock_dep_tests")
 
 #endif
+
+#if WITH_LOCK_STAT
+
+namespace test {
+
+struct LockStatTest {};
+struct LockStatNoHoldTest {};
+
+}  // namespace test
+
+static bool lock_stat_tests() {
+  BEGIN_TEST;
+
+  using TestLock = lockdep::LockDep<test::LockStatTest, Mutex>;
+  TestLock lock;
+
+  lockstat::Stats before;
+  ASSERT_TRUE(lockstat::GetStats(TestLock::LockClass::Id(), &before));
+
+  constexpr uint64_t kAcquisitions = 10;
+  for (uint64_t i = 0; i < kAcquisitions; i++) {
+    Guard<Mutex> guard{&lock};
+  }
+
+  // Hold the lock long enough for the hold time to be unambiguous.
+  constexpr zx_duration_t kHoldTime = ZX_MSEC(1);
+  {
+    Guard<Mutex> guard{&lock};
+    const zx_time_t deadline = zx_time_add_duration(current_time(), kHoldTime);
+    while (current_time() < deadline) {
+    }
+  }
+
+  lockstat::Stats after;
+  ASSERT_TRUE(lockstat::GetStats(TestLock::LockClass::Id(), &after));
+
+  const uint64_t hold_ticks = platform_get_ticks_to_time_ratio().Inverse().Scale(kHoldTime);
+  EXPECT_EQ(before.acquisitions + kAcquisitions + 1, after.acquisitions);
+  EXPECT_GE(after.total_hold - before.total_hold, hold_ticks);
+  EXPECT_GE(after.max_hold, hold_ticks);
+
+  END_TEST;
+}
+
+static bool lock_stat_hold_disabled_tests() {
+  BEGIN_TEST;
+
+  using TestLock =
+      lockdep::LockDep<test::LockStatNoHoldTest, Mutex, 0, LockFlagsHoldStatsDisabled>;
+  TestLock lock;
+
+  lockstat::Stats before;
+  ASSERT_TRUE(lockstat::GetStats(TestLock::LockClass::Id(), &before));
+
+  {
+    Guard<Mutex> guard{&lock};
+    const zx_time_t deadline = zx_time_add_duration(current_time(), ZX_MSEC(1));
+    while (current_time() < deadline) {
+    }
+  }
+
+  // Acquisitions are still counted, but the hold time is not recorded.
+  lockstat::Stats after;
+  ASSERT_TRUE(lockstat::GetStats(TestLock::LockClass::Id(), &after));
+  EXPECT_EQ(before.acquisitions + 1, after.acquisitions);
+  EXPECT_EQ(before.total_hold, after.total_hold);
+  EXPECT_EQ(before.max_hold, after.max_hold);
+
+  END_TEST;
+}
+
+UNITTEST_START_TESTCASE(lock_stat_tests)
+UNITTEST("lock_stat_tests", lock_stat_tests)
+UNITTEST("lock_stat_hold_disabled_tests", lock_stat_hold_disabled_tests)
+UNITTEST_END_TESTCASE(lock_stat_tests, "lock_stat_tests", "lock_stat_tests")
+
+#endif
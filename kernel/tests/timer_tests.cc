@@ -283,6 +283,54 @@ int timer_stress(int argc, const cmd_args* argv, uint32_t) {
   return 0;
 }
 
+// timer_bench measures the cost of setting and canceling timers as the number of timers
+// outstanding on a cpu grows.
+int timer_bench(int, const cmd_args*, uint32_t) {
+  constexpr size_t kCounts[] = {100, 1000, 10000, 50000};
+  constexpr size_t kMaxTimers = kCounts[fbl::count_of(kCounts) - 1];
+  fbl::AllocChecker ac;
+  auto timers = ktl::unique_ptr<Timer[]>(new (&ac) Timer[kMaxTimers]);
+  if (!ac.check()) {
+    printf("failed to allocate %zu timers\n", kMaxTimers);
+    return ZX_ERR_NO_MEMORY;
+  }
+
+  // Keep all of the timers on one cpu's queue.
+  Thread* const current = Thread::Current::Get();
+  const cpu_mask_t old_affinity = current->GetCpuAffinity();
+  current->SetCpuAffinity(cpu_num_to_mask(arch_curr_cpu_num()));
+
+  for (size_t count : kCounts) {
+    // Use far away deadlines so none of the timers fire, with enough slack that some of them
+    // coalesce.
+    const zx_time_t base = current_time() + ZX_SEC(3600);
+    const TimerSlack slack = {ZX_USEC(50), TIMER_SLACK_CENTER};
+
+    zx_time_t start = current_time();
+    for (size_t i = 0; i < count; i++) {
+      const Deadline deadline(base + rand_duration(ZX_SEC(60)), slack);
+      timers[i].Set(
+          deadline, [](Timer*, zx_time_t, void*) {}, nullptr);
+    }
+    const zx_duration_t set_time = zx_time_sub_time(current_time(), start);
+
+    // Cancel in a different order than the timers were set. The stride is prime, so this visits
+    // every timer once.
+    start = current_time();
+    for (size_t i = 0; i < count; i++) {
+      timers[(i * 7919) % count].Cancel();
+    }
+    const zx_duration_t cancel_time = zx_time_sub_time(current_time(), start);
+
+    printf("%6zu timers: %" PRIi64 " ns per set, %" PRIi64 " ns per cancel\n", count,
+           set_time / static_cast<zx_duration_t>(count),
+           cancel_time / static_cast<zx_duration_t>(count));
+  }
+
+  current->SetCpuAffinity(old_affinity);
+  return 0;
+}
+
 struct timer_args {
   volatile int result;
   volatile int timer_fired;
@@ -478,6 +526,48 @@ static bool trylock_or_cancel_get_lock() {
   END_TEST;
 }
 
+// Set a number of timers with the same deadline and see that they fire in the order they were set.
+static bool same_deadline_fires_in_order() {
+  BEGIN_TEST;
+
+  constexpr size_t kNumTimers = 16;
+  struct State {
+    Timer timers[kNumTimers];
+    size_t order[kNumTimers];
+    ktl::atomic<size_t> fired;
+  };
+  fbl::AllocChecker ac;
+  auto state = ktl::make_unique<State>(&ac);
+  ASSERT_TRUE(ac.check());
+  state->fired.store(0);
+
+  // Disable interrupts so that all of the timers land on the same cpu.
+  arch_disable_ints();
+  const Deadline deadline = Deadline::no_slack(current_time() + ZX_MSEC(1));
+  for (Timer& timer : state->timers) {
+    timer.Set(
+        deadline,
+        [](Timer* timer, zx_time_t, void* arg) {
+          auto state = static_cast<State*>(arg);
+          state->order[state->fired.fetch_add(1)] = static_cast<size_t>(timer - state->timers);
+        },
+        state.get());
+  }
+  arch_enable_ints();
+
+  while (state->fired.load() != kNumTimers) {
+    Thread::Current::SleepRelative(ZX_MSEC(1));
+  }
+  for (size_t i = 0; i < kNumTimers; ++i) {
+    EXPECT_EQ(i, state->order[i]);
+  }
+  for (Timer& timer : state->timers) {
+    EXPECT_FALSE(timer.Cancel());
+  }
+
+  END_TEST;
+}
+
 static bool print_timer_queues() {
   BEGIN_TEST;
 
@@ -522,5 +612,6 @@ UNITTEST("cancel_from_callback", cancel_from_callback)
 UNITTEST("set_from_callback", set_from_callback)
 UNITTEST("trylock_or_cancel_canceled", trylock_or_cancel_canceled)
 UNITTEST("trylock_or_cancel_get_lock", trylock_or_cancel_get_lock)
+UNITTEST("same_deadline_fires_in_order", same_deadline_fires_in_order)
 UNITTEST("print_timer_queues", print_timer_queues)
 UNITTEST_END_TESTCASE(timer_tests, "timer", "timer tests")
@@ -10,12 +10,16 @@
 #include <sys/types.h>
 
 #include <fbl/ref_ptr.h>
+#include <kernel/cpu.h>
 
 class VmAddressRegion;
 
 // KernelStack encapsulates a kernel stack.
 // A kernel stack object is not valid until Init() has been successfully
 // called.
+//
+// Each cpu keeps a few mapped stacks of exited threads, which Init() reuses
+// before it maps new ones.
 class KernelStack {
  public:
   KernelStack() = default;
@@ -36,9 +40,16 @@ class KernelStack {
   // This is useful during a thread dump.
   void DumpInfo(int debug_level);
 
-  // Returns the stack to its pre-Init() state.
+  // Returns the stack to its pre-Init() state. The mappings go to the cache of
+  // the current cpu if it has room, and are destroyed otherwise.
   zx_status_t Teardown();
 
+  // Destroys the stacks cached by every cpu, returning their memory.
+  static void TrimCache();
+
+  // Returns the number of stacks in the cache of |cpu|.
+  static size_t CachedCount(cpu_num_t cpu);
+
   vaddr_t base() const { return base_; }
   size_t size() const { return size_; }
   vaddr_t top() const { return base_ + size_; }
@@ -52,6 +63,17 @@ class KernelStack {
 #endif
 
  private:
+  // Moves the mappings of this stack to the cache of the current cpu. Returns
+  // false if the cache is full or the stack is not completely mapped.
+  bool MoveToCache();
+
+  // Takes the mappings of a stack from the cache of the current cpu. Returns
+  // false if the cache is empty.
+  bool TakeFromCache();
+
+  // Unmaps the stack, bypassing the cache.
+  zx_status_t DestroyMappings();
+
   vaddr_t base_ = 0;
   size_t size_ = 0;
   fbl::RefPtr<VmAddressRegion> vmar_;
@@ -70,9 +70,14 @@ typedef struct vm_page {
 
   // offset 0x2b
 
-  // five bytes of padding would be inserted here to make sizeof(vm_page) a multiple of 8
+  // logically private; use |numa_node()|. Assigned by the pmm during boot.
+  uint8_t numa_node_priv;
+
+  // offset 0x2c
+
+  // four bytes of padding would be inserted here to make sizeof(vm_page) a multiple of 8
   // explicit padding is added to validate all commented offsets were indeed correct.
-  char padding[5];
+  char padding[4];
 
   // helper routines
   bool is_free() const { return state_priv == VM_PAGE_STATE_FREE; }
@@ -85,6 +90,9 @@ typedef struct vm_page {
 
   vm_page_state state() const { return vm_page_state(state_priv); }
 
+  // return the NUMA node of the memory backing this page
+  uint32_t numa_node() const { return numa_node_priv; }
+
   void set_state(vm_page_state new_state);
 
   // Return the approximate number of pages in state |state|.
@@ -12,6 +12,7 @@
 #include <zircon/compiler.h>
 #include <zircon/types.h>
 
+#include <kernel/cpu.h>
 #include <vm/page.h>
 #include <vm/page_queues.h>
 #include <vm/page_request.h>
@@ -52,6 +53,25 @@ zx_status_t pmm_get_arena_info(size_t count, uint64_t i, pmm_arena_info_t* buffe
 #define PMM_ALLOC_FLAG_LO_MEM (1 << 0)  // allocate only from arenas marked LO_MEM
 // the caller can handle allocation failures with a delayed page_request_t request.
 #define PMM_ALLOC_DELAY_OK (1 << 1)
+// prefer the pages of NUMA node |node| over those of the node of the current cpu. Allocations fall
+// back to the other nodes when |node| has no free pages.
+#define PMM_ALLOC_FLAG_NODE_SHIFT 8
+#define PMM_ALLOC_FLAG_NODE_MASK (0xffu << PMM_ALLOC_FLAG_NODE_SHIFT)
+#define PMM_ALLOC_FLAG_NODE(node) \
+  ((((node) + 1u) << PMM_ALLOC_FLAG_NODE_SHIFT) & PMM_ALLOC_FLAG_NODE_MASK)
+
+// The maximum number of NUMA nodes the physical allocator keeps the free pages of apart.
+#define PMM_MAX_NUMA_NODES 8
+
+// Assign the pages in [base, base + size) to NUMA node |node|. Pages belong to node 0 until
+// assigned. Only valid during early boot, before the secondary cpus are started.
+zx_status_t pmm_set_numa_range(uint32_t node, paddr_t base, size_t size);
+
+// Make |node| the local NUMA node of |cpu|, which allocations on |cpu| are served from first.
+zx_status_t pmm_set_cpu_numa_node(cpu_num_t cpu, uint32_t node);
+
+// Return the number of NUMA nodes known to the physical allocator.
+uint32_t pmm_num_numa_nodes();
 
 // Debugging flag that can be used to induce artifical delayed page allocation by randomly
 // rejecting some fraction of the synchronous allocations which have PMM_ALLOC_DELAY_OK set.
@@ -99,6 +119,9 @@ void pmm_free_page(vm_page_t* page) __NONNULL((1));
 // Return count of unallocated physical pages in system.
 uint64_t pmm_count_free_pages();
 
+// Return the number of free pages in NUMA node |node|.
+uint64_t pmm_count_free_pages(uint32_t node);
+
 // Return amount of physical memory in system, in bytes.
 uint64_t pmm_count_total_bytes();
 
@@ -37,6 +37,8 @@ class VmObjectPaged final : public VmObject {
   static constexpr uint32_t kHidden = (1u << 2);
   static constexpr uint32_t kSlice = (1u << 3);
 
+  // |pmm_alloc_flags| may include PMM_ALLOC_FLAG_NODE() to allocate the pages of the VMO, and of
+  // its clones, from a NUMA node other than the one of the committing cpu.
   static zx_status_t Create(uint32_t pmm_alloc_flags, uint32_t options, uint64_t size,
                             fbl::RefPtr<VmObject>* vmo);
 
@@ -8,6 +8,7 @@
 #include <assert.h>
 #include <err.h>
 #include <inttypes.h>
+#include <lib/counters.h>
 #include <stdio.h>
 #include <string.h>
 #include <trace.h>
@@ -17,6 +18,9 @@
 #include <fbl/auto_call.h>
 #include <fbl/auto_lock.h>
 #include <fbl/ref_ptr.h>
+#include <kernel/cpu.h>
+#include <kernel/mp.h>
+#include <kernel/spinlock.h>
 #include <ktl/move.h>
 #include <vm/vm.h>
 #include <vm/vm_address_region.h>
@@ -25,6 +29,10 @@
 
 #define LOCAL_TRACE 0
 
+KCOUNTER(kstack_cache_hit, "kstack.cache.hit")
+KCOUNTER(kstack_cache_miss, "kstack.cache.miss")
+KCOUNTER(kstack_cache_trimmed, "kstack.cache.trimmed")
+
 namespace {
 
 struct StackType {
@@ -40,6 +48,19 @@ constexpr StackType kUnsafe = {"kernel-unsafe-stack", DEFAULT_STACK_SIZE};
 constexpr StackType kShadowCall = {"kernel-shadow-call-stack", ZX_PAGE_SIZE};
 #endif
 
+// The number of stacks each cpu keeps for reuse.
+constexpr size_t kCachedStacksPerCpu = 4;
+
+// The mapped stacks of threads that exited on a cpu, ready for the next
+// threads created there.
+struct StackCache {
+  DECLARE_SPINLOCK(StackCache) lock;
+  KernelStack stacks[kCachedStacksPerCpu] TA_GUARDED(lock);
+  size_t count TA_GUARDED(lock) = 0;
+};
+
+StackCache stack_caches[SMP_MAX_CPUS];
+
 }  // namespace
 
 // Allocates and maps a kernel stack with one page of padding before and after the mapping.
@@ -109,6 +130,12 @@ zx_status_t KernelStack::Init() {
   DEBUG_ASSERT(size_ == 0);
   DEBUG_ASSERT(base_ == 0);
 
+  if (TakeFromCache()) {
+    kcounter_add(kstack_cache_hit, 1);
+    return ZX_OK;
+  }
+  kcounter_add(kstack_cache_miss, 1);
+
   fbl::RefPtr<VmMapping> mapping;
   zx_status_t status = allocate_vmar(kSafe, &mapping, &vmar_);
   if (status != ZX_OK) {
@@ -158,6 +185,76 @@ KernelStack::~KernelStack() {
 }
 
 zx_status_t KernelStack::Teardown() {
+  // Once the mappings are in the cache, only the addresses are left to reset.
+  MoveToCache();
+  return DestroyMappings();
+}
+
+void KernelStack::TrimCache() {
+  for (cpu_num_t cpu = 0; cpu < arch_max_num_cpus(); cpu++) {
+    // Take the stacks out of the cache first, as unmapping them can block.
+    KernelStack stacks[kCachedStacksPerCpu];
+    size_t count;
+    {
+      StackCache& cache = stack_caches[cpu];
+      Guard<SpinLock, IrqSave> guard{&cache.lock};
+      count = cache.count;
+      for (size_t i = 0; i < count; i++) {
+        stacks[i] = ktl::move(cache.stacks[i]);
+      }
+      cache.count = 0;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      [[maybe_unused]] zx_status_t status = stacks[i].DestroyMappings();
+      DEBUG_ASSERT_MSG(status == ZX_OK, "KernelStack::DestroyMappings returned %d\n", status);
+    }
+    kcounter_add(kstack_cache_trimmed, count);
+  }
+}
+
+size_t KernelStack::CachedCount(cpu_num_t cpu) {
+  StackCache& cache = stack_caches[cpu];
+  Guard<SpinLock, IrqSave> guard{&cache.lock};
+  return cache.count;
+}
+
+bool KernelStack::MoveToCache() {
+  // Only stacks that Init() mapped completely can be reused.
+  if (!vmar_) {
+    return false;
+  }
+#if __has_feature(safe_stack)
+  if (!unsafe_vmar_) {
+    return false;
+  }
+#endif
+#if __has_feature(shadow_call_stack)
+  if (!shadow_call_vmar_) {
+    return false;
+  }
+#endif
+
+  StackCache& cache = stack_caches[arch_curr_cpu_num()];
+  Guard<SpinLock, IrqSave> guard{&cache.lock};
+  if (cache.count == kCachedStacksPerCpu) {
+    return false;
+  }
+  cache.stacks[cache.count++] = ktl::move(*this);
+  return true;
+}
+
+bool KernelStack::TakeFromCache() {
+  StackCache& cache = stack_caches[arch_curr_cpu_num()];
+  Guard<SpinLock, IrqSave> guard{&cache.lock};
+  if (cache.count == 0) {
+    return false;
+  }
+  *this = ktl::move(cache.stacks[--cache.count]);
+  return true;
+}
+
+zx_status_t KernelStack::DestroyMappings() {
   base_ = 0;
   size_ = 0;
 
@@ -52,6 +52,16 @@ zx_status_t pmm_add_arena(const pmm_arena_info_t* info) { return pmm_node.AddAre
 
 size_t pmm_num_arenas() { return pmm_node.NumArenas(); }
 
+zx_status_t pmm_set_numa_range(uint32_t node, paddr_t base, size_t size) {
+  return pmm_node.SetNumaRange(node, base, size);
+}
+
+zx_status_t pmm_set_cpu_numa_node(cpu_num_t cpu, uint32_t node) {
+  return pmm_node.SetCpuNumaNode(cpu, node);
+}
+
+uint32_t pmm_num_numa_nodes() { return pmm_node.NumNumaNodes(); }
+
 zx_status_t pmm_get_arena_info(size_t count, uint64_t i, pmm_arena_info_t* buffer,
                                size_t buffer_size) {
   return pmm_node.GetArenaInfo(count, i, buffer, buffer_size);
@@ -109,6 +119,8 @@ void pmm_free_page(vm_page* page) { pmm_node.FreePage(page); }
 
 uint64_t pmm_count_free_pages() { return pmm_node.CountFreePages(); }
 
+uint64_t pmm_count_free_pages(uint32_t node) { return pmm_node.CountFreePages(node); }
+
 uint64_t pmm_count_total_bytes() { return pmm_node.CountTotalBytes(); }
 
 PageQueues* pmm_page_queues() { return pmm_node.GetPageQueues(); }
@@ -15,6 +15,7 @@
 
 #include <kernel/mp.h>
 #include <kernel/thread.h>
+#include <ktl/algorithm.h>
 #include <pretty/sizes.h>
 #include <vm/bootalloc.h>
 #include <vm/page_request.h>
@@ -27,6 +28,7 @@
 #define LOCAL_TRACE VM_GLOBAL_TRACE(0)
 
 KCOUNTER(pmm_alloc_async, "vm.pmm.alloc.async")
+KCOUNTER(pmm_alloc_numa_remote, "vm.pmm.alloc.numa_remote")
 
 namespace {
 
@@ -45,6 +47,10 @@ void PmmNode::AsanPoisonPage(vm_page_t* p, uint8_t value) {
 }
 
 PmmNode::PmmNode() {
+  for (list_node& free_list : free_lists_) {
+    list_initialize(&free_list);
+  }
+
   // Initialize the reclaimation watermarks such that system never
   // falls into a low memory state.
   uint64_t default_watermark = 0;
@@ -145,7 +151,10 @@ void PmmNode::AddFreePages(list_node* list) TA_NO_THREAD_SAFETY_ANALYSIS {
   vm_page *temp, *page;
   list_for_every_entry_safe (list, page, temp, vm_page, queue_node) {
     list_delete(&page->queue_node);
-    list_add_tail(&free_list_, &page->queue_node);
+    DEBUG_ASSERT(page->numa_node() < PMM_MAX_NUMA_NODES);
+    list_add_tail(&free_lists_[page->numa_node()], &page->queue_node);
+    numa_free_count_[page->numa_node()]++;
+    num_numa_nodes_ = ktl::max(num_numa_nodes_, page->numa_node() + 1);
     free_count_++;
   }
   ASSERT(free_count_);
@@ -162,7 +171,9 @@ void PmmNode::FillFreePages() {
   }
 
   vm_page* page;
-  list_for_every_entry (&free_list_, page, vm_page, queue_node) { checker_.FillPattern(page); }
+  for (list_node& free_list : free_lists_) {
+    list_for_every_entry (&free_list, page, vm_page, queue_node) { checker_.FillPattern(page); }
+  }
 
   // Now that every page has been filled, we can arm the checker.
   checker_.Arm();
@@ -176,7 +187,9 @@ void PmmNode::CheckAllFreePages() {
   }
 
   vm_page* page;
-  list_for_every_entry (&free_list_, page, vm_page, queue_node) { checker_.AssertPattern(page); }
+  for (list_node& free_list : free_lists_) {
+    list_for_every_entry (&free_list, page, vm_page, queue_node) { checker_.AssertPattern(page); }
+  }
 }
 
 #if __has_feature(address_sanitizer)
@@ -192,9 +205,11 @@ void PmmNode::PoisonAllFreePages() {
   }
 
   vm_page* page;
-  list_for_every_entry (&free_list_, page, vm_page, queue_node) {
-    AsanPoisonPage(page, kAsanPmmFreeMagic);
-  };
+  for (list_node& free_list : free_lists_) {
+    list_for_every_entry (&free_list, page, vm_page, queue_node) {
+      AsanPoisonPage(page, kAsanPmmFreeMagic);
+    };
+  }
 }
 #endif  // __has_feature(address_sanitizer)
 
@@ -234,7 +249,20 @@ zx_status_t PmmNode::AllocPage(uint alloc_flags, vm_page_t** page_out, paddr_t*
     }
   }
 
-  vm_page* page = list_remove_head_type(&free_list_, vm_page, queue_node);
+  // Take a page of the preferred node if it has any, or else of the next node that does.
+  const uint32_t preferred = PreferredNumaNode(alloc_flags);
+  vm_page* page = nullptr;
+  for (uint32_t i = 0; i < num_numa_nodes_; i++) {
+    const uint32_t numa_node = (preferred + i) % num_numa_nodes_;
+    page = list_remove_head_type(&free_lists_[numa_node], vm_page, queue_node);
+    if (page) {
+      numa_free_count_[numa_node]--;
+      if (i > 0) {
+        kcounter_add(pmm_alloc_numa_remote, 1);
+      }
+      break;
+    }
+  }
   if (!page) {
     return ZX_ERR_NO_MEMORY;
   }
@@ -287,21 +315,90 @@ zx_status_t PmmNode::AllocPages(size_t count, uint alloc_flags, list_node* list)
     }
   }
 
-  auto node = &free_list_;
+  // Take as many pages as possible from the preferred node, and the rest from the other nodes in
+  // turn. The total free count covers |count|, so the loop always finishes.
+  const uint32_t preferred = PreferredNumaNode(alloc_flags);
+  for (uint32_t i = 0; count > 0; i++) {
+    DEBUG_ASSERT(i < num_numa_nodes_);
+    const uint32_t numa_node = (preferred + i) % num_numa_nodes_;
+    const size_t taken = ktl::min(count, numa_free_count_[numa_node]);
+    if (taken == 0) {
+      continue;
+    }
+    TakeFreePagesLocked(numa_node, taken, list);
+    if (i > 0) {
+      kcounter_add(pmm_alloc_numa_remote, taken);
+    }
+    count -= taken;
+  }
+
+  return ZX_OK;
+}
+
+void PmmNode::TakeFreePagesLocked(uint32_t numa_node, size_t count, list_node* list) {
+  list_node* free_list = &free_lists_[numa_node];
+  DEBUG_ASSERT(count <= numa_free_count_[numa_node]);
+  numa_free_count_[numa_node] -= count;
+
+  auto node = free_list;
   while (count-- > 0) {
-    node = list_next(&free_list_, node);
+    node = list_next(free_list, node);
     AllocPageHelperLocked(containerof(node, vm_page, queue_node));
   }
 
   list_node tmp_list = LIST_INITIAL_VALUE(tmp_list);
-  list_split_after(&free_list_, node, &tmp_list);
+  list_split_after(free_list, node, &tmp_list);
   if (list_is_empty(list)) {
-    list_move(&free_list_, list);
+    list_move(free_list, list);
   } else {
-    list_splice_after(&free_list_, list_peek_tail(list));
+    list_splice_after(free_list, list_peek_tail(list));
   }
-  list_move(&tmp_list, &free_list_);
+  list_move(&tmp_list, free_list);
+}
+
+uint32_t PmmNode::PreferredNumaNode(uint alloc_flags) const {
+  const uint32_t requested = (alloc_flags & PMM_ALLOC_FLAG_NODE_MASK) >> PMM_ALLOC_FLAG_NODE_SHIFT;
+  if (requested != 0 && requested <= num_numa_nodes_) {
+    return requested - 1;
+  }
+  return cpu_numa_node_[arch_curr_cpu_num()];
+}
 
+zx_status_t PmmNode::SetNumaRange(uint32_t numa_node, paddr_t base, size_t size) {
+  if (numa_node >= PMM_MAX_NUMA_NODES) {
+    return ZX_ERR_OUT_OF_RANGE;
+  }
+
+  Guard<Mutex> guard{&lock_};
+
+  LTRACEF("numa node %u base %#" PRIxPTR " size %#zx\n", numa_node, base, size);
+
+  const paddr_t end = ROUNDDOWN(base + size, PAGE_SIZE);
+  base = ROUNDUP(base, PAGE_SIZE);
+  for (auto& a : arena_list_) {
+    const paddr_t start = ktl::max(base, a.base());
+    const paddr_t stop = ktl::min(end, a.base() + a.size());
+    for (paddr_t pa = start; pa < stop; pa += PAGE_SIZE) {
+      vm_page_t* page = a.FindSpecific(pa);
+      if (page->is_free()) {
+        RemoveFreePageLocked(page);
+        list_add_tail(&free_lists_[numa_node], &page->queue_node);
+        numa_free_count_[numa_node]++;
+      }
+      page->numa_node_priv = static_cast<uint8_t>(numa_node);
+    }
+  }
+
+  num_numa_nodes_ = ktl::max(num_numa_nodes_, numa_node + 1);
+  return ZX_OK;
+}
+
+zx_status_t PmmNode::SetCpuNumaNode(cpu_num_t cpu, uint32_t numa_node) {
+  if (cpu >= SMP_MAX_CPUS || numa_node >= PMM_MAX_NUMA_NODES) {
+    return ZX_ERR_OUT_OF_RANGE;
+  }
+  cpu_numa_node_[cpu] = static_cast<uint8_t>(numa_node);
+  num_numa_nodes_ = ktl::max(num_numa_nodes_, numa_node + 1);
   return ZX_OK;
 }
 
@@ -332,7 +429,7 @@ zx_status_t PmmNode::AllocRange(paddr_t address, size_t count, list_node* list)
         break;
       }
 
-      list_delete(&page->queue_node);
+      RemoveFreePageLocked(page);
 
       AllocPageHelperLocked(page);
 
@@ -387,7 +484,7 @@ zx_status_t PmmNode::AllocContiguous(const size_t count, uint alloc_flags, uint8
       DEBUG_ASSERT_MSG(p->is_free(), "p %p state %u\n", p, p->state());
       DEBUG_ASSERT(list_in_list(&p->queue_node));
 
-      list_delete(&p->queue_node);
+      RemoveFreePageLocked(p);
       p->set_state(VM_PAGE_STATE_ALLOC);
 
       DecrementFreeCountLocked(1);
@@ -428,8 +525,9 @@ void PmmNode::FreePage(vm_page* page) {
 
   FreePageHelperLocked(page);
 
-  // add it to the free queue
-  list_add_head(&free_list_, &page->queue_node);
+  // add it to the free queue of its node
+  list_add_head(&free_lists_[page->numa_node()], &page->queue_node);
+  numa_free_count_[page->numa_node()]++;
 
   IncrementFreeCountLocked(1);
 }
@@ -439,14 +537,26 @@ void PmmNode::FreeListLocked(list_node* list) {
 
   // process list backwards so the head is as hot as possible
   uint64_t count = 0;
-  for (vm_page* page = list_peek_tail_type(list, vm_page, queue_node); page != nullptr;
-       page = list_prev_type(list, &page->queue_node, vm_page, queue_node)) {
-    FreePageHelperLocked(page);
-    count++;
-  }
+  if (num_numa_nodes_ == 1) {
+    for (vm_page* page = list_peek_tail_type(list, vm_page, queue_node); page != nullptr;
+         page = list_prev_type(list, &page->queue_node, vm_page, queue_node)) {
+      FreePageHelperLocked(page);
+      count++;
+    }
 
-  // splice list at the head of free_list_
-  list_splice_after(list, &free_list_);
+    // splice list at the head of the only free list
+    list_splice_after(list, &free_lists_[0]);
+    numa_free_count_[0] += count;
+  } else {
+    // move each page to the head of the free list of its node
+    vm_page* page;
+    while ((page = list_remove_tail_type(list, vm_page, queue_node)) != nullptr) {
+      FreePageHelperLocked(page);
+      list_add_head(&free_lists_[page->numa_node()], &page->queue_node);
+      numa_free_count_[page->numa_node()]++;
+      count++;
+    }
+  }
 
   IncrementFreeCountLocked(count);
 }
@@ -564,13 +674,24 @@ void PmmNode::ProcessPendingRequests() {
 
 uint64_t PmmNode::CountFreePages() const TA_NO_THREAD_SAFETY_ANALYSIS { return free_count_; }
 
+uint64_t PmmNode::CountFreePages(uint32_t numa_node) const TA_NO_THREAD_SAFETY_ANALYSIS {
+  return numa_node < num_numa_nodes_ ? numa_free_count_[numa_node] : 0;
+}
+
 uint64_t PmmNode::CountTotalBytes() const TA_NO_THREAD_SAFETY_ANALYSIS {
   return arena_cumulative_size_;
 }
 
 void PmmNode::DumpFree() const TA_NO_THREAD_SAFETY_ANALYSIS {
   auto megabytes_free = CountFreePages() / 256u;
-  printf(" %zu free MBs\n", megabytes_free);
+  printf(" %zu free MBs", megabytes_free);
+  if (num_numa_nodes_ > 1) {
+    for (uint32_t i = 0; i < num_numa_nodes_; i++) {
+      printf("%s node %u: %zu", i == 0 ? " (" : ",", i, CountFreePages(i) / 256u);
+    }
+    printf(")");
+  }
+  printf("\n");
 }
 
 void PmmNode::Dump(bool is_panic) const {
@@ -578,6 +699,10 @@ void PmmNode::Dump(bool is_panic) const {
   auto dump = [this]() TA_NO_THREAD_SAFETY_ANALYSIS {
     printf("pmm node %p: free_count %zu (%zu bytes), total size %zu\n", this, free_count_,
            free_count_ * PAGE_SIZE, arena_cumulative_size_);
+    for (uint32_t i = 0; i < num_numa_nodes_; i++) {
+      printf("\tnuma node %u: free_count %zu (%zu bytes)\n", i, numa_free_count_[i],
+             numa_free_count_[i] * PAGE_SIZE);
+    }
     for (auto& a : arena_list_) {
       a.Dump(false, false);
     }
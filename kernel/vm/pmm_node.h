@@ -16,7 +16,11 @@
 
 #include "pmm_arena.h"
 
-// per numa node collection of pmm arenas and worker threads
+// Collection of pmm arenas and worker threads.
+//
+// The free pages are kept on one list per NUMA node, so that allocations can be served from the
+// memory closest to the allocating cpu. The lock, the memory availability state and the delayed
+// allocation requests are shared by all the NUMA nodes.
 class PmmNode {
  public:
   PmmNode();
@@ -48,8 +52,18 @@ class PmmNode {
   void InitRequestThread();
 
   uint64_t CountFreePages() const;
+  uint64_t CountFreePages(uint32_t numa_node) const;
   uint64_t CountTotalBytes() const;
 
+  // Assigns the pages in [base, base + size) to |numa_node|, moving the free ones to its free list.
+  // Only called during early boot.
+  zx_status_t SetNumaRange(uint32_t numa_node, paddr_t base, size_t size);
+
+  // Makes |numa_node| the local NUMA node of |cpu|.
+  zx_status_t SetCpuNumaNode(cpu_num_t cpu, uint32_t numa_node);
+
+  uint32_t NumNumaNodes() const { return num_numa_nodes_; }
+
   // printf free and overall state of the internal arenas
   // NOTE: both functions skip mutexes and can be called inside timer or crash context
   // though the data they return may be questionable
@@ -112,6 +126,20 @@ class PmmNode {
   void FreePageHelperLocked(vm_page* page) TA_REQ(lock_);
   void FreeListLocked(list_node* list) TA_REQ(lock_);
 
+  // Returns the NUMA node to allocate from first: the one requested in |alloc_flags|, if any, or
+  // else the local node of the current cpu.
+  uint32_t PreferredNumaNode(uint alloc_flags) const;
+
+  // Moves the first |count| pages of the free list of |numa_node| to the tail of |list|.
+  void TakeFreePagesLocked(uint32_t numa_node, size_t count, list_node* list) TA_REQ(lock_);
+
+  // Removes |page| from its free list.
+  void RemoveFreePageLocked(vm_page* page) TA_REQ(lock_) {
+    list_delete(&page->queue_node);
+    DEBUG_ASSERT(numa_free_count_[page->numa_node()] > 0);
+    numa_free_count_[page->numa_node()]--;
+  }
+
   void ProcessPendingRequests();
 
   void UpdateMemAvailStateLocked() TA_REQ(lock_);
@@ -148,7 +176,14 @@ class PmmNode {
 
   fbl::SizedDoublyLinkedList<PmmArena*> arena_list_ TA_GUARDED(lock_);
 
-  list_node free_list_ TA_GUARDED(lock_) = LIST_INITIAL_VALUE(free_list_);
+  // The free pages of each NUMA node, and their number. |free_count_| is their total.
+  list_node free_lists_[PMM_MAX_NUMA_NODES] TA_GUARDED(lock_);
+  uint64_t numa_free_count_[PMM_MAX_NUMA_NODES] TA_GUARDED(lock_) = {};
+
+  // Only changed during early boot, before other cpus are started, so these are read without the
+  // lock.
+  uint32_t num_numa_nodes_ = 1;
+  uint8_t cpu_numa_node_[SMP_MAX_CPUS] = {};
 
   // List of pending requests.
   list_node_t request_list_ TA_GUARDED(lock_) = LIST_INITIAL_VALUE(request_list_);
@@ -50,15 +50,19 @@ class ManagedPmmNode {
                                                 ManagedPmmNode::kDefaultWatermark +
                                                 ManagedPmmNode::kDefaultDebounce;
 
+  static constexpr uint64_t kDefaultArray[1] = {kDefaultWatermark * PAGE_SIZE};
+
+  // The pages are spread evenly over |numa_nodes| NUMA nodes.
   explicit ManagedPmmNode(const uint64_t* watermarks = kDefaultArray, uint8_t watermark_count = 1,
-                          uint64_t debounce = kDefaultDebounce) {
+                          uint64_t debounce = kDefaultDebounce, uint8_t numa_nodes = 1) {
 #if __has_feature(address_sanitizer)
     // Pmm nodes for tests do not use asan; their pages are managed independently.
     node_.DisableKasan();
 #endif
     list_node list = LIST_INITIAL_VALUE(list);
-    for (auto& p : pages_) {
-      list_add_tail(&list, &p.queue_node);
+    for (size_t i = 0; i < kNumPages; i++) {
+      pages_[i].numa_node_priv = static_cast<uint8_t>(i % numa_nodes);
+      list_add_tail(&list, &pages_[i].queue_node);
     }
     node_.AddFreePages(&list);
 
@@ -90,7 +94,6 @@ class ManagedPmmNode {
   static void StateCallback(uint8_t level) { instance_->cur_level_ = level; }
   static ManagedPmmNode* instance_;
 
-  static constexpr uint64_t kDefaultArray[1] = {kDefaultWatermark * PAGE_SIZE};
 };
 
 ManagedPmmNode* ManagedPmmNode::instance_ = nullptr;
@@ -258,6 +261,49 @@ static bool pmm_node_oversized_alloc_test() {
   END_TEST;
 }
 
+// Checks that allocations are served from the requested NUMA node first, and from the other
+// nodes once it runs out of free pages.
+static bool pmm_node_numa_alloc_test() {
+  BEGIN_TEST;
+  ManagedPmmNode node(ManagedPmmNode::kDefaultArray, 1, ManagedPmmNode::kDefaultDebounce, 2);
+  static constexpr size_t kPagesPerNode = ManagedPmmNode::kNumPages / 2;
+  ASSERT_EQ(2u, node.node().NumNumaNodes());
+  EXPECT_EQ(kPagesPerNode, node.node().CountFreePages(0));
+  EXPECT_EQ(kPagesPerNode, node.node().CountFreePages(1));
+
+  vm_page_t* page;
+  ASSERT_EQ(ZX_OK, node.node().AllocPage(PMM_ALLOC_FLAG_NODE(1), &page, nullptr));
+  EXPECT_EQ(1u, page->numa_node());
+  EXPECT_EQ(kPagesPerNode - 1, node.node().CountFreePages(1));
+  node.node().FreePage(page);
+  EXPECT_EQ(kPagesPerNode, node.node().CountFreePages(1));
+
+  // Take every page of node 1 and a few of node 0.
+  list_node list = LIST_INITIAL_VALUE(list);
+  static constexpr size_t kOverflow = 4;
+  ASSERT_EQ(ZX_OK,
+            node.node().AllocPages(kPagesPerNode + kOverflow, PMM_ALLOC_FLAG_NODE(1), &list));
+  size_t node_counts[2] = {};
+  list_for_every_entry (&list, page, vm_page_t, queue_node) { node_counts[page->numa_node()]++; }
+  EXPECT_EQ(kOverflow, node_counts[0]);
+  EXPECT_EQ(kPagesPerNode, node_counts[1]);
+  EXPECT_EQ(kPagesPerNode - kOverflow, node.node().CountFreePages(0));
+  EXPECT_EQ(0u, node.node().CountFreePages(1));
+
+  // Node 1 is empty, so a single page comes from node 0.
+  ASSERT_EQ(ZX_OK, node.node().AllocPage(PMM_ALLOC_FLAG_NODE(1), &page, nullptr));
+  EXPECT_EQ(0u, page->numa_node());
+  list_add_tail(&list, &page->queue_node);
+
+  // Freed pages go back to the free list of their own node.
+  node.node().FreeList(&list);
+  EXPECT_EQ(kPagesPerNode, node.node().CountFreePages(0));
+  EXPECT_EQ(kPagesPerNode, node.node().CountFreePages(1));
+  EXPECT_EQ(ManagedPmmNode::kNumPages, node.node().CountFreePages());
+
+  END_TEST;
+}
+
 // Checks the correctness of the reported watermark level.
 static bool pmm_node_watermark_level_test() {
   BEGIN_TEST;
@@ -3161,6 +3207,7 @@ VM_UNITTEST(pmm_alloc_contiguous_one_test)
 VM_UNITTEST(pmm_node_multi_alloc_test)
 VM_UNITTEST(pmm_node_singlton_list_test)
 VM_UNITTEST(pmm_node_oversized_alloc_test)
+VM_UNITTEST(pmm_node_numa_alloc_test)
 VM_UNITTEST(pmm_node_watermark_level_test)
 VM_UNITTEST(pmm_node_multi_watermark_level_test)
 VM_UNITTEST(pmm_node_multi_watermark_level_test2)
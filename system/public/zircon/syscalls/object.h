@@ -246,6 +246,22 @@ typedef struct zx_info_thread_stats {
     uint8_t padding1[4];
 } zx_info_thread_stats_t;
 
+// Statistics about a thread, read without entering the kernel by
+// zx_thread_read_stats() from a mapping of zx_thread_get_stats_vmo().
+typedef struct zx_thread_stats {
+    // Total accumulated running time of the thread.
+    zx_duration_t total_runtime;
+
+    // Number of times the thread has been switched to.
+    uint64_t context_switches;
+
+    // CPU number that this thread was last scheduled on, or ZX_INFO_INVALID_CPU
+    // if the thread has never been scheduled on a CPU.
+    uint32_t last_scheduled_cpu;
+
+    uint8_t padding1[4];
+} zx_thread_stats_t;
+
 // Statistics about resources (e.g., memory) used by a task. Can be relatively
 // expensive to gather.
 typedef struct zx_info_task_stats {
@@ -30,6 +30,9 @@ __BEGIN_CDECLS
 // For options passed to port_create
 #define ZX_PORT_BIND_TO_INTERRUPT   ((uint32_t)(0x1u << 0))
 
+// The largest number of packets returned by a single port_wait_many
+#define ZX_PORT_WAIT_MANY_MAX_PACKETS ((size_t)16u)
+
 #define ZX_PKT_TYPE_MASK            ((uint32_t)0x000000FFu)
 
 #define ZX_PKT_IS_USER(type)          ((type) == ZX_PKT_TYPE_USER)
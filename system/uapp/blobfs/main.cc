@@ -147,6 +147,10 @@ int usage() {
       "                                    Does not affect any blobs already stored on-disk.\n"
       "                                    'alg' can be one of ZSTD, ZSTD_SEEKABLE, ZSTD_CHUNKED,\n"
       "                                    or UNCOMPRESSED.\n"
+      "         -t|--serving_threads [n]   Number of threads servicing filesystem requests.\n"
+      "                                    Readable blobs are served concurrently when n > 1.\n"
+      "         -w|--write_threads [n]     Number of threads processing blobs as they are written.\n"
+      "                                    Defaults to one per CPU.\n"
       "         -h|--help                  Display this message\n"
       "\n"
       "On Fuchsia, blobfs takes the block device argument by handle.\n"
@@ -169,11 +173,14 @@ zx_status_t ProcessArgs(int argc, char** argv, CommandFunction* func,
         {"verbose", no_argument, nullptr, 'v'}, {"readonly", no_argument, nullptr, 'r'},
         {"metrics", no_argument, nullptr, 'm'}, {"journal", no_argument, nullptr, 'j'},
         {"pager", no_argument, nullptr, 'p'},   {"write-uncompressed", no_argument, nullptr, 'u'},
-        {"compression", required_argument, nullptr, 'c'}, {"help", no_argument, nullptr, 'h'},
+        {"compression", required_argument, nullptr, 'c'},
+        {"serving_threads", required_argument, nullptr, 't'},
+        {"write_threads", required_argument, nullptr, 'w'},
+        {"help", no_argument, nullptr, 'h'},
         {nullptr, 0, nullptr, 0},
     };
     int opt_index;
-    int c = getopt_long(argc, argv, "vrmjpuc:h", opts, &opt_index);
+    int c = getopt_long(argc, argv, "vrmjpuc:t:w:h", opts, &opt_index);
 
     if (c < 0) {
       break;
@@ -204,6 +211,26 @@ zx_status_t ProcessArgs(int argc, char** argv, CommandFunction* func,
         options->write_compression_algorithm = *algorithm;
         break;
       }
+      case 't': {
+        char* end;
+        unsigned long threads = strtoul(optarg, &end, 10);
+        if (*end != '\0' || threads == 0 || threads > UINT32_MAX) {
+          fprintf(stderr, "Invalid number of serving threads: %s\n", optarg);
+          return usage();
+        }
+        options->serving_threads = static_cast<uint32_t>(threads);
+        break;
+      }
+      case 'w': {
+        char* end;
+        unsigned long threads = strtoul(optarg, &end, 10);
+        if (*end != '\0' || threads == 0 || threads > UINT32_MAX) {
+          fprintf(stderr, "Invalid number of write threads: %s\n", optarg);
+          return usage();
+        }
+        options->write_threads = static_cast<uint32_t>(threads);
+        break;
+      }
       case 'v':
         options->verbose = true;
         break;
@@ -9,6 +9,7 @@
 #include <fbl/array.h>
 #include <fbl/unique_fd.h>
 #include <fcntl.h>
+#include <lib/counter-snapshot.h>
 #include <lib/counter-vmo-abi.h>
 #include <lib/fdio/io.h>
 #include <lib/fzl/owned-vmo-mapper.h>
@@ -17,6 +18,7 @@
 #include <utility>
 #include <zircon/compiler.h>
 #include <zircon/status.h>
+#include <zircon/syscalls.h>
 
 #include "kcounter_cmdline.h"
 
@@ -24,6 +26,66 @@ namespace {
 
 constexpr char kVmoFileDir[] = "/boot/kernel";
 
+const char* TypeSeparator(counters::Type type) {
+  return type == counters::Type::kSum ? " + " : ", ";
+}
+
+// Prints |value| followed by its rate of change over |interval|, if any.
+void PrintValueAndRate(int64_t value, int64_t change, zx_duration_t interval) {
+  int64_t ev_per_nsec = 0;
+  if (unlikely(mul_overflow(change, 1000000000LL, &ev_per_nsec))) {
+    printf("%" PRId64 " [rate overflow]\n", value);
+    return;
+  }
+  const int64_t rate = interval > 0 ? ev_per_nsec / interval : 0;
+  if (rate != 0) {
+    printf("%" PRId64 " [%" PRId64 "/sec]\n", value, rate);
+  } else {
+    printf("%" PRId64 "\n", value);
+  }
+}
+
+// Prints counter |i| of |current|. Once |previous| is valid, kSum counters
+// show their rate since |previous| rather than since boot and, with
+// --verbose, their per-CPU changes rather than their per-CPU values.
+void PrintCounter(const KcounterCmdline& cmdline, size_t i, const counters::Snapshot& previous,
+                  const counters::Snapshot& current) {
+  const counters::Descriptor& entry = current.descriptor(i);
+  const bool show_change = previous.is_valid() && entry.type == counters::Type::kSum;
+  const int64_t value = current.Value(i);
+
+  if (!cmdline.terse) {
+    printf("%s =%s", entry.name,
+           !cmdline.verbose ? " "
+                            : show_change ? " change("
+                                          : entry.type == counters::Type::kMin
+                                                ? " min("
+                                                : entry.type == counters::Type::kMax ? " max("
+                                                                                     : " ");
+  }
+
+  if (cmdline.verbose) {
+    for (size_t cpu = 0; cpu < current.num_cpus(); ++cpu) {
+      printf("%s%" PRId64, cpu == 0 ? "" : TypeSeparator(entry.type),
+             show_change ? current.Delta(previous, i, cpu) : current.Value(i, cpu));
+    }
+    if (show_change) {
+      const int64_t change = current.Delta(previous, i);
+      printf(") = ");
+      PrintValueAndRate(change, change, current.timestamp() - previous.timestamp());
+    } else {
+      printf("%s = %" PRId64 "\n", entry.type == counters::Type::kSum ? "" : ")", value);
+    }
+  } else if (show_change) {
+    PrintValueAndRate(value, current.Delta(previous, i),
+                      current.timestamp() - previous.timestamp());
+  } else if (entry.type == counters::Type::kSum) {
+    PrintValueAndRate(value, value, current.timestamp());
+  } else {
+    printf("%" PRId64 "\n", value);
+  }
+}
+
 }  // anonymous namespace
 
 int main(int argc, char** argv) {
@@ -143,9 +205,14 @@ int main(int argc, char** argv) {
     return false;
   };
 
+  // Only the online CPUs are read. The arena slots of the others stay zero.
+  const size_t num_cpus = zx_system_get_num_cpus();
+
   size_t times = 1;
   zx_time_t deadline = 0;
   bool match_failed = false;
+  counters::Snapshot previous;
+  counters::Snapshot current;
 
   while (true) {
     if (cmdline.period != 0) {
@@ -153,6 +220,10 @@ int main(int argc, char** argv) {
       printf("[%zu]\n", times);
     }
 
+    if (!cmdline.list) {
+      current.Take(*desc, arena, num_cpus, zx_clock_get_monotonic());
+    }
+
     for (size_t i = 0; i < desc->num_counters(); ++i) {
       const auto& entry = desc->descriptor_table[i];
       if (matches(entry.name)) {
@@ -172,52 +243,7 @@ int main(int argc, char** argv) {
               printf(" ??? unknown type %" PRIu64 " ???\n", static_cast<uint64_t>(entry.type));
           }
         } else {
-          if (!cmdline.terse) {
-            printf("%s =%s", entry.name,
-                   !cmdline.verbose ? " "
-                                    : entry.type == counters::Type::kMin
-                                          ? " min("
-                                          : entry.type == counters::Type::kMax ? " max(" : " ");
-          }
-          int64_t value = 0;
-          for (uint64_t cpu = 0; cpu < desc->max_cpus; ++cpu) {
-            const int64_t cpu_value = arena[(cpu * desc->num_counters()) + i];
-            if (cmdline.verbose) {
-              printf("%s%" PRId64,
-                     cpu == 0 ? "" : entry.type == counters::Type::kSum ? " + " : ", ", cpu_value);
-            }
-            switch (entry.type) {
-              case counters::Type::kSum:
-              default:
-                value += cpu_value;
-                break;
-              case counters::Type::kMin:
-                if (cpu_value < value) {
-                  value = cpu_value;
-                }
-                break;
-              case counters::Type::kMax:
-                if (cpu_value > value) {
-                  value = cpu_value;
-                }
-                break;
-            }
-          }
-          if (cmdline.verbose) {
-            printf("%s = %" PRId64 "\n", entry.type == counters::Type::kSum ? "" : ")", value);
-          } else {
-            int64_t ev_per_nsec = 0;
-            if (unlikely(mul_overflow(value, 1000000000LL, &ev_per_nsec))) {
-              printf("%" PRId64 " [rate overflow]\n", value);
-            } else {
-              auto rate = ev_per_nsec / zx_clock_get_monotonic();
-              if (rate != 0) {
-                printf("%" PRId64 " [%" PRId64 "/sec]\n", value, rate);
-              } else {
-                printf("%" PRId64 "\n", value);
-              }
-            }
-          }
+          PrintCounter(cmdline, i, previous, current);
         }
       }
     }
@@ -239,6 +265,7 @@ int main(int argc, char** argv) {
 
     zx_nanosleep(deadline);
     ++times;
+    std::swap(previous, current);
   }  // while
 
   return match_failed ? 1 : 0;
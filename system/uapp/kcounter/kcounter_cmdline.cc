@@ -27,6 +27,8 @@ With --terse or -t, show only values and no names.\n\
 With --verbose or -v, show space-separated lists of per-CPU values.\n\
 With --watch or -w, keep showing the values every [period] seconds, default is %d seconds.\n\
 Otherwise values are aggregated summaries across all CPUs.\n\
+Rates are averaged since boot, or since the previous period when watching.\n\
+When watching with --verbose, per-CPU changes since the previous period are shown.\n\
 If PREFIX arguments are given, only matching names are shown.\n\
 Results are always sorted by name.\n\
 ",
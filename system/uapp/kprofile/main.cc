@@ -0,0 +1,272 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// kprofile runs the kernel sampling profiler for a while and writes the
+// samples of every CPU as pprof-compatible CPU profiles. The profiles use the
+// legacy binary format of gperftools, which pprof reads directly.
+//
+// A user address only means something within its own process, so samples are
+// split into one profile per process and mode: the user stacks of a process,
+// the kernel stacks of a process's threads, and the kernel stacks of kernel
+// threads each go into their own file.
+
+#include <errno.h>
+#include <fuchsia/boot/c/fidl.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <lib/fdio/directory.h>
+#include <lib/sampler-abi.h>
+#include <lib/zircon-internal/mtrace.h>
+#include <lib/zx/channel.h>
+#include <lib/zx/resource.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zircon/status.h>
+#include <zircon/syscalls.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr char kUsage[] =
+    "\
+Usage: kprofile [options] <output>\n\
+Samples the stacks running on every CPU and writes them as pprof CPU profiles:\n\
+<output>-<pid>-user and <output>-<pid>-kernel for the user and kernel stacks\n\
+of each process, and <output>-kernel for kernel threads.\n\
+\n\
+Options:\n\
+  --duration=<seconds>, -d  How long to sample, default is 5 seconds.\n\
+  --period=<usec>, -p       Time between samples on each CPU, default is 1000.\n\
+  --buffer=<KiB>, -b        Size of the sample buffer of each CPU, default is 4096.\n\
+  --help, -h                Show this help.\n\
+";
+
+constexpr char kShortOptions[] = "hd:p:b:";
+constexpr struct option kLongOptions[] = {
+    {"help", no_argument, nullptr, 'h'},           {"duration", required_argument, nullptr, 'd'},
+    {"period", required_argument, nullptr, 'p'},   {"buffer", required_argument, nullptr, 'b'},
+    {nullptr, 0, nullptr, 0}};
+
+zx_status_t get_root_resource(zx::resource* root_resource) {
+  zx::channel local, remote;
+  zx_status_t status = zx::channel::create(0, &local, &remote);
+  if (status != ZX_OK) {
+    return status;
+  }
+  status = fdio_service_connect("/svc/fuchsia.boot.RootResource", remote.release());
+  if (status != ZX_OK) {
+    fprintf(stderr, "ERROR: Cannot open fuchsia.boot.RootResource: %s (%d)\n",
+            zx_status_get_string(status), status);
+    return ZX_ERR_NOT_FOUND;
+  }
+
+  zx_handle_t h;
+  zx_status_t fidl_status = fuchsia_boot_RootResourceGet(local.get(), &h);
+  if (fidl_status != ZX_OK) {
+    fprintf(stderr, "ERROR: Cannot obtain root resource: %s (%d)\n",
+            zx_status_get_string(fidl_status), fidl_status);
+    return fidl_status;
+  }
+
+  root_resource->reset(h);
+  return ZX_OK;
+}
+
+zx_status_t SamplerControl(const zx::resource& root_resource, uint32_t action, uint32_t options,
+                           void* arg, size_t size) {
+  zx_status_t status =
+      zx_mtrace_control(root_resource.get(), MTRACE_KIND_SAMPLER, action, options, arg, size);
+  if (status != ZX_OK) {
+    fprintf(stderr, "ERROR: sampler action %u failed: %s (%d)\n", action,
+            zx_status_get_string(status), status);
+  }
+  return status;
+}
+
+// The number of times each distinct stack was sampled.
+using StackCounts = std::map<std::vector<uint64_t>, uint64_t>;
+
+// Identifies a profile: the koid of the process, or ZX_KOID_INVALID for kernel
+// threads, and the sampler::kRecordUser bit of the samples.
+using ProfileKey = std::pair<zx_koid_t, uint32_t>;
+
+// The stacks of each profile.
+using Profiles = std::map<ProfileKey, StackCounts>;
+
+struct Totals {
+  uint64_t user = 0;
+  uint64_t kernel = 0;
+  uint64_t dropped = 0;
+};
+
+// Adds the samples of |data| to |profiles|. Returns false if |data| is malformed.
+bool ParseSamples(const uint8_t* data, size_t size, Profiles* profiles, Totals* totals) {
+  size_t offset = 0;
+  while (offset < size) {
+    sampler::Record record;
+    if (size - offset < sizeof(record)) {
+      return false;
+    }
+    memcpy(&record, data + offset, sizeof(record));
+    if (record.num_frames > sampler::kMaxFrames || size - offset < record.size()) {
+      return false;
+    }
+    std::vector<uint64_t> frames(record.num_frames);
+    memcpy(frames.data(), data + offset + sizeof(record), record.num_frames * sizeof(frames[0]));
+    const ProfileKey key(record.pid, record.flags & sampler::kRecordUser);
+    ++(*profiles)[key][std::move(frames)];
+    if (record.flags & sampler::kRecordUser) {
+      totals->user++;
+    } else {
+      totals->kernel++;
+    }
+    offset += record.size();
+  }
+  return true;
+}
+
+void WriteWord(FILE* f, uint64_t word) { fwrite(&word, sizeof(word), 1, f); }
+
+// Writes |stacks| in the legacy gperftools CPU profile format.
+bool WriteProfile(const char* path, const StackCounts& stacks, zx_duration_t period) {
+  FILE* f = fopen(path, "wb");
+  if (f == nullptr) {
+    fprintf(stderr, "ERROR: Cannot open %s: %s\n", path, strerror(errno));
+    return false;
+  }
+
+  // Header: header count, header words, format version, period in usec, padding.
+  WriteWord(f, 0);
+  WriteWord(f, 3);
+  WriteWord(f, 0);
+  WriteWord(f, period / ZX_USEC(1));
+  WriteWord(f, 0);
+
+  for (const auto& [frames, count] : stacks) {
+    WriteWord(f, count);
+    WriteWord(f, frames.size());
+    for (uint64_t pc : frames) {
+      WriteWord(f, pc);
+    }
+  }
+
+  // Trailer: a sample with one frame and a count of zero.
+  WriteWord(f, 0);
+  WriteWord(f, 1);
+  WriteWord(f, 0);
+
+  if (fclose(f) != 0) {
+    fprintf(stderr, "ERROR: Cannot write %s: %s\n", path, strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+// Returns the file name of the profile |key| for the output prefix |output|.
+std::string ProfilePath(const char* output, const ProfileKey& key) {
+  const auto& [pid, flags] = key;
+  std::string path = output;
+  if (pid != ZX_KOID_INVALID) {
+    path += "-" + std::to_string(pid);
+  }
+  path += (flags & sampler::kRecordUser) ? "-user" : "-kernel";
+  return path;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char** argv) {
+  int duration = 5;
+  zx_duration_t period = ZX_USEC(1000);
+  uint64_t buffer_size = 4096 * 1024;
+
+  int opt;
+  while ((opt = getopt_long(argc, argv, kShortOptions, kLongOptions, nullptr)) != -1) {
+    switch (opt) {
+      case 'h':
+        fputs(kUsage, stdout);
+        return 0;
+      case 'd':
+        duration = atoi(optarg);
+        break;
+      case 'p':
+        period = ZX_USEC(atoi(optarg));
+        break;
+      case 'b':
+        buffer_size = strtoull(optarg, nullptr, 0) * 1024;
+        break;
+      default:
+        fputs(kUsage, stderr);
+        return 1;
+    }
+  }
+  if (optind + 1 != argc || duration < 1) {
+    fputs(kUsage, stderr);
+    return 1;
+  }
+  const char* output = argv[optind];
+
+  zx::resource root_resource;
+  if (get_root_resource(&root_resource) != ZX_OK) {
+    return 1;
+  }
+
+  sampler::Config config = {.period = period, .buffer_size = buffer_size};
+  if (SamplerControl(root_resource, MTRACE_SAMPLER_INIT, 0, &config, sizeof(config)) != ZX_OK) {
+    return 1;
+  }
+  if (SamplerControl(root_resource, MTRACE_SAMPLER_START, 0, nullptr, 0) != ZX_OK) {
+    SamplerControl(root_resource, MTRACE_SAMPLER_FINI, 0, nullptr, 0);
+    return 1;
+  }
+  printf("Sampling every %" PRId64 " usec for %d seconds...\n", period / ZX_USEC(1), duration);
+  zx_nanosleep(zx_deadline_after(ZX_SEC(duration)));
+  SamplerControl(root_resource, MTRACE_SAMPLER_STOP, 0, nullptr, 0);
+
+  const size_t read_size = sizeof(sampler::BufferHeader) + buffer_size;
+  std::unique_ptr<uint8_t[]> buffer(new uint8_t[read_size]);
+  Profiles profiles;
+  Totals totals;
+  int result = 0;
+  for (uint32_t cpu = 0; cpu < zx_system_get_num_cpus(); cpu++) {
+    if (SamplerControl(root_resource, MTRACE_SAMPLER_READ, cpu, buffer.get(), read_size) !=
+        ZX_OK) {
+      result = 1;
+      break;
+    }
+    sampler::BufferHeader header;
+    memcpy(&header, buffer.get(), sizeof(header));
+    totals.dropped += header.dropped;
+    if (!ParseSamples(buffer.get() + sizeof(header), header.size, &profiles, &totals)) {
+      fprintf(stderr, "ERROR: Malformed samples from CPU %u\n", cpu);
+      result = 1;
+      break;
+    }
+  }
+  SamplerControl(root_resource, MTRACE_SAMPLER_FINI, 0, nullptr, 0);
+
+  if (result == 0) {
+    printf("%" PRIu64 " user and %" PRIu64 " kernel samples in %zu profiles", totals.user,
+           totals.kernel, profiles.size());
+    if (totals.dropped != 0) {
+      printf(", %" PRIu64 " dropped (use a larger --buffer)", totals.dropped);
+    }
+    printf("\n");
+    for (const auto& [key, stacks] : profiles) {
+      const std::string path = ProfilePath(output, key);
+      if (!WriteProfile(path.c_str(), stacks, period)) {
+        result = 1;
+        break;
+      }
+      printf("%s: %zu distinct stacks\n", path.c_str(), stacks.size());
+    }
+  }
+  return result;
+}
@@ -13,6 +13,7 @@
 #include <lib/fdio/vfs.h>
 #include <libgen.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -97,8 +98,17 @@ int Mount(std::unique_ptr<minfs::Bcache> bcache, const minfs::MountOptions& opti
     FS_TRACE_ERROR("minfs: Mounted successfully\n");
   }
 
+  for (uint32_t i = 1; i < options.serving_threads; i++) {
+    status = loop.StartThread("minfs-serving");
+    if (status != ZX_OK) {
+      FS_TRACE_WARN("minfs: Failed to start serving thread: %d\n", status);
+      break;
+    }
+  }
+
   // |ZX_ERR_CANCELED| is returned when the loop is cancelled via |loop.Quit()|.
   ZX_ASSERT(loop.Run() == ZX_ERR_CANCELED);
+  loop.JoinThreads();
   return 0;
 }
 
@@ -124,6 +134,7 @@ int usage(const std::vector<Command>& commands) {
           "    -s|--fvm_data_slices SLICES     When mkfs on top of FVM,\n"
           "                                    preallocate |SLICES| slices of data. \n"
           "    --fsck_after_every_transaction  Run fsck after every transaction.\n"
+          "    -t|--serving_threads THREADS    Number of threads servicing requests.\n"
           "    -h|--help                       Display this message\n"
           "\n"
           "On Fuchsia, MinFS takes the block device argument by handle.\n"
@@ -182,11 +193,12 @@ int main(int argc, char** argv) {
         {"verbose", no_argument, nullptr, 'v'},
         {"fvm_data_slices", required_argument, nullptr, 's'},
         {"fsck_after_every_transaction", no_argument, nullptr, 'f'},
+        {"serving_threads", required_argument, nullptr, 't'},
         {"help", no_argument, nullptr, 'h'},
         {nullptr, 0, nullptr, 0},
     };
     int opt_index;
-    int c = getopt_long(argc, argv, "rmjvsh:", opts, &opt_index);
+    int c = getopt_long(argc, argv, "rmjvst:h:", opts, &opt_index);
     if (c < 0) {
       break;
     }
@@ -209,6 +221,16 @@ int main(int argc, char** argv) {
       case 'f':
         options.fsck_after_every_transaction = true;
         break;
+      case 't': {
+        char* end;
+        unsigned long threads = strtoul(optarg, &end, 10);
+        if (*end != '\0' || threads == 0 || threads > UINT32_MAX) {
+          fprintf(stderr, "minfs: invalid number of serving threads: %s\n", optarg);
+          return usage(commands);
+        }
+        options.serving_threads = static_cast<uint32_t>(threads);
+        break;
+      }
       case 'h':
       default:
         return usage(commands);
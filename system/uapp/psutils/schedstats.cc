@@ -0,0 +1,286 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// schedstats prints the scheduler histograms the kernel keeps in its
+// counters: wakeup latency, time slice utilization, run queue depth and
+// deadline misses. Each bucket of a histogram is a counter named
+// "sched.<histogram>.<lower bound>".
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <lib/counter-snapshot.h>
+#include <lib/counter-vmo-abi.h>
+#include <lib/fdio/io.h>
+#include <lib/fzl/owned-vmo-mapper.h>
+#include <lib/zx/vmo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zircon/status.h>
+#include <zircon/syscalls.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fbl/unique_fd.h>
+
+namespace {
+
+constexpr char kVmoFileDir[] = "/boot/kernel";
+constexpr char kHistogramPrefix[] = "sched.";
+
+constexpr char kUsage[] =
+    "\
+Usage: schedstats [options] [histogram prefix...]\n\
+Prints the scheduler histograms kept by the kernel, totaled over all CPUs.\n\
+\n\
+Options:\n\
+  --cpus, -c                Also print the buckets of each CPU.\n\
+  --interval=<seconds>, -i  Only count the samples taken during an interval\n\
+                            rather than since boot.\n\
+  --help, -h                Show this help.\n\
+";
+
+constexpr char kShortOptions[] = "hci:";
+constexpr struct option kLongOptions[] = {{"help", no_argument, nullptr, 'h'},
+                                          {"cpus", no_argument, nullptr, 'c'},
+                                          {"interval", required_argument, nullptr, 'i'},
+                                          {nullptr, 0, nullptr, 0}};
+
+// The percentiles printed for every histogram.
+constexpr int kPercentiles[] = {50, 90, 99};
+
+struct Histogram {
+  std::string name;
+  // The counter index and lower bound of each bucket, in increasing order.
+  std::vector<std::pair<size_t, int64_t>> buckets;
+};
+
+// Maps the VMO |name| of the counters directory |dir_fd| into |mapper|.
+bool MapVmo(int dir_fd, const char* name, fzl::OwnedVmoMapper* mapper, uint64_t* size) {
+  fbl::unique_fd fd(openat(dir_fd, name, O_RDONLY));
+  if (!fd) {
+    fprintf(stderr, "%s/%s: %s\n", kVmoFileDir, name, strerror(errno));
+    return false;
+  }
+  zx::vmo vmo;
+  zx_status_t status = fdio_get_vmo_exact(fd.get(), vmo.reset_and_get_address());
+  if (status != ZX_OK) {
+    fprintf(stderr, "fdio_get_vmo_exact: %s: %s\n", name, zx_status_get_string(status));
+    return false;
+  }
+  status = vmo.get_size(size);
+  if (status != ZX_OK) {
+    fprintf(stderr, "cannot get %s VMO size: %s\n", name, zx_status_get_string(status));
+    return false;
+  }
+  status = mapper->Map(std::move(vmo), *size, ZX_VM_PERM_READ);
+  if (status != ZX_OK) {
+    fprintf(stderr, "cannot map %s VMO: %s\n", name, zx_status_get_string(status));
+    return false;
+  }
+  return true;
+}
+
+// Splits a counter named "sched.<histogram>.<lower bound>" into its parts.
+// Returns false if the counter is not a histogram bucket.
+bool ParseBucketName(const char* name, std::string* histogram, int64_t* bound) {
+  if (strncmp(name, kHistogramPrefix, strlen(kHistogramPrefix)) != 0) {
+    return false;
+  }
+  const char* dot = strrchr(name, '.');
+  if (dot[1] == '\0') {
+    return false;
+  }
+  for (const char* p = dot + 1; *p != '\0'; ++p) {
+    if (!isdigit(*p)) {
+      return false;
+    }
+  }
+  histogram->assign(name, dot - name);
+  *bound = strtoll(dot + 1, nullptr, 10);
+  return true;
+}
+
+// Collects the histograms among the counters, whose descriptors are sorted by
+// name, so the buckets of each histogram are adjacent and in order.
+std::vector<Histogram> FindHistograms(const counters::DescriptorVmo& desc) {
+  std::vector<Histogram> histograms;
+  for (size_t i = 0; i < desc.num_counters(); ++i) {
+    std::string name;
+    int64_t bound;
+    if (!ParseBucketName(desc.descriptor_table[i].name, &name, &bound)) {
+      continue;
+    }
+    if (histograms.empty() || histograms.back().name != name) {
+      histograms.push_back({std::move(name), {}});
+    }
+    histograms.back().buckets.emplace_back(i, bound);
+  }
+  return histograms;
+}
+
+bool Matches(const std::string& name, int argc, char** argv) {
+  if (optind == argc) {
+    return true;
+  }
+  for (int i = optind; i < argc; ++i) {
+    if (name.compare(0, strlen(argv[i]), argv[i]) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the samples of |counter| on |cpu|, or on every CPU if |cpu| is
+// num_cpus(), since |earlier| if it is valid.
+int64_t Samples(const counters::Snapshot& current, const counters::Snapshot& earlier,
+                size_t counter, size_t cpu) {
+  if (cpu == current.num_cpus()) {
+    return earlier.is_valid() ? current.Delta(earlier, counter) : current.Value(counter);
+  }
+  return earlier.is_valid() ? current.Delta(earlier, counter, cpu) : current.Value(counter, cpu);
+}
+
+void PrintHistogram(const Histogram& histogram, const counters::Snapshot& current,
+                    const counters::Snapshot& earlier, bool show_cpus) {
+  const size_t total = current.num_cpus();
+  int64_t samples = 0;
+  for (const auto& [counter, bound] : histogram.buckets) {
+    samples += Samples(current, earlier, counter, total);
+  }
+
+  printf("%s: %" PRId64 " samples", histogram.name.c_str(), samples);
+  if (samples != 0) {
+    // Each percentile is reported as the upper bound of its bucket.
+    for (int percentile : kPercentiles) {
+      const int64_t rank = (samples * percentile + 99) / 100;
+      int64_t seen = 0;
+      for (size_t i = 0; i < histogram.buckets.size(); ++i) {
+        seen += Samples(current, earlier, histogram.buckets[i].first, total);
+        if (seen >= rank) {
+          if (i + 1 < histogram.buckets.size()) {
+            printf(", p%d < %" PRId64, percentile, histogram.buckets[i + 1].second);
+          } else {
+            printf(", p%d >= %" PRId64, percentile, histogram.buckets[i].second);
+          }
+          break;
+        }
+      }
+    }
+  }
+  printf("\n");
+
+  printf("%12s %12s", ">=", "total");
+  if (show_cpus) {
+    for (size_t cpu = 0; cpu < total; ++cpu) {
+      printf(" %9s%-3zu", "cpu", cpu);
+    }
+  }
+  printf("\n");
+  for (const auto& [counter, bound] : histogram.buckets) {
+    printf("%12" PRId64 " %12" PRId64, bound, Samples(current, earlier, counter, total));
+    if (show_cpus) {
+      for (size_t cpu = 0; cpu < total; ++cpu) {
+        printf(" %12" PRId64, Samples(current, earlier, counter, cpu));
+      }
+    }
+    printf("\n");
+  }
+  printf("\n");
+}
+
+}  // anonymous namespace
+
+int main(int argc, char** argv) {
+  bool show_cpus = false;
+  int interval = 0;
+
+  int opt;
+  while ((opt = getopt_long(argc, argv, kShortOptions, kLongOptions, nullptr)) != -1) {
+    switch (opt) {
+      case 'h':
+        fputs(kUsage, stdout);
+        return 0;
+      case 'c':
+        show_cpus = true;
+        break;
+      case 'i':
+        interval = atoi(optarg);
+        if (interval < 1) {
+          fputs(kUsage, stderr);
+          return 1;
+        }
+        break;
+      default:
+        fputs(kUsage, stderr);
+        return 1;
+    }
+  }
+
+  fbl::unique_fd dir_fd(open(kVmoFileDir, O_RDONLY | O_DIRECTORY));
+  if (!dir_fd) {
+    fprintf(stderr, "%s: %s\n", kVmoFileDir, strerror(errno));
+    return 1;
+  }
+
+  fzl::OwnedVmoMapper desc_mapper;
+  uint64_t desc_size;
+  if (!MapVmo(dir_fd.get(), counters::DescriptorVmo::kVmoName, &desc_mapper, &desc_size)) {
+    return 1;
+  }
+  const auto* desc = reinterpret_cast<const counters::DescriptorVmo*>(desc_mapper.start());
+  if (desc->magic != counters::DescriptorVmo::kMagic ||
+      desc_size < sizeof(*desc) + desc->descriptor_table_size) {
+    fprintf(stderr, "%s: malformed counter descriptors\n", counters::DescriptorVmo::kVmoName);
+    return 1;
+  }
+
+  fzl::OwnedVmoMapper arena_mapper;
+  uint64_t arena_size;
+  if (!MapVmo(dir_fd.get(), counters::kArenaVmoName, &arena_mapper, &arena_size)) {
+    return 1;
+  }
+  if (arena_size < desc->max_cpus * desc->num_counters() * sizeof(int64_t)) {
+    fprintf(stderr, "%s: too small for %" PRIu64 " CPUs * %" PRIu64 " counters\n",
+            counters::kArenaVmoName, desc->max_cpus, desc->num_counters());
+    return 1;
+  }
+  const auto* arena = reinterpret_cast<const volatile int64_t*>(arena_mapper.start());
+  dir_fd.reset();
+
+  std::vector<Histogram> histograms = FindHistograms(*desc);
+  if (histograms.empty()) {
+    fprintf(stderr, "no scheduler histograms in the kernel counters\n");
+    return 1;
+  }
+
+  // Only the online CPUs are read. The arena slots of the others stay zero.
+  const size_t num_cpus = zx_system_get_num_cpus();
+  counters::Snapshot earlier;
+  counters::Snapshot current;
+  if (interval != 0) {
+    earlier.Take(*desc, arena, num_cpus, zx_clock_get_monotonic());
+    zx_nanosleep(zx_deadline_after(ZX_SEC(interval)));
+  }
+  current.Take(*desc, arena, num_cpus, zx_clock_get_monotonic());
+
+  bool matched = false;
+  for (const Histogram& histogram : histograms) {
+    if (Matches(histogram.name, argc, argv)) {
+      PrintHistogram(histogram, current, earlier, show_cpus);
+      matched = true;
+    }
+  }
+  if (!matched) {
+    fprintf(stderr, "no scheduler histograms match\n");
+    return 1;
+  }
+  return 0;
+}
@@ -9,6 +9,9 @@
 #include <stdarg.h>
 #include <stdio.h>
 
+#include <thread>
+#include <vector>
+
 #include <fbl/function.h>
 #include <trace-engine/buffer_internal.h>
 #include <trace-engine/instrumentation.h>
@@ -53,6 +56,40 @@ class Runner {
     }
   }
 
+  // Runs |benchmark| from |num_threads| threads at once, to measure how
+  // writing records scales with the number of threads. Each measured
+  // iteration runs |benchmark| |kEventsPerThreadedRun| times in total,
+  // divided evenly between the threads. Note that this includes the time
+  // taken to start and join the threads.
+  void RunThreaded(const char* name, unsigned num_threads, Benchmark benchmark) {
+    ZX_DEBUG_ASSERT(enabled_);
+    auto run = [num_threads, &benchmark]() {
+      std::vector<std::thread> threads;
+      for (unsigned i = 0; i < num_threads; ++i) {
+        threads.emplace_back([num_threads, &benchmark]() {
+          for (unsigned j = 0; j < kEventsPerThreadedRun / num_threads; ++j) {
+            benchmark();
+          }
+        });
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+    };
+
+    async::Loop loop(&kAsyncLoopConfigNoAttachToCurrentThread);
+    BenchmarkHandler handler(&loop, spec_->mode, spec_->buffer_size);
+
+    loop.StartThread("trace-engine loop", nullptr);
+
+    RunAndMeasure(
+        name, spec_->name, 1, run, [&handler]() { handler.Start(); },
+        [&handler]() { handler.Stop(); });
+
+    loop.Quit();
+    loop.JoinThreads();
+  }
+
   // Utility to print a line of text in the same format as RunAndMeasure.
   void Print(const char* fmt, ...) {
     fputs(kTestOutputPrefix, stdout);
@@ -63,6 +100,10 @@ class Runner {
   }
 
  private:
+  // The warm-up iterations all write to the same buffer, which must not
+  // fill in oneshot mode.
+  static constexpr unsigned kEventsPerThreadedRun = kDefaultRunIterations / kWarmUpIterations;
+
   const bool enabled_;
   // nullptr if |!enabled_|.
   const BenchmarkSpec* spec_;
@@ -191,6 +232,15 @@ static void RunBenchmarks(bool tracing_enabled, const BenchmarkSpec* spec) {
   RUN_TEST(zero_args, "0 arguments", TRACE_VTHREAD_DURATION_BEGIN, "+", enabled,
            TRACE_VTHREAD_DURATION_BEGIN("+enabled", "name", "vthread", 1, zx_ticks_get()));
 
+  if (tracing_enabled) {
+    for (unsigned num_threads : {1u, 2u, 4u, 8u}) {
+      char name[64];
+      snprintf(name, sizeof(name), "TRACE_INSTANT from %u threads", num_threads);
+      runner.RunThreaded(name, num_threads,
+                         [] { TRACE_INSTANT("+enabled", "name", TRACE_SCOPE_THREAD); });
+    }
+  }
+
   if (tracing_enabled) {
     DURATION_TEST(TRACE_DURATION_BEGIN, "-", disabled);
     DURATION_TEST(TRACE_DURATION, "-", disabled);
@@ -15,6 +15,7 @@
 #include <lib/async/wait.h>
 #include <stdatomic.h>
 #include <stdlib.h>
+#include <string.h>
 #include <zircon/assert.h>
 #include <zircon/listnode.h>
 #include <zircon/syscalls.h>
@@ -23,6 +24,13 @@
 // The port wait key associated with the dispatcher's control messages.
 #define KEY_CONTROL (0u)
 
+// The port wait key associated with the task inbox event. Like |KEY_CONTROL|, it is
+// not a valid pointer so it cannot collide with the keys of other packets.
+#define KEY_TASK_INBOX (1u)
+
+// The largest number of packets a dispatch thread takes from the port per wakeup.
+#define BATCH_SIZE (8u)
+
 static zx_time_t async_loop_now(async_dispatcher_t* dispatcher);
 static zx_status_t async_loop_begin_wait(async_dispatcher_t* dispatcher, async_wait_t* wait);
 static zx_status_t async_loop_cancel_wait(async_dispatcher_t* dispatcher, async_wait_t* wait);
@@ -77,6 +85,7 @@ typedef struct async_loop {
   async_loop_config_t config;     // immutable
   zx_handle_t port;               // immutable
   zx_handle_t timer;              // immutable
+  zx_handle_t task_event;         // immutable, signaled when the task inbox becomes non-empty
 
   _Atomic async_loop_state_t state;
   atomic_uint active_threads;  // number of active dispatch threads
@@ -84,20 +93,45 @@ typedef struct async_loop {
   mtx_t lock;                  // guards the lists and the dispatching tasks flag
   bool dispatching_tasks;      // true while the loop is busy dispatching tasks
   list_node_t wait_list;       // most recently added first
-  list_node_t task_list;       // pending tasks, earliest deadline first
+  list_node_t task_list;       // pending tasks which were due when posted, earliest deadline first
   list_node_t due_list;        // due tasks, earliest deadline first
   list_node_t thread_list;     // earliest created thread first
   list_node_t irq_list;        // list of IRQs
   list_node_t paged_vmo_list;  // most recently added first
   bool timer_armed;            // true if timer has been set and has not fired yet
+
+  // Pending tasks which were not due yet when posted, as a binary min-heap ordered by
+  // deadline and then by posting order.
+  async_task_t** timer_heap;
+  size_t timer_heap_count;
+  size_t timer_heap_capacity;
+  uint64_t timer_heap_sequence;
+
+  // Tasks which were due when posted and have not been moved to |task_list| yet,
+  // most recently posted first. Posting to it does not take |lock|.
+  _Atomic(async_task_t*) task_inbox;
+
+  // Packets which were taken from the port in a batch but not dispatched yet, oldest first.
+  // Any thread may dispatch them.
+  zx_port_packet_t* pending_packets;
+  size_t pending_head;
+  size_t pending_tail;
+  size_t pending_capacity;
+  atomic_size_t pending_count;  // pending_tail - pending_head, readable without the lock
 } async_loop_t;
 
-static zx_status_t async_loop_run_once(async_loop_t* loop, zx_time_t deadline);
+static zx_status_t async_loop_run_once(async_loop_t* loop, zx_time_t deadline, bool batch);
+static bool async_loop_take_pending_packet(async_loop_t* loop, zx_port_packet_t* packet);
+static void async_loop_add_pending_packets(async_loop_t* loop, const zx_port_packet_t* packets,
+                                           size_t count);
+static bool async_loop_cancel_pending_wait_locked(async_loop_t* loop, async_wait_t* wait);
+static zx_status_t async_loop_dispatch_port_packet(async_loop_t* loop,
+                                                   const zx_port_packet_t* packet);
 static zx_status_t async_loop_dispatch_wait(async_loop_t* loop, async_wait_t* wait,
                                             zx_status_t status, const zx_packet_signal_t* signal);
 static zx_status_t async_loop_dispatch_irq(async_loop_t* loop, async_irq_t* irq, zx_status_t status,
                                            const zx_packet_interrupt_t* interrupt);
-static zx_status_t async_loop_dispatch_tasks(async_loop_t* loop);
+static zx_status_t async_loop_dispatch_tasks(async_loop_t* loop, bool timer_fired);
 static void async_loop_dispatch_task(async_loop_t* loop, async_task_t* task, zx_status_t status);
 static zx_status_t async_loop_dispatch_packet(async_loop_t* loop, async_receiver_t* receiver,
                                               zx_status_t status, const zx_packet_user_t* data);
@@ -111,6 +145,10 @@ static zx_status_t async_loop_dispatch_paged_vmo(async_loop_t* loop, async_paged
 static zx_status_t async_loop_cancel_paged_vmo(async_paged_vmo_t* paged_vmo);
 static void async_loop_wake_threads(async_loop_t* loop);
 static void async_loop_insert_task_locked(async_loop_t* loop, async_task_t* task);
+static void async_loop_drain_task_inbox_locked(async_loop_t* loop);
+static zx_status_t async_loop_insert_timer_task_locked(async_loop_t* loop, async_task_t* task);
+static async_task_t* async_loop_peek_task_locked(async_loop_t* loop);
+static void async_loop_remove_task_locked(async_loop_t* loop, async_task_t* task);
 static void async_loop_restart_timer_locked(async_loop_t* loop);
 static void async_loop_invoke_prologue(async_loop_t* loop);
 static void async_loop_invoke_epilogue(async_loop_t* loop);
@@ -134,6 +172,13 @@ static inline async_task_t* node_to_task(list_node_t* node) {
   return FROM_NODE(async_task_t, node);
 }
 
+// Tasks in the timer heap keep their index in the heap in the first word of
+// their state, and their posting sequence number in the second, shifted left
+// and tagged with 1 to tell them apart from tasks linked in a list.
+static inline bool task_in_timer_heap(const async_task_t* task) {
+  return task->state.reserved[1] & 1u;
+}
+
 static inline async_irq_t* node_to_irq(list_node_t* node) { return FROM_NODE(async_irq_t, node); }
 
 static inline list_node_t* paged_vmo_to_node(async_paged_vmo_t* paged_vmo) {
@@ -156,6 +201,8 @@ zx_status_t async_loop_create(const async_loop_config_t* config, async_loop_t**
     return ZX_ERR_NO_MEMORY;
   atomic_init(&loop->state, ASYNC_LOOP_RUNNABLE);
   atomic_init(&loop->active_threads, 0u);
+  atomic_init(&loop->pending_count, 0u);
+  atomic_init(&loop->task_inbox, NULL);
 
   loop->dispatcher.ops = (const async_ops_t*)&async_loop_ops;
   loop->config = *config;
@@ -171,6 +218,11 @@ zx_status_t async_loop_create(const async_loop_config_t* config, async_loop_t**
       zx_port_create(config->irq_support ? ZX_PORT_BIND_TO_INTERRUPT : 0, &loop->port);
   if (status == ZX_OK)
     status = zx_timer_create(ZX_TIMER_SLACK_LATE, ZX_CLOCK_MONOTONIC, &loop->timer);
+  if (status == ZX_OK)
+    status = zx_event_create(0u, &loop->task_event);
+  if (status == ZX_OK)
+    status = zx_object_wait_async(loop->task_event, loop->port, KEY_TASK_INBOX, ZX_USER_SIGNAL_0,
+                                  ZX_WAIT_ASYNC_ONCE);
   if (status == ZX_OK) {
     *out_loop = loop;
     if (loop->config.make_default_for_current_thread) {
@@ -193,7 +245,10 @@ void async_loop_destroy(async_loop_t* loop) {
 
   zx_handle_close(loop->port);
   zx_handle_close(loop->timer);
+  zx_handle_close(loop->task_event);
   mtx_destroy(&loop->lock);
+  free(loop->pending_packets);
+  free(loop->timer_heap);
   free(loop);
 }
 
@@ -208,6 +263,12 @@ void async_loop_shutdown(async_loop_t* loop) {
   async_loop_wake_threads(loop);
   async_loop_join_threads(loop);
 
+  // Packets which were never dispatched are dropped along with the port. Their waits are still
+  // in the wait list, so they are canceled below.
+  loop->pending_head = 0u;
+  loop->pending_tail = 0u;
+  atomic_store_explicit(&loop->pending_count, 0u, memory_order_release);
+
   list_node_t* node;
   while ((node = list_remove_head(&loop->wait_list))) {
     async_wait_t* wait = node_to_wait(node);
@@ -221,8 +282,10 @@ void async_loop_shutdown(async_loop_t* loop) {
     async_task_t* task = node_to_task(node);
     async_loop_dispatch_task(loop, task, ZX_ERR_CANCELED);
   }
-  while ((node = list_remove_head(&loop->task_list))) {
-    async_task_t* task = node_to_task(node);
+  async_loop_drain_task_inbox_locked(loop);
+  async_task_t* task;
+  while ((task = async_loop_peek_task_locked(loop))) {
+    async_loop_remove_task_locked(loop, task);
     async_loop_dispatch_task(loop, task, ZX_ERR_CANCELED);
   }
   while ((node = list_remove_head(&loop->irq_list))) {
@@ -250,7 +313,9 @@ zx_status_t async_loop_run(async_loop_t* loop, zx_time_t deadline, bool once) {
   zx_status_t status;
   atomic_fetch_add_explicit(&loop->active_threads, 1u, memory_order_acq_rel);
   do {
-    status = async_loop_run_once(loop, deadline);
+    // Dequeuing a batch of packets would dispatch more than one handler per call, so only
+    // do that when running until quit or timed out.
+    status = async_loop_run_once(loop, deadline, !once);
   } while (status == ZX_OK && !once);
   atomic_fetch_sub_explicit(&loop->active_threads, 1u, memory_order_acq_rel);
   return status;
@@ -264,58 +329,163 @@ zx_status_t async_loop_run_until_idle(async_loop_t* loop) {
   return status;
 }
 
-static zx_status_t async_loop_run_once(async_loop_t* loop, zx_time_t deadline) {
+static zx_status_t async_loop_run_once(async_loop_t* loop, zx_time_t deadline, bool batch) {
   async_loop_state_t state = atomic_load_explicit(&loop->state, memory_order_acquire);
   if (state == ASYNC_LOOP_SHUTDOWN)
     return ZX_ERR_BAD_STATE;
   if (state != ASYNC_LOOP_RUNNABLE)
     return ZX_ERR_CANCELED;
 
-  zx_port_packet_t packet;
-  zx_status_t status = zx_port_wait(loop->port, deadline, &packet);
-  if (status != ZX_OK)
-    return status;
+  zx_port_packet_t packets[BATCH_SIZE];
+  if (!async_loop_take_pending_packet(loop, &packets[0])) {
+    if (batch) {
+      // Take every packet which is already queued, up to the batch size, so that a busy loop
+      // makes one syscall per batch rather than one per packet. This thread dispatches the first
+      // packet and parks the rest in the pending queue, which any thread may take from.
+      size_t count;
+      zx_status_t status = zx_port_wait_many(loop->port, deadline, packets, BATCH_SIZE, &count);
+      if (status != ZX_OK)
+        return status;
+      if (count > 1u) {
+        async_loop_add_pending_packets(loop, packets + 1, count - 1u);
+        // Threads blocked on the port do not look at the pending queue. Wake up to one of them per
+        // parked packet, so the parked packets do not wait for the handler of the first one to
+        // return.
+        uint32_t others = atomic_load_explicit(&loop->active_threads, memory_order_acquire) - 1u;
+        for (size_t i = 1u; i < count && others > 0u; i++, others--) {
+          zx_port_packet_t wake = {.key = KEY_CONTROL, .type = ZX_PKT_TYPE_USER, .status = ZX_OK};
+          status = zx_port_queue(loop->port, &wake);
+          ZX_ASSERT_MSG(status == ZX_OK, "zx_port_queue: status=%d", status);
+        }
+      }
+    } else {
+      zx_status_t status = zx_port_wait(loop->port, deadline, &packets[0]);
+      if (status != ZX_OK)
+        return status;
+    }
+  }
+
+  return async_loop_dispatch_port_packet(loop, &packets[0]);
+}
 
-  if (packet.key == KEY_CONTROL) {
+static bool async_loop_take_pending_packet(async_loop_t* loop, zx_port_packet_t* packet) {
+  if (atomic_load_explicit(&loop->pending_count, memory_order_acquire) == 0u)
+    return false;
+
+  bool taken = false;
+  mtx_lock(&loop->lock);
+  if (loop->pending_head != loop->pending_tail) {
+    *packet = loop->pending_packets[loop->pending_head++];
+    if (loop->pending_head == loop->pending_tail) {
+      loop->pending_head = 0u;
+      loop->pending_tail = 0u;
+    }
+    atomic_fetch_sub_explicit(&loop->pending_count, 1u, memory_order_release);
+    taken = true;
+  }
+  mtx_unlock(&loop->lock);
+  return taken;
+}
+
+static void async_loop_add_pending_packets(async_loop_t* loop, const zx_port_packet_t* packets,
+                                           size_t count) {
+  mtx_lock(&loop->lock);
+  for (size_t i = 0u; i < count; i++) {
+    // Wake-up packets are meant for the other threads blocked on the port, so give them back.
+    if (packets[i].key == KEY_CONTROL && packets[i].type == ZX_PKT_TYPE_USER) {
+      zx_status_t status = zx_port_queue(loop->port, &packets[i]);
+      ZX_ASSERT_MSG(status == ZX_OK, "zx_port_queue: status=%d", status);
+      continue;
+    }
+
+    if (loop->pending_tail == loop->pending_capacity) {
+      size_t pending = loop->pending_tail - loop->pending_head;
+      if (loop->pending_head != 0u) {
+        memmove(loop->pending_packets, loop->pending_packets + loop->pending_head,
+                pending * sizeof(zx_port_packet_t));
+      } else {
+        size_t capacity = loop->pending_capacity ? loop->pending_capacity * 2u : BATCH_SIZE;
+        zx_port_packet_t* pending_packets =
+            realloc(loop->pending_packets, capacity * sizeof(zx_port_packet_t));
+        // The packets have already been taken from the port, so there is no way to put them back.
+        ZX_ASSERT_MSG(pending_packets, "out of memory for %zu pending packets", capacity);
+        loop->pending_packets = pending_packets;
+        loop->pending_capacity = capacity;
+      }
+      loop->pending_head = 0u;
+      loop->pending_tail = pending;
+    }
+    loop->pending_packets[loop->pending_tail++] = packets[i];
+    atomic_fetch_add_explicit(&loop->pending_count, 1u, memory_order_release);
+  }
+  mtx_unlock(&loop->lock);
+}
+
+static bool async_loop_cancel_pending_wait_locked(async_loop_t* loop, async_wait_t* wait) {
+  for (size_t i = loop->pending_head; i < loop->pending_tail; i++) {
+    const zx_port_packet_t* packet = &loop->pending_packets[i];
+    if (packet->key == (uintptr_t)wait && packet->type == ZX_PKT_TYPE_SIGNAL_ONE) {
+      memmove(loop->pending_packets + i, loop->pending_packets + i + 1u,
+              (loop->pending_tail - i - 1u) * sizeof(zx_port_packet_t));
+      loop->pending_tail--;
+      atomic_fetch_sub_explicit(&loop->pending_count, 1u, memory_order_release);
+      return true;
+    }
+  }
+  return false;
+}
+
+static zx_status_t async_loop_dispatch_port_packet(async_loop_t* loop,
+                                                   const zx_port_packet_t* packet) {
+  if (packet->key == KEY_CONTROL) {
     // Handle wake-up packets.
-    if (packet.type == ZX_PKT_TYPE_USER)
+    if (packet->type == ZX_PKT_TYPE_USER)
       return ZX_OK;
 
     // Handle task timer expirations.
-    if (packet.type == ZX_PKT_TYPE_SIGNAL_ONE && packet.signal.observed & ZX_TIMER_SIGNALED) {
-      return async_loop_dispatch_tasks(loop);
+    if (packet->type == ZX_PKT_TYPE_SIGNAL_ONE && packet->signal.observed & ZX_TIMER_SIGNALED) {
+      return async_loop_dispatch_tasks(loop, true);
     }
+  } else if (packet->key == KEY_TASK_INBOX) {
+    // Handle tasks posted to the inbox.  Rearm the event before taking the
+    // tasks, so that a task posted after that raises another packet.
+    zx_status_t status = zx_object_signal(loop->task_event, ZX_USER_SIGNAL_0, 0u);
+    ZX_ASSERT_MSG(status == ZX_OK, "zx_object_signal: status=%d", status);
+    status = zx_object_wait_async(loop->task_event, loop->port, KEY_TASK_INBOX, ZX_USER_SIGNAL_0,
+                                  ZX_WAIT_ASYNC_ONCE);
+    ZX_ASSERT_MSG(status == ZX_OK, "zx_object_wait_async: status=%d", status);
+    return async_loop_dispatch_tasks(loop, false);
   } else {
     // Handle wait completion packets.
-    if (packet.type == ZX_PKT_TYPE_SIGNAL_ONE) {
-      async_wait_t* wait = (void*)(uintptr_t)packet.key;
+    if (packet->type == ZX_PKT_TYPE_SIGNAL_ONE) {
+      async_wait_t* wait = (void*)(uintptr_t)packet->key;
       mtx_lock(&loop->lock);
       list_delete(wait_to_node(wait));
       mtx_unlock(&loop->lock);
-      return async_loop_dispatch_wait(loop, wait, packet.status, &packet.signal);
+      return async_loop_dispatch_wait(loop, wait, packet->status, &packet->signal);
     }
 
     // Handle queued user packets.
-    if (packet.type == ZX_PKT_TYPE_USER) {
-      async_receiver_t* receiver = (void*)(uintptr_t)packet.key;
-      return async_loop_dispatch_packet(loop, receiver, packet.status, &packet.user);
+    if (packet->type == ZX_PKT_TYPE_USER) {
+      async_receiver_t* receiver = (void*)(uintptr_t)packet->key;
+      return async_loop_dispatch_packet(loop, receiver, packet->status, &packet->user);
     }
 
     // Handle guest bell trap packets.
-    if (packet.type == ZX_PKT_TYPE_GUEST_BELL) {
-      async_guest_bell_trap_t* trap = (void*)(uintptr_t)packet.key;
-      return async_loop_dispatch_guest_bell_trap(loop, trap, packet.status, &packet.guest_bell);
+    if (packet->type == ZX_PKT_TYPE_GUEST_BELL) {
+      async_guest_bell_trap_t* trap = (void*)(uintptr_t)packet->key;
+      return async_loop_dispatch_guest_bell_trap(loop, trap, packet->status, &packet->guest_bell);
     }
 
     // Handle interrupt packets.
-    if (packet.type == ZX_PKT_TYPE_INTERRUPT) {
-      async_irq_t* irq = (void*)(uintptr_t)packet.key;
-      return async_loop_dispatch_irq(loop, irq, packet.status, &packet.interrupt);
+    if (packet->type == ZX_PKT_TYPE_INTERRUPT) {
+      async_irq_t* irq = (void*)(uintptr_t)packet->key;
+      return async_loop_dispatch_irq(loop, irq, packet->status, &packet->interrupt);
     }
     // Handle pager packets.
-    if (packet.type == ZX_PKT_TYPE_PAGE_REQUEST) {
-      async_paged_vmo_t* paged_vmo = (void*)(uintptr_t)packet.key;
-      return async_loop_dispatch_paged_vmo(loop, paged_vmo, packet.status, &packet.page_request);
+    if (packet->type == ZX_PKT_TYPE_PAGE_REQUEST) {
+      async_paged_vmo_t* paged_vmo = (void*)(uintptr_t)packet->key;
+      return async_loop_dispatch_paged_vmo(loop, paged_vmo, packet->status, &packet->page_request);
     }
   }
 
@@ -356,12 +526,14 @@ static zx_status_t async_loop_dispatch_irq(async_loop_t* loop, async_irq_t* irq,
   return ZX_OK;
 }
 
-static zx_status_t async_loop_dispatch_tasks(async_loop_t* loop) {
+static zx_status_t async_loop_dispatch_tasks(async_loop_t* loop, bool timer_fired) {
   // Dequeue and dispatch one task at a time in case an earlier task wants
   // to cancel a later task which has also come due.  At most one thread
   // can dispatch tasks at any given moment (to preserve serial ordering).
   // Timer restarts are suppressed until we run out of tasks to dispatch.
   mtx_lock(&loop->lock);
+  if (timer_fired)
+    loop->timer_armed = false;
   if (!loop->dispatching_tasks) {
     loop->dispatching_tasks = true;
 
@@ -370,21 +542,12 @@ static zx_status_t async_loop_dispatch_tasks(async_loop_t* loop) {
     // we would like to process in order.
     list_node_t* node;
     if (list_is_empty(&loop->due_list)) {
+      async_loop_drain_task_inbox_locked(loop);
       zx_time_t due_time = async_loop_now((async_dispatcher_t*)loop);
-      list_node_t* tail = NULL;
-      list_for_every(&loop->task_list, node) {
-        if (node_to_task(node)->deadline > due_time)
-          break;
-        tail = node;
-      }
-      if (tail) {
-        list_node_t* head = loop->task_list.next;
-        loop->task_list.next = tail->next;
-        tail->next->prev = &loop->task_list;
-        loop->due_list.next = head;
-        head->prev = &loop->due_list;
-        loop->due_list.prev = tail;
-        tail->next = &loop->due_list;
+      async_task_t* task;
+      while ((task = async_loop_peek_task_locked(loop)) && task->deadline <= due_time) {
+        async_loop_remove_task_locked(loop, task);
+        list_add_tail(&loop->due_list, task_to_node(task));
       }
     }
 
@@ -404,8 +567,10 @@ static zx_status_t async_loop_dispatch_tasks(async_loop_t* loop) {
         break;
     }
 
+    // Tasks posted to the inbox meanwhile may have had their packet handled
+    // by another thread which found us busy, so pick them up now.
     loop->dispatching_tasks = false;
-    loop->timer_armed = false;
+    async_loop_drain_task_inbox_locked(loop);
     async_loop_restart_timer_locked(loop);
   }
   mtx_unlock(&loop->lock);
@@ -536,8 +701,11 @@ static zx_status_t async_loop_cancel_wait(async_dispatcher_t* async, async_wait_
 
   // Next, cancel the wait.  This may be racing with another thread that
   // has read the wait's packet but not yet dispatched it.  So if we fail
-  // to cancel then we assume we lost the race.
+  // to cancel then we assume we lost the race.  A packet which was taken
+  // from the port in a batch and is still pending can be canceled though.
   zx_status_t status = zx_port_cancel(loop->port, wait->object, (uintptr_t)wait);
+  if (status == ZX_ERR_NOT_FOUND && async_loop_cancel_pending_wait_locked(loop, wait))
+    status = ZX_OK;
   if (status == ZX_OK) {
     list_delete(node);
   } else {
@@ -556,16 +724,33 @@ static zx_status_t async_loop_post_task(async_dispatcher_t* async, async_task_t*
   if (atomic_load_explicit(&loop->state, memory_order_acquire) == ASYNC_LOOP_SHUTDOWN)
     return ZX_ERR_BAD_STATE;
 
+  if (task->deadline <= async_loop_now(async)) {
+    // The task is already due, so push it to the inbox without taking the lock.
+    // Only the push which finds the inbox empty needs to wake the loop; later
+    // ones are picked up along with it.
+    task->state.reserved[1] = 0u;
+    async_task_t* next = atomic_load_explicit(&loop->task_inbox, memory_order_relaxed);
+    do {
+      task->state.reserved[0] = (uintptr_t)next;
+    } while (!atomic_compare_exchange_weak_explicit(&loop->task_inbox, &next, task,
+                                                    memory_order_release, memory_order_relaxed));
+    if (!next) {
+      zx_status_t status = zx_object_signal(loop->task_event, 0u, ZX_USER_SIGNAL_0);
+      ZX_ASSERT_MSG(status == ZX_OK, "zx_object_signal: status=%d", status);
+    }
+    return ZX_OK;
+  }
+
   mtx_lock(&loop->lock);
 
-  async_loop_insert_task_locked(loop, task);
-  if (!loop->dispatching_tasks && task_to_node(task)->prev == &loop->task_list) {
+  zx_status_t status = async_loop_insert_timer_task_locked(loop, task);
+  if (status == ZX_OK && !loop->dispatching_tasks && async_loop_peek_task_locked(loop) == task) {
     // Task inserted at head.  Earliest deadline changed.
     async_loop_restart_timer_locked(loop);
   }
 
   mtx_unlock(&loop->lock);
-  return ZX_OK;
+  return status;
 }
 
 static zx_status_t async_loop_cancel_task(async_dispatcher_t* async, async_task_t* task) {
@@ -577,22 +762,21 @@ static zx_status_t async_loop_cancel_task(async_dispatcher_t* async, async_task_
   // destroyed in case the client is counting on the handler not being
   // invoked again past this point.  Also, the task we're removing here
   // might be present in the dispatcher's |due_list| if it is pending
-  // dispatch instead of in the loop's |task_list| as usual.  The same
-  // logic works in both cases.
+  // dispatch, or in the inbox if it has just been posted, instead of in
+  // the loop's |task_list| or timer heap as usual.  Draining the inbox
+  // first lets the same logic work in all cases.
 
   mtx_lock(&loop->lock);
-  list_node_t* node = task_to_node(task);
-  if (!list_in_list(node)) {
+  async_loop_drain_task_inbox_locked(loop);
+  if (!task_in_timer_heap(task) && !list_in_list(task_to_node(task))) {
     mtx_unlock(&loop->lock);
     return ZX_ERR_NOT_FOUND;
   }
 
-  // Determine whether the head task was canceled and following task has
-  // a later deadline.  If so, we will bump the timer along to that deadline.
-  bool must_restart =
-      !loop->dispatching_tasks && node->prev == &loop->task_list &&
-      (node->next == &loop->task_list || node_to_task(node->next)->deadline > task->deadline);
-  list_delete(node);
+  // Determine whether the head task was canceled.  If so, we will bump the
+  // timer along to the deadline of the following task.
+  bool must_restart = !loop->dispatching_tasks && async_loop_peek_task_locked(loop) == task;
+  async_loop_remove_task_locked(loop, task);
   if (must_restart)
     async_loop_restart_timer_locked(loop);
 
@@ -679,10 +863,9 @@ static zx_status_t async_loop_cancel_paged_vmo(async_paged_vmo_t* paged_vmo) {
 }
 
 static void async_loop_insert_task_locked(async_loop_t* loop, async_task_t* task) {
-  // TODO(ZX-976): We assume that tasks are inserted in quasi-monotonic order and
-  // that insertion into the task queue will typically take no more than a few steps.
-  // If this assumption proves false and the cost of insertion becomes a problem, we
-  // should consider using a more efficient representation for maintaining order.
+  // Tasks only get here from the inbox, with deadlines no later than the time
+  // they were posted, so insertion typically takes no more than a few steps
+  // from the tail.
   list_node_t* node;
   for (node = loop->task_list.prev; node != &loop->task_list; node = node->prev) {
     if (task->deadline >= node_to_task(node)->deadline)
@@ -691,12 +874,113 @@ static void async_loop_insert_task_locked(async_loop_t* loop, async_task_t* task
   list_add_after(node, task_to_node(task));
 }
 
+static void async_loop_drain_task_inbox_locked(async_loop_t* loop) {
+  async_task_t* task = atomic_exchange_explicit(&loop->task_inbox, NULL, memory_order_acquire);
+
+  // Reverse the inbox to insert the tasks in the order they were posted.
+  async_task_t* posted = NULL;
+  while (task) {
+    async_task_t* next = (async_task_t*)task->state.reserved[0];
+    task->state.reserved[0] = (uintptr_t)posted;
+    posted = task;
+    task = next;
+  }
+  while (posted) {
+    async_task_t* next = (async_task_t*)posted->state.reserved[0];
+    async_loop_insert_task_locked(loop, posted);
+    posted = next;
+  }
+}
+
+static inline bool timer_heap_less(const async_task_t* a, const async_task_t* b) {
+  return a->deadline < b->deadline ||
+         (a->deadline == b->deadline && a->state.reserved[1] < b->state.reserved[1]);
+}
+
+static void async_loop_timer_heap_set_locked(async_loop_t* loop, size_t index,
+                                             async_task_t* task) {
+  loop->timer_heap[index] = task;
+  task->state.reserved[0] = index;
+}
+
+static void async_loop_timer_heap_sift_up_locked(async_loop_t* loop, size_t index) {
+  async_task_t* task = loop->timer_heap[index];
+  while (index > 0u) {
+    size_t parent = (index - 1u) / 2u;
+    if (!timer_heap_less(task, loop->timer_heap[parent]))
+      break;
+    async_loop_timer_heap_set_locked(loop, index, loop->timer_heap[parent]);
+    index = parent;
+  }
+  async_loop_timer_heap_set_locked(loop, index, task);
+}
+
+static void async_loop_timer_heap_sift_down_locked(async_loop_t* loop, size_t index) {
+  async_task_t* task = loop->timer_heap[index];
+  for (;;) {
+    size_t child = 2u * index + 1u;
+    if (child >= loop->timer_heap_count)
+      break;
+    if (child + 1u < loop->timer_heap_count &&
+        timer_heap_less(loop->timer_heap[child + 1u], loop->timer_heap[child]))
+      child++;
+    if (!timer_heap_less(loop->timer_heap[child], task))
+      break;
+    async_loop_timer_heap_set_locked(loop, index, loop->timer_heap[child]);
+    index = child;
+  }
+  async_loop_timer_heap_set_locked(loop, index, task);
+}
+
+static zx_status_t async_loop_insert_timer_task_locked(async_loop_t* loop, async_task_t* task) {
+  if (loop->timer_heap_count == loop->timer_heap_capacity) {
+    size_t capacity = loop->timer_heap_capacity ? loop->timer_heap_capacity * 2u : 16u;
+    async_task_t** timer_heap = realloc(loop->timer_heap, capacity * sizeof(async_task_t*));
+    if (!timer_heap)
+      return ZX_ERR_NO_MEMORY;
+    loop->timer_heap = timer_heap;
+    loop->timer_heap_capacity = capacity;
+  }
+
+  task->state.reserved[1] = (loop->timer_heap_sequence++ << 1) | 1u;
+  async_loop_timer_heap_set_locked(loop, loop->timer_heap_count++, task);
+  async_loop_timer_heap_sift_up_locked(loop, task->state.reserved[0]);
+  return ZX_OK;
+}
+
+static async_task_t* async_loop_peek_task_locked(async_loop_t* loop) {
+  list_node_t* head = list_peek_head(&loop->task_list);
+  async_task_t* task = head ? node_to_task(head) : NULL;
+  async_task_t* timer_task = loop->timer_heap_count ? loop->timer_heap[0] : NULL;
+  // On a tie, the timer task was posted first: it was not due yet when posted,
+  // while the other task was.
+  if (!task || (timer_task && timer_task->deadline <= task->deadline))
+    return timer_task;
+  return task;
+}
+
+static void async_loop_remove_task_locked(async_loop_t* loop, async_task_t* task) {
+  if (!task_in_timer_heap(task)) {
+    list_delete(task_to_node(task));
+    return;
+  }
+
+  size_t index = task->state.reserved[0];
+  async_task_t* last = loop->timer_heap[--loop->timer_heap_count];
+  if (last != task) {
+    async_loop_timer_heap_set_locked(loop, index, last);
+    async_loop_timer_heap_sift_down_locked(loop, index);
+    async_loop_timer_heap_sift_up_locked(loop, last->state.reserved[0]);
+  }
+  task->state.reserved[0] = 0u;
+  task->state.reserved[1] = 0u;
+}
+
 static zx_time_t async_loop_next_deadline_locked(async_loop_t* loop) {
   if (list_is_empty(&loop->due_list)) {
-    list_node_t* head = list_peek_head(&loop->task_list);
-    if (!head)
+    async_task_t* task = async_loop_peek_task_locked(loop);
+    if (!task)
       return ZX_TIME_INFINITE;
-    async_task_t* task = node_to_task(head);
     if (task->deadline == ZX_TIME_INFINITE)
       return ZX_TIME_INFINITE;
     else
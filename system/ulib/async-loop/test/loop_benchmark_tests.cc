@@ -0,0 +1,177 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <lib/async-loop/cpp/loop.h>
+#include <lib/async-loop/default.h>
+#include <lib/async/receiver.h>
+#include <lib/async/task.h>
+#include <lib/async/time.h>
+#include <lib/zx/clock.h>
+#include <lib/zx/time.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <zxtest/zxtest.h>
+
+namespace {
+
+// The number of packets queued before the loop runs, and the number of rounds of that.
+constexpr uint64_t kPacketsPerRound = 256;
+constexpr int kRounds = 200;
+
+class CountingReceiver : public async_receiver_t {
+ public:
+  CountingReceiver() : async_receiver_t{{ASYNC_STATE_INIT}, &CountingReceiver::CallHandler} {}
+
+  uint64_t count() const { return count_.load(); }
+
+ private:
+  static void CallHandler(async_dispatcher_t* dispatcher, async_receiver_t* receiver,
+                          zx_status_t status, const zx_packet_user_t* data) {
+    static_cast<CountingReceiver*>(receiver)->count_++;
+  }
+
+  std::atomic<uint64_t> count_ = 0;
+};
+
+void PrintRate(const char* name, uint64_t packets, zx::duration elapsed) {
+  printf("async-loop: %s: %lu packets in %ld us, %lu packets/s\n", name, packets,
+         elapsed.to_usecs(), packets * ZX_SEC(1) / elapsed.get());
+}
+
+// Dispatches queued packets one per zx_port_wait, by running the loop once per packet.
+TEST(LoopBenchmark, DispatchOnePacketPerWait) {
+  async::Loop loop(&kAsyncLoopConfigNoAttachToCurrentThread);
+  CountingReceiver receiver;
+
+  zx::time start = zx::clock::get_monotonic();
+  for (int round = 0; round < kRounds; round++) {
+    for (uint64_t i = 0; i < kPacketsPerRound; i++) {
+      ASSERT_OK(async_queue_packet(loop.dispatcher(), &receiver, nullptr));
+    }
+    for (uint64_t i = 0; i < kPacketsPerRound; i++) {
+      ASSERT_OK(loop.Run(zx::time::infinite(), true));
+    }
+  }
+  zx::duration elapsed = zx::clock::get_monotonic() - start;
+
+  EXPECT_EQ(kRounds * kPacketsPerRound, receiver.count());
+  PrintRate("one packet per wait", receiver.count(), elapsed);
+}
+
+// Dispatches queued packets in batches, by running the loop until it is idle.
+TEST(LoopBenchmark, DispatchBatchedPackets) {
+  async::Loop loop(&kAsyncLoopConfigNoAttachToCurrentThread);
+  CountingReceiver receiver;
+
+  zx::time start = zx::clock::get_monotonic();
+  for (int round = 0; round < kRounds; round++) {
+    for (uint64_t i = 0; i < kPacketsPerRound; i++) {
+      ASSERT_OK(async_queue_packet(loop.dispatcher(), &receiver, nullptr));
+    }
+    ASSERT_OK(loop.RunUntilIdle());
+  }
+  zx::duration elapsed = zx::clock::get_monotonic() - start;
+
+  EXPECT_EQ(kRounds * kPacketsPerRound, receiver.count());
+  PrintRate("batched", receiver.count(), elapsed);
+}
+
+// Dispatches packets on several loop threads while they are being queued.
+TEST(LoopBenchmark, DispatchOnThreads) {
+  constexpr int kThreads = 4;
+  async::Loop loop(&kAsyncLoopConfigNoAttachToCurrentThread);
+  CountingReceiver receiver;
+  for (int i = 0; i < kThreads; i++) {
+    ASSERT_OK(loop.StartThread());
+  }
+
+  constexpr uint64_t kPackets = kRounds * kPacketsPerRound;
+  zx::time start = zx::clock::get_monotonic();
+  for (uint64_t i = 0; i < kPackets;) {
+    zx_status_t status = async_queue_packet(loop.dispatcher(), &receiver, nullptr);
+    if (status == ZX_ERR_SHOULD_WAIT) {
+      // The port is full; let the threads catch up.
+      zx::nanosleep(zx::deadline_after(zx::usec(10)));
+      continue;
+    }
+    ASSERT_OK(status);
+    i++;
+  }
+  while (receiver.count() < kPackets) {
+    zx::nanosleep(zx::deadline_after(zx::usec(10)));
+  }
+  zx::duration elapsed = zx::clock::get_monotonic() - start;
+
+  loop.Shutdown();
+  EXPECT_EQ(kPackets, receiver.count());
+  PrintRate("4 threads", receiver.count(), elapsed);
+}
+
+class CountingTask : public async_task_t {
+ public:
+  explicit CountingTask(std::atomic<uint64_t>* count)
+      : async_task_t{{ASYNC_STATE_INIT}, &CountingTask::CallHandler, ZX_TIME_INFINITE},
+        count_(count) {}
+
+ private:
+  static void CallHandler(async_dispatcher_t* dispatcher, async_task_t* task, zx_status_t status) {
+    CountingTask* self = static_cast<CountingTask*>(task);
+    self->count_->fetch_add(1);
+    delete self;
+  }
+
+  std::atomic<uint64_t>* count_;
+};
+
+// Posts tasks which are already due from several threads at once, to a loop running on several
+// threads, and measures how long it takes until all of them have run.
+TEST(LoopBenchmark, PostTasksFromThreads) {
+  constexpr int kLoopThreads = 4;
+  constexpr int kPosterThreads = 4;
+  constexpr uint64_t kTasksPerThread = kRounds * kPacketsPerRound / kPosterThreads;
+  async::Loop loop(&kAsyncLoopConfigNoAttachToCurrentThread);
+  for (int i = 0; i < kLoopThreads; i++) {
+    ASSERT_OK(loop.StartThread());
+  }
+
+  std::atomic<uint64_t> count = 0;
+  std::atomic<uint64_t> failures = 0;
+  zx::time start = zx::clock::get_monotonic();
+  std::vector<std::thread> posters;
+  for (int i = 0; i < kPosterThreads; i++) {
+    posters.emplace_back([&loop, &count, &failures]() {
+      for (uint64_t j = 0; j < kTasksPerThread; j++) {
+        auto task = std::make_unique<CountingTask>(&count);
+        task->deadline = async_now(loop.dispatcher());
+        if (async_post_task(loop.dispatcher(), task.get()) != ZX_OK) {
+          failures++;
+          continue;
+        }
+        task.release();
+      }
+    });
+  }
+  for (auto& poster : posters) {
+    poster.join();
+  }
+  zx::duration posted = zx::clock::get_monotonic() - start;
+  while (count.load() < kPosterThreads * kTasksPerThread) {
+    zx::nanosleep(zx::deadline_after(zx::usec(10)));
+  }
+  zx::duration elapsed = zx::clock::get_monotonic() - start;
+
+  loop.Shutdown();
+  EXPECT_EQ(0u, failures.load());
+  EXPECT_EQ(kPosterThreads * kTasksPerThread, count.load());
+  printf("async-loop: %lu tasks posted from %d threads in %ld us, %lu posts/s, all run in %ld us\n",
+         count.load(), kPosterThreads, posted.to_usecs(), count.load() * ZX_SEC(1) / posted.get(),
+         elapsed.to_usecs());
+}
+
+}  // namespace
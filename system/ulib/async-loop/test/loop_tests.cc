@@ -868,6 +868,80 @@ TEST(Loop, TaskShutdown) {
   EXPECT_EQ(0u, task8.run_count, "run count 8");
 }
 
+// Records the order in which tasks run.
+class OrderedTask : public TestTask {
+ public:
+  explicit OrderedTask(uint32_t* counter) : counter_(counter) {}
+
+  uint32_t order = 0u;
+
+ protected:
+  void Handle(async_dispatcher_t* dispatcher, zx_status_t status) override {
+    TestTask::Handle(dispatcher, status);
+    order = ++*counter_;
+  }
+
+ private:
+  uint32_t* counter_;
+};
+
+TEST(Loop, TasksRunInDeadlineOrder) {
+  async::Loop loop(&kAsyncLoopConfigNoAttachToCurrentThread);
+
+  zx::time start_time = async::Now(loop.dispatcher());
+  uint32_t counter = 0u;
+  OrderedTask task1(&counter);  // due now
+  OrderedTask task2(&counter);  // delayed, posted last
+  OrderedTask task3(&counter);  // delayed, same deadline as |task4|
+  OrderedTask task4(&counter);  // delayed
+  OrderedTask task5(&counter);  // delayed, earliest
+  OrderedTask task6(&counter);  // due now, posted after |task1|
+
+  EXPECT_EQ(ZX_OK, task1.PostForTime(loop.dispatcher(), start_time), "post 1");
+  EXPECT_EQ(ZX_OK, task3.PostForTime(loop.dispatcher(), start_time + zx::msec(3)), "post 3");
+  EXPECT_EQ(ZX_OK, task4.PostForTime(loop.dispatcher(), start_time + zx::msec(3)), "post 4");
+  EXPECT_EQ(ZX_OK, task5.PostForTime(loop.dispatcher(), start_time + zx::msec(1)), "post 5");
+  EXPECT_EQ(ZX_OK, task2.PostForTime(loop.dispatcher(), start_time + zx::msec(5)), "post 2");
+  EXPECT_EQ(ZX_OK, task6.PostForTime(loop.dispatcher(), start_time), "post 6");
+
+  EXPECT_EQ(ZX_ERR_TIMED_OUT, loop.Run(start_time + zx::msec(10)), "run loop");
+  EXPECT_EQ(1u, task1.order, "order 1");
+  EXPECT_EQ(2u, task6.order, "order 6");
+  EXPECT_EQ(3u, task5.order, "order 5");
+  EXPECT_EQ(4u, task3.order, "order 3");
+  EXPECT_EQ(5u, task4.order, "order 4");
+  EXPECT_EQ(6u, task2.order, "order 2");
+
+  loop.Shutdown();
+}
+
+TEST(Loop, TaskCanceledBeforeRunning) {
+  async::Loop loop(&kAsyncLoopConfigNoAttachToCurrentThread);
+
+  zx::time start_time = async::Now(loop.dispatcher());
+  TestTask task1;  // due now
+  TestTask task2;  // delayed
+  TestTask task3;  // due now, canceled
+  TestTask task4;  // delayed, canceled
+
+  EXPECT_EQ(ZX_OK, task1.PostForTime(loop.dispatcher(), start_time), "post 1");
+  EXPECT_EQ(ZX_OK, task2.PostForTime(loop.dispatcher(), start_time + zx::msec(1)), "post 2");
+  EXPECT_EQ(ZX_OK, task3.PostForTime(loop.dispatcher(), start_time), "post 3");
+  EXPECT_EQ(ZX_OK, task4.PostForTime(loop.dispatcher(), start_time + zx::msec(1)), "post 4");
+
+  EXPECT_EQ(ZX_OK, task3.Cancel(loop.dispatcher()), "cancel 3");
+  EXPECT_EQ(ZX_OK, task4.Cancel(loop.dispatcher()), "cancel 4");
+  EXPECT_EQ(ZX_ERR_NOT_FOUND, task3.Cancel(loop.dispatcher()), "cancel 3, again");
+
+  EXPECT_EQ(ZX_ERR_TIMED_OUT, loop.Run(start_time + zx::msec(5)), "run loop");
+  EXPECT_EQ(1u, task1.run_count, "run count 1");
+  EXPECT_EQ(1u, task2.run_count, "run count 2");
+  EXPECT_EQ(0u, task3.run_count, "run count 3");
+  EXPECT_EQ(0u, task4.run_count, "run count 4");
+
+  loop.Shutdown();
+}
+
 TEST(Loop, Receiver) {
   const zx_packet_user_t data1{.u64 = {11, 12, 13, 14}};
   const zx_packet_user_t data2{.u64 = {21, 22, 23, 24}};
@@ -911,6 +985,79 @@ TEST(Loop, ReceiverShutdown) {
   EXPECT_EQ(0u, receiver.run_count, "run count 1");
 }
 
+class QuitReceiver : public TestReceiver {
+ public:
+  QuitReceiver() = default;
+
+ protected:
+  void Handle(async_dispatcher_t* dispatcher, zx_status_t status,
+              const zx_packet_user_t* data) override {
+    TestReceiver::Handle(dispatcher, status, data);
+    async_loop_quit(async_loop_from_dispatcher(dispatcher));
+  }
+};
+
+TEST(Loop, ReceiverQuitKeepsRemainingPackets) {
+  async::Loop loop(&kAsyncLoopConfigNoAttachToCurrentThread);
+
+  // The loop takes all of these packets from the port at once, so the ones left over when the
+  // handler quits must still be delivered by the next run.
+  QuitReceiver receiver;
+  for (int i = 0; i < 3; i++) {
+    EXPECT_OK(receiver.QueuePacket(loop.dispatcher(), nullptr));
+  }
+
+  EXPECT_EQ(ZX_ERR_CANCELED, loop.Run());
+  EXPECT_EQ(1u, receiver.run_count);
+
+  for (uint32_t expected = 2u; expected <= 3u; expected++) {
+    EXPECT_OK(loop.ResetQuit());
+    EXPECT_EQ(ZX_ERR_CANCELED, loop.Run());
+    EXPECT_EQ(expected, receiver.run_count);
+  }
+
+  EXPECT_OK(loop.ResetQuit());
+  EXPECT_OK(loop.RunUntilIdle());
+  EXPECT_EQ(3u, receiver.run_count);
+}
+
+class CancelOtherWait : public TestWait {
+ public:
+  CancelOtherWait(zx_handle_t object, zx_signals_t trigger) : TestWait(object, trigger) {}
+
+  CancelOtherWait* other = nullptr;
+  zx_status_t cancel_result = ZX_ERR_INTERNAL;
+
+ protected:
+  void Handle(async_dispatcher_t* dispatcher, zx_status_t status,
+              const zx_packet_signal_t* signal) override {
+    TestWait::Handle(dispatcher, status, signal);
+    cancel_result = other->Cancel(dispatcher);
+  }
+};
+
+TEST(Loop, WaitCanceledAfterPacketDequeued) {
+  async::Loop loop(&kAsyncLoopConfigNoAttachToCurrentThread);
+
+  zx::event event;
+  ASSERT_OK(zx::event::create(0u, &event));
+
+  CancelOtherWait wait1(event.get(), ZX_USER_SIGNAL_0);
+  CancelOtherWait wait2(event.get(), ZX_USER_SIGNAL_0);
+  wait1.other = &wait2;
+  wait2.other = &wait1;
+  ASSERT_OK(wait1.Begin(loop.dispatcher()));
+  ASSERT_OK(wait2.Begin(loop.dispatcher()));
+
+  // Both packets are queued before the loop runs, so they are dequeued together. Whichever
+  // handler runs first must still be able to cancel the other wait.
+  ASSERT_OK(event.signal(0u, ZX_USER_SIGNAL_0));
+  EXPECT_OK(loop.RunUntilIdle());
+  EXPECT_EQ(1u, wait1.run_count + wait2.run_count);
+  CancelOtherWait& ran = wait1.run_count ? wait1 : wait2;
+  EXPECT_OK(ran.cancel_result);
+}
+
 TEST(Loop, PageVmoShutdown) {
   async::Loop loop(&kAsyncLoopConfigNoAttachToCurrentThread);
   EXPECT_EQ(ASYNC_LOOP_RUNNABLE, loop.GetState(), "loop runnable");
@@ -130,6 +130,26 @@ zx_status_t BlobLoader::LoadBlob(uint32_t node_index, fzl::OwnedVmoMapper* data_
   return ZX_OK;
 }
 
+zx_status_t BlobLoader::LoadMerkleVerifier(uint32_t node_index, fzl::OwnedVmoMapper* merkle_out,
+                                           std::unique_ptr<BlobVerifier>* verifier_out) {
+  ZX_DEBUG_ASSERT(scratch_vmo_.vmo().is_valid());
+  const InodePtr inode = node_finder_->GetNode(node_index);
+  // See the comment in LoadBlob().
+  ZX_ASSERT(inode->header.IsInode() && inode->header.IsAllocated());
+
+  TRACE_DURATION("blobfs", "BlobLoader::LoadMerkleVerifier", "blob_size", inode->blob_size);
+
+  fzl::OwnedVmoMapper merkle_mapper;
+  zx_status_t status;
+  if ((status = InitMerkleVerifier(node_index, *inode, &merkle_mapper, verifier_out)) != ZX_OK) {
+    return status;
+  }
+  if (merkle_mapper.vmo().is_valid()) {
+    *merkle_out = std::move(merkle_mapper);
+  }
+  return ZX_OK;
+}
+
 zx_status_t BlobLoader::LoadBlobPaged(uint32_t node_index,
                                       std::unique_ptr<PageWatcher>* page_watcher_out,
                                       fzl::OwnedVmoMapper* data_out,
@@ -76,6 +76,17 @@ class BlobLoader {
   zx_status_t LoadBlobPaged(uint32_t node_index, std::unique_ptr<PageWatcher>* page_watcher_out,
                             fzl::OwnedVmoMapper* data_out, fzl::OwnedVmoMapper* merkle_out);
 
+  // Loads only the merkle tree for the blob with index |node_index|, for callers which read and
+  // verify ranges of the blob's data themselves.
+  //
+  // |merkle_out| will be a VMO containing the merkle tree of the blob, which must outlive
+  // |verifier_out|. For small blobs, there may be no merkle tree, in which case no VMO is
+  // returned.
+  //
+  // This method verifies the same properties of the merkle tree as |LoadBlobPaged()|.
+  zx_status_t LoadMerkleVerifier(uint32_t node_index, fzl::OwnedVmoMapper* merkle_out,
+                                 std::unique_ptr<BlobVerifier>* verifier_out);
+
  private:
   BlobLoader(TransactionManager* txn_manager, BlockIteratorProvider* block_iter_provider,
              NodeFinder* node_finder, UserPager* pager, BlobfsMetrics* metrics,
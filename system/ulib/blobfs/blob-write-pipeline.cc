@@ -0,0 +1,185 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "blob-write-pipeline.h"
+
+#include <lib/async/cpp/task.h>
+#include <lib/fit/defer.h>
+#include <zircon/assert.h>
+
+#include <algorithm>
+#include <utility>
+
+#include <fbl/algorithm.h>
+#include <fs/trace.h>
+
+namespace blobfs {
+namespace {
+
+// Work is only handed to the workers once this much data has accumulated, to amortize the cost of
+// posting tasks over many small writes.
+constexpr size_t kMinBatchSize = 256 * 1024;
+
+// The largest range hashed by a single task. Smaller ranges balance better across workers.
+constexpr size_t kMaxHashChunkSize = 1024 * 1024;
+
+static_assert(kMinBatchSize % digest::kDefaultNodeSize == 0);
+static_assert(kMaxHashChunkSize % digest::kDefaultNodeSize == 0);
+
+}  // namespace
+
+BlobWritePipeline::BlobWritePipeline(async_dispatcher_t* workers, const uint8_t* data,
+                                     size_t data_len, digest::MerkleTreeCreator* merkle,
+                                     BlobCompressor* compressor, size_t compression_limit)
+    : workers_(workers),
+      data_(data),
+      data_len_(data_len),
+      merkle_(merkle),
+      compressor_(compressor),
+      compression_limit_(compression_limit) {}
+
+BlobWritePipeline::~BlobWritePipeline() {
+  std::unique_lock<std::mutex> lock(lock_);
+  idle_.wait(lock, [this]() __TA_REQUIRES(lock_) { return pending_tasks_ == 0; });
+}
+
+void BlobWritePipeline::Update(size_t data_available) {
+  ZX_DEBUG_ASSERT(data_available <= data_len_);
+
+  if (merkle_ != nullptr) {
+    // Only whole nodes can be hashed, except for the last one.
+    size_t hash_end = data_available == data_len_
+                          ? data_len_
+                          : fbl::round_down(data_available, digest::kDefaultNodeSize);
+    if (hash_end > hash_scheduled_ &&
+        (hash_end == data_len_ || hash_end - hash_scheduled_ >= kMinBatchSize)) {
+      while (hash_scheduled_ < hash_end) {
+        size_t offset = hash_scheduled_;
+        size_t length = std::min(hash_end - offset, kMaxHashChunkSize);
+        hash_scheduled_ += length;
+        Post([this, offset, length]() { HashRange(offset, length); });
+      }
+    }
+  }
+
+  if (compressor_ != nullptr) {
+    bool post = false;
+    {
+      std::scoped_lock guard(lock_);
+      compress_available_ = data_available;
+      if (!compressing_ && compress_available_ > compress_scheduled_ &&
+          (compress_available_ == data_len_ ||
+           compress_available_ - compress_scheduled_ >= kMinBatchSize)) {
+        compressing_ = true;
+        post = true;
+      }
+    }
+    if (post) {
+      Post([this]() { Compress(); });
+    }
+  }
+}
+
+zx_status_t BlobWritePipeline::Finish() {
+  Update(data_len_);
+
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    idle_.wait(lock, [this]() __TA_REQUIRES(lock_) { return pending_tasks_ == 0; });
+    if (status_ != ZX_OK) {
+      return status_;
+    }
+  }
+
+  zx_status_t status;
+  if (merkle_ != nullptr && (status = merkle_->AppendHashed(data_len_)) != ZX_OK) {
+    FS_TRACE_ERROR("blobfs: Failed to complete merkle tree: %d\n", status);
+    return status;
+  }
+
+  if (compressor_ != nullptr && !compression_aborted_) {
+    if ((status = compressor_->End()) != ZX_OK) {
+      return status;
+    }
+    compression_aborted_ = compressor_->Size() > compression_limit_;
+  }
+  return ZX_OK;
+}
+
+void BlobWritePipeline::Post(fit::closure task) {
+  {
+    std::scoped_lock guard(lock_);
+    pending_tasks_++;
+  }
+
+  if (workers_ == nullptr) {
+    task();
+    TaskDone(ZX_OK);
+    return;
+  }
+
+  // If the workers shut down before running the task, it is destroyed without running, and the
+  // pipeline fails rather than waiting forever.
+  auto dropped = fit::defer([this]() { TaskDone(ZX_ERR_CANCELED); });
+  async::PostTask(workers_, [this, task = std::move(task), dropped = std::move(dropped)]() mutable {
+    dropped.cancel();
+    task();
+    TaskDone(ZX_OK);
+  });
+}
+
+void BlobWritePipeline::TaskDone(zx_status_t status) {
+  std::scoped_lock guard(lock_);
+  if (status != ZX_OK) {
+    Fail(status);
+  }
+  if (--pending_tasks_ == 0) {
+    idle_.notify_all();
+  }
+}
+
+void BlobWritePipeline::HashRange(size_t offset, size_t length) {
+  zx_status_t status = merkle_->HashLeaves(data_ + offset, length, offset);
+  if (status != ZX_OK) {
+    std::scoped_lock guard(lock_);
+    Fail(status);
+  }
+}
+
+void BlobWritePipeline::Compress() {
+  for (;;) {
+    size_t start;
+    size_t end;
+    {
+      std::scoped_lock guard(lock_);
+      if (compression_aborted_ || status_ != ZX_OK || compress_scheduled_ == compress_available_) {
+        compressing_ = false;
+        return;
+      }
+      start = compress_scheduled_;
+      end = compress_available_;
+      compress_scheduled_ = end;
+    }
+
+    zx_status_t status = compressor_->Update(data_ + start, end - start);
+    if (status != ZX_OK) {
+      std::scoped_lock guard(lock_);
+      Fail(status);
+      continue;
+    }
+
+    // For blobs which don't compress very well, stop early rather than wasting work.
+    if (compressor_->Size() > compression_limit_) {
+      compression_aborted_ = true;
+    }
+  }
+}
+
+void BlobWritePipeline::Fail(zx_status_t status) {
+  if (status_ == ZX_OK) {
+    status_ = status;
+  }
+}
+
+}  // namespace blobfs
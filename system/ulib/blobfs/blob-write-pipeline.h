@@ -0,0 +1,109 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ZIRCON_SYSTEM_ULIB_BLOBFS_BLOB_WRITE_PIPELINE_H_
+#define ZIRCON_SYSTEM_ULIB_BLOBFS_BLOB_WRITE_PIPELINE_H_
+
+#ifndef __Fuchsia__
+#error Fuchsia-only Header
+#endif
+
+#include <lib/async/dispatcher.h>
+#include <lib/fit/function.h>
+#include <zircon/types.h>
+
+#include <condition_variable>
+#include <mutex>
+
+#include <digest/merkle-tree.h>
+#include <fbl/macros.h>
+
+#include "compression/blob-compressor.h"
+
+namespace blobfs {
+
+// BlobWritePipeline compresses and builds the Merkle tree of a blob while its data is still being
+// written, on a pool of worker threads.
+//
+// The bottom level of the Merkle tree is hashed in independent node-aligned ranges, which run
+// concurrently. Compression is a single stream, so it runs on one worker at a time, but still
+// overlaps with hashing and with the client writing the rest of the blob. Both produce exactly the
+// same output as hashing and compressing the whole blob serially.
+//
+// This class is not thread-safe: |Update| and |Finish| must be called from the thread writing the
+// blob.
+class BlobWritePipeline {
+ public:
+  // Processes the |data_len| bytes at |data|, which are written in order and must not change once
+  // passed to |Update|. The tree must already be registered with |merkle| via |SetTree|.
+  //
+  // |compressor| may be null if the blob is not compressed. Compression is abandoned once the
+  // compressed size exceeds |compression_limit|, see |compression_aborted|.
+  //
+  // Work is posted to |workers|. If |workers| is null, all work runs synchronously within |Update|
+  // and |Finish|.
+  BlobWritePipeline(async_dispatcher_t* workers, const uint8_t* data, size_t data_len,
+                    digest::MerkleTreeCreator* merkle, BlobCompressor* compressor,
+                    size_t compression_limit);
+
+  // Waits for any outstanding work, since it refers to |data|.
+  ~BlobWritePipeline();
+
+  DISALLOW_COPY_ASSIGN_AND_MOVE(BlobWritePipeline);
+
+  // Schedules the processing of the data up to |data_available| bytes.
+  void Update(size_t data_available);
+
+  // Processes the rest of the data and waits for all outstanding work. On success, the Merkle tree
+  // is complete and, unless compression was aborted, so is the compressed blob.
+  zx_status_t Finish();
+
+  // Returns true if the blob did not compress well enough to be worth storing compressed. Only
+  // valid after |Finish|.
+  bool compression_aborted() const { return compression_aborted_; }
+
+ private:
+  // Runs |task| on a worker, or inline if there are no workers.
+  void Post(fit::closure task);
+
+  void HashRange(size_t offset, size_t length);
+
+  // Compresses all the data made available so far, then marks the compressor as idle.
+  void Compress();
+
+  // Records |status| as the result of the pipeline if it is the first failure.
+  void Fail(zx_status_t status) __TA_REQUIRES(lock_);
+
+  // Called when a posted task has run, or has been dropped without running.
+  void TaskDone(zx_status_t status);
+
+  async_dispatcher_t* const workers_;
+  const uint8_t* const data_;
+  const size_t data_len_;
+  digest::MerkleTreeCreator* const merkle_;
+  BlobCompressor* const compressor_;
+  const size_t compression_limit_;
+
+  // Data up to this offset has been handed to hashing tasks.
+  size_t hash_scheduled_ = 0;
+
+  std::mutex lock_;
+  std::condition_variable idle_;
+  // Number of tasks which have been posted but have not completed.
+  size_t pending_tasks_ __TA_GUARDED(lock_) = 0;
+  // Data up to this offset is available to the compressor.
+  size_t compress_available_ __TA_GUARDED(lock_) = 0;
+  // Data up to this offset has been handed to the compressor.
+  size_t compress_scheduled_ __TA_GUARDED(lock_) = 0;
+  // Whether a compression task is running or queued.
+  bool compressing_ __TA_GUARDED(lock_) = false;
+  zx_status_t status_ __TA_GUARDED(lock_) = ZX_OK;
+
+  // Only touched by the compression task, or once all tasks have completed.
+  bool compression_aborted_ = false;
+};
+
+}  // namespace blobfs
+
+#endif  // ZIRCON_SYSTEM_ULIB_BLOBFS_BLOB_WRITE_PIPELINE_H_
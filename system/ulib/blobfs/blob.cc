@@ -16,6 +16,7 @@
 #include <zircon/status.h>
 #include <zircon/syscalls.h>
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -186,6 +187,25 @@ zx_status_t Blob::SpaceAllocate(uint64_t size_data) {
     }
   }
 
+  // Hash and compress the blob in the background while it is being written.
+  auto merkle = std::make_unique<MerkleTreeCreator>();
+  if ((status = merkle->SetDataLength(inode_.blob_size)) != ZX_OK) {
+    return status;
+  }
+  const size_t merkle_size = merkle->GetTreeLength();
+  if (merkle_size > 0) {
+    if ((status = merkle->SetTree(GetMerkleTreeBuffer(), merkle_size, write_info->merkle_root,
+                                  sizeof(write_info->merkle_root))) != ZX_OK) {
+      FS_TRACE_ERROR("blob: Failed to create merkle: %s\n", zx_status_get_string(status));
+      return status;
+    }
+    write_info->merkle = std::move(merkle);
+  }
+  write_info->pipeline = std::make_unique<BlobWritePipeline>(
+      blobfs_->write_workers(), static_cast<const uint8_t*>(GetDataBuffer()), inode_.blob_size,
+      write_info->merkle.get(), write_info->compressor ? &*write_info->compressor : nullptr,
+      inode_.blob_size - kCompressionMinBytesSaved);
+
   map_index_ = nodes[0].index();
 
   write_info->extents = std::move(extents);
@@ -327,12 +347,7 @@ zx_status_t Blob::WriteInternal(const void* data, size_t len, size_t* actual) {
   *actual = to_write;
   write_info_->bytes_written += to_write;
 
-  if (write_info_->compressor) {
-    if ((status = write_info_->compressor->Update(data, to_write)) != ZX_OK) {
-      return status;
-    }
-    ConsiderCompressionAbort();
-  }
+  write_info_->pipeline->Update(write_info_->bytes_written);
 
   // More data to write.
   if (write_info_->bytes_written < inode_.blob_size) {
@@ -343,42 +358,34 @@ zx_status_t Blob::WriteInternal(const void* data, size_t len, size_t* actual) {
 
   // Only write data to disk once we've buffered the file into memory.
   // This gives us a chance to try compressing the blob before we write it back.
-  if (write_info_->compressor) {
-    if ((status = write_info_->compressor->End()) != ZX_OK) {
+  fs::Duration generation_time;
+  {
+    // Tracking generation time. Most of the work has already overlapped with the client's
+    // writes, so this only measures the time spent waiting for it to finish.
+    fs::Ticker ticker(blobfs_->Metrics()->Collecting());
+    if ((status = write_info_->pipeline->Finish()) != ZX_OK) {
+      FS_TRACE_ERROR("blob: Failed to process blob: %s\n", zx_status_get_string(status));
       return status;
     }
-    ConsiderCompressionAbort();
+    generation_time = ticker.End();
+  }
+  if (write_info_->pipeline->compression_aborted()) {
+    // For blobs which don't compress very well, store them uncompressed.
+    write_info_->compressor.reset();
   }
 
   // Since the merkle tree and data are co-allocated, use a block iterator
   // to parse their data in order.
   BlockIterator block_iter(std::make_unique<VectorExtentIterator>(write_info_->extents));
 
-  fs::Duration generation_time;
   std::vector<fit::promise<void, zx_status_t>> promises;
   fs::DataStreamer streamer(blobfs_->journal(), blobfs_->WritebackCapacity());
 
-  MerkleTreeCreator mtc;
-  if ((status = mtc.SetDataLength(inode_.blob_size)) != ZX_OK) {
-    return status;
-  }
   const uint32_t merkle_blocks = ComputeNumMerkleTreeBlocks(inode_);
-  const size_t merkle_size = mtc.GetTreeLength();
+  const size_t merkle_size = write_info_->merkle ? write_info_->merkle->GetTreeLength() : 0;
   if (merkle_size > 0) {
-    // Tracking generation time.
-    fs::Ticker ticker(blobfs_->Metrics()->Collecting());
-
-    // TODO(smklein): As an optimization, use the Append method to create the merkle tree as we
-    // write data, rather than waiting until the data is fully downloaded to create the tree.
-    uint8_t root[digest::kSha256Length];
-    if ((status = mtc.SetTree(GetMerkleTreeBuffer(), merkle_size, root, sizeof(root))) != ZX_OK ||
-        (status = mtc.Append(GetDataBuffer(), inode_.blob_size)) != ZX_OK) {
-      FS_TRACE_ERROR("blob: Failed to create merkle: %s\n", zx_status_get_string(status));
-      return status;
-    }
-
     Digest expected = MerkleRoot();
-    if (expected != root) {
+    if (expected != write_info_->merkle_root) {
       // Downloaded blob did not match provided digest.
       return ZX_ERR_IO_DATA_INTEGRITY;
     }
@@ -400,7 +407,6 @@ zx_status_t Blob::WriteInternal(const void* data, size_t len, size_t* actual) {
       FS_TRACE_ERROR("blob: failed to write blocks: %s\n", zx_status_get_string(status));
       return status;
     }
-    generation_time = ticker.End();
   } else if ((status = Verify()) != ZX_OK) {
     // Small blobs may not have associated Merkle Trees, and will
     // require validation, since we are not regenerating and checking
@@ -488,13 +494,6 @@ zx_status_t Blob::WriteInternal(const void* data, size_t len, size_t* actual) {
   return ZX_OK;
 }
 
-void Blob::ConsiderCompressionAbort() {
-  ZX_DEBUG_ASSERT(write_info_->compressor);
-  if (inode_.blob_size - kCompressionMinBytesSaved < write_info_->compressor->Size()) {
-    write_info_->compressor.reset();
-  }
-}
-
 zx_status_t Blob::GetReadableEvent(zx::event* out) {
   TRACE_DURATION("blobfs", "Blobfs::GetReadableEvent");
   zx_status_t status;
@@ -561,6 +560,7 @@ zx_status_t Blob::CloneDataVmo(zx_rights_t rights, zx::vmo* out_vmo, size_t* out
   *out_vmo = std::move(clone);
   *out_size = inode_.blob_size;
 
+  std::scoped_lock guard(mutex_);
   if (clone_watcher_.object() == ZX_HANDLE_INVALID) {
     clone_watcher_.set_object(data_vmo.get());
     clone_watcher_.set_trigger(ZX_VMO_ZERO_CHILDREN);
@@ -579,13 +579,18 @@ zx_status_t Blob::CloneDataVmo(zx_rights_t rights, zx::vmo* out_vmo, size_t* out
 
 void Blob::HandleNoClones(async_dispatcher_t* dispatcher, async::WaitBase* wait, zx_status_t status,
                           const zx_packet_signal_t* signal) {
-  if (!tearing_down_) {
-    ZX_DEBUG_ASSERT(status == ZX_OK);
-    ZX_DEBUG_ASSERT((signal->observed & ZX_VMO_ZERO_CHILDREN) != 0);
-    ZX_DEBUG_ASSERT(clone_watcher_.object() != ZX_HANDLE_INVALID);
+  // Drop the self-reference only after releasing the lock, since it may be the last one.
+  fbl::RefPtr<Blob> clone_ref;
+  {
+    std::scoped_lock guard(mutex_);
+    if (!tearing_down_) {
+      ZX_DEBUG_ASSERT(status == ZX_OK);
+      ZX_DEBUG_ASSERT((signal->observed & ZX_VMO_ZERO_CHILDREN) != 0);
+      ZX_DEBUG_ASSERT(clone_watcher_.object() != ZX_HANDLE_INVALID);
+    }
+    clone_watcher_.set_object(ZX_HANDLE_INVALID);
+    clone_ref = std::move(clone_ref_);
   }
-  clone_watcher_.set_object(ZX_HANDLE_INVALID);
-  clone_ref_ = nullptr;
 }
 
 zx_status_t Blob::ReadInternal(void* data, size_t len, size_t off, size_t* actual) {
@@ -595,6 +600,10 @@ zx_status_t Blob::ReadInternal(void* data, size_t len, size_t off, size_t* actua
     return ZX_ERR_BAD_STATE;
   }
 
+  if (!IsDataLoaded() && (inode_.header.flags & kBlobFlagZSTDSeekableCompressed)) {
+    return ReadSeekableInternal(data, len, off, actual);
+  }
+
   auto status = LoadVmosFromDisk();
   if (status != ZX_OK) {
     return status;
@@ -619,15 +628,106 @@ zx_status_t Blob::ReadInternal(void* data, size_t len, size_t off, size_t* actua
   return status;
 }
 
+zx_status_t Blob::ReadSeekableInternal(void* data, size_t len, size_t off, size_t* actual) {
+  TRACE_DURATION("blobfs", "Blobfs::ReadSeekableInternal", "len", len, "off", off);
+
+  if (off >= inode_.blob_size) {
+    *actual = 0;
+    return ZX_OK;
+  }
+  if (len > (inode_.blob_size - off)) {
+    len = inode_.blob_size - off;
+  }
+
+  // The collection is only reset once every connection is closed, and it locks its own transfer
+  // buffer, so the loader mutex is only needed to load the merkle tree.
+  ZSTDSeekableBlobCollection* collection = blobfs_->zstd_seekable_blob_collection();
+  if (collection == nullptr) {
+    return ZX_ERR_BAD_STATE;
+  }
+
+  zx_status_t status;
+  if (seekable_verifier_ == nullptr) {
+    std::scoped_lock loader_guard(blobfs_->loader_mutex());
+    if ((status = blobfs_->loader().LoadMerkleVerifier(map_index_, &seekable_merkle_mapping_,
+                                                       &seekable_verifier_)) != ZX_OK) {
+      return status;
+    }
+    seekable_verified_.assign(
+        fbl::round_up(inode_.blob_size, kBlobfsBlockSize) / kBlobfsBlockSize, false);
+  }
+
+  // Only whole merkle tree nodes can be verified, so decompress the aligned range around the
+  // request. Frames shared with neighbouring reads come from the collection's frame cache.
+  size_t aligned_off = off;
+  size_t aligned_len = len;
+  if ((status = seekable_verifier_->Align(&aligned_off, &aligned_len)) != ZX_OK) {
+    return status;
+  }
+  // The verifier expects the tail of the last block to be zeroed.
+  const size_t buffer_len = fbl::round_up(aligned_len, kBlobfsBlockSize);
+  if (buffer_len > seekable_buffer_len_) {
+    seekable_buffer_ = std::make_unique<uint8_t[]>(buffer_len);
+    seekable_buffer_len_ = buffer_len;
+  } else {
+    memset(seekable_buffer_.get() + aligned_len, 0, buffer_len - aligned_len);
+  }
+  uint8_t* buffer = seekable_buffer_.get();
+  UncompressedRange decompressed;
+  if ((status = collection->Read(map_index_, buffer, aligned_off, aligned_len, &decompressed)) !=
+      ZX_OK) {
+    // Frames may have been decompressed before the failure without being reported.
+    std::fill(seekable_verified_.begin(), seekable_verified_.end(), false);
+    return status;
+  }
+
+  // Frames which were just read from storage have not been verified, even where they extend
+  // beyond this read. Data which was verified and has stayed in the frame cache since is trusted.
+  const auto first_block = [](uint64_t offset) { return offset / kBlobfsBlockSize; };
+  const auto end_block = [this](uint64_t offset) {
+    return std::min<uint64_t>(fbl::round_up(offset, kBlobfsBlockSize) / kBlobfsBlockSize,
+                              seekable_verified_.size());
+  };
+  for (uint64_t block = first_block(decompressed.begin); block < end_block(decompressed.end);
+       block++) {
+    seekable_verified_[block] = false;
+  }
+  bool verified = true;
+  for (uint64_t block = first_block(aligned_off); block < end_block(aligned_off + aligned_len);
+       block++) {
+    verified = verified && seekable_verified_[block];
+  }
+  if (!verified) {
+    if ((status = seekable_verifier_->VerifyPartial(buffer, aligned_len, aligned_off,
+                                                    buffer_len)) != ZX_OK) {
+      FS_TRACE_ERROR("blobfs: Failed to verify range [%zu, %zu): %s\n", aligned_off,
+                     aligned_off + aligned_len, zx_status_get_string(status));
+      return status;
+    }
+    for (uint64_t block = first_block(aligned_off); block < end_block(aligned_off + aligned_len);
+         block++) {
+      seekable_verified_[block] = true;
+    }
+  }
+
+  memcpy(data, buffer + (off - aligned_off), len);
+  *actual = len;
+  return ZX_OK;
+}
+
 zx_status_t Blob::LoadVmosFromDisk() {
   if (IsDataLoaded()) {
     return ZX_OK;
   }
-  BlobLoader& loader = blobfs_->loader();
-  zx_status_t status =
-      IsPagerBacked()
-          ? loader.LoadBlobPaged(map_index_, &page_watcher_, &data_mapping_, &merkle_mapping_)
-          : loader.LoadBlob(map_index_, &data_mapping_, &merkle_mapping_);
+  zx_status_t status;
+  {
+    // The loader stages reads through a shared buffer.
+    std::scoped_lock loader_guard(blobfs_->loader_mutex());
+    BlobLoader& loader = blobfs_->loader();
+    status = IsPagerBacked()
+                 ? loader.LoadBlobPaged(map_index_, &page_watcher_, &data_mapping_, &merkle_mapping_)
+                 : loader.LoadBlob(map_index_, &data_mapping_, &merkle_mapping_);
+  }
 
   std::scoped_lock guard(mutex_);
   syncing_state_ = SyncingState::kDone;  // Nothing to sync when blob was loaded from the device.
@@ -707,14 +807,39 @@ bool Blob::ShouldCache() const {
 }
 
 void Blob::ActivateLowMemory() {
+  ReleaseMemory();
+  if (inode_.header.flags & kBlobFlagZSTDSeekableCompressed) {
+    // The frame cache is thread-safe, and the collection is only reset once every connection is
+    // closed, so no lock is needed to drop this blob's frames.
+    if (ZSTDSeekableBlobCollection* collection = blobfs_->zstd_seekable_blob_collection()) {
+      DecompressedFrameCache::BlobId blob_id;
+      static_assert(sizeof(inode_.merkle_root_hash) == blob_id.size());
+      memcpy(blob_id.data(), inode_.merkle_root_hash, blob_id.size());
+      collection->ActivateLowMemory(blob_id);
+    }
+  }
+}
+
+void Blob::ReleaseMemory() {
   // We shouldn't be putting the blob into a low-memory state while it is still mapped.
   ZX_ASSERT(clone_watcher_.object() == ZX_HANDLE_INVALID);
   page_watcher_.reset();
   data_mapping_.Reset();
   merkle_mapping_.Reset();
+  seekable_verifier_.reset();
+  seekable_merkle_mapping_.Reset();
+  seekable_verified_.clear();
+  seekable_buffer_.reset();
+  seekable_buffer_len_ = 0;
 }
 
-Blob::~Blob() { ActivateLowMemory(); }
+Blob::~Blob() {
+  // Any outstanding write work refers to the mappings, so wait for it before releasing them.
+  write_info_.reset();
+  // Blobfs may already be tearing down, so only this blob's own memory is released here. Its
+  // frames age out of the frame cache.
+  ReleaseMemory();
+}
 
 fs::VnodeProtocolSet Blob::GetProtocols() const { return fs::VnodeProtocol::kFile; }
 
@@ -882,8 +1007,10 @@ void Blob::CompleteSync() {
 }
 
 fbl::RefPtr<Blob> Blob::CloneWatcherTeardown() {
-  if (clone_watcher_.is_pending()) {
-    clone_watcher_.Cancel();
+  std::scoped_lock guard(mutex_);
+  // If cancellation fails, the handler is already running on another dispatcher thread and will
+  // release the reference itself.
+  if (clone_watcher_.is_pending() && clone_watcher_.Cancel() == ZX_OK) {
     clone_watcher_.set_object(ZX_HANDLE_INVALID);
     tearing_down_ = true;
     return std::move(clone_ref_);
@@ -891,6 +1018,10 @@ fbl::RefPtr<Blob> Blob::CloneWatcherTeardown() {
   return nullptr;
 }
 
+bool Blob::SupportsConcurrentDispatch() const {
+  return GetState() == kBlobStateReadable && !DeletionQueued();
+}
+
 zx_status_t Blob::Open([[maybe_unused]] ValidatedOptions options,
                        fbl::RefPtr<Vnode>* out_redirect) {
   fd_count_++;
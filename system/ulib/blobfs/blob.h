@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include <blobfs/common.h>
 #include <blobfs/format.h>
@@ -37,6 +38,8 @@
 #include "allocator/extent-reserver.h"
 #include "allocator/node-reserver.h"
 #include "blob-cache.h"
+#include "blob-verifier.h"
+#include "blob-write-pipeline.h"
 #include "compression/blob-compressor.h"
 #include "compression/compressor.h"
 #include "format-assertions.h"
@@ -91,6 +94,10 @@ class Blob final : public CacheNode, fbl::Recyclable<Blob> {
   zx_status_t Open(ValidatedOptions options, fbl::RefPtr<Vnode>* out_redirect) final;
   zx_status_t Close() final;
 
+  // Readable blobs are immutable, so operations on them may be dispatched concurrently with
+  // operations on other readable blobs. Everything else remains serialized filesystem-wide.
+  bool SupportsConcurrentDispatch() const final;
+
   ////////////////
   // fbl::Recyclable interface.
 
@@ -199,17 +206,18 @@ class Blob final : public CacheNode, fbl::Recyclable<Blob> {
   // depending on the state.
   zx_status_t WriteInternal(const void* data, size_t len, size_t* actual);
 
-  // For a blob being written, consider stopping the compressor,
-  // the blob to eventually be written uncompressed to disk.
-  //
-  // For blobs which don't compress very well, this provides an escape
-  // hatch to avoid wasting work.
-  void ConsiderCompressionAbort();
-
   // Reads from a blob.
   // Requires: kBlobStateReadable
   zx_status_t ReadInternal(void* data, size_t len, size_t off, size_t* actual);
 
+  // Reads from a zstd-seekable blob whose data has not been loaded, decompressing and verifying
+  // only the frames and merkle tree nodes under the requested range.
+  // Requires: kBlobStateReadable
+  zx_status_t ReadSeekableInternal(void* data, size_t len, size_t off, size_t* actual);
+
+  // Releases the mappings and read state held by this blob, without touching blobfs.
+  void ReleaseMemory();
+
   // Loads the blob's data and merkle from disk, and initializes the data/merkle VMOs.
   // If paging is enabled, the data VMO will be pager-backed and lazily loaded and verified as the
   // client accesses the pages.
@@ -283,15 +291,29 @@ class Blob final : public CacheNode, fbl::Recyclable<Blob> {
   fzl::OwnedVmoMapper merkle_mapping_;
   fzl::OwnedVmoMapper data_mapping_;
 
+  // State for ranged reads of a zstd-seekable blob whose data is not loaded: the merkle tree and
+  // its verifier, which blocks of the frames cached for this blob have been verified since they
+  // were decompressed, and a staging buffer for the aligned ranges which are verified. Only
+  // touched by reads, which the Vfs dispatches one at a time for each blob, and by
+  // |ActivateLowMemory| and the destructor, once no connection remains.
+  fzl::OwnedVmoMapper seekable_merkle_mapping_;
+  std::unique_ptr<BlobVerifier> seekable_verifier_;
+  std::vector<bool> seekable_verified_;
+  std::unique_ptr<uint8_t[]> seekable_buffer_;
+  size_t seekable_buffer_len_ = 0;
+
   // Watches any clones of "vmo_" provided to clients.
   // Observes the ZX_VMO_ZERO_CHILDREN signal.
+  //
+  // The watcher fires on the dispatcher, which may be serviced by several threads, so it and
+  // |clone_ref_| are only touched with |mutex_| held.
   async::WaitMethod<Blob, &Blob::HandleNoClones> clone_watcher_;
   // Keeps a reference to the blob alive (from within itself)
   // until there are no cloned VMOs in used.
   //
   // This RefPtr is only non-null when a client is using a cloned VMO,
   // or there would be a clear leak of Blob.
-  fbl::RefPtr<Blob> clone_ref_ = {};
+  fbl::RefPtr<Blob> clone_ref_ __TA_GUARDED(mutex_) = {};
 
   zx::event readable_event_ = {};
 
@@ -313,6 +335,14 @@ class Blob final : public CacheNode, fbl::Recyclable<Blob> {
     fbl::Vector<ReservedNode> node_indices;
 
     std::optional<BlobCompressor> compressor;
+
+    // Builds the Merkle tree as data is written. Null for blobs which have no tree.
+    std::unique_ptr<digest::MerkleTreeCreator> merkle;
+    uint8_t merkle_root[digest::kSha256Length] = {};
+
+    // Hashes and compresses data as it is written. Declared last, since outstanding work refers
+    // to the fields above.
+    std::unique_ptr<BlobWritePipeline> pipeline;
   };
 
   std::unique_ptr<WritebackInfo> write_info_ = {};
@@ -282,6 +282,15 @@ zx_status_t Blobfs::Create(async_dispatcher_t* dispatcher, std::unique_ptr<Block
   FS_TRACE_INFO("blobfs: Using compression %s\n",
                 CompressionAlgorithmToString(fs->write_compression_algorithm_));
 
+  uint32_t write_threads =
+      options->write_threads != 0 ? options->write_threads : zx_system_get_num_cpus();
+  for (uint32_t i = 0; i < write_threads; i++) {
+    if ((status = fs->write_workers_.StartThread("blobfs-write-worker")) != ZX_OK) {
+      FS_TRACE_ERROR("blobfs: Failed to start write worker: %s\n", zx_status_get_string(status));
+      return status;
+    }
+  }
+
   auto* fs_ptr = fs.get();
   zx::status<BlobLoader> loader = BlobLoader::Create(fs_ptr, fs_ptr, fs->GetNodeFinder(), fs_ptr,
                                                      fs->Metrics());
@@ -291,6 +300,14 @@ zx_status_t Blobfs::Create(async_dispatcher_t* dispatcher, std::unique_ptr<Block
   }
   fs->loader_ = std::move(loader.value());
 
+  if ((status = ZSTDSeekableBlobCollection::Create(fs_ptr, fs_ptr, fs_ptr, fs->GetNodeFinder(),
+                                                   &fs->zstd_seekable_blob_collection_)) !=
+      ZX_OK) {
+    FS_TRACE_ERROR("blobfs: Failed to initialize zstd-seekable reader: %s\n",
+                   zx_status_get_string(status));
+    return status;
+  }
+
   *out = std::move(fs);
   return ZX_OK;
 }
@@ -691,9 +708,13 @@ std::unique_ptr<BlockDevice> Blobfs::Reset() {
     vnode->CloneWatcherTeardown();
   });
 
-  // Reset loader_ now, since it has internally allocated buffers attached to the FIFO it needs to
-  // detach.
-  loader_.Reset();
+  // Reset loader_ and the zstd-seekable reader now, since they have internally allocated buffers
+  // attached to the FIFO they need to detach.
+  {
+    std::scoped_lock loader_guard(loader_mutex_);
+    loader_.Reset();
+  }
+  zstd_seekable_blob_collection_.reset();
 
   // Write the clean bit.
   if (writability_ == Writability::Writable) {
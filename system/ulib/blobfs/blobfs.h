@@ -14,11 +14,13 @@
 
 #include <fuchsia/blobfs/llcpp/fidl.h>
 #include <fuchsia/hardware/block/c/fidl.h>
+#include <lib/async-loop/cpp/loop.h>
 #include <lib/fzl/resizeable-vmo-mapper.h>
 #include <lib/zx/resource.h>
 #include <lib/zx/vmo.h>
 
 #include <memory>
+#include <mutex>
 
 #include <bitmap/raw-bitmap.h>
 #include <blobfs/common.h>
@@ -46,6 +48,7 @@
 #include "allocator/node-reserver.h"
 #include "blob-cache.h"
 #include "blob-loader.h"
+#include "compression/zstd-seekable-blob-collection.h"
 #include "directory.h"
 #include "iterator/allocated-extent-iterator.h"
 #include "iterator/block-iterator-provider.h"
@@ -136,6 +139,9 @@ class Blobfs : public TransactionManager, public UserPager, public BlockIterator
 
   const CompressionAlgorithm& write_compression_algorithm() { return write_compression_algorithm_; }
 
+  // Returns the dispatcher for the threads which process blobs as they are written.
+  async_dispatcher_t* write_workers() { return write_workers_.dispatcher(); }
+
   bool CheckBlocksAllocated(uint64_t start_block, uint64_t end_block,
                             uint64_t* first_unset = nullptr) const {
     return allocator_->CheckBlocksAllocated(start_block, end_block, first_unset);
@@ -191,6 +197,16 @@ class Blobfs : public TransactionManager, public UserPager, public BlockIterator
 
   BlobLoader& loader() { return loader_; }
 
+  // Serializes use of |loader()| between blobs dispatched concurrently.
+  std::mutex& loader_mutex() { return loader_mutex_; }
+
+  // Reads ranges of zstd-seekable blobs without decompressing the whole blob, keeping recently
+  // decompressed frames cached across blobs. It is thread-safe. Null once blobfs has been reset,
+  // which only happens once every connection is closed.
+  ZSTDSeekableBlobCollection* zstd_seekable_blob_collection() {
+    return zstd_seekable_blob_collection_.get();
+  }
+
  protected:
   // Reloads metadata from disk. Useful when metadata on disk
   // may have changed due to journal playback.
@@ -297,6 +313,10 @@ class Blobfs : public TransactionManager, public UserPager, public BlockIterator
   bool paging_enabled_ = false;
 
   BlobLoader loader_;
+  std::mutex loader_mutex_;
+  std::unique_ptr<ZSTDSeekableBlobCollection> zstd_seekable_blob_collection_;
+
+  async::Loop write_workers_{&kAsyncLoopConfigNoAttachToCurrentThread};
 };
 
 }  // namespace blobfs
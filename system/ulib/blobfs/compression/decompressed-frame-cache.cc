@@ -0,0 +1,117 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "decompressed-frame-cache.h"
+
+#include <zircon/assert.h>
+
+#include <iterator>
+#include <utility>
+
+namespace blobfs {
+
+DecompressedFrameCache::DecompressedFrameCache(size_t capacity_bytes)
+    : capacity_bytes_(capacity_bytes) {}
+
+std::shared_ptr<const DecompressedFrame> DecompressedFrameCache::Lookup(
+    const BlobId& blob, uint64_t data_byte_offset) {
+  std::scoped_lock guard(lock_);
+  auto frames = index_.find(blob);
+  if (frames != index_.end()) {
+    // Find the last frame starting at or before |data_byte_offset|.
+    auto frame = frames->second.upper_bound(data_byte_offset);
+    if (frame != frames->second.begin()) {
+      --frame;
+      EntryList::iterator entry = frame->second;
+      if (entry->frame->Contains(data_byte_offset)) {
+        entries_.splice(entries_.begin(), entries_, entry);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return entry->frame;
+      }
+    }
+  }
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  return nullptr;
+}
+
+void DecompressedFrameCache::Insert(const BlobId& blob,
+                                    std::shared_ptr<const DecompressedFrame> frame) {
+  ZX_DEBUG_ASSERT(frame != nullptr);
+  std::scoped_lock guard(lock_);
+  if (frame->size > capacity_bytes_) {
+    return;
+  }
+
+  FrameMap& frames = index_[blob];
+  auto existing = frames.find(frame->offset);
+  if (existing != frames.end()) {
+    // Another reader decompressed the same frame concurrently.
+    entries_.splice(entries_.begin(), entries_, existing->second);
+    return;
+  }
+
+  EvictLocked(capacity_bytes_ - frame->size);
+  size_bytes_ += frame->size;
+  uint64_t offset = frame->offset;
+  entries_.push_front(Entry{blob, std::move(frame)});
+  // |EvictLocked| may have erased the map of this blob, so look it up again.
+  index_[blob].emplace(offset, entries_.begin());
+}
+
+void DecompressedFrameCache::SetCapacity(size_t capacity_bytes) {
+  std::scoped_lock guard(lock_);
+  capacity_bytes_ = capacity_bytes;
+  EvictLocked(capacity_bytes_);
+}
+
+void DecompressedFrameCache::Erase(const BlobId& blob) {
+  std::scoped_lock guard(lock_);
+  auto frames = index_.find(blob);
+  if (frames == index_.end()) {
+    return;
+  }
+  for (auto& frame : frames->second) {
+    size_bytes_ -= frame.second->frame->size;
+    entries_.erase(frame.second);
+  }
+  index_.erase(frames);
+}
+
+void DecompressedFrameCache::Clear() {
+  std::scoped_lock guard(lock_);
+  entries_.clear();
+  index_.clear();
+  size_bytes_ = 0;
+}
+
+DecompressedFrameCache::Stats DecompressedFrameCache::GetStats() const {
+  Stats stats;
+  stats.hits = hits_.load(std::memory_order_relaxed);
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  stats.evictions = evictions_.load(std::memory_order_relaxed);
+  std::scoped_lock guard(lock_);
+  stats.size_bytes = size_bytes_;
+  return stats;
+}
+
+void DecompressedFrameCache::EvictLocked(size_t capacity_bytes) {
+  while (size_bytes_ > capacity_bytes) {
+    ZX_DEBUG_ASSERT(!entries_.empty());
+    RemoveLocked(std::prev(entries_.end()));
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void DecompressedFrameCache::RemoveLocked(EntryList::iterator entry) {
+  auto frames = index_.find(entry->blob);
+  ZX_DEBUG_ASSERT(frames != index_.end());
+  frames->second.erase(entry->frame->offset);
+  if (frames->second.empty()) {
+    index_.erase(frames);
+  }
+  size_bytes_ -= entry->frame->size;
+  entries_.erase(entry);
+}
+
+}  // namespace blobfs
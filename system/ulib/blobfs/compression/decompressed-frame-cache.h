@@ -0,0 +1,111 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ZIRCON_SYSTEM_ULIB_BLOBFS_COMPRESSION_DECOMPRESSED_FRAME_CACHE_H_
+#define ZIRCON_SYSTEM_ULIB_BLOBFS_COMPRESSION_DECOMPRESSED_FRAME_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <digest/digest.h>
+#include <fbl/macros.h>
+
+namespace blobfs {
+
+// A frame of a compressed blob, in decompressed form.
+struct DecompressedFrame {
+  // Offset of the frame within the decompressed blob.
+  uint64_t offset = 0;
+  size_t size = 0;
+  std::unique_ptr<uint8_t[]> data;
+
+  bool Contains(uint64_t data_byte_offset) const {
+    return data_byte_offset >= offset && data_byte_offset - offset < size;
+  }
+};
+
+// DecompressedFrameCache is a bounded, least-recently-used cache of decompressed frames, shared by
+// all readers of compressed blobs. It spares small random reads from decompressing the same frame
+// over and over.
+//
+// Frames are keyed by the Merkle root of their blob, so entries for a blob which has been deleted
+// can never be returned for another blob; they simply age out.
+//
+// Frames are handed out by shared pointer, so a frame which is evicted while a reader is copying
+// from it stays alive until the reader is done.
+//
+// This class is thread-safe.
+class DecompressedFrameCache {
+ public:
+  using BlobId = std::array<uint8_t, digest::kSha256Length>;
+
+  struct Stats {
+    // Lookups answered by a cached frame.
+    uint64_t hits = 0;
+    // Lookups which required decompressing a frame.
+    uint64_t misses = 0;
+    // Frames dropped to make room for new ones.
+    uint64_t evictions = 0;
+    // Bytes of decompressed data currently held by the cache.
+    size_t size_bytes = 0;
+  };
+
+  // Creates a cache which holds at most |capacity_bytes| of decompressed data. A capacity of zero
+  // disables the cache.
+  explicit DecompressedFrameCache(size_t capacity_bytes);
+  DISALLOW_COPY_ASSIGN_AND_MOVE(DecompressedFrameCache);
+
+  // Returns the cached frame of |blob| which contains |data_byte_offset|, or null if there is
+  // none.
+  std::shared_ptr<const DecompressedFrame> Lookup(const BlobId& blob, uint64_t data_byte_offset);
+
+  // Adds |frame| of |blob| to the cache, evicting the least recently used frames to stay within
+  // capacity. Frames larger than the capacity are not cached.
+  void Insert(const BlobId& blob, std::shared_ptr<const DecompressedFrame> frame);
+
+  // Changes the capacity, evicting frames as necessary.
+  void SetCapacity(size_t capacity_bytes);
+
+  // Drops every frame of |blob|.
+  void Erase(const BlobId& blob);
+
+  // Drops every frame. Called when the system is low on memory.
+  void Clear();
+
+  Stats GetStats() const;
+
+ private:
+  struct Entry {
+    BlobId blob;
+    std::shared_ptr<const DecompressedFrame> frame;
+  };
+  using EntryList = std::list<Entry>;
+  // Frames of a single blob, by decompressed offset.
+  using FrameMap = std::map<uint64_t, EntryList::iterator>;
+
+  void EvictLocked(size_t capacity_bytes) __TA_REQUIRES(lock_);
+  void RemoveLocked(EntryList::iterator entry) __TA_REQUIRES(lock_);
+
+  mutable std::mutex lock_;
+  size_t capacity_bytes_ __TA_GUARDED(lock_);
+  size_t size_bytes_ __TA_GUARDED(lock_) = 0;
+  // Most recently used frames first.
+  EntryList entries_ __TA_GUARDED(lock_);
+  std::map<BlobId, FrameMap> index_ __TA_GUARDED(lock_);
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> evictions_{0};
+};
+
+}  // namespace blobfs
+
+#endif  // ZIRCON_SYSTEM_ULIB_BLOBFS_COMPRESSION_DECOMPRESSED_FRAME_CACHE_H_
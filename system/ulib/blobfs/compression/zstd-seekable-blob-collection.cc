@@ -5,6 +5,7 @@
 #include "zstd-seekable-blob-collection.h"
 
 #include <lib/zx/vmo.h>
+#include <string.h>
 #include <zircon/device/block.h>
 #include <zircon/errors.h>
 #include <zircon/status.h>
@@ -26,10 +27,11 @@ zx_status_t ZSTDSeekableBlobCollection::Create(storage::VmoidRegistry* vmoid_reg
                                                SpaceManager* space_manager,
                                                fs::LegacyTransactionHandler* txn_handler,
                                                NodeFinder* node_finder,
-                                               std::unique_ptr<ZSTDSeekableBlobCollection>* out) {
+                                               std::unique_ptr<ZSTDSeekableBlobCollection>* out,
+                                               size_t frame_cache_bytes) {
   // |space_manager|, |txn_handler|, |node_finder| passed through on |Read()|.
-  std::unique_ptr<ZSTDSeekableBlobCollection> cbc(
-      new ZSTDSeekableBlobCollection(vmoid_registry, space_manager, txn_handler, node_finder));
+  std::unique_ptr<ZSTDSeekableBlobCollection> cbc(new ZSTDSeekableBlobCollection(
+      vmoid_registry, space_manager, txn_handler, node_finder, frame_cache_bytes));
 
   // Initialize shared transfer buffer.
   zx_status_t status = zx::vmo::create(kCompressedTransferBufferBytes, 0, &cbc->transfer_vmo_);
@@ -64,14 +66,17 @@ zx_status_t ZSTDSeekableBlobCollection::Create(storage::VmoidRegistry* vmoid_reg
 ZSTDSeekableBlobCollection::ZSTDSeekableBlobCollection(storage::VmoidRegistry* vmoid_registry,
                                                        SpaceManager* space_manager,
                                                        fs::LegacyTransactionHandler* txn_handler,
-                                                       NodeFinder* node_finder)
+                                                       NodeFinder* node_finder,
+                                                       size_t frame_cache_bytes)
     : space_manager_(space_manager),
       txn_handler_(txn_handler),
       node_finder_(node_finder),
-      vmoid_(vmoid_registry) {}
+      vmoid_(vmoid_registry),
+      frame_cache_(frame_cache_bytes) {}
 
 zx_status_t ZSTDSeekableBlobCollection::Read(uint32_t node_index, uint8_t* buf,
-                                             uint64_t data_byte_offset, uint64_t num_bytes) {
+                                             uint64_t data_byte_offset, uint64_t num_bytes,
+                                             UncompressedRange* out_decompressed) {
   InodePtr node = node_finder_->GetNode(node_index);
   if (!node) {
     FS_TRACE_ERROR("[blobfs][compressed] Invalid node index: %u\n", node_index);
@@ -90,8 +95,15 @@ zx_status_t ZSTDSeekableBlobCollection::Read(uint32_t node_index, uint8_t* buf,
   auto blocks = std::make_unique<ZSTDCompressedBlockCollectionImpl>(
       &vmoid_, kCompressedTransferBufferBlocks, space_manager_, txn_handler_, node_finder_,
       node_index, num_merkle_blocks);
+  // Frames are cached by Merkle root, which stays unique to the blob's contents even if the node
+  // is later reused.
+  DecompressedFrameCache::BlobId blob_id;
+  static_assert(sizeof(node->merkle_root_hash) == blob_id.size());
+  memcpy(blob_id.data(), node->merkle_root_hash, blob_id.size());
   std::unique_ptr<ZSTDSeekableBlob> blob;
-  zx_status_t status = ZSTDSeekableBlob::Create(&mapped_vmo_, std::move(blocks), &blob);
+  zx_status_t status =
+      ZSTDSeekableBlob::Create(&mapped_vmo_, std::move(blocks), blob_id, &frame_cache_, &blob,
+                               &transfer_lock_);
   if (status != ZX_OK) {
     FS_TRACE_ERROR("[blobfs][compressed] Failed to construct ZSTDSeekableBlob: %s\n",
                    zx_status_get_string(status));
@@ -105,6 +117,9 @@ zx_status_t ZSTDSeekableBlobCollection::Read(uint32_t node_index, uint8_t* buf,
         node_index, data_byte_offset, num_bytes, zx_status_get_string(status));
     return status;
   }
+  if (out_decompressed != nullptr) {
+    *out_decompressed = blob->last_decompressed();
+  }
 
   return ZX_OK;
 }
@@ -12,6 +12,7 @@
 #include <zircon/types.h>
 
 #include <memory>
+#include <mutex>
 
 #include <blobfs/node-finder.h>
 #include <fbl/macros.h>
@@ -20,6 +21,8 @@
 #include <storage/buffer/vmoid_registry.h>
 
 #include "allocator/allocator.h"
+#include "compression/decompressed-frame-cache.h"
+#include "compression/zstd-seekable-blob.h"
 #include "compression/zstd-seekable.h"
 
 namespace blobfs {
@@ -44,25 +47,49 @@ static_assert(kCompressedTransferBufferBytes / kBlobfsBlockSize <=
 constexpr uint32_t kCompressedTransferBufferBlocks =
     static_cast<uint32_t>(kCompressedTransferBufferBytes / kBlobfsBlockSize);
 
+// The default number of bytes of decompressed frames cached across all blobs in a
+// |ZSTDSeekableBlobCollection|.
+constexpr size_t kDefaultDecompressedFrameCacheBytes = 16 * size_t{kZSTDSeekableMaxFrameSize};
+
 // ZSTDSeekableBlobCollection is a container for accessing compressed blobs. This container stores
 // data shared between compressed blobs such as a single storage/VMO transfer buffer.
+//
+// This class is thread-safe. Reads which must decompress frames are serialized on the transfer
+// buffer; reads served entirely from the frame cache proceed in parallel.
 class ZSTDSeekableBlobCollection {
  public:
+  // Recently decompressed frames are kept in a cache of |frame_cache_bytes| bytes, shared by all
+  // blobs. A size of zero disables the cache.
   static zx_status_t Create(storage::VmoidRegistry* vmoid_registry, SpaceManager* space_manager,
                             fs::LegacyTransactionHandler* txn_handler, NodeFinder* node_finder,
-                            std::unique_ptr<ZSTDSeekableBlobCollection>* out);
+                            std::unique_ptr<ZSTDSeekableBlobCollection>* out,
+                            size_t frame_cache_bytes = kDefaultDecompressedFrameCacheBytes);
 
   DISALLOW_COPY_ASSIGN_AND_MOVE(ZSTDSeekableBlobCollection);
 
   // Load exactly |num_bytes| bytes starting at _uncompressed_ file contents byte offset
   // |data_byte_offset| from blob identified by inode index |node_index| into |buf|. The value of
   // data in |buf| is expected to be valid if and only if the return value is |ZX_OK|.
+  //
+  // If |out_decompressed| is not null, it is set to the range covered by the frames which had to
+  // be decompressed from storage rather than found in the frame cache, which may extend beyond
+  // the requested range.
   zx_status_t Read(uint32_t node_index, uint8_t* buf, uint64_t data_byte_offset,
-                   uint64_t num_bytes);
+                   uint64_t num_bytes, UncompressedRange* out_decompressed = nullptr);
+
+  // Releases all cached frames. Called when the system is low on memory.
+  void ActivateLowMemory() { frame_cache_.Clear(); }
+
+  // Releases the cached frames of the blob with Merkle root |blob|. Called when that blob is
+  // evicted to save memory.
+  void ActivateLowMemory(const DecompressedFrameCache::BlobId& blob) { frame_cache_.Erase(blob); }
+
+  DecompressedFrameCache::Stats GetFrameCacheStats() const { return frame_cache_.GetStats(); }
 
  private:
   ZSTDSeekableBlobCollection(storage::VmoidRegistry* vmoid_registry, SpaceManager* space_manager,
-                             fs::LegacyTransactionHandler* txn_handler, NodeFinder* node_finder);
+                             fs::LegacyTransactionHandler* txn_handler, NodeFinder* node_finder,
+                             size_t frame_cache_bytes);
 
   // Parameters passed through to |ZSTDCompressedBlockCollection| construction.
   SpaceManager* space_manager_;
@@ -73,15 +100,18 @@ class ZSTDSeekableBlobCollection {
   // It is safe to keep this VMO mapped and pass it to inidividual blobs for each read because
   // all components involved in compressed blob reads:
   //
-  // 1. Run in the same thread,
+  // 1. Hold |transfer_lock_| while they use it,
   //    and
   // 2. Synchronously wait for their data to arrive in |transfer_vmo_|, then:
   //      a) Decompress and discard the data before requesting more,
   //         or
   //      b) Copy the data before requesting more.
+  std::mutex transfer_lock_;
   zx::vmo transfer_vmo_;
   storage::OwnedVmoid vmoid_;
   fzl::VmoMapper mapped_vmo_;
+
+  DecompressedFrameCache frame_cache_;
 };
 
 }  // namespace blobfs
@@ -12,11 +12,11 @@
 #include <zircon/status.h>
 #include <zircon/types.h>
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
 #include <fbl/algorithm.h>
-#include <fbl/auto_call.h>
 #include <fs/trace.h>
 #include <zstd/zstd_seekable.h>
 
@@ -216,11 +216,25 @@ zx_status_t ZSTDSeekableBlob::Create(
     fzl::VmoMapper* mapped_vmo,
     std::unique_ptr<ZSTDCompressedBlockCollection> compressed_block_collection,
     std::unique_ptr<ZSTDSeekableBlob>* out) {
-  std::unique_ptr<ZSTDSeekableBlob> blob(
-      new ZSTDSeekableBlob(mapped_vmo, std::move(compressed_block_collection)));
-  zx_status_t status = blob->ReadHeader();
-  if (status != ZX_OK) {
-    return status;
+  return Create(mapped_vmo, std::move(compressed_block_collection), {}, nullptr, out);
+}
+
+zx_status_t ZSTDSeekableBlob::Create(
+    fzl::VmoMapper* mapped_vmo,
+    std::unique_ptr<ZSTDCompressedBlockCollection> compressed_block_collection,
+    const DecompressedFrameCache::BlobId& blob_id, DecompressedFrameCache* frame_cache,
+    std::unique_ptr<ZSTDSeekableBlob>* out, std::mutex* transfer_lock) {
+  std::unique_ptr<ZSTDSeekableBlob> blob(new ZSTDSeekableBlob(
+      mapped_vmo, std::move(compressed_block_collection), blob_id, frame_cache, transfer_lock));
+  if (frame_cache == nullptr) {
+    std::unique_lock<std::mutex> transfer_guard;
+    if (transfer_lock != nullptr) {
+      transfer_guard = std::unique_lock<std::mutex>(*transfer_lock);
+    }
+    zx_status_t status = blob->ReadHeader();
+    if (status != ZX_OK) {
+      return status;
+    }
   }
 
   *out = std::move(blob);
@@ -228,32 +242,24 @@ zx_status_t ZSTDSeekableBlob::Create(
 }
 
 zx_status_t ZSTDSeekableBlob::Read(uint8_t* buf, uint64_t data_byte_offset, uint64_t num_bytes) {
-  ZSTD_seekable* d_stream = ZSTD_seekable_create();
-  if (d_stream == nullptr) {
-    FS_TRACE_ERROR("[blobfs][zstd-seekable] Failed to create seekable dstream\n");
-    return ZX_ERR_INTERNAL;
+  if (frame_cache_ != nullptr) {
+    return ReadCached(buf, data_byte_offset, num_bytes);
   }
 
-  auto clean_up = fbl::MakeAutoCall([&]() { ZSTD_seekable_free(d_stream); });
-
-  ZSTDSeekableFile zstd_seekable_file{
-      .blob = this,
-      .blocks = compressed_block_collection_.get(),
-      .byte_offset = 0,
-      .num_bytes = header_.archive_size,
-      .status = ZX_OK,
-  };
-  size_t zstd_return = ZSTD_seekable_initAdvanced(d_stream, ZSTD_seekable_customFile{
-                                                                .opaque = &zstd_seekable_file,
-                                                                .read = ZSTDRead,
-                                                                .seek = ZSTDSeek,
-                                                            });
-  if (ZSTD_isError(zstd_return)) {
-    FS_TRACE_ERROR("[blobfs][zstd-seekable] Failed to initialize seekable dstream: %s\n",
-                   ZSTD_getErrorName(zstd_return));
-    return ZX_ERR_INTERNAL;
+  last_decompressed_ = {.begin = data_byte_offset, .end = data_byte_offset + num_bytes};
+  std::unique_lock<std::mutex> transfer_guard;
+  if (transfer_lock_ != nullptr) {
+    transfer_guard = std::unique_lock<std::mutex>(*transfer_lock_);
+  }
+  SeekableStream stream(this);
+  zx_status_t status = stream.Init();
+  if (status != ZX_OK) {
+    return status;
   }
+  ZSTD_seekable* d_stream = stream.d_stream();
+  ZSTDSeekableFile& zstd_seekable_file = *stream.file();
 
+  size_t zstd_return;
   size_t decompressed = 0;
   do {
     zstd_return =
@@ -283,11 +289,66 @@ zx_status_t ZSTDSeekableBlob::Read(uint8_t* buf, uint64_t data_byte_offset, uint
   return ZX_OK;
 }
 
+zx_status_t ZSTDSeekableBlob::ReadCached(uint8_t* buf, uint64_t data_byte_offset,
+                                         uint64_t num_bytes) {
+  TRACE_DURATION("blobfs", "ZSTDSeekableBlob::ReadCached", "byte_offset", data_byte_offset,
+                 "bytes", num_bytes);
+
+  // The stream is only set up, and the transfer buffer only locked, once a frame is missing from
+  // the cache. The lock is released before the stream is destroyed, which does not touch the
+  // transfer buffer.
+  last_decompressed_ = {};
+  SeekableStream stream(this);
+  std::unique_lock<std::mutex> transfer_guard;
+  bool stream_initialized = false;
+
+  uint64_t copied = 0;
+  while (copied < num_bytes) {
+    const uint64_t offset = data_byte_offset + copied;
+    std::shared_ptr<const DecompressedFrame> frame = frame_cache_->Lookup(blob_id_, offset);
+    if (frame == nullptr) {
+      if (!stream_initialized) {
+        if (transfer_lock_ != nullptr) {
+          transfer_guard = std::unique_lock<std::mutex>(*transfer_lock_);
+        }
+        zx_status_t status = stream.Init();
+        if (status != ZX_OK) {
+          return status;
+        }
+        stream_initialized = true;
+      }
+      zx_status_t status = stream.DecompressFrameAt(offset, &frame);
+      if (status != ZX_OK) {
+        return status;
+      }
+      if (last_decompressed_.empty()) {
+        last_decompressed_.begin = frame->offset;
+      }
+      last_decompressed_.end = frame->offset + frame->size;
+      frame_cache_->Insert(blob_id_, frame);
+    }
+
+    const uint64_t frame_offset = offset - frame->offset;
+    const uint64_t length = std::min(num_bytes - copied, frame->size - frame_offset);
+    memcpy(buf + copied, frame->data.get() + frame_offset, length);
+    copied += length;
+  }
+
+  // TODO(markdittmer): Perform verification over block-aligned data that was read.
+
+  return ZX_OK;
+}
+
 ZSTDSeekableBlob::ZSTDSeekableBlob(
     fzl::VmoMapper* mapped_vmo,
-    std::unique_ptr<ZSTDCompressedBlockCollection> compressed_block_collection)
+    std::unique_ptr<ZSTDCompressedBlockCollection> compressed_block_collection,
+    const DecompressedFrameCache::BlobId& blob_id, DecompressedFrameCache* frame_cache,
+    std::mutex* transfer_lock)
     : mapped_vmo_(mapped_vmo),
-      compressed_block_collection_(std::move(compressed_block_collection)) {}
+      compressed_block_collection_(std::move(compressed_block_collection)),
+      blob_id_(blob_id),
+      frame_cache_(frame_cache),
+      transfer_lock_(transfer_lock) {}
 
 zx_status_t ZSTDSeekableBlob::ReadHeader() {
   // The header is an internal BlobFS data structure that fits into one block.
@@ -302,7 +363,84 @@ zx_status_t ZSTDSeekableBlob::ReadHeader() {
     return status;
   }
 
-  return ZSTDSeekableDecompressor::ReadHeader(mapped_vmo_->start(), read_num_bytes, &header_);
+  status = ZSTDSeekableDecompressor::ReadHeader(mapped_vmo_->start(), read_num_bytes, &header_);
+  if (status != ZX_OK) {
+    return status;
+  }
+  header_loaded_ = true;
+  return ZX_OK;
+}
+
+ZSTDSeekableBlob::SeekableStream::~SeekableStream() {
+  if (d_stream_ != nullptr) {
+    ZSTD_seekable_free(d_stream_);
+  }
+}
+
+zx_status_t ZSTDSeekableBlob::SeekableStream::Init() {
+  if (!blob_->header_loaded_) {
+    zx_status_t status = blob_->ReadHeader();
+    if (status != ZX_OK) {
+      return status;
+    }
+  }
+
+  d_stream_ = ZSTD_seekable_create();
+  if (d_stream_ == nullptr) {
+    FS_TRACE_ERROR("[blobfs][zstd-seekable] Failed to create seekable dstream\n");
+    return ZX_ERR_INTERNAL;
+  }
+
+  file_ = ZSTDSeekableFile{
+      .blob = blob_,
+      .blocks = blob_->compressed_block_collection_.get(),
+      .byte_offset = 0,
+      .num_bytes = blob_->header_.archive_size,
+      .status = ZX_OK,
+  };
+  size_t zstd_return = ZSTD_seekable_initAdvanced(d_stream_, ZSTD_seekable_customFile{
+                                                                 .opaque = &file_,
+                                                                 .read = ZSTDRead,
+                                                                 .seek = ZSTDSeek,
+                                                             });
+  if (ZSTD_isError(zstd_return)) {
+    FS_TRACE_ERROR("[blobfs][zstd-seekable] Failed to initialize seekable dstream: %s\n",
+                   ZSTD_getErrorName(zstd_return));
+    return ZX_ERR_INTERNAL;
+  }
+  return ZX_OK;
+}
+
+zx_status_t ZSTDSeekableBlob::SeekableStream::DecompressFrameAt(
+    uint64_t data_byte_offset, std::shared_ptr<const DecompressedFrame>* out) {
+  const unsigned frame_index = ZSTD_seekable_offsetToFrameIndex(d_stream_, data_byte_offset);
+  if (frame_index >= ZSTD_seekable_getNumFrames(d_stream_)) {
+    // Reading beyond the end of the blob is reported the same way as by
+    // |ZSTD_seekable_decompress|.
+    FS_TRACE_ERROR("[blobfs][zstd-seekable] No frame at offset %lu\n", data_byte_offset);
+    return ZX_ERR_IO_DATA_INTEGRITY;
+  }
+
+  auto frame = std::make_shared<DecompressedFrame>();
+  frame->offset = ZSTD_seekable_getFrameDecompressedOffset(d_stream_, frame_index);
+  frame->size = ZSTD_seekable_getFrameDecompressedSize(d_stream_, frame_index);
+  frame->data = std::make_unique<uint8_t[]>(frame->size);
+
+  TRACE_DURATION("blobfs", "ZSTDSeekableBlob::DecompressFrame", "frame_offset", frame->offset,
+                 "frame_size", frame->size);
+  size_t zstd_return =
+      ZSTD_seekable_decompressFrame(d_stream_, frame->data.get(), frame->size, frame_index);
+  if (ZSTD_isError(zstd_return) || zstd_return != frame->size) {
+    FS_TRACE_ERROR("[blobfs][zstd-seekable] Failed to decompress frame %u: %s\n", frame_index,
+                   ZSTD_isError(zstd_return) ? ZSTD_getErrorName(zstd_return) : "short frame");
+    if (file_.status != ZX_OK) {
+      return file_.status;
+    }
+    return ZX_ERR_IO_DATA_INTEGRITY;
+  }
+
+  *out = std::move(frame);
+  return ZX_OK;
 }
 
 }  // namespace blobfs
@@ -11,10 +11,12 @@
 #include <zircon/types.h>
 
 #include <memory>
+#include <mutex>
 
 #include <fbl/macros.h>
 #include <zstd/zstd_seekable.h>
 
+#include "decompressed-frame-cache.h"
 #include "zstd-compressed-block-collection.h"
 #include "zstd-seekable.h"
 
@@ -36,6 +38,26 @@ class RandomAccessCompressedBlob {
   virtual zx_status_t Read(uint8_t* buf, uint64_t data_byte_offset, uint64_t num_bytes) = 0;
 };
 
+class ZSTDSeekableBlob;
+
+// A range [begin, end) of uncompressed bytes of a blob.
+struct UncompressedRange {
+  uint64_t begin = 0;
+  uint64_t end = 0;
+
+  bool empty() const { return begin >= end; }
+};
+
+// Type used for opaque pointer in ZSTD Seekable custom |ZSTD_seekable_seek| and
+// |ZSTD_seekable_read| API.
+struct ZSTDSeekableFile {
+  ZSTDSeekableBlob* blob;
+  ZSTDCompressedBlockCollection* blocks;
+  unsigned long long byte_offset;
+  unsigned long long num_bytes;
+  zx_status_t status;
+};
+
 // ZSTDSeekableBlob as an implementation of |RandomAccessCompressedBlob| that uses the ZSTD Seekable
 // Format.
 //
@@ -49,32 +71,75 @@ class ZSTDSeekableBlob : public RandomAccessCompressedBlob {
       std::unique_ptr<ZSTDCompressedBlockCollection> compressed_block_collection,
       std::unique_ptr<ZSTDSeekableBlob>* out);
 
+  // Create a |ZSTDSeekableBlob| which looks up decompressed frames in |frame_cache| before
+  // reading and decompressing them, and adds the frames it decompresses. |blob_id| identifies the
+  // blob within the cache.
+  //
+  // The header is only read once a frame must be decompressed, so reads served entirely from the
+  // cache do not touch storage. If |transfer_lock| is not null, it is held whenever
+  // |mapped_vmo| is in use, so that blobs sharing the VMO may be read from several threads; reads
+  // served entirely from the cache do not take it.
+  static zx_status_t Create(
+      fzl::VmoMapper* mapped_vmo,
+      std::unique_ptr<ZSTDCompressedBlockCollection> compressed_block_collection,
+      const DecompressedFrameCache::BlobId& blob_id, DecompressedFrameCache* frame_cache,
+      std::unique_ptr<ZSTDSeekableBlob>* out, std::mutex* transfer_lock = nullptr);
+
   // RandomAccessCompressedBlob implementation.
   zx_status_t Read(uint8_t* buf, uint64_t data_byte_offset, uint64_t num_bytes) final;
 
+  // The range covered by the frames which the last |Read| decompressed from storage rather than
+  // found in the frame cache. Empty if every frame was cached. Without a frame cache, this is
+  // the range of the last read.
+  const UncompressedRange& last_decompressed() const { return last_decompressed_; }
+
   const uint8_t* decompressed_data_start() const {
     return static_cast<uint8_t*>(mapped_vmo_->start());
   }
 
  private:
   ZSTDSeekableBlob(fzl::VmoMapper* mapped_vmo,
-                   std::unique_ptr<ZSTDCompressedBlockCollection> compressed_block_collection);
+                   std::unique_ptr<ZSTDCompressedBlockCollection> compressed_block_collection,
+                   const DecompressedFrameCache::BlobId& blob_id,
+                   DecompressedFrameCache* frame_cache, std::mutex* transfer_lock);
 
   zx_status_t ReadHeader();
 
+  // A decompression stream over this blob, which reads compressed data through
+  // |compressed_block_collection_|.
+  class SeekableStream {
+   public:
+    explicit SeekableStream(ZSTDSeekableBlob* blob) : blob_(blob) {}
+    ~SeekableStream();
+    DISALLOW_COPY_ASSIGN_AND_MOVE(SeekableStream);
+
+    // Reads the header if necessary and loads the seek table.
+    zx_status_t Init();
+
+    // Decompresses the whole frame containing |data_byte_offset|.
+    zx_status_t DecompressFrameAt(uint64_t data_byte_offset,
+                                  std::shared_ptr<const DecompressedFrame>* out);
+
+    ZSTD_seekable* d_stream() { return d_stream_; }
+    ZSTDSeekableFile* file() { return &file_; }
+
+   private:
+    ZSTDSeekableBlob* const blob_;
+    ZSTD_seekable* d_stream_ = nullptr;
+    ZSTDSeekableFile file_ = {};
+  };
+
+  // Read implementation which goes through |frame_cache_| one frame at a time.
+  zx_status_t ReadCached(uint8_t* buf, uint64_t data_byte_offset, uint64_t num_bytes);
+
   ZSTDSeekableHeader header_;
+  bool header_loaded_ = false;
   fzl::VmoMapper* mapped_vmo_;
   std::unique_ptr<ZSTDCompressedBlockCollection> compressed_block_collection_;
-};
-
-// Type used for opaque pointer in ZSTD Seekable custom |ZSTD_seekable_seek| and
-// |ZSTD_seekable_read| API.
-struct ZSTDSeekableFile {
-  ZSTDSeekableBlob* blob;
-  ZSTDCompressedBlockCollection* blocks;
-  unsigned long long byte_offset;
-  unsigned long long num_bytes;
-  zx_status_t status;
+  const DecompressedFrameCache::BlobId blob_id_;
+  DecompressedFrameCache* const frame_cache_;
+  std::mutex* const transfer_lock_;
+  UncompressedRange last_decompressed_;
 };
 
 // ZSTD Seekable custom |ZSTD_seekable_seek| and |ZSTD_seekable_read| API.
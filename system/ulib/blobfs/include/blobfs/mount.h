@@ -52,6 +52,12 @@ struct MountOptions {
   // Blobs that are already stored on disk using another compression algorithm from disk are not
   // affected by this flag.
   CompressionAlgorithm write_compression_algorithm = CompressionAlgorithm::ZSTD_SEEKABLE;
+  // Number of threads servicing filesystem requests. Operations on readable blobs are dispatched
+  // concurrently when this is greater than one.
+  uint32_t serving_threads = 1;
+  // Number of threads which hash and compress blobs while they are being written. Zero selects one
+  // thread per CPU.
+  uint32_t write_threads = 0;
 };
 
 // Begins serving requests to the filesystem by parsing the on-disk format using |device|. If
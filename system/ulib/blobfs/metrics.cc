@@ -61,6 +61,11 @@ void BlobfsMetrics::Dump() {
                 total_writeback_bytes_written_ / mb, TicksToMs(total_writeback_time_ticks_));
   FS_TRACE_INFO("Lookup Info:\n");
   FS_TRACE_INFO("  Opened %zu blobs (%zu MB)\n", blobs_opened_, blobs_opened_total_size_ / mb);
+  if (const fs::LookupCache* lookup_cache = lookup_cache_.load(std::memory_order_acquire)) {
+    fs::LookupCache::Stats stats = lookup_cache->GetStats();
+    FS_TRACE_INFO("  Lookup cache: %zu negative hits, %zu misses, %zu evictions\n",
+                  stats.negative_hits, stats.misses, stats.evictions);
+  }
 
   auto verify_snapshot = verification_metrics_.Get();
   auto read_snapshot = read_metrics_.GetDiskRead();
@@ -76,6 +81,11 @@ void BlobfsMetrics::ScheduleMetricFlush() {
   async::PostDelayedTask(
       flush_loop_.dispatcher(),
       [this]() {
+        if (const fs::LookupCache* lookup_cache = lookup_cache_.load(std::memory_order_acquire)) {
+          fs::LookupCache::Stats stats = lookup_cache->GetStats();
+          cobalt_metrics_.mutable_lookup_cache_metrics()->Update(stats.hits, stats.negative_hits,
+                                                                 stats.misses);
+        }
         mutable_collector()->Flush();
         ScheduleMetricFlush();
       },
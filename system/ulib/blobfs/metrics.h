@@ -12,8 +12,11 @@
 #include <lib/inspect/cpp/inspect.h>
 #include <lib/zx/time.h>
 
+#include <atomic>
+
 #include <blobfs/format.h>
 #include <cobalt-client/cpp/collector.h>
+#include <fs/lookup_cache.h>
 #include <fs/metrics/cobalt_metrics.h>
 #include <fs/metrics/composite_latency_event.h>
 #include <fs/metrics/events.h>
@@ -78,6 +81,13 @@ class BlobfsMetrics {
   ReadMetrics& read_metrics() { return read_metrics_; }
   VerificationMetrics& verification_metrics() { return verification_metrics_; }
 
+  // Sets the lookup cache of the Vfs serving blobfs, whose statistics are reported alongside the
+  // other metrics. |cache| must outlive this object. This may be called while the metrics are
+  // being flushed from the flusher thread.
+  void set_lookup_cache(const fs::LookupCache* cache) {
+    lookup_cache_.store(cache, std::memory_order_release);
+  }
+
  private:
   // Returns the underlying collector of cobalt metrics.
   cobalt_client::Collector* mutable_collector() { return cobalt_metrics_.mutable_collector(); }
@@ -111,6 +121,7 @@ class BlobfsMetrics {
   // Opened via "LookupBlob".
   uint64_t blobs_opened_ = 0;
   uint64_t blobs_opened_total_size_ = 0;
+  std::atomic<const fs::LookupCache*> lookup_cache_ = nullptr;
 
   // READ STATS
   ReadMetrics read_metrics_;
@@ -9,6 +9,7 @@
 #include <utility>
 
 #include <blobfs/mount.h>
+#include <fs/trace.h>
 #include <trace-provider/provider.h>
 
 #include "runner.h"
@@ -31,7 +32,19 @@ zx_status_t Mount(std::unique_ptr<BlockDevice> device, MountOptions* options, zx
   if (status != ZX_OK) {
     return status;
   }
+  // Additional serving threads only run handlers concurrently for vnodes which opt in through
+  // |fs::Vnode::SupportsConcurrentDispatch|; everything else is still serialized by the Vfs.
+  for (uint32_t i = 1; i < options->serving_threads; i++) {
+    status = loop.StartThread("blobfs-serving");
+    if (status != ZX_OK) {
+      FS_TRACE_WARN("blobfs: Failed to start serving thread: %d\n", status);
+      break;
+    }
+  }
   loop.Run();
+  // The runner must outlive every handler, so wait for the other serving threads to observe the
+  // loop quitting before it is destroyed.
+  loop.JoinThreads();
   return ZX_OK;
 }
 
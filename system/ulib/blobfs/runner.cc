@@ -11,6 +11,12 @@
 #include "query.h"
 
 namespace blobfs {
+namespace {
+
+// Maximum number of names remembered by the lookup cache.
+constexpr size_t kLookupCacheCapacity = 1024;
+
+}  // namespace
 
 // static.
 zx_status_t Runner::Create(async::Loop* loop, std::unique_ptr<BlockDevice> device,
@@ -31,9 +37,16 @@ zx_status_t Runner::Create(async::Loop* loop, std::unique_ptr<BlockDevice> devic
 Runner::Runner(async::Loop* loop, std::unique_ptr<Blobfs> fs)
     : ManagedVfs(loop->dispatcher()), loop_(loop), blobfs_(std::move(fs)) {
   SetReadonly(blobfs_->writability() != Writability::Writable);
+  // Blobs are pinned in memory by the blob cache according to its own policy, so only remember
+  // names which do not exist. These absorb the repeated probes of package resolution.
+  lookup_cache().SetCapacity(kLookupCacheCapacity, fs::LookupCache::Policy::kNegativeOnly);
+  blobfs_->Metrics()->set_lookup_cache(&lookup_cache());
 }
 
-Runner::~Runner() {}
+Runner::~Runner() {
+  // Negative entries still reference the root directory, which refers back to |blobfs_|.
+  lookup_cache().Clear();
+}
 
 void Runner::Shutdown(fs::Vfs::ShutdownCallback cb) {
   TRACE_DURATION("blobfs", "Runner::Unmount");
@@ -0,0 +1,138 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "blob-write-pipeline.h"
+
+#include <lib/async-loop/cpp/loop.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+
+#include <digest/merkle-tree.h>
+#include <zxtest/zxtest.h>
+
+namespace blobfs {
+namespace {
+
+constexpr size_t kWriteChunkSize = 37 * 1024;
+
+class BlobWritePipelineTest : public zxtest::Test {
+ public:
+  void SetUp() override {
+    srand(zxtest::Runner::GetInstance()->random_seed());
+    ASSERT_OK(loop_.StartThread("worker-1"));
+    ASSERT_OK(loop_.StartThread("worker-2"));
+    ASSERT_OK(loop_.StartThread("worker-3"));
+  }
+
+ protected:
+  // Builds the Merkle tree of |data| both serially and through a pipeline fed in small writes,
+  // and checks that both are identical.
+  void RunMerkleTest(async_dispatcher_t* workers, const uint8_t* data, size_t len) {
+    digest::MerkleTreeCreator expected;
+    ASSERT_OK(expected.SetDataLength(len));
+    const size_t tree_len = expected.GetTreeLength();
+    std::unique_ptr<uint8_t[]> expected_tree(new uint8_t[tree_len]);
+    uint8_t expected_root[digest::kSha256Length];
+    ASSERT_OK(expected.SetTree(expected_tree.get(), tree_len, expected_root,
+                               sizeof(expected_root)));
+    ASSERT_OK(expected.Append(data, len));
+
+    digest::MerkleTreeCreator actual;
+    ASSERT_OK(actual.SetDataLength(len));
+    std::unique_ptr<uint8_t[]> actual_tree(new uint8_t[tree_len]);
+    uint8_t actual_root[digest::kSha256Length];
+    ASSERT_OK(actual.SetTree(actual_tree.get(), tree_len, actual_root, sizeof(actual_root)));
+
+    BlobWritePipeline pipeline(workers, data, len, &actual, nullptr, 0);
+    for (size_t written = 0; written < len;) {
+      written = std::min(len, written + kWriteChunkSize);
+      pipeline.Update(written);
+    }
+    ASSERT_OK(pipeline.Finish());
+
+    EXPECT_BYTES_EQ(expected_root, actual_root, sizeof(expected_root));
+    EXPECT_BYTES_EQ(expected_tree.get(), actual_tree.get(), tree_len);
+  }
+
+  async::Loop loop_{&kAsyncLoopConfigNoAttachToCurrentThread};
+};
+
+void FillWithRandom(uint8_t* buf, size_t len) {
+  for (size_t i = 0; i < len; ++i) {
+    buf[i] = static_cast<uint8_t>(rand());
+  }
+}
+
+TEST_F(BlobWritePipelineTest, MerkleTreeMatchesSerialCreation) {
+  for (size_t len : {size_t{8193}, size_t{300 * 1024}, size_t{3 * 1024 * 1024 + 17}}) {
+    std::unique_ptr<uint8_t[]> data(new uint8_t[len]);
+    FillWithRandom(data.get(), len);
+    ASSERT_NO_FAILURES(RunMerkleTest(loop_.dispatcher(), data.get(), len));
+  }
+}
+
+TEST_F(BlobWritePipelineTest, RunsInlineWithoutWorkers) {
+  const size_t len = 1024 * 1024 + 1;
+  std::unique_ptr<uint8_t[]> data(new uint8_t[len]);
+  FillWithRandom(data.get(), len);
+  ASSERT_NO_FAILURES(RunMerkleTest(nullptr, data.get(), len));
+}
+
+TEST_F(BlobWritePipelineTest, CompressesCompressibleData) {
+  const size_t len = 2 * 1024 * 1024;
+  std::unique_ptr<uint8_t[]> data(new uint8_t[len]);
+  memset(data.get(), 'a', len);
+
+  std::optional<BlobCompressor> compressor =
+      BlobCompressor::Create(CompressionAlgorithm::ZSTD_SEEKABLE, len);
+  ASSERT_TRUE(compressor);
+
+  BlobWritePipeline pipeline(loop_.dispatcher(), data.get(), len, nullptr, &*compressor, len / 2);
+  for (size_t written = 0; written < len;) {
+    written = std::min(len, written + kWriteChunkSize);
+    pipeline.Update(written);
+  }
+  ASSERT_OK(pipeline.Finish());
+  EXPECT_FALSE(pipeline.compression_aborted());
+  EXPECT_LT(compressor->Size(), len / 2);
+}
+
+TEST_F(BlobWritePipelineTest, AbortsCompressionOfIncompressibleData) {
+  const size_t len = 2 * 1024 * 1024;
+  std::unique_ptr<uint8_t[]> data(new uint8_t[len]);
+  FillWithRandom(data.get(), len);
+
+  std::optional<BlobCompressor> compressor =
+      BlobCompressor::Create(CompressionAlgorithm::ZSTD_SEEKABLE, len);
+  ASSERT_TRUE(compressor);
+
+  BlobWritePipeline pipeline(loop_.dispatcher(), data.get(), len, nullptr, &*compressor, len / 2);
+  pipeline.Update(len);
+  ASSERT_OK(pipeline.Finish());
+  EXPECT_TRUE(pipeline.compression_aborted());
+}
+
+TEST_F(BlobWritePipelineTest, FailsIfWorkersShutDown) {
+  const size_t len = 1024 * 1024;
+  std::unique_ptr<uint8_t[]> data(new uint8_t[len]);
+  FillWithRandom(data.get(), len);
+
+  digest::MerkleTreeCreator merkle;
+  ASSERT_OK(merkle.SetDataLength(len));
+  const size_t tree_len = merkle.GetTreeLength();
+  std::unique_ptr<uint8_t[]> tree(new uint8_t[tree_len]);
+  uint8_t root[digest::kSha256Length];
+  ASSERT_OK(merkle.SetTree(tree.get(), tree_len, root, sizeof(root)));
+
+  loop_.Shutdown();
+  BlobWritePipeline pipeline(loop_.dispatcher(), data.get(), len, &merkle, nullptr, 0);
+  pipeline.Update(len);
+  EXPECT_NOT_OK(pipeline.Finish());
+}
+
+}  // namespace
+}  // namespace blobfs
@@ -0,0 +1,157 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "compression/decompressed-frame-cache.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <zxtest/zxtest.h>
+
+namespace blobfs {
+namespace {
+
+std::shared_ptr<const DecompressedFrame> MakeFrame(uint64_t offset, size_t size) {
+  auto frame = std::make_shared<DecompressedFrame>();
+  frame->offset = offset;
+  frame->size = size;
+  frame->data = std::make_unique<uint8_t[]>(size);
+  return frame;
+}
+
+DecompressedFrameCache::BlobId MakeBlobId(uint8_t value) {
+  DecompressedFrameCache::BlobId id = {};
+  id[0] = value;
+  return id;
+}
+
+TEST(DecompressedFrameCacheTest, LookupFindsFrameContainingOffset) {
+  DecompressedFrameCache cache(1024);
+  const auto blob = MakeBlobId(1);
+  EXPECT_NULL(cache.Lookup(blob, 0));
+
+  cache.Insert(blob, MakeFrame(0, 100));
+  cache.Insert(blob, MakeFrame(100, 100));
+
+  std::shared_ptr<const DecompressedFrame> frame = cache.Lookup(blob, 0);
+  ASSERT_NOT_NULL(frame);
+  EXPECT_EQ(0, frame->offset);
+  frame = cache.Lookup(blob, 199);
+  ASSERT_NOT_NULL(frame);
+  EXPECT_EQ(100, frame->offset);
+  EXPECT_NULL(cache.Lookup(blob, 200));
+
+  DecompressedFrameCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(2, stats.hits);
+  EXPECT_EQ(2, stats.misses);
+  EXPECT_EQ(200, stats.size_bytes);
+}
+
+TEST(DecompressedFrameCacheTest, FramesAreKeyedByBlob) {
+  DecompressedFrameCache cache(1024);
+  cache.Insert(MakeBlobId(1), MakeFrame(0, 100));
+  EXPECT_NOT_NULL(cache.Lookup(MakeBlobId(1), 50));
+  EXPECT_NULL(cache.Lookup(MakeBlobId(2), 50));
+}
+
+TEST(DecompressedFrameCacheTest, EvictsLeastRecentlyUsedFrame) {
+  DecompressedFrameCache cache(300);
+  const auto blob = MakeBlobId(1);
+  cache.Insert(blob, MakeFrame(0, 100));
+  cache.Insert(blob, MakeFrame(100, 100));
+  cache.Insert(blob, MakeFrame(200, 100));
+
+  // Touch the first frame, so the second one is the least recently used.
+  EXPECT_NOT_NULL(cache.Lookup(blob, 0));
+  cache.Insert(blob, MakeFrame(300, 100));
+
+  EXPECT_NOT_NULL(cache.Lookup(blob, 0));
+  EXPECT_NULL(cache.Lookup(blob, 100));
+  EXPECT_NOT_NULL(cache.Lookup(blob, 200));
+  EXPECT_NOT_NULL(cache.Lookup(blob, 300));
+  EXPECT_EQ(1, cache.GetStats().evictions);
+  EXPECT_EQ(300, cache.GetStats().size_bytes);
+}
+
+TEST(DecompressedFrameCacheTest, EvictedFrameOutlivesReader) {
+  DecompressedFrameCache cache(100);
+  const auto blob = MakeBlobId(1);
+  cache.Insert(blob, MakeFrame(0, 100));
+  std::shared_ptr<const DecompressedFrame> frame = cache.Lookup(blob, 0);
+  ASSERT_NOT_NULL(frame);
+
+  cache.Insert(blob, MakeFrame(100, 100));
+  EXPECT_NULL(cache.Lookup(blob, 0));
+  EXPECT_EQ(100, frame->size);
+}
+
+TEST(DecompressedFrameCacheTest, OversizedFramesAreNotCached) {
+  DecompressedFrameCache cache(100);
+  const auto blob = MakeBlobId(1);
+  cache.Insert(blob, MakeFrame(0, 101));
+  EXPECT_NULL(cache.Lookup(blob, 0));
+  EXPECT_EQ(0, cache.GetStats().size_bytes);
+}
+
+TEST(DecompressedFrameCacheTest, ShrinkingAndClearingReleaseFrames) {
+  DecompressedFrameCache cache(400);
+  const auto blob = MakeBlobId(1);
+  for (uint64_t offset = 0; offset < 400; offset += 100) {
+    cache.Insert(blob, MakeFrame(offset, 100));
+  }
+
+  cache.SetCapacity(200);
+  EXPECT_EQ(200, cache.GetStats().size_bytes);
+  EXPECT_NOT_NULL(cache.Lookup(blob, 300));
+  EXPECT_NULL(cache.Lookup(blob, 0));
+
+  cache.Clear();
+  EXPECT_EQ(0, cache.GetStats().size_bytes);
+  EXPECT_NULL(cache.Lookup(blob, 300));
+}
+
+TEST(DecompressedFrameCacheTest, ErasingBlobReleasesOnlyItsFrames) {
+  DecompressedFrameCache cache(400);
+  cache.Insert(MakeBlobId(1), MakeFrame(0, 100));
+  cache.Insert(MakeBlobId(1), MakeFrame(100, 100));
+  cache.Insert(MakeBlobId(2), MakeFrame(0, 100));
+
+  cache.Erase(MakeBlobId(1));
+  EXPECT_EQ(100, cache.GetStats().size_bytes);
+  EXPECT_NULL(cache.Lookup(MakeBlobId(1), 0));
+  EXPECT_NULL(cache.Lookup(MakeBlobId(1), 100));
+  EXPECT_NOT_NULL(cache.Lookup(MakeBlobId(2), 0));
+
+  // Erasing a blob with no cached frames is a no-op.
+  cache.Erase(MakeBlobId(3));
+  EXPECT_EQ(100, cache.GetStats().size_bytes);
+}
+
+TEST(DecompressedFrameCacheTest, ConcurrentLookupsAndInserts) {
+  constexpr size_t kFrameSize = 64;
+  DecompressedFrameCache cache(16 * kFrameSize);
+  std::vector<std::thread> threads;
+  for (uint8_t i = 0; i < 4; i++) {
+    threads.emplace_back([&cache, i]() {
+      const auto blob = MakeBlobId(i % 2);
+      for (uint64_t j = 0; j < 1000; j++) {
+        const uint64_t offset = (j * 7 % 50) * kFrameSize;
+        std::shared_ptr<const DecompressedFrame> frame = cache.Lookup(blob, offset);
+        if (frame == nullptr) {
+          cache.Insert(blob, MakeFrame(offset, kFrameSize));
+        } else {
+          EXPECT_TRUE(frame->Contains(offset));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(cache.GetStats().size_bytes, 16 * kFrameSize);
+}
+
+}  // namespace
+}  // namespace blobfs
@@ -355,6 +355,74 @@ TEST_F(ZSTDSeekableBlobTest, BadSize) {
                                           node_index, buf.data(), blob_info->size_data - 1, 2));
 }
 
+TEST_F(ZSTDSeekableBlobTest, RepeatedReadsHitFrameCache) {
+  std::unique_ptr<BlobInfo> blob_info;
+  AddBlobAndSync(&blob_info);
+  uint32_t node_index = LookupInode(*blob_info);
+  std::vector<uint8_t> buf(blob_info->size_data);
+  std::vector<uint8_t> expected_buf(blob_info->size_data);
+  ZeroToSevenBlobSrcFunction(reinterpret_cast<char*>(expected_buf.data()), blob_info->size_data);
+
+  CheckRead(node_index, &buf, &expected_buf, blob_info->size_data - 29, 19);
+  DecompressedFrameCache::Stats stats = compressed_blob_collection()->GetFrameCacheStats();
+  EXPECT_EQ(0, stats.hits);
+  EXPECT_GT(stats.misses, 0);
+  EXPECT_GT(stats.size_bytes, 0);
+  const uint64_t misses = stats.misses;
+
+  // The frame is already decompressed, so neither read should miss.
+  CheckRead(node_index, &buf, &expected_buf, blob_info->size_data - 89, 61);
+  CheckRead(node_index, &buf, &expected_buf, blob_info->size_data - 53, 37);
+  stats = compressed_blob_collection()->GetFrameCacheStats();
+  EXPECT_EQ(2, stats.hits);
+  EXPECT_EQ(misses, stats.misses);
+
+  compressed_blob_collection()->ActivateLowMemory();
+  EXPECT_EQ(0, compressed_blob_collection()->GetFrameCacheStats().size_bytes);
+  CheckRead(node_index, &buf, &expected_buf, blob_info->size_data - 53, 37);
+  EXPECT_GT(compressed_blob_collection()->GetFrameCacheStats().misses, misses);
+}
+
+TEST_F(ZSTDSeekableBlobTest, ReadReportsDecompressedFrames) {
+  std::unique_ptr<BlobInfo> blob_info;
+  AddBlobAndSync(&blob_info);
+  uint32_t node_index = LookupInode(*blob_info);
+  std::vector<uint8_t> buf(blob_info->size_data);
+  const uint64_t offset = blob_info->size_data - 29;
+
+  // The frame under the read is decompressed, and covers at least the bytes which were read.
+  UncompressedRange decompressed;
+  ASSERT_OK(compressed_blob_collection()->Read(node_index, buf.data(), offset, 19, &decompressed));
+  EXPECT_LE(decompressed.begin, offset);
+  EXPECT_GE(decompressed.end, offset + 19);
+
+  // The second read is served from the frame cache.
+  ASSERT_OK(compressed_blob_collection()->Read(node_index, buf.data(), offset, 19, &decompressed));
+  EXPECT_TRUE(decompressed.empty());
+}
+
+TEST_F(ZSTDSeekableBlobTest, ReadWithoutFrameCache) {
+  std::unique_ptr<ZSTDSeekableBlobCollection> uncached_collection;
+  ASSERT_OK(ZSTDSeekableBlobCollection::Create(vmoid_registry(), space_manager(),
+                                               transaction_handler(), node_finder(),
+                                               &uncached_collection, 0));
+
+  std::unique_ptr<BlobInfo> blob_info;
+  AddBlobAndSync(&blob_info);
+  uint32_t node_index = LookupInode(*blob_info);
+  std::vector<uint8_t> buf(blob_info->size_data);
+  std::vector<uint8_t> expected(blob_info->size_data);
+  ZeroToSevenBlobSrcFunction(reinterpret_cast<char*>(expected.data()), blob_info->size_data);
+
+  for (int i = 0; i < 2; i++) {
+    ASSERT_OK(uncached_collection->Read(node_index, buf.data(), 0, blob_info->size_data));
+    ASSERT_BYTES_EQ(expected.data(), buf.data(), blob_info->size_data);
+  }
+  DecompressedFrameCache::Stats stats = uncached_collection->GetFrameCacheStats();
+  EXPECT_EQ(0, stats.hits);
+  EXPECT_EQ(0, stats.size_bytes);
+}
+
 TEST_F(ZSTDSeekableBlobNullNodeFinderTest, BadNode) {
   std::vector<uint8_t> buf(1);
 
@@ -38,6 +38,11 @@ zx_status_t HashListBase::SetDataLength(size_t data_len) {
   return ZX_OK;
 }
 
+void HashListBase::SkipTo(size_t data_off) {
+  data_off_ = data_off;
+  list_off_ = GetListOffset(node_digest_.NextAligned(data_off));
+}
+
 size_t HashListBase::GetListOffset(size_t data_off) const {
   return node_digest_.ToNode(data_off) * GetDigestSize();
 }
@@ -113,6 +118,28 @@ zx_status_t HashListCreator::Append(const void *buf, size_t buf_len) {
   return this->ProcessData(static_cast<const uint8_t *>(buf), buf_len, this->data_off());
 }
 
+zx_status_t HashListCreator::AppendAt(const void *buf, size_t buf_len, size_t data_off) {
+  size_t buf_end;
+  if (!IsAligned(data_off) || add_overflow(data_off, buf_len, &buf_end) ||
+      (!IsAligned(buf_end) && buf_end != data_len())) {
+    return ZX_ERR_INVALID_ARGS;
+  }
+  return this->ProcessData(static_cast<const uint8_t *>(buf), buf_len, data_off);
+}
+
+zx_status_t HashListCreator::Skip(size_t buf_len) {
+  size_t buf_end;
+  if (list_len() == 0) {
+    return ZX_ERR_BAD_STATE;
+  }
+  if (!IsAligned(data_off()) || add_overflow(data_off(), buf_len, &buf_end) ||
+      buf_end > data_len() || (!IsAligned(buf_end) && buf_end != data_len())) {
+    return ZX_ERR_INVALID_ARGS;
+  }
+  SkipTo(buf_end);
+  return ZX_OK;
+}
+
 void HashListCreator::HandleOne(const Digest &digest) {
   digest.CopyTo(list() + list_off(), GetDigestSize());
 }
@@ -58,6 +58,10 @@ class HashListBase {
  protected:
   void set_list_len(size_t list_len) { list_len_ = list_len; }
 
+  // Moves to |data_off| as if all the data before it had been processed. |data_off| must be
+  // node-aligned or equal to |data_len_|.
+  void SkipTo(size_t data_off);
+
   // Checks range given by |data_off| and |buf_len| is valid.
   virtual bool IsValidRange(size_t data_off, size_t buf_len);
 
@@ -118,6 +122,16 @@ class HashListCreator : public internal::HashList<uint8_t> {
   // Reads |buf_len| bytes of data from |buf| and appends digests to the hash |list|.
   zx_status_t Append(const void *buf, size_t buf_len);
 
+  // Reads |buf_len| bytes of data from |buf|, corresponding to the data starting at |data_off|, and
+  // writes their digests to the matching position in the hash |list|. |data_off| must be
+  // node-aligned, and |buf_len| must be node-aligned or reach the end of the data. Ranges may be
+  // written in any order, and by different creators sharing the same |list|.
+  zx_status_t AppendAt(const void *buf, size_t buf_len, size_t data_off);
+
+  // Advances past |buf_len| bytes of data whose digests have already been written to the hash
+  // |list| with |AppendAt|. The same alignment requirements apply.
+  zx_status_t Skip(size_t buf_len);
+
  protected:
   // Writes a single calculated digest to the appropriate position in the list.
   void HandleOne(const Digest &digest) override;
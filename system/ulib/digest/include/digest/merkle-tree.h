@@ -86,6 +86,24 @@ class MerkleTreeCreator
 
   // Reads |buf_len| bytes of data from |buf| and appends digests to the hash |list|.
   zx_status_t Append(const void *buf, size_t buf_len);
+
+  // Computes the bottom level of the tree for |buf_len| bytes of data from |buf|, starting at
+  // |data_off|. |data_off| must be node-aligned, and |buf_len| must be node-aligned or reach the
+  // end of the data. This does not modify the creator, so disjoint ranges may be hashed
+  // concurrently once |SetTree| has been called. The rest of the tree is completed by
+  // |AppendHashed|.
+  //
+  // Together, these are equivalent to |Append|, but let the bulk of the hashing be spread across
+  // threads.
+  zx_status_t HashLeaves(const void *buf, size_t buf_len, size_t data_off) const;
+
+  // Appends |buf_len| bytes of data whose bottom level digests have already been computed with
+  // |HashLeaves|.
+  zx_status_t AppendHashed(size_t buf_len);
+
+ private:
+  // Propagates the digests appended to |hash_list_| since |list_off| to the upper levels.
+  zx_status_t AppendUpperLevels(size_t list_off);
 };
 
 // |digest::MerkleTreeVerifier| verifies data against a Merkle tree.
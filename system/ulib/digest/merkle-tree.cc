@@ -121,6 +121,40 @@ zx_status_t MerkleTreeCreator::Append(const void *buf, size_t buf_len) {
   if (rc != ZX_OK) {
     return rc;
   }
+  return AppendUpperLevels(list_off);
+}
+
+zx_status_t MerkleTreeCreator::HashLeaves(const void *buf, size_t buf_len, size_t data_off) const {
+  if (buf_len == 0) {
+    return ZX_OK;
+  }
+  // Each call uses its own hash list over the shared bottom level, so that concurrent calls only
+  // write to their own part of the tree.
+  HashListCreator leaves;
+  leaves.SetNodeId(hash_list_.GetNodeId());
+  zx_status_t rc;
+  if ((rc = leaves.SetNodeSize(hash_list_.GetNodeSize())) != ZX_OK ||
+      (rc = leaves.SetDataLength(hash_list_.data_len())) != ZX_OK ||
+      (rc = leaves.SetList(hash_list_.list(), hash_list_.list_len())) != ZX_OK) {
+    return rc;
+  }
+  return leaves.AppendAt(buf, buf_len, data_off);
+}
+
+zx_status_t MerkleTreeCreator::AppendHashed(size_t buf_len) {
+  if (buf_len == 0) {
+    return ZX_OK;
+  }
+  size_t list_off = hash_list_.list_off();
+  zx_status_t rc = hash_list_.Skip(buf_len);
+  if (rc != ZX_OK) {
+    return rc;
+  }
+  return AppendUpperLevels(list_off);
+}
+
+zx_status_t MerkleTreeCreator::AppendUpperLevels(size_t list_off) {
+  zx_status_t rc;
   if (next_.get() == nullptr) {
     return ZX_OK;
   }
@@ -140,6 +140,42 @@ TEST(MerkleTree, Create) {
   }
 }
 
+TEST(MerkleTree, HashLeaves) {
+  MerkleTreeCreator creator;
+  std::unique_ptr<uint8_t[]> data;
+  std::unique_ptr<uint8_t[]> tree;
+  ASSERT_NO_FATAL_FAILURES(MaxDataAndTree(&data, &tree));
+  uint8_t root[kSha256Length];
+  Digest digest;
+  for (size_t i = 0; i < kNumTreeParams; ++i) {
+    size_t data_len = kTreeParams[i].data_len;
+    size_t tree_len = kTreeParams[i].tree_len;
+    ASSERT_OK(digest.Parse(kTreeParams[i].digest));
+    memset(root, 0, sizeof(root));
+    ASSERT_OK(creator.SetDataLength(data_len));
+    ASSERT_OK(creator.SetTree(tree.get(), tree_len, root, sizeof(root)));
+    if (data_len > kNodeSize) {
+      // Unaligned ranges are rejected.
+      EXPECT_STATUS(creator.HashLeaves(&data[1], kNodeSize, 1), ZX_ERR_INVALID_ARGS);
+      EXPECT_STATUS(creator.HashLeaves(data.get(), kNodeSize - 1, 0), ZX_ERR_INVALID_ARGS);
+    }
+    // Hash the nodes back to front, then complete the tree one node at a time.
+    for (size_t data_off = fbl::round_down(data_len, kNodeSize) + kNodeSize; data_off > 0;) {
+      data_off -= kNodeSize;
+      if (data_off < data_len) {
+        size_t buf_len = fbl::min(data_len - data_off, kNodeSize);
+        EXPECT_OK(creator.HashLeaves(&data[data_off], buf_len, data_off));
+      }
+    }
+    for (size_t data_off = 0; data_off < data_len; data_off += kNodeSize) {
+      EXPECT_OK(creator.AppendHashed(fbl::min(data_len - data_off, kNodeSize)));
+    }
+    EXPECT_BYTES_EQ(root, digest.get(), sizeof(root));
+    // Too much
+    EXPECT_STATUS(creator.AppendHashed(1), ZX_ERR_INVALID_ARGS);
+  }
+}
+
 TEST(MerkleTree, Verify) {
   srand(zxtest::Runner::GetInstance()->random_seed());
   MerkleTreeCreator creator;
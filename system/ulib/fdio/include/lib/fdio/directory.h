@@ -5,9 +5,11 @@
 #ifndef LIB_FDIO_DIRECTORY_H_
 #define LIB_FDIO_DIRECTORY_H_
 
+#include <dirent.h>
 #include <lib/fdio/fd.h>
 #include <lib/fdio/fdio.h>
 #include <stdint.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include <zircon/compiler.h>
 #include <zircon/types.h>
@@ -108,6 +110,20 @@ zx_status_t fdio_open_fd(const char* path, uint32_t flags, int* out_fd);
 // See |fdio_service_connect| fort details.
 zx_status_t fdio_open_fd_at(int dir_fd, const char* path, uint32_t flags, int* out_fd);
 
+// Reads the next entry of |dir| like |readdir|, together with its attributes as
+// |fstatat(dirfd(dir), entry->d_name, out_stat, 0)| would return them.
+//
+// Directories served by the fs library return the attributes of their entries
+// together with the entries, which saves a round trip per entry. For other
+// directories, and for entries such as mount points, this falls back to
+// |fstatat|.
+//
+// Returns 0 and sets |*out_entry| to the entry on success, or to NULL at the
+// end of the directory. Returns -1 and sets errno on failure. If only the
+// attributes of the entry could not be read, |*out_entry| is still set to the
+// entry, which has been consumed.
+int fdio_readdir_stat(DIR* dir, struct dirent** out_entry, struct stat* out_stat);
+
 // Clone the given |node| asynchronously.
 //
 // |node| must be a channel that implements the |fuchsia.io.Node| protocol.
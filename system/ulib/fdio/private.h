@@ -333,6 +333,9 @@ zx_status_t fdio_default_set_attr(fdio_t* io, const zxio_node_attributes_t* attr
 // Defaults to running conversion assuming the object is a file.
 uint32_t fdio_default_convert_to_posix_mode(fdio_t* io, zxio_node_protocols_t protocols,
                                             zxio_abilities_t abilities);
+// Runs conversion assuming the object is a directory.
+uint32_t fdio_dir_convert_to_posix_mode(fdio_t* io, zxio_node_protocols_t protocols,
+                                        zxio_abilities_t abilities);
 zx_status_t fdio_default_dirent_iterator_init(fdio_t* io, zxio_dirent_iterator_t* iterator,
                                               zxio_t* directory);
 zx_status_t fdio_default_dirent_iterator_next(fdio_t* io, zxio_dirent_iterator_t* iterator,
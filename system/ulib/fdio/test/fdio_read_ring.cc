@@ -0,0 +1,410 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <fuchsia/io/llcpp/fidl.h>
+#include <lib/async-loop/cpp/loop.h>
+#include <lib/async-loop/default.h>
+#include <lib/async/cpp/wait.h>
+#include <lib/fdio/fd.h>
+#include <lib/fidl-async/cpp/bind.h>
+#include <lib/fidl/llcpp/vector_view.h>
+#include <lib/zx/channel.h>
+#include <lib/zx/clock.h>
+#include <lib/zx/fifo.h>
+#include <lib/zx/vmar.h>
+#include <lib/zx/vmo.h>
+#include <stdio.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <zircon/rights.h>
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include <fbl/unique_fd.h>
+#include <zxtest/zxtest.h>
+
+namespace {
+
+namespace fuchsia_io = ::llcpp::fuchsia::io;
+
+constexpr size_t kFileSize = 1024 * 1024;
+
+struct Context {
+  zx::vmo contents;
+  uint64_t seek;
+  bool supports_read_ring;
+  // Whether the ring server closes its FIFO instead of serving the next read.
+  bool break_ring;
+  // The number of reads served over the channel and over the ring.
+  size_t channel_reads;
+  size_t ring_reads;
+};
+
+// Serves the read ring of a |TestServer|, on the same dispatcher.
+class RingServer {
+ public:
+  RingServer(Context* context, zx::fifo fifo, uint8_t* buffer, size_t size)
+      : context_(context), fifo_(std::move(fifo)), buffer_(buffer), size_(size) {}
+
+  ~RingServer() {
+    wait_.Cancel();
+    zx::vmar::root_self()->unmap(reinterpret_cast<zx_vaddr_t>(buffer_), size_);
+  }
+
+  zx_status_t Begin(async_dispatcher_t* dispatcher) {
+    wait_.set_object(fifo_.get());
+    wait_.set_trigger(ZX_FIFO_READABLE | ZX_FIFO_PEER_CLOSED);
+    return wait_.Begin(dispatcher);
+  }
+
+ private:
+  void OnSignals(async_dispatcher_t* dispatcher, async::WaitBase* wait, zx_status_t status,
+                 const zx_packet_signal_t* signal) {
+    if (status != ZX_OK || !(signal->observed & ZX_FIFO_READABLE)) {
+      return;
+    }
+    if (context_->break_ring) {
+      fifo_.reset();
+      return;
+    }
+    fuchsia_io::ReadRingEntry entries[fuchsia_io::READ_RING_FIFO_DEPTH];
+    size_t count;
+    if (fifo_.read(sizeof(entries[0]), entries, std::size(entries), &count) != ZX_OK) {
+      return;
+    }
+    for (size_t i = 0; i < count; i++) {
+      fuchsia_io::ReadRingEntry& entry = entries[i];
+      if (entry.buffer_offset > size_ || entry.count > size_ - entry.buffer_offset) {
+        entry.status = ZX_ERR_OUT_OF_RANGE;
+        entry.count = 0;
+        continue;
+      }
+      bool seek = entry.flags & fuchsia_io::READ_RING_FLAG_SEEK;
+      uint64_t offset = seek ? context_->seek : entry.offset;
+      size_t actual = offset < kFileSize ? std::min<size_t>(entry.count, kFileSize - offset) : 0;
+      entry.status = context_->contents.read(buffer_ + entry.buffer_offset, offset, actual);
+      entry.count = entry.status == ZX_OK ? static_cast<uint32_t>(actual) : 0;
+      if (seek) {
+        context_->seek += entry.count;
+      }
+      context_->ring_reads++;
+    }
+    if (fifo_.write(sizeof(entries[0]), entries, count, nullptr) != ZX_OK) {
+      return;
+    }
+    wait->Begin(dispatcher);
+  }
+
+  Context* context_;
+  zx::fifo fifo_;
+  uint8_t* buffer_;
+  size_t size_;
+  async::WaitMethod<RingServer, &RingServer::OnSignals> wait_{this};
+};
+
+class TestServer final : public fuchsia_io::File::Interface {
+ public:
+  TestServer(Context* context, async_dispatcher_t* dispatcher)
+      : context_(context), dispatcher_(dispatcher) {}
+
+  void Clone(uint32_t flags, zx::channel object, CloneCompleter::Sync completer) override {}
+
+  void Close(CloseCompleter::Sync completer) override { completer.Reply(ZX_OK); }
+
+  void Describe(DescribeCompleter::Sync completer) override {
+    fuchsia_io::FileObject fo;
+    completer.Reply(fuchsia_io::NodeInfo::WithFile(fidl::unowned_ptr(&fo)));
+  }
+
+  void Sync(SyncCompleter::Sync completer) override {}
+
+  void GetAttr(GetAttrCompleter::Sync completer) override {
+    fuchsia_io::NodeAttributes attributes;
+    attributes.id = 5;
+    attributes.content_size = kFileSize;
+    attributes.storage_size = kFileSize;
+    attributes.link_count = 1;
+    completer.Reply(ZX_OK, std::move(attributes));
+  }
+
+  void SetAttr(uint32_t flags, fuchsia_io::NodeAttributes attribute,
+               SetAttrCompleter::Sync completer) override {}
+
+  void Read(uint64_t count, ReadCompleter::Sync completer) override {
+    ReadAtInternal(count, context_->seek, &context_->seek, completer);
+  }
+
+  void ReadAt(uint64_t count, uint64_t offset, ReadAtCompleter::Sync completer) override {
+    ReadAtInternal(count, offset, nullptr, completer);
+  }
+
+  void Write(fidl::VectorView<uint8_t> data, WriteCompleter::Sync completer) override {}
+
+  void WriteAt(fidl::VectorView<uint8_t> data, uint64_t offset,
+               WriteAtCompleter::Sync completer) override {}
+
+  void Seek(int64_t offset, fuchsia_io::SeekOrigin start, SeekCompleter::Sync completer) override {
+    if (start != fuchsia_io::SeekOrigin::START || offset < 0) {
+      return completer.Reply(ZX_ERR_NOT_SUPPORTED, context_->seek);
+    }
+    context_->seek = offset;
+    completer.Reply(ZX_OK, context_->seek);
+  }
+
+  void Truncate(uint64_t length, TruncateCompleter::Sync completer) override {}
+
+  void GetFlags(GetFlagsCompleter::Sync completer) override {}
+
+  void SetFlags(uint32_t flags, SetFlagsCompleter::Sync completer) override {}
+
+  void GetBuffer(uint32_t flags, GetBufferCompleter::Sync completer) override {
+    completer.Reply(ZX_ERR_NOT_SUPPORTED, nullptr);
+  }
+
+  void GetReadRing(uint64_t size, GetReadRingCompleter::Sync completer) override {
+    if (!context_->supports_read_ring) {
+      // Servers which do not assert FILE_SIGNAL_READ_RING close the channel instead.
+      return completer.Close(ZX_ERR_NOT_SUPPORTED);
+    }
+    ring_.reset();
+    zx::vmo buffer;
+    zx_status_t status = zx::vmo::create(size, 0, &buffer);
+    if (status != ZX_OK) {
+      return completer.Reply(status, zx::vmo(), zx::fifo());
+    }
+    zx_vaddr_t addr;
+    status = zx::vmar::root_self()->map(0, buffer, 0, size, ZX_VM_PERM_READ | ZX_VM_PERM_WRITE,
+                                        &addr);
+    if (status != ZX_OK) {
+      return completer.Reply(status, zx::vmo(), zx::fifo());
+    }
+    zx::fifo client, server;
+    status = zx::fifo::create(fuchsia_io::READ_RING_FIFO_DEPTH,
+                              sizeof(fuchsia_io::ReadRingEntry), 0, &client, &server);
+    if (status == ZX_OK) {
+      status = buffer.replace(ZX_RIGHTS_BASIC | ZX_RIGHT_READ | ZX_RIGHT_MAP, &buffer);
+    }
+    ring_ = std::make_unique<RingServer>(context_, std::move(server),
+                                         reinterpret_cast<uint8_t*>(addr), size);
+    if (status == ZX_OK) {
+      status = ring_->Begin(dispatcher_);
+    }
+    if (status != ZX_OK) {
+      ring_.reset();
+      return completer.Reply(status, zx::vmo(), zx::fifo());
+    }
+    completer.Reply(ZX_OK, std::move(buffer), std::move(client));
+  }
+
+ private:
+  template <typename Completer>
+  void ReadAtInternal(uint64_t count, uint64_t offset, uint64_t* seek, Completer& completer) {
+    context_->channel_reads++;
+    if (count > fuchsia_io::MAX_BUF) {
+      return completer.Reply(ZX_ERR_INVALID_ARGS, fidl::VectorView<uint8_t>());
+    }
+    size_t actual = offset < kFileSize ? std::min<size_t>(count, kFileSize - offset) : 0;
+    uint8_t buffer[fuchsia_io::MAX_BUF];
+    zx_status_t status = context_->contents.read(buffer, offset, actual);
+    if (status != ZX_OK) {
+      return completer.Reply(status, fidl::VectorView<uint8_t>());
+    }
+    if (seek) {
+      *seek += actual;
+    }
+    completer.Reply(ZX_OK, fidl::VectorView(fidl::unowned_ptr(buffer), actual));
+  }
+
+  Context* context_;
+  async_dispatcher_t* dispatcher_;
+  std::unique_ptr<RingServer> ring_;
+};
+
+class ReadRingTest : public zxtest::Test {
+ protected:
+  ReadRingTest() : loop_(&kAsyncLoopConfigNoAttachToCurrentThread) {}
+
+  void SetUp() override {
+    ASSERT_OK(loop_.StartThread("fake-filesystem"));
+    ASSERT_OK(zx::vmo::create(kFileSize, 0, &context_.contents));
+    std::vector<uint8_t> contents(kFileSize);
+    for (size_t i = 0; i < kFileSize; i++) {
+      contents[i] = static_cast<uint8_t>(i * 7 + i / 251);
+    }
+    ASSERT_OK(context_.contents.write(contents.data(), 0, kFileSize));
+    expected_ = std::move(contents);
+  }
+
+  void TearDown() override { loop_.Shutdown(); }
+
+  // Opens the file over a new connection, which advertises read rings if
+  // |supports_read_ring|.
+  void Open(bool supports_read_ring, fbl::unique_fd* out_fd) {
+    context_.seek = 0;
+    context_.supports_read_ring = supports_read_ring;
+    context_.break_ring = false;
+    context_.channel_reads = 0;
+    context_.ring_reads = 0;
+
+    zx::channel client, server;
+    ASSERT_OK(zx::channel::create(0, &client, &server));
+    if (supports_read_ring) {
+      ASSERT_OK(server.signal_peer(0, fuchsia_io::FILE_SIGNAL_READ_RING));
+    }
+    ASSERT_OK(fidl::Bind(loop_.dispatcher(), std::move(server),
+                         std::make_unique<TestServer>(&context_, loop_.dispatcher())));
+    int raw_fd = -1;
+    ASSERT_OK(fdio_fd_create(client.release(), &raw_fd));
+    out_fd->reset(raw_fd);
+  }
+
+  // Reads the whole file with |read| in chunks of |chunk| bytes, and returns
+  // the time taken.
+  void ReadAll(int fd, size_t chunk, zx::duration* out_elapsed) {
+    std::vector<uint8_t> buffer(chunk);
+    zx::time start = zx::clock::get_monotonic();
+    for (size_t offset = 0; offset < kFileSize; offset += chunk) {
+      ASSERT_EQ(read(fd, buffer.data(), chunk), static_cast<ssize_t>(chunk));
+    }
+    *out_elapsed = zx::clock::get_monotonic() - start;
+    ASSERT_EQ(read(fd, buffer.data(), chunk), 0);
+    ASSERT_BYTES_EQ(buffer.data(), expected_.data() + kFileSize - chunk, chunk);
+  }
+
+  // Reads the whole file with |pread| in chunks of |chunk| bytes, and returns
+  // the time taken.
+  void PreadAll(int fd, size_t chunk, zx::duration* out_elapsed) {
+    std::vector<uint8_t> buffer(chunk);
+    zx::time start = zx::clock::get_monotonic();
+    for (size_t offset = 0; offset < kFileSize; offset += chunk) {
+      ASSERT_EQ(pread(fd, buffer.data(), chunk, offset), static_cast<ssize_t>(chunk));
+    }
+    *out_elapsed = zx::clock::get_monotonic() - start;
+    ASSERT_BYTES_EQ(buffer.data(), expected_.data() + kFileSize - chunk, chunk);
+  }
+
+  Context context_ = {};
+  std::vector<uint8_t> expected_;
+
+ private:
+  async::Loop loop_;
+};
+
+TEST_F(ReadRingTest, ReadsMatchChannel) {
+  fbl::unique_fd fd;
+  ASSERT_NO_FATAL_FAILURES(Open(true, &fd));
+
+  // Small reads stay on the channel, however many there are.
+  std::vector<uint8_t> buffer(kFileSize);
+  for (size_t offset = 0; offset < 64 * 1024; offset += 512) {
+    ASSERT_EQ(read(fd.get(), buffer.data() + offset, 512), 512);
+  }
+  EXPECT_BYTES_EQ(buffer.data(), expected_.data(), 64 * 1024);
+  EXPECT_EQ(context_.channel_reads, 64 * 1024 / 512);
+  EXPECT_EQ(context_.ring_reads, 0);
+
+  // Reads which would take several channel reads go through the ring, and
+  // share the seek offset with reads over the channel.
+  constexpr size_t kLargeRead = 3 * fuchsia_io::MAX_BUF;
+  context_.channel_reads = 0;
+  ASSERT_EQ(lseek(fd.get(), 1000, SEEK_SET), 1000);
+  ASSERT_EQ(read(fd.get(), buffer.data(), kLargeRead), static_cast<ssize_t>(kLargeRead));
+  EXPECT_BYTES_EQ(buffer.data(), expected_.data() + 1000, kLargeRead);
+  EXPECT_EQ(context_.channel_reads, 0);
+  EXPECT_EQ(context_.ring_reads, 1);
+  ASSERT_EQ(read(fd.get(), buffer.data(), 3000), 3000);
+  EXPECT_BYTES_EQ(buffer.data(), expected_.data() + 1000 + kLargeRead, 3000);
+  EXPECT_EQ(context_.channel_reads, 1);
+
+  // Reads larger than the ring take several round trips.
+  ASSERT_EQ(pread(fd.get(), buffer.data(), kFileSize, 0), static_cast<ssize_t>(kFileSize));
+  EXPECT_BYTES_EQ(buffer.data(), expected_.data(), kFileSize);
+
+  // Short reads at the end of the file.
+  ASSERT_EQ(pread(fd.get(), buffer.data(), 4096, kFileSize - 100), 100);
+  EXPECT_BYTES_EQ(buffer.data(), expected_.data() + kFileSize - 100, 100);
+  ASSERT_EQ(pread(fd.get(), buffer.data(), 4096, kFileSize), 0);
+}
+
+TEST_F(ReadRingTest, FallsBackToChannel) {
+  fbl::unique_fd fd;
+  ASSERT_NO_FATAL_FAILURES(Open(true, &fd));
+
+  std::vector<uint8_t> buffer(kFileSize);
+  ASSERT_EQ(pread(fd.get(), buffer.data(), kFileSize, 0), static_cast<ssize_t>(kFileSize));
+  EXPECT_GT(context_.ring_reads, 0);
+
+  // Once the ring fails, the read that saw the failure and every read after it
+  // go over the channel.
+  context_.break_ring = true;
+  context_.channel_reads = 0;
+  context_.ring_reads = 0;
+  for (int i = 0; i < 2; i++) {
+    std::fill(buffer.begin(), buffer.end(), 0);
+    ASSERT_EQ(pread(fd.get(), buffer.data(), kFileSize, 0), static_cast<ssize_t>(kFileSize));
+    EXPECT_BYTES_EQ(buffer.data(), expected_.data(), kFileSize);
+  }
+  EXPECT_EQ(context_.ring_reads, 0);
+  EXPECT_EQ(context_.channel_reads, 2 * kFileSize / fuchsia_io::MAX_BUF);
+}
+
+TEST_F(ReadRingTest, NotAdvertised) {
+  fbl::unique_fd fd;
+  ASSERT_NO_FATAL_FAILURES(Open(false, &fd));
+
+  std::vector<uint8_t> buffer(kFileSize);
+  ASSERT_EQ(pread(fd.get(), buffer.data(), kFileSize, 0), static_cast<ssize_t>(kFileSize));
+  EXPECT_BYTES_EQ(buffer.data(), expected_.data(), kFileSize);
+  EXPECT_EQ(context_.ring_reads, 0);
+}
+
+TEST_F(ReadRingTest, VectoredReadsShareTransactions) {
+  fbl::unique_fd fd;
+  ASSERT_NO_FATAL_FAILURES(Open(false, &fd));
+
+  // Small buffers are filled by a single read over the channel.
+  uint8_t buffer[8][256];
+  struct iovec iov[8];
+  for (size_t i = 0; i < std::size(iov); i++) {
+    iov[i] = {.iov_base = buffer[i], .iov_len = sizeof(buffer[i])};
+  }
+  ASSERT_EQ(preadv(fd.get(), iov, std::size(iov), 100), static_cast<ssize_t>(sizeof(buffer)));
+  EXPECT_EQ(context_.channel_reads, 1);
+  EXPECT_BYTES_EQ(buffer, expected_.data() + 100, sizeof(buffer));
+
+  // Buffers larger than a transaction are split where the transaction ends.
+  std::vector<uint8_t> large(2 * fuchsia_io::MAX_BUF);
+  struct iovec large_iov[] = {
+      {.iov_base = large.data(), .iov_len = 3},
+      {.iov_base = large.data() + 3, .iov_len = large.size() - 3},
+  };
+  context_.channel_reads = 0;
+  ASSERT_EQ(readv(fd.get(), large_iov, std::size(large_iov)), static_cast<ssize_t>(large.size()));
+  EXPECT_EQ(context_.channel_reads, 2);
+  EXPECT_BYTES_EQ(large.data(), expected_.data(), large.size());
+
+  // Short reads at the end of the file.
+  ASSERT_EQ(preadv(fd.get(), iov, std::size(iov), kFileSize - 300), 300);
+  EXPECT_BYTES_EQ(buffer, expected_.data() + kFileSize - 300, 300);
+}
+
+TEST_F(ReadRingTest, Benchmark) {
+  for (size_t chunk : {512ul, 8192ul, 64ul * 1024}) {
+    zx::duration elapsed[2][2];
+    for (bool ring : {false, true}) {
+      fbl::unique_fd fd;
+      ASSERT_NO_FATAL_FAILURES(Open(ring, &fd));
+      ASSERT_NO_FATAL_FAILURES(ReadAll(fd.get(), chunk, &elapsed[ring][0]));
+      ASSERT_NO_FATAL_FAILURES(PreadAll(fd.get(), chunk, &elapsed[ring][1]));
+    }
+    printf("read ring: %zu byte reads of %zu bytes, us: read %ld -> %ld, pread %ld -> %ld\n",
+           chunk, kFileSize, elapsed[0][0].to_usecs(), elapsed[1][0].to_usecs(),
+           elapsed[0][1].to_usecs(), elapsed[1][1].to_usecs());
+  }
+}
+
+}  // namespace
@@ -780,15 +780,10 @@ zx_status_t fdio_wait_fd(int fd, uint32_t events, uint32_t* out_pending, zx_time
   return status;
 }
 
-static zx_status_t fdio_stat(fdio_t* io, struct stat* s) {
-  zxio_node_attributes_t attr;
-  zx_status_t status = fdio_get_ops(io)->get_attr(io, &attr);
-  if (status != ZX_OK) {
-    return status;
-  }
-
+static void zxio_node_attributes_to_stat(const zxio_node_attributes_t& attr, uint32_t mode,
+                                         struct stat* s) {
   memset(s, 0, sizeof(struct stat));
-  s->st_mode = fdio_get_ops(io)->convert_to_posix_mode(io, attr.protocols, attr.abilities);
+  s->st_mode = mode;
   s->st_ino = attr.has.id ? attr.id : fio::INO_UNKNOWN;
   s->st_size = attr.content_size;
   s->st_blksize = VNATTR_BLKSIZE;
@@ -798,6 +793,16 @@ static zx_status_t fdio_stat(fdio_t* io, struct stat* s) {
   s->st_ctim.tv_nsec = attr.creation_time % ZX_SEC(1);
   s->st_mtim.tv_sec = attr.modification_time / ZX_SEC(1);
   s->st_mtim.tv_nsec = attr.modification_time % ZX_SEC(1);
+}
+
+static zx_status_t fdio_stat(fdio_t* io, struct stat* s) {
+  zxio_node_attributes_t attr;
+  zx_status_t status = fdio_get_ops(io)->get_attr(io, &attr);
+  if (status != ZX_OK) {
+    return status;
+  }
+  zxio_node_attributes_to_stat(
+      attr, fdio_get_ops(io)->convert_to_posix_mode(io, attr.protocols, attr.abilities), s);
   return ZX_OK;
 }
 
@@ -1782,8 +1787,9 @@ int closedir(DIR* dir) {
   return 0;
 }
 
-__EXPORT
-struct dirent* readdir(DIR* dir) {
+// Reads the next entry of |dir| into |dir->de|. If the directory returned the attributes of the
+// entry together with it, also fills |out_stat| with them and sets |*out_has_stat|.
+static struct dirent* internal_readdir(DIR* dir, struct stat* out_stat, bool* out_has_stat) {
   fbl::AutoLock lock(&dir->lock);
   struct dirent* de = &dir->de;
   zxio_dirent_t* entry = nullptr;
@@ -1850,9 +1856,45 @@ struct dirent* readdir(DIR* dir) {
   }
   memcpy(de->d_name, entry->name, entry->name_length);
   de->d_name[entry->name_length] = '\0';
+  *out_has_stat = false;
+  if (out_stat != nullptr && entry->attributes != nullptr) {
+    const zxio_node_attributes_t& attr = *entry->attributes;
+    uint32_t mode = (attr.protocols & ZXIO_NODE_PROTOCOL_DIRECTORY)
+                        ? fdio_dir_convert_to_posix_mode(io, attr.protocols, attr.abilities)
+                        : fdio_default_convert_to_posix_mode(io, attr.protocols, attr.abilities);
+    zxio_node_attributes_to_stat(attr, mode, out_stat);
+    *out_has_stat = true;
+  }
   return de;
 }
 
+__EXPORT
+struct dirent* readdir(DIR* dir) {
+  bool has_stat;
+  return internal_readdir(dir, nullptr, &has_stat);
+}
+
+__EXPORT
+int fdio_readdir_stat(DIR* dir, struct dirent** out_entry, struct stat* out_stat) {
+  int saved_errno = errno;
+  errno = 0;
+  bool has_stat;
+  struct dirent* de = internal_readdir(dir, out_stat, &has_stat);
+  *out_entry = de;
+  if (de == nullptr) {
+    if (errno != 0) {
+      return -1;
+    }
+    errno = saved_errno;
+    return 0;
+  }
+  errno = saved_errno;
+  if (has_stat) {
+    return 0;
+  }
+  return fstatat(dir->fd, de->d_name, out_stat, 0);
+}
+
 __EXPORT
 void rewinddir(DIR* dir) {
   fbl::AutoLock lock(&dir->lock);
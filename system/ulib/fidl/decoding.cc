@@ -354,6 +354,30 @@ zx_status_t fidl_decode_impl(const fidl_type_t* type, void* bytes, uint32_t num_
     return status;
   }
 
+  if (const FidlCodedStruct* coded_struct = fidl::InlineCodedStruct(type, bytes)) {
+    // The message has no handles nor pointers, so decoding it only requires validating it.
+    if (next_out_of_line != num_bytes) {
+      set_error("message did not decode all provided bytes");
+      drop_all_handles();
+      return ZX_ERR_INVALID_ARGS;
+    }
+    FidlInlineCodingResult result =
+        coded_struct->validate_inline(static_cast<const uint8_t*>(bytes));
+    if (result != kFidlInlineCoding_Ok) {
+      set_error(result == kFidlInlineCoding_NonZeroPadding
+                    ? "non-zero padding bytes detected during decoding"
+                    : fidl::InlineCodingError(result));
+      drop_all_handles();
+      return ZX_ERR_INVALID_ARGS;
+    }
+    if (num_handles != 0) {
+      set_error("message did not decode all provided handles");
+      drop_all_handles();
+      return ZX_ERR_INVALID_ARGS;
+    }
+    return ZX_OK;
+  }
+
   FidlDecoder decoder(bytes, num_bytes, handles, num_handles, next_out_of_line, out_error_msg);
   fidl::Walk(decoder, type, StartingPoint{reinterpret_cast<uint8_t*>(bytes)});
 
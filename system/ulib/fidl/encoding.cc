@@ -280,6 +280,31 @@ zx_status_t fidl_encode_impl(const fidl_type_t* type, void* bytes, uint32_t num_
   }
   memset(reinterpret_cast<uint8_t*>(bytes) + primary_size, 0, next_out_of_line - primary_size);
 
+  if (const FidlCodedStruct* coded_struct = fidl::InlineCodedStruct(type, bytes)) {
+    // The message has no handles nor out-of-line objects, so there is nothing to walk.
+    if (out_actual_handles != nullptr) {
+      *out_actual_handles = 0;
+    }
+    if (next_out_of_line != num_bytes) {
+      set_error("message did not encode all provided bytes");
+      return ZX_ERR_INVALID_ARGS;
+    }
+    FidlInlineCodingResult result = coded_struct->encode_inline(static_cast<uint8_t*>(bytes));
+    if (result != kFidlInlineCoding_Ok) {
+      set_error(fidl::InlineCodingError(result));
+      return ZX_ERR_INVALID_ARGS;
+    }
+    if (out_actual_handles == nullptr) {
+      set_error("Cannot encode with null out_actual_handles");
+      return ZX_ERR_INVALID_ARGS;
+    }
+    if (handles == nullptr && max_handles != 0) {
+      set_error("Cannot provide non-zero handle count and null handle pointer");
+      return ZX_ERR_INVALID_ARGS;
+    }
+    return ZX_OK;
+  }
+
   FidlEncoder encoder(bytes, num_bytes, handles, max_handles, next_out_of_line, out_error_msg);
   fidl::Walk(encoder, type, StartingPoint{reinterpret_cast<uint8_t*>(bytes)});
 
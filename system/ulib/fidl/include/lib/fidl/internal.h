@@ -140,13 +140,34 @@ struct FidlCodedBits {
   const char* name;  // may be nullptr if omitted at compile time
 };
 
+// Result of a coding routine specialized for an inline-only struct.
+typedef uint32_t FidlInlineCodingResult;
+static const uint32_t kFidlInlineCoding_Ok = 0;
+static const uint32_t kFidlInlineCoding_NonZeroPadding = 1;
+static const uint32_t kFidlInlineCoding_InvalidEnum = 2;
+static const uint32_t kFidlInlineCoding_InvalidBits = 3;
+
+// Coding routines which fidlc specializes for structs which are entirely inline, i.e. which
+// contain no handles and no out-of-line objects. Encoding such a struct zeroes its padding, while
+// decoding or validating it checks that its padding is zero: there are no pointers to patch, so
+// decoding is the same as validating. Both check the values of its enum and bits members.
+//
+// |bytes| must be aligned to FIDL_ALIGNMENT and hold the struct size rounded up to FIDL_ALIGNMENT.
+typedef FidlInlineCodingResult (*FidlInlineEncodeFunc)(uint8_t* bytes);
+typedef FidlInlineCodingResult (*FidlInlineValidateFunc)(const uint8_t* bytes);
+
 // Though the |size| is implied by the fields, computing that information is not
 // the purview of this library. It's easier for the compiler to stash it.
+//
+// |encode_inline| and |validate_inline| are only set for inline-only structs, and only used when
+// the struct is the whole message. Other messages are coded by walking |fields|.
 struct FidlCodedStruct {
   const struct FidlStructField* const fields;
   const uint32_t field_count;
   const uint32_t size;
   const char* name;  // may be nullptr if omitted at compile time
+  const FidlInlineEncodeFunc encode_inline;      // may be nullptr
+  const FidlInlineValidateFunc validate_inline;  // may be nullptr
 };
 
 struct FidlCodedStructPointer {
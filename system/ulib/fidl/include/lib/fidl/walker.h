@@ -862,6 +862,15 @@ zx_status_t PrimaryObjectSize(const fidl_type_t* type, size_t* out_size, const c
 zx_status_t StartingOutOfLineOffset(const fidl_type_t* type, uint32_t buffer_size,
                                     uint32_t* out_first_out_of_line, const char** out_error);
 
+// Returns the coding table of |type| if messages of that type are coded by the routines which
+// fidlc specialized for them rather than walked, or nullptr otherwise. Those routines may only be
+// called once the message has been checked to hold exactly |first_out_of_line| aligned bytes.
+const FidlCodedStruct* InlineCodedStruct(const fidl_type_t* type, const void* bytes);
+
+// Returns the error message which the walker reports for the problem that a specialized coding
+// routine found.
+const char* InlineCodingError(FidlInlineCodingResult result);
+
 }  // namespace fidl
 
 #endif  // LIB_FIDL_WALKER_H_
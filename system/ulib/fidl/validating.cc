@@ -218,6 +218,24 @@ zx_status_t fidl_validate(const fidl_type_t* type, const void* bytes, uint32_t n
     return status;
   }
 
+  if (const FidlCodedStruct* coded_struct = fidl::InlineCodedStruct(type, bytes)) {
+    if (next_out_of_line != num_bytes) {
+      set_error("message did not consume all provided bytes");
+      return ZX_ERR_INVALID_ARGS;
+    }
+    FidlInlineCodingResult result =
+        coded_struct->validate_inline(static_cast<const uint8_t*>(bytes));
+    if (result != kFidlInlineCoding_Ok) {
+      set_error(fidl::InlineCodingError(result));
+      return ZX_ERR_INVALID_ARGS;
+    }
+    if (num_handles != 0) {
+      set_error("message did not reference all provided handles");
+      return ZX_ERR_INVALID_ARGS;
+    }
+    return ZX_OK;
+  }
+
   FidlValidator validator(bytes, num_bytes, num_handles, next_out_of_line, out_error_msg);
   fidl::Walk(validator, type, StartingPoint{reinterpret_cast<const uint8_t*>(bytes)});
 
@@ -55,4 +55,25 @@ zx_status_t StartingOutOfLineOffset(const fidl_type_t* type, uint32_t buffer_siz
   return ZX_OK;
 }
 
+const FidlCodedStruct* InlineCodedStruct(const fidl_type_t* type, const void* bytes) {
+  if (type->type_tag != kFidlTypeStruct || type->coded_struct.validate_inline == nullptr ||
+      !FidlIsAligned(static_cast<const uint8_t*>(bytes))) {
+    return nullptr;
+  }
+  return &type->coded_struct;
+}
+
+const char* InlineCodingError(FidlInlineCodingResult result) {
+  switch (result) {
+    case kFidlInlineCoding_NonZeroPadding:
+      return "non-zero padding bytes detected";
+    case kFidlInlineCoding_InvalidEnum:
+      return "not a valid enum member";
+    case kFidlInlineCoding_InvalidBits:
+      return "not a valid bits member";
+    default:
+      return "unknown error from specialized coding routine";
+  }
+}
+
 }  // namespace fidl
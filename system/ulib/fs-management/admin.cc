@@ -7,6 +7,7 @@
 #include <lib/fdio/directory.h>
 #include <lib/fdio/vfs.h>
 #include <lib/zx/channel.h>
+#include <stdio.h>
 #include <zircon/processargs.h>
 #include <zircon/syscalls.h>
 
@@ -64,6 +65,18 @@ zx_status_t InitNativeFs(const char* binary, zx::channel device, const init_opti
   if (options.fsck_after_every_transaction) {
     argv.push_back("--fsck_after_every_transaction");
   }
+  char serving_threads[16];
+  if (options.serving_threads > 1) {
+    snprintf(serving_threads, sizeof(serving_threads), "%u", options.serving_threads);
+    argv.push_back("--serving_threads");
+    argv.push_back(serving_threads);
+  }
+  char write_threads[16];
+  if (options.write_threads > 0) {
+    snprintf(write_threads, sizeof(write_threads), "%u", options.write_threads);
+    argv.push_back("--write_threads");
+    argv.push_back(write_threads);
+  }
   argv.push_back("mount");
   argv.push_back(nullptr);
   int argc = static_cast<int>(argv.size() - 1);
@@ -107,6 +120,8 @@ const init_options_t default_init_options = {
     .enable_pager = false,
     .write_compression_algorithm = nullptr,
     .fsck_after_every_transaction = false,
+    .serving_threads = 1,
+    .write_threads = 0,
     .callback = launch_stdio_async,
 };
 
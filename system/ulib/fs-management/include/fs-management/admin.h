@@ -33,6 +33,12 @@ typedef struct init_options {
   // If true, run fsck after every transaction (if supported). This is for testing/debugging
   // purposes.
   bool fsck_after_every_transaction;
+  // Number of threads servicing filesystem requests (if supported). Zero or one selects a single
+  // serving thread.
+  uint32_t serving_threads;
+  // Number of threads processing files as they are written (if supported). Zero selects the
+  // filesystem's default.
+  uint32_t write_threads;
   // Provide a launch callback function pointer for configuring how the underlying filesystem
   // process is launched.
   LaunchCallback callback;
@@ -30,6 +30,12 @@ typedef struct mount_options {
   bool register_fs;
   // If set, run fsck after every transaction.
   bool fsck_after_every_transaction;
+  // Number of threads servicing filesystem requests (if supported). Zero or one selects a single
+  // serving thread.
+  uint32_t serving_threads;
+  // Number of threads processing files as they are written (if supported). Zero selects the
+  // filesystem's default.
+  uint32_t write_threads;
 } mount_options_t;
 
 __EXPORT
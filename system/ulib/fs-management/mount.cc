@@ -106,6 +106,8 @@ zx_status_t StartFilesystem(fbl::unique_fd device_fd, disk_format_t df,
       .enable_pager = options->enable_pager,
       .write_compression_algorithm = options->write_compression_algorithm,
       .fsck_after_every_transaction = options->fsck_after_every_transaction,
+      .serving_threads = options->serving_threads,
+      .write_threads = options->write_threads,
       .callback = cb,
   };
 
@@ -137,6 +139,8 @@ const mount_options_t default_mount_options = {
     .write_compression_algorithm = nullptr,
     .register_fs = true,
     .fsck_after_every_transaction = false,
+    .serving_threads = 1,
+    .write_threads = 0,
 };
 
 const mkfs_options_t default_mkfs_options = {
@@ -248,6 +248,8 @@ zx_status_t Fixture::Mount() {
   if (options_.write_compression_algorithm) {
     mount_options.write_compression_algorithm = options_.write_compression_algorithm;
   }
+  mount_options.serving_threads = options_.serving_threads;
+  mount_options.write_threads = options_.write_threads;
 
   disk_format_t format = detect_disk_format(fd.get());
   zx_status_t result =
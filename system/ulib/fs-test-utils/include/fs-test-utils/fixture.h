@@ -61,6 +61,8 @@ struct FixtureOptions {
     options.isolated_devmgr = false;
     options.use_pager = false;
     options.write_compression_algorithm = nullptr;
+    options.serving_threads = 1;
+    options.write_threads = 0;
     return options;
   }
 
@@ -109,6 +111,13 @@ struct FixtureOptions {
   // An optional compression algorithm specifier for the filesystem to use when storing files (if
   // the filesystem supports it).
   const char* write_compression_algorithm = nullptr;
+
+  // Number of threads the filesystem uses to service requests (if supported by the |fs_format|).
+  uint32_t serving_threads = 1;
+
+  // Number of threads the filesystem uses to process files as they are written (if supported by
+  // the |fs_format|). Zero selects the filesystem's default.
+  uint32_t write_threads = 0;
 };
 
 // Provides a base fixture for File system tests.
@@ -55,6 +55,12 @@ Usage:
         --seed SEED                    An unsigned integer to initialize
                                        pseudo-ramdom number generator.
 
+        --serving_threads COUNT        Number of threads the filesystem uses
+                                       to service requests.
+
+        --write_threads COUNT          Number of threads the filesystem uses
+                                       to process files as they are written.
+
     [Test Options]
          --out PATH                    In performance test mode, collected
                                        results will be written to PATH.
@@ -312,6 +318,8 @@ bool ParseCommandLineArgs(int argc, const char* const* argv, FixtureOptions* fix
       {"seed", required_argument, nullptr, 0},
       {"pager", no_argument, nullptr, 0},
       {"compression", required_argument, nullptr, 'c'},
+      {"serving_threads", required_argument, nullptr, 0},
+      {"write_threads", required_argument, nullptr, 0},
       {0, 0, 0, 0},
   };
   // Resets the internal state of getopt*, making this function idempotent.
@@ -381,6 +389,12 @@ bool ParseCommandLineArgs(int argc, const char* const* argv, FixtureOptions* fix
           case 13:
             fixture_options->use_pager = true;
             break;
+          case 15:
+            fixture_options->serving_threads = static_cast<uint32_t>(strtoul(optarg, NULL, 0));
+            break;
+          case 16:
+            fixture_options->write_threads = static_cast<uint32_t>(strtoul(optarg, NULL, 0));
+            break;
           default:
             break;
         }
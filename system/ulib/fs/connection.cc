@@ -150,7 +150,8 @@ void Connection::UnmountAndShutdown(fit::callback<void(zx_status_t)> callback) {
   Vfs::ShutdownCallback closure([binding = std::move(binding_), callback = std::move(callback)](
                                     zx_status_t status) mutable { callback(status); });
   Vfs* vfs = vfs_;
-  SyncTeardown();
+  // We are being dispatched, hence the dispatch locks are already held.
+  SyncTeardownLocked();
   vfs->Shutdown(std::move(closure));
 }
 
@@ -242,9 +243,16 @@ bool Connection::OnMessage() {
   auto header = reinterpret_cast<fidl_message_header_t*>(msg.bytes);
   FidlTransaction txn(header->txid, binding);
 
-  bool handled = fidl_protocol_.TryDispatch(&msg, &txn);
-  if (!handled) {
-    vnode_->HandleFsSpecificMessage(&msg, &txn);
+  {
+    // The message is read from the channel before taking the dispatch locks, so that other
+    // serving threads are only excluded while the vnode operation itself runs. Note that the
+    // handler may tear down and destroy this connection (e.g. |UnmountAndShutdown|); the guard
+    // keeps everything it locked alive on its own.
+    Vfs::DispatchGuard guard = vfs_->LockForDispatch(vnode_);
+    bool handled = fidl_protocol_.TryDispatch(&msg, &txn);
+    if (!handled) {
+      vnode_->HandleFsSpecificMessage(&msg, &txn);
+    }
   }
 
   switch (txn.ToResult()) {
@@ -266,6 +274,13 @@ bool Connection::OnMessage() {
 }
 
 void Connection::SyncTeardown() {
+  // Closing the vnode must be ordered against operations dispatched from other connections.
+  // The guard holds its own references, so it may outlive this connection.
+  Vfs::DispatchGuard guard = vfs_->LockForDispatch(vnode_);
+  SyncTeardownLocked();
+}
+
+void Connection::SyncTeardownLocked() {
   EnsureVnodeClosed();
   binding_.reset();
 
@@ -203,6 +203,34 @@ void DirectoryConnection::ReadDirents(uint64_t max_out, ReadDirentsCompleter::Sy
   completer.Reply(status, fidl::VectorView(fidl::unowned_ptr(data), actual));
 }
 
+void DirectoryConnection::ReadDirentsAttributes(uint64_t max_out,
+                                                ReadDirentsAttributesCompleter::Sync completer) {
+  FS_PRETTY_TRACE_DEBUG("[DirectoryReadDirentsAttributes] our options: ", options());
+
+  if (options().flags.node_reference) {
+    return completer.Reply(ZX_ERR_BAD_HANDLE, fidl::VectorView<uint8_t>(),
+                           fidl::VectorView<uint8_t>());
+  }
+  if (max_out > fio::MAX_BUF) {
+    return completer.Reply(ZX_ERR_BAD_HANDLE, fidl::VectorView<uint8_t>(),
+                           fidl::VectorView<uint8_t>());
+  }
+  static_assert(fio::MAX_BUF / Vfs::kMinDirentSize * sizeof(fio::DirentAttributes) <=
+                fio::MAX_DIRENT_ATTRIBUTES_BUF);
+  uint8_t data[max_out];
+  auto attributes = std::make_unique<fio::DirentAttributes[]>(max_out / Vfs::kMinDirentSize);
+  size_t actual = 0;
+  size_t count = 0;
+  zx_status_t status = vfs()->ReaddirAttributes(vnode().get(), &dircookie_, data, max_out, &actual,
+                                                attributes.get(), &count);
+  if (status != ZX_OK) {
+    return completer.Reply(status, fidl::VectorView<uint8_t>(), fidl::VectorView<uint8_t>());
+  }
+  completer.Reply(ZX_OK, fidl::VectorView(fidl::unowned_ptr(data), actual),
+                  fidl::VectorView(fidl::unowned_ptr(reinterpret_cast<uint8_t*>(attributes.get())),
+                                   count * sizeof(fio::DirentAttributes)));
+}
+
 void DirectoryConnection::Rewind(RewindCompleter::Sync completer) {
   FS_PRETTY_TRACE_DEBUG("[DirectoryRewind] our options: ", options());
 
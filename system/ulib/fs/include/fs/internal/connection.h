@@ -79,6 +79,11 @@ class Connection : public fbl::DoublyLinkedListable<std::unique_ptr<Connection>>
   // unregistering it from the Vfs object.
   void SyncTeardown();
 
+  // Same as |SyncTeardown|, but does not acquire the |Vfs::DispatchGuard| for this connection's
+  // vnode. The caller must either hold it already, as is the case from within a FIDL message
+  // handler, or otherwise guarantee that no message is being dispatched concurrently.
+  void SyncTeardownLocked();
+
   // Begins waiting for messages on the channel.
   // |channel| is the channel on which the FIDL protocol will be served.
   //
@@ -53,6 +53,8 @@ class DirectoryConnection final : public Connection,
             OpenCompleter::Sync completer) final;
   void Unlink(fidl::StringView path, UnlinkCompleter::Sync completer) final;
   void ReadDirents(uint64_t max_out, ReadDirentsCompleter::Sync completer) final;
+  void ReadDirentsAttributes(uint64_t max_out,
+                             ReadDirentsAttributesCompleter::Sync completer) final;
   void Rewind(RewindCompleter::Sync completer) final;
   void GetToken(GetTokenCompleter::Sync completer) final;
   void Rename(fidl::StringView src, zx::handle dst_parent_token, fidl::StringView dst,
@@ -10,6 +10,8 @@
 #endif
 
 #include <fuchsia/io/llcpp/fidl.h>
+#include <string.h>
+#include <zircon/assert.h>
 
 #include <fs/internal/connection.h>
 #include <fs/vfs.h>
@@ -51,8 +53,41 @@ class FileConnection : public Connection, public llcpp::fuchsia::io::File::Inter
   void GetFlags(GetFlagsCompleter::Sync completer) final;
   void SetFlags(uint32_t flags, SetFlagsCompleter::Sync completer) final;
   void GetBuffer(uint32_t flags, GetBufferCompleter::Sync completer) final;
+
+  // Replies to |Read| or |ReadAt| with data which |read| writes directly into the reply message.
+  // |read| is invoked as |zx_status_t read(uint8_t* data, size_t capacity, size_t* out_actual)|
+  // with |capacity| equal to |count|.
+  //
+  // The reply is then encoded in place, where the data already sits at its wire offset, so the
+  // data is not copied again before being written to the channel, and no reply buffer is
+  // allocated on the heap.
+  template <typename Response, typename Completer, typename ReadFunction>
+  static void ReplyWithData(uint64_t count, Completer& completer, ReadFunction read);
 };
 
+template <typename Response, typename Completer, typename ReadFunction>
+void FileConnection::ReplyWithData(uint64_t count, Completer& completer, ReadFunction read) {
+  // The data is the only out-of-line object of the reply, so it immediately follows the primary
+  // object on the wire.
+  static_assert(sizeof(Response) % FIDL_ALIGNMENT == 0);
+  fidl::Buffer<Response> buffer;
+  fidl::BytePart bytes = buffer.view();
+  ZX_DEBUG_ASSERT(sizeof(Response) + count <= bytes.capacity());
+  uint8_t* data = bytes.data() + sizeof(Response);
+
+  size_t actual = 0;
+  zx_status_t status = read(data, count, &actual);
+  ZX_DEBUG_ASSERT(actual <= count);
+
+  memset(bytes.data(), 0, sizeof(Response));
+  memset(data + actual, 0, FIDL_ALIGN(actual) - actual);
+  bytes.set_actual(static_cast<uint32_t>(sizeof(Response) + FIDL_ALIGN(actual)));
+  fidl::DecodedMessage<Response> message(std::move(bytes));
+  message.message()->s = status;
+  message.message()->data = fidl::VectorView(fidl::unowned_ptr(data), actual);
+  completer.Reply(std::move(message));
+}
+
 }  // namespace internal
 
 }  // namespace fs
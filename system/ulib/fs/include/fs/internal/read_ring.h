@@ -0,0 +1,85 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FS_INTERNAL_READ_RING_H_
+#define FS_INTERNAL_READ_RING_H_
+
+#ifndef __Fuchsia__
+#error "Fuchsia-only header"
+#endif
+
+#include <fuchsia/io/llcpp/fidl.h>
+#include <lib/async/cpp/wait.h>
+#include <lib/fit/function.h>
+#include <lib/fzl/owned-vmo-mapper.h>
+#include <lib/zx/fifo.h>
+#include <lib/zx/vmo.h>
+#include <zircon/compiler.h>
+
+#include <memory>
+#include <mutex>
+
+#include <fs/vfs.h>
+#include <fs/vnode.h>
+
+namespace fs {
+
+namespace internal {
+
+// Serves the read ring of a file connection. See |fuchsia.io/File.GetReadRing|.
+//
+// Requests are handled on the dispatcher of the Vfs, holding the same dispatch lock as messages on
+// the channel of the connection. That lock is shared for vnodes which support concurrent dispatch,
+// so |read| must synchronize any state it shares with the connection. Each request is replied to
+// as soon as it is served, so the client may keep several in flight.
+//
+// A pending wait on the FIFO keeps the ring alive, so the ring may outlive its connection. The
+// connection must |Detach| from the ring before it is destroyed.
+//
+// This class is thread-safe.
+class ReadRing {
+ public:
+  // Reads up to |count| bytes into |data|, at the offset given by |entry|.
+  using ReadFunction = fit::function<zx_status_t(
+      const llcpp::fuchsia::io::ReadRingEntry& entry, uint8_t* data, size_t* out_actual)>;
+
+  // Creates a ring with a buffer of |size| bytes, and begins serving requests from the client
+  // with |read|. Returns the client ends of the buffer and FIFO in |out_buffer| and |out_fifo|.
+  static zx_status_t Create(Vfs* vfs, fbl::RefPtr<Vnode> vnode, uint64_t size, ReadFunction read,
+                            zx::vmo* out_buffer, zx::fifo* out_fifo,
+                            std::shared_ptr<ReadRing>* out_ring);
+
+  ReadRing(const ReadRing&) = delete;
+  ReadRing& operator=(const ReadRing&) = delete;
+  ~ReadRing();
+
+  // Stops serving requests. |read| is not invoked once this returns.
+  void Detach();
+
+ private:
+  ReadRing(Vfs* vfs, fbl::RefPtr<Vnode> vnode, ReadFunction read);
+
+  void HandleSignals(async_dispatcher_t* dispatcher, async::WaitBase* wait, zx_status_t status,
+                     const zx_packet_signal_t* signal);
+
+  // Handles the requests currently in the FIFO.
+  zx_status_t ServeLocked() __TA_REQUIRES(lock_);
+
+  Vfs* const vfs_;
+  const fbl::RefPtr<Vnode> vnode_;
+  fzl::OwnedVmoMapper buffer_;
+  zx::fifo fifo_;
+
+  std::mutex lock_;
+  ReadFunction read_ __TA_GUARDED(lock_);
+  async::WaitMethod<ReadRing, &ReadRing::HandleSignals> wait_ __TA_GUARDED(lock_);
+  // Holds a reference to the ring while |wait_| is pending.
+  std::shared_ptr<ReadRing> self_ __TA_GUARDED(lock_);
+};
+
+}  // namespace internal
+
+}  // namespace fs
+
+#endif  // FS_INTERNAL_READ_RING_H_
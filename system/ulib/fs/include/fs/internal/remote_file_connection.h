@@ -10,6 +10,10 @@
 #endif
 
 #include <fuchsia/io/llcpp/fidl.h>
+#include <zircon/compiler.h>
+
+#include <memory>
+#include <mutex>
 
 #include <fs/internal/file_connection.h>
 #include <fs/vfs.h>
@@ -20,13 +24,15 @@ namespace fs {
 
 namespace internal {
 
+class ReadRing;
+
 class RemoteFileConnection final : public FileConnection {
  public:
   // Refer to documentation for |Connection::Connection|.
   RemoteFileConnection(fs::Vfs* vfs, fbl::RefPtr<fs::Vnode> vnode, VnodeProtocol protocol,
                        VnodeConnectionOptions options);
 
-  ~RemoteFileConnection() final = default;
+  ~RemoteFileConnection() final;
 
  private:
   //
@@ -40,9 +46,22 @@ class RemoteFileConnection final : public FileConnection {
                WriteAtCompleter::Sync completer) final;
   void Seek(int64_t offset, llcpp::fuchsia::io::SeekOrigin start,
             SeekCompleter::Sync completer) final;
+  void GetReadRing(uint64_t size, GetReadRingCompleter::Sync completer) final;
+
+  // Reads for a request on |read_ring_|.
+  zx_status_t ReadForRing(const llcpp::fuchsia::io::ReadRingEntry& entry, uint8_t* data,
+                          size_t* out_actual);
+
+  // Serializes uses of the seek offset. Messages on the channel are handled one at a time, but
+  // requests on |read_ring_| are handled separately, and may run at the same time as them if the
+  // vnode supports concurrent dispatch.
+  std::mutex offset_lock_;
 
   // Current seek offset.
-  size_t offset_ = 0;
+  size_t offset_ __TA_GUARDED(offset_lock_) = 0;
+
+  // The read ring of the connection, if the client acquired one.
+  std::shared_ptr<ReadRing> read_ring_;
 };
 
 }  // namespace internal
@@ -0,0 +1,147 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FS_LOOKUP_CACHE_H_
+#define FS_LOOKUP_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zircon/types.h>
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <fbl/macros.h>
+#include <fbl/ref_ptr.h>
+#include <fbl/string_piece.h>
+#include <fs/locking.h>
+
+namespace fs {
+
+class Vnode;
+
+// A bounded, least-recently-used cache of directory entry lookups performed by |Vfs| while
+// walking paths.
+//
+// Entries are keyed by the parent directory and the entry name. A positive entry holds a
+// reference to the vnode which was found; a negative entry records that the name did not exist.
+// Every entry also holds a reference to its parent, so a key can never be reused by another
+// vnode allocated at the same address.
+//
+// The cache only observes mutations made through |Vfs| (create, unlink, rename and link), which
+// invalidate the affected names. Filesystems which mutate directories by other means must call
+// |Invalidate| themselves. Filesystems must also call |InvalidateChildren| when they remove a
+// directory, since |Vfs| does not know which vnode an unlinked or replaced name referred to. Filesystems whose lookups have side effects which must not be skipped
+// should only cache negative entries, see |Policy|.
+//
+// The cache is disabled until |SetCapacity| is called with a non-zero capacity.
+//
+// This class is thread-safe.
+class LookupCache {
+ public:
+  enum class Policy {
+    // Caches both successful and failed lookups.
+    kPositiveAndNegative,
+    // Only caches lookups which failed with ZX_ERR_NOT_FOUND. Vnodes are never retained.
+    kNegativeOnly,
+  };
+
+  struct Stats {
+    // Lookups answered by a positive entry.
+    uint64_t hits = 0;
+    // Lookups answered by a negative entry.
+    uint64_t negative_hits = 0;
+    // Lookups which had to be forwarded to the filesystem.
+    uint64_t misses = 0;
+    // Entries dropped to make room for new ones.
+    uint64_t evictions = 0;
+    // Entries dropped because the directory entry changed.
+    uint64_t invalidations = 0;
+  };
+
+  LookupCache() = default;
+  ~LookupCache();
+  DISALLOW_COPY_ASSIGN_AND_MOVE(LookupCache);
+
+  // Sets the maximum number of cached entries and which lookups are cached. A capacity of zero
+  // disables the cache. Entries beyond the new capacity are evicted.
+  void SetCapacity(size_t capacity, Policy policy = Policy::kPositiveAndNegative);
+
+  bool enabled() const { return capacity_.load(std::memory_order_relaxed) > 0; }
+
+  // Returns true if the result of looking up |name| within |parent| is cached. On a positive hit,
+  // |out| is set to the cached vnode; on a negative hit, |out| is reset to null.
+  bool Lookup(const Vnode& parent, fbl::StringPiece name, fbl::RefPtr<Vnode>* out);
+
+  // Records the result of looking up |name| within |parent|. Only ZX_OK (with |vnode| set) and
+  // ZX_ERR_NOT_FOUND are cached.
+  //
+  // The caller must prevent the directory entry from changing between the lookup and this call,
+  // typically by holding the directory lock shared.
+  void Insert(fbl::RefPtr<Vnode> parent, fbl::StringPiece name, zx_status_t status,
+              fbl::RefPtr<Vnode> vnode);
+
+  // Drops any entry for |name| within |parent|.
+  void Invalidate(const Vnode& parent, fbl::StringPiece name);
+
+  // Drops every entry within |parent|. Called by filesystems when they remove the directory
+  // |parent| from the namespace, so that the cache does not keep it alive.
+  void InvalidateChildren(const Vnode& parent);
+
+  // Drops every entry, releasing all retained vnodes. Filesystems must call this before tearing
+  // down state which the destructors of their vnodes depend on.
+  void Clear();
+
+  Stats GetStats() const;
+
+ private:
+  struct Key {
+    const Vnode* parent;
+    std::string name;
+
+    bool operator==(const Key& other) const {
+      return parent == other.parent && name == other.name;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return std::hash<const Vnode*>{}(key.parent) ^ std::hash<std::string>{}(key.name);
+    }
+  };
+
+  struct Entry {
+    Key key;
+    fbl::RefPtr<Vnode> parent;
+    // Null for negative entries.
+    fbl::RefPtr<Vnode> vnode;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  // Moves entries beyond |capacity_| into |evicted|, to be released without holding |lock_|.
+  void EvictLocked(EntryList* evicted) FS_TA_REQUIRES(lock_);
+
+  std::atomic<size_t> capacity_{0};
+  std::atomic<Policy> policy_{Policy::kPositiveAndNegative};
+
+  mutable std::mutex lock_;
+  // Most recently used entries first.
+  EntryList entries_ FS_TA_GUARDED(lock_);
+  std::unordered_map<Key, EntryList::iterator, KeyHash> index_ FS_TA_GUARDED(lock_);
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> negative_hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::atomic<uint64_t> invalidations_{0};
+};
+
+}  // namespace fs
+
+#endif  // FS_LOOKUP_CACHE_H_
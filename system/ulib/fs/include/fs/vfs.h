@@ -18,6 +18,7 @@
 #include <memory>
 
 #include <fs/locking.h>
+#include <fs/lookup_cache.h>
 #include <fs/vfs_types.h>
 #include <fs/vnode.h>
 
@@ -34,7 +35,12 @@
 #include <fs/mount_channel.h>
 #endif  // __Fuchsia__
 
+#include <array>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <utility>
 #include <variant>
 
@@ -164,6 +170,10 @@ class Vfs {
   // Sets whether this file system is read-only.
   void SetReadonly(bool value) FS_TA_EXCLUDES(vfs_lock_);
 
+  // Caches the results of the lookups performed while walking paths. Disabled by default;
+  // filesystems opt in with |LookupCache::SetCapacity|.
+  LookupCache& lookup_cache() { return lookup_cache_; }
+
 #ifdef __Fuchsia__
   using ShutdownCallback = fit::callback<void(zx_status_t status)>;
 
@@ -186,10 +196,19 @@ class Vfs {
                    fbl::StringPiece newStr) FS_TA_EXCLUDES(vfs_lock_);
   zx_status_t Rename(zx::event token, fbl::RefPtr<Vnode> oldparent, fbl::StringPiece oldStr,
                      fbl::StringPiece newStr) FS_TA_EXCLUDES(vfs_lock_);
-  // Calls readdir on the Vnode while holding the vfs_lock, preventing path
-  // modification operations for the duration of the operation.
+  // Calls readdir on the Vnode while holding its directory lock, preventing path
+  // modification operations within |vn| for the duration of the operation.
   zx_status_t Readdir(Vnode* vn, vdircookie_t* cookie, void* dirents, size_t len,
                       size_t* out_actual) FS_TA_EXCLUDES(vfs_lock_);
+  // Like |Readdir|, and also looks up each entry read, filling |out_attributes| with its
+  // attributes. |out_attributes| must have room for one element per |kMinDirentSize| bytes of
+  // |len|; the number of elements filled is returned in |out_count|.
+  zx_status_t ReaddirAttributes(Vnode* vn, vdircookie_t* cookie, void* dirents, size_t len,
+                                size_t* out_actual,
+                                llcpp::fuchsia::io::DirentAttributes* out_attributes,
+                                size_t* out_count) FS_TA_EXCLUDES(vfs_lock_);
+  // The size of a dirent with a one-byte name, the smallest one |Readdir| may produce.
+  static constexpr size_t kMinDirentSize = sizeof(vdirent_t) + 1;
 
   explicit Vfs(async_dispatcher_t* dispatcher);
 
@@ -252,11 +271,43 @@ class Vfs {
   static zx_status_t UnmountHandle(zx::channel handle, zx::time deadline);
 
   bool IsTokenAssociatedWithVnode(zx::event token) FS_TA_EXCLUDES(vfs_lock_);
+
+  // Holds the locks which order vnode operations dispatched from connections when the
+  // filesystem is served by more than one thread.
+  //
+  // If the vnode |SupportsConcurrentDispatch|, the filesystem-wide dispatch lock is held shared
+  // together with the vnode's own |dispatch_lock()|, so operations on different vnodes may
+  // proceed in parallel while operations on the same vnode are serialized. Otherwise the
+  // filesystem-wide dispatch lock is held exclusively, which is equivalent to serving the
+  // filesystem from a single thread.
+  //
+  // Ordering of messages within one connection is provided by |internal::Binding|, which never
+  // waits for the next message until the current one has been handled.
+  class DispatchGuard {
+   public:
+    DispatchGuard(DispatchGuard&&) = default;
+    DispatchGuard& operator=(DispatchGuard&&) = default;
+    ~DispatchGuard() = default;
+
+   private:
+    friend class Vfs;
+    DispatchGuard() = default;
+
+    // Keeps the vnode, and hence its dispatch lock, alive for as long as the lock is held. This
+    // must be declared before |vnode_lock_| so it is released after the lock.
+    fbl::RefPtr<Vnode> vnode_;
+    std::shared_lock<std::shared_mutex> shared_lock_;
+    std::unique_lock<std::shared_mutex> exclusive_lock_;
+    std::unique_lock<std::mutex> vnode_lock_;
+  };
+
+  // Acquires the locks required to dispatch an operation on |vnode|. See |DispatchGuard|.
+  DispatchGuard LockForDispatch(fbl::RefPtr<Vnode> vnode);
 #endif
 
  protected:
   // Whether this file system is read-only.
-  bool ReadonlyLocked() const FS_TA_REQUIRES(vfs_lock_) { return readonly_; }
+  bool ReadonlyLocked() const FS_TA_REQUIRES(vfs_lock_) { return readonly_.load(); }
 
  private:
   // Starting at vnode |vn|, walk the tree described by the path string,
@@ -266,12 +317,20 @@ class Vfs {
   // On success,
   // |out| is the vnode at which we stopped searching.
   // |pathout| is the remainder of the path to search.
+  //
+  // The caller must hold |topology_lock_|, either shared or exclusive.
   zx_status_t Walk(fbl::RefPtr<Vnode> vn, fbl::RefPtr<Vnode>* out, fbl::StringPiece path,
-                   fbl::StringPiece* pathout) FS_TA_REQUIRES(vfs_lock_);
+                   fbl::StringPiece* pathout) FS_TA_EXCLUDES(vfs_lock_);
 
+  // Looks up |name| within |vn| while holding the directory lock of |vn| shared.
+  // The caller must hold |topology_lock_|, either shared or exclusive.
+  zx_status_t Lookup(fbl::RefPtr<Vnode> vn, fbl::StringPiece name, fbl::RefPtr<Vnode>* out)
+      FS_TA_EXCLUDES(vfs_lock_);
+
+  // The caller must hold |topology_lock_|, either shared or exclusive.
   OpenResult OpenLocked(fbl::RefPtr<Vnode> vn, fbl::StringPiece path,
                         VnodeConnectionOptions options, Rights parent_rights, uint32_t mode)
-      FS_TA_REQUIRES(vfs_lock_);
+      FS_TA_EXCLUDES(vfs_lock_);
 
   // Attempt to create an entry with name |name| within the |vndir| directory.
   // - Upon success, returns a reference to the new vnode via |out_vn|, and return ZX_OK.
@@ -281,12 +340,18 @@ class Vfs {
   // Otherwise, a corresponding error code is returned.
   zx_status_t EnsureExists(fbl::RefPtr<Vnode> vndir, fbl::StringPiece name,
                            fbl::RefPtr<Vnode>* out_vn, fs::VnodeConnectionOptions options,
-                           uint32_t mode, bool* did_create) FS_TA_REQUIRES(vfs_lock_);
+                           uint32_t mode, bool* did_create) FS_TA_EXCLUDES(vfs_lock_);
 
-  bool readonly_{};
+  // Read on every open, so it is not guarded by |vfs_lock_|.
+  std::atomic<bool> readonly_{};
+
+  LookupCache lookup_cache_;
 
 #ifdef __Fuchsia__
   zx_status_t TokenToVnode(zx::event token, fbl::RefPtr<Vnode>* out) FS_TA_REQUIRES(vfs_lock_);
+
+  // The caller must also hold |topology_lock_| exclusively, since these change whether |vn| is
+  // remote.
   zx_status_t InstallRemoteLocked(fbl::RefPtr<Vnode> vn, MountChannel h) FS_TA_REQUIRES(vfs_lock_);
   zx_status_t UninstallRemoteLocked(fbl::RefPtr<Vnode> vn, zx::channel* h)
       FS_TA_REQUIRES(vfs_lock_);
@@ -317,9 +382,29 @@ class Vfs {
   async_dispatcher_t* dispatcher_{};
 
  protected:
-  // A lock which should be used to protect lookup and walk operations
+  // Protects the mount point list and the vnode tokens. It is only held for bookkeeping and
+  // never across a path walk.
   mtx_t vfs_lock_{};
 
+  // Orders vnode operations dispatched from connections. See |DispatchGuard|.
+  std::shared_mutex dispatch_lock_;
+
+  // Path walks hold |topology_lock_| shared and take the lock of each directory they visit in
+  // turn, so lookups and single-directory mutations (create, unlink) in unrelated directories
+  // proceed in parallel. Operations which may change the shape of the tree across directories
+  // (rename, link, mount and unmount) hold |topology_lock_| exclusively instead.
+  //
+  // Directory locks are striped by vnode address; at most one is held at a time, so collisions
+  // only cost parallelism. Lock order: |topology_lock_|, then a directory lock, then
+  // |vfs_lock_|.
+  static constexpr size_t kDirectoryLockCount = 32;
+  std::shared_mutex& DirectoryLock(const Vnode& vn) {
+    return directory_locks_[std::hash<const Vnode*>{}(&vn) % kDirectoryLockCount];
+  }
+
+  std::shared_mutex topology_lock_;
+  std::array<std::shared_mutex, kDirectoryLockCount> directory_locks_;
+
   // Starts FIDL message dispatching on |channel|, at the same time
   // starts to manage the lifetime of the connection.
   //
@@ -17,6 +17,7 @@
 #include <zircon/compiler.h>
 #include <zircon/types.h>
 
+#include <mutex>
 #include <type_traits>
 #include <utility>
 
@@ -332,6 +333,18 @@ class Vnode : public VnodeRefCounted<Vnode>, public fbl::Recyclable<Vnode> {
   virtual zx::channel DetachRemote();
   virtual zx_handle_t GetRemote() const;
   virtual void SetRemote(zx::channel remote);
+
+  // Returns true if messages targeting this vnode may be dispatched concurrently with messages
+  // targeting other vnodes of the same filesystem, when the filesystem is served from more than
+  // one thread. Messages targeting the same vnode are always dispatched one at a time, under
+  // |dispatch_lock()|.
+  //
+  // The default implementation returns false, in which case operations on this vnode are
+  // serialized against every other vnode operation in the filesystem. See |Vfs::DispatchGuard|.
+  virtual bool SupportsConcurrentDispatch() const;
+
+  // Serializes operations on this vnode when |SupportsConcurrentDispatch| is true.
+  std::mutex& dispatch_lock() { return dispatch_lock_; }
 #endif  // __Fuchsia__
 
   // Invoked by internal Connections to account transactions
@@ -348,6 +361,10 @@ class Vnode : public VnodeRefCounted<Vnode>, public fbl::Recyclable<Vnode> {
 
  private:
   std::atomic<size_t> inflight_transactions_ = 0;
+
+#ifdef __Fuchsia__
+  std::mutex dispatch_lock_;
+#endif  // __Fuchsia__
 };
 
 // Opens a vnode by reference.
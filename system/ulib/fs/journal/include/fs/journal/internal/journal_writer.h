@@ -10,6 +10,7 @@
 #include <zircon/types.h>
 
 #include <algorithm>
+#include <vector>
 
 #include <fbl/vector.h>
 #include <fs/journal/format.h>
@@ -66,6 +67,12 @@ class JournalWriter {
   // could be more fine grained, returning a promise that represents the completion of all phases.
   fit::result<void, zx_status_t> WriteMetadata(JournalWorkItem work);
 
+  // Writes |group| to disk immediately, as consecutive journal entries.
+  //
+  // This goes through the same phases as |WriteMetadata|, but each phase issues a single request
+  // to the device for the whole group, rather than one per entry.
+  fit::result<void, zx_status_t> WriteMetadataGroup(std::vector<JournalWorkItem> group);
+
   // Trims |operations| immediately.
   fit::result<void, zx_status_t> TrimData(std::vector<storage::BufferedOperation> operations);
 
@@ -104,10 +111,11 @@ class JournalWriter {
   // Returns the length of the portion of the journal which stores entries.
   [[nodiscard]] uint64_t EntriesLength() const { return entries_length_; }
 
-  // Writes |work| to the journal, and flushes it to the underlying device.
+  // Writes each item of |group| to the journal as its own entry, and flushes them to the
+  // underlying device.
   //
   // Blocks the calling thread on I/O until the operation completes.
-  zx_status_t WriteMetadataToJournal(JournalWorkItem* work);
+  zx_status_t WriteMetadataToJournal(std::vector<JournalWorkItem>* group);
 
   // Writes the info block if adding a |block_count| block entry to the journal
   // will hit the start of the journal.
@@ -120,11 +128,13 @@ class JournalWriter {
   // Blocks the calling thread on I/O until the operation completes.
   zx_status_t WriteInfoBlock();
 
-  // Writes an operation into the journal, creating a sequence of operations
-  // which deal with wraparound of the in-memory |reservation| buffer and the on-disk
-  // journal. Additionally, issues these operations to the underlying device and
-  // returns the result (see |WriteOperations|).
-  zx_status_t WriteOperationToJournal(const storage::BlockBufferView& view);
+  // Appends to |operations| the sequence of operations which write |view| into the journal,
+  // dealing with wraparound of the in-memory |reservation| buffer and the on-disk journal.
+  //
+  // Advances the start of the next entry past |view|; the operations must then be issued to the
+  // underlying device (see |WriteOperations|).
+  void AddOperationsToJournal(const storage::BlockBufferView& view,
+                              std::vector<storage::BufferedOperation>* operations);
 
   // Writes operations directly through to disk.
   //
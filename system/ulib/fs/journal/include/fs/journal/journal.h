@@ -5,6 +5,8 @@
 #ifndef FS_JOURNAL_JOURNAL_H_
 #define FS_JOURNAL_JOURNAL_H_
 
+#include <lib/async-loop/cpp/loop.h>
+#include <lib/async-loop/default.h>
 #include <lib/fit/barrier.h>
 #include <lib/fit/promise.h>
 #include <lib/fit/sequencer.h>
@@ -12,6 +14,7 @@
 #include <zircon/types.h>
 
 #include <algorithm>
+#include <memory>
 
 #include <fbl/vector.h>
 #include <fs/journal/background_executor.h>
@@ -62,6 +65,18 @@ class Journal final : public fit::executor {
     // if there were to be a power-loss event, the file system would see new data with old
     // metadata. See fxb/37958 for more details.
     bool sequence_data_writes = true;
+
+    // If nonzero, enables group commit: metadata transactions which are ready to be written at
+    // the same time are written together, up to this many journal blocks (including entry
+    // headers and commit blocks). Each transaction remains its own journal entry, so ordering and
+    // atomicity are unchanged, but the group is issued to the journal with a single request, and
+    // then to its final location with a single request, rather than two requests per transaction.
+    uint64_t group_commit_blocks = 0;
+
+    // With group commit enabled, how long the first transaction of a group waits for others to
+    // join it before the group is written. With a window of zero, a group only collects the
+    // transactions which are already queued when it is written.
+    zx_duration_t group_commit_window = 0;
   };
 
   // Constructs a Journal with journaling enabled. This is the traditional constructor
@@ -98,6 +113,9 @@ class Journal final : public fit::executor {
   // Multiple requests to WriteMetadata are ordered. They are ordered by the invocation of the
   // |WriteMetadata| method, not by the completion of the returned promise. If provided, |callback|
   // will be invoked when the metadata has been submitted to the underlying device.
+  //
+  // With group commit enabled, the returned promise completes once the group containing the
+  // operations has been written.
   Promise WriteMetadata(fbl::Vector<storage::UnbufferedOperation> operations,
                         fit::callback<void(zx_status_t)> callback = {});
 
@@ -124,6 +142,19 @@ class Journal final : public fit::executor {
   void schedule_task(fit::pending_task task) final { executor_.schedule_task(std::move(task)); }
 
  private:
+  // Metadata transactions which will be written to the device together.
+  struct MetadataGroup;
+
+  // Returns a promise which adds |work| to the open metadata group, and completes once that
+  // group has been written.
+  Promise GroupMetadata(internal::JournalWorkItem work, fit::callback<void(zx_status_t)> callback);
+
+  // Writes the open metadata group, if any, and completes the promises of its transactions.
+  //
+  // Must be invoked before any other work is issued to the device, so that work is not reordered
+  // ahead of metadata which was enqueued before it.
+  void FlushMetadataGroup();
+
   std::unique_ptr<storage::BlockingRingBuffer> journal_buffer_;
   std::unique_ptr<storage::BlockingRingBuffer> writeback_buffer_;
 
@@ -140,6 +171,16 @@ class Journal final : public fit::executor {
 
   internal::JournalWriter writer_;
 
+  // The group of metadata transactions which has not been written yet. Only accessed from
+  // |executor_|.
+  std::shared_ptr<MetadataGroup> metadata_group_;
+
+  // Runs one timer per metadata group, which resumes the last transaction of the group once the
+  // group commit window has passed, so waiting out the window never blocks |executor_|. Only runs
+  // a thread when |options_.group_commit_window| is non-zero. Outlives |executor_|, so tasks still
+  // waiting for the window are resumed while the executor drains.
+  async::Loop group_commit_timer_{&kAsyncLoopConfigNoAttachToCurrentThread};
+
   // Intentionally place the executor at the end of the journal. This ensures that
   // during destruction, the executor can complete pending tasks operation on the writeback
   // buffers before the writeback buffers are destroyed.
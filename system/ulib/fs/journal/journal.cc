@@ -2,8 +2,16 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <lib/async/cpp/task.h>
 #include <lib/sync/completion.h>
+#include <lib/zx/time.h>
+#include <zircon/assert.h>
 #include <zircon/status.h>
+#include <zircon/syscalls.h>
+
+#include <mutex>
+#include <optional>
+#include <vector>
 
 #include <fs/journal/journal.h>
 #include <fs/trace.h>
@@ -42,6 +50,25 @@ fit::result<void, zx_status_t> SignalSyncComplete(sync_completion_t* completion)
 
 }  // namespace
 
+struct Journal::MetadataGroup {
+  std::vector<internal::JournalWorkItem> work;
+  std::vector<fit::callback<void(zx_status_t)>> callbacks;
+  // Total length of |work| in the journal.
+  uint64_t block_count = 0;
+  // Transactions which are waiting for the group to be written.
+  std::vector<fit::suspended_task> waiters;
+
+  // Guards |window_expired| and |flusher|, which the group commit timer also accesses.
+  std::mutex lock;
+  // Set once the group commit window has passed. The group is not written before then, unless
+  // it fills up or is flushed.
+  bool window_expired = false;
+  // The last transaction of the group, while it waits for the window to pass.
+  fit::suspended_task flusher;
+  // The result of writing the group, once it has been written.
+  std::optional<zx_status_t> status;
+};
+
 Journal::Journal(TransactionHandler* transaction_handler, JournalSuperblock journal_superblock,
                  std::unique_ptr<storage::BlockingRingBuffer> journal_buffer,
                  std::unique_ptr<storage::BlockingRingBuffer> writeback_buffer,
@@ -50,7 +77,11 @@ Journal::Journal(TransactionHandler* transaction_handler, JournalSuperblock jour
       writeback_buffer_(std::move(writeback_buffer)),
       writer_(transaction_handler, std::move(journal_superblock), journal_start_block,
               journal_buffer_->capacity()),
-      options_(options) {}
+      options_(options) {
+  if (options_.group_commit_window > 0) {
+    group_commit_timer_.StartThread("journal-group-commit");
+  }
+}
 
 Journal::Journal(TransactionHandler* transaction_handler,
                  std::unique_ptr<storage::BlockingRingBuffer> writeback_buffer)
@@ -94,6 +125,7 @@ Journal::Promise Journal::WriteData(fbl::Vector<storage::UnbufferedOperation> op
   // Return the deferred action to write the data operations to the device.
   auto promise =
       fit::make_promise([this, work = std::move(work)]() mutable -> fit::result<void, zx_status_t> {
+        FlushMetadataGroup();
         return writer_.WriteData(std::move(work));
       });
 
@@ -141,6 +173,10 @@ Journal::Promise Journal::WriteMetadata(fbl::Vector<storage::UnbufferedOperation
   }
   internal::JournalWorkItem work(std::move(reservation), std::move(buffered_operations));
 
+  if (options_.group_commit_blocks != 0) {
+    return GroupMetadata(std::move(work), std::move(callback));
+  }
+
   // Return the deferred action to write the metadata operations to the device.
   auto promise =
       fit::make_promise([this, work = std::move(work), callback = std::move(callback)]() mutable
@@ -169,6 +205,7 @@ Journal::Promise Journal::TrimData(std::vector<storage::BufferedOperation> opera
   // Return the deferred action to write the metadata operations to the device.
   auto promise = fit::make_promise(
       [this, operations = std::move(operations)]() mutable -> fit::result<void, zx_status_t> {
+        FlushMetadataGroup();
         return writer_.TrimData(std::move(operations));
       });
 
@@ -180,12 +217,135 @@ Journal::Promise Journal::TrimData(std::vector<storage::BufferedOperation> opera
 }
 
 Journal::Promise Journal::Sync() {
-  auto update = fit::make_promise(
-      [this]() mutable -> fit::result<void, zx_status_t> { return writer_.Sync(); });
-  return barrier_.sync().then(
-      [update = std::move(update)](fit::context& context, fit::result<void, void>& result) mutable {
+  auto update = fit::make_promise([this]() mutable -> fit::result<void, zx_status_t> {
+    FlushMetadataGroup();
+    return writer_.Sync();
+  });
+  // Write the open metadata group before waiting for prior work, so that the transactions in it
+  // do not wait out the group commit window.
+  auto flush = fit::make_promise([this]() { FlushMetadataGroup(); });
+  return flush.and_then([prior_work = barrier_.sync()]() mutable { return std::move(prior_work); })
+      .then([update = std::move(update)](fit::context& context,
+                                         fit::result<void, void>& result) mutable {
         return update(context);
       });
 }
 
+Journal::Promise Journal::GroupMetadata(internal::JournalWorkItem work,
+                                        fit::callback<void(zx_status_t)> callback) {
+  // Joining a group is ordered with respect to all other metadata operations, so transactions
+  // are written in the order they were enqueued.
+  auto join = fit::make_promise(
+      [this, work = std::move(work), callback = std::move(callback)]() mutable
+      -> fit::result<std::shared_ptr<MetadataGroup>, zx_status_t> {
+        const uint64_t block_count = work.reservation.length();
+        if (metadata_group_ &&
+            metadata_group_->block_count + block_count > options_.group_commit_blocks) {
+          FlushMetadataGroup();
+        }
+        if (!metadata_group_) {
+          metadata_group_ = std::make_shared<MetadataGroup>();
+          if (options_.group_commit_window > 0) {
+            async::PostTaskForTime(
+                group_commit_timer_.dispatcher(),
+                [group = metadata_group_]() {
+                  std::lock_guard lock(group->lock);
+                  group->window_expired = true;
+                  if (group->flusher) {
+                    group->flusher.resume_task();
+                  }
+                },
+                zx::deadline_after(zx::duration(options_.group_commit_window)));
+          } else {
+            metadata_group_->window_expired = true;
+          }
+        } else {
+          // The previous last transaction is no longer responsible for writing the group; it just
+          // waits for it like any other member.
+          std::lock_guard lock(metadata_group_->lock);
+          if (metadata_group_->flusher) {
+            metadata_group_->waiters.push_back(std::move(metadata_group_->flusher));
+          }
+        }
+        std::shared_ptr<MetadataGroup> group = metadata_group_;
+        group->work.push_back(std::move(work));
+        group->callbacks.push_back(std::move(callback));
+        group->block_count += block_count;
+        if (group->block_count >= options_.group_commit_blocks) {
+          FlushMetadataGroup();
+        }
+        return fit::ok(std::move(group));
+      });
+  auto ordered_join = metadata_sequencer_.wrap(std::move(join));
+
+  // Once the transaction has joined a group, later metadata operations may proceed, and join the
+  // same group. The last transaction of the group is responsible for writing it.
+  auto promise = ordered_join.and_then(
+      [this, members = size_t{0}, yielded = false](
+          fit::context& context,
+          const std::shared_ptr<MetadataGroup>& group) mutable -> fit::result<void, zx_status_t> {
+        if (!group->status) {
+          if (members == 0) {
+            members = group->work.size();
+          }
+          if (group->work.size() != members) {
+            group->waiters.push_back(context.suspend_task());
+            return fit::pending();
+          }
+          if (!yielded) {
+            // Let all tasks which are already runnable go first, so the metadata they carry may
+            // join the group.
+            yielded = true;
+            context.suspend_task().resume_task();
+            return fit::pending();
+          }
+          {
+            // Wait out the window off the executor. The group's timer resumes this task once the
+            // window passes. If the group is written sooner, because it filled up or a sync
+            // flushed it, or another transaction joins it, this task becomes a waiter instead.
+            std::lock_guard lock(group->lock);
+            if (!group->window_expired) {
+              group->flusher = context.suspend_task();
+              return fit::pending();
+            }
+          }
+          ZX_DEBUG_ASSERT(group == metadata_group_);
+          FlushMetadataGroup();
+        }
+        if (*group->status != ZX_OK) {
+          return fit::error(*group->status);
+        }
+        return fit::ok();
+      });
+
+  // Track write ops to ensure that invocations of |sync| can flush all prior work.
+  return barrier_.wrap(std::move(promise));
+}
+
+void Journal::FlushMetadataGroup() {
+  if (!metadata_group_) {
+    return;
+  }
+  std::shared_ptr<MetadataGroup> group = std::move(metadata_group_);
+  metadata_group_ = nullptr;
+
+  fit::result<void, zx_status_t> result = writer_.WriteMetadataGroup(std::move(group->work));
+  group->status = result.is_ok() ? ZX_OK : result.error();
+  for (auto& callback : group->callbacks) {
+    if (callback) {
+      callback(*group->status);
+    }
+  }
+  {
+    std::lock_guard lock(group->lock);
+    if (group->flusher) {
+      group->waiters.push_back(std::move(group->flusher));
+    }
+  }
+  for (auto& waiter : group->waiters) {
+    waiter.resume_task();
+  }
+  group->waiters.clear();
+}
+
 }  // namespace fs
@@ -5,6 +5,9 @@
 #include <lib/sync/completion.h>
 #include <zircon/status.h>
 
+#include <algorithm>
+#include <set>
+
 #include <fs/journal/internal/journal_writer.h>
 #include <fs/trace.h>
 #include <fs/transaction/writeback.h>
@@ -16,6 +19,47 @@ namespace {
 
 using storage::OperationType;
 
+// Returns the operations which write |group| to its final on-disk location.
+//
+// Requests within a single transaction may be completed by the device in any order, so if several
+// entries of the group write the same block, only the write from the latest entry is kept.
+std::vector<storage::BufferedOperation> FinalOperations(
+    const std::vector<internal::JournalWorkItem>& group) {
+  if (group.size() == 1) {
+    return group[0].operations;
+  }
+
+  std::vector<storage::BufferedOperation> operations;
+  std::set<uint64_t> written_blocks;
+  for (auto work = group.rbegin(); work != group.rend(); ++work) {
+    for (auto operation = work->operations.rbegin(); operation != work->operations.rend();
+         ++operation) {
+      // Emit each run of blocks which are not overwritten later.
+      uint64_t run_start = 0;
+      uint64_t run_length = 0;
+      for (uint64_t i = 0; i <= operation->op.length; i++) {
+        if (i < operation->op.length &&
+            written_blocks.insert(operation->op.dev_offset + i).second) {
+          if (run_length++ == 0) {
+            run_start = i;
+          }
+          continue;
+        }
+        if (run_length > 0) {
+          storage::BufferedOperation run = *operation;
+          run.op.vmo_offset += run_start;
+          run.op.dev_offset += run_start;
+          run.op.length = run_length;
+          operations.push_back(run);
+          run_length = 0;
+        }
+      }
+    }
+  }
+  std::reverse(operations.begin(), operations.end());
+  return operations;
+}
+
 }  // namespace
 
 namespace internal {
@@ -68,8 +112,19 @@ fit::result<void, zx_status_t> JournalWriter::WriteData(JournalWorkItem work) {
 }
 
 fit::result<void, zx_status_t> JournalWriter::WriteMetadata(JournalWorkItem work) {
-  const uint64_t block_count = work.reservation.length();
-  FS_TRACE_DEBUG("WriteMetadata: Writing %zu blocks (includes header, commit)\n", block_count);
+  std::vector<JournalWorkItem> group;
+  group.push_back(std::move(work));
+  return WriteMetadataGroup(std::move(group));
+}
+
+fit::result<void, zx_status_t> JournalWriter::WriteMetadataGroup(
+    std::vector<JournalWorkItem> group) {
+  uint64_t block_count = 0;
+  for (const auto& work : group) {
+    block_count += work.reservation.length();
+  }
+  FS_TRACE_DEBUG("WriteMetadata: Writing %zu blocks in %zu entries (includes header, commit)\n",
+                 block_count, group.size());
 
   // Ensure the info block is caught up, so it doesn't point to the middle of an invalid entry.
   zx_status_t status = WriteInfoBlockIfIntersect(block_count);
@@ -79,14 +134,16 @@ fit::result<void, zx_status_t> JournalWriter::WriteMetadata(JournalWorkItem work
   }
 
   // Monitor the in-flight metadata operations.
-  for (const auto& operation : work.operations) {
-    range::Range<uint64_t> range(operation.op.dev_offset,
-                                 operation.op.dev_offset + operation.op.length);
-    live_metadata_operations_.Insert(std::move(range));
+  for (const auto& work : group) {
+    for (const auto& operation : work.operations) {
+      range::Range<uint64_t> range(operation.op.dev_offset,
+                                   operation.op.dev_offset + operation.op.length);
+      live_metadata_operations_.Insert(std::move(range));
+    }
   }
 
   // Write metadata to the journal itself.
-  status = WriteMetadataToJournal(&work);
+  status = WriteMetadataToJournal(&group);
   if (status != ZX_OK) {
     FS_TRACE_ERROR("WriteMetadata: Failed to write metadata to journal: %s\n",
                    zx_status_get_string(status));
@@ -94,7 +151,7 @@ fit::result<void, zx_status_t> JournalWriter::WriteMetadata(JournalWorkItem work
   }
 
   // Write metadata to the final on-disk, non-journal location.
-  status = WriteOperations(work.operations);
+  status = WriteOperations(FinalOperations(group));
   if (status != ZX_OK) {
     FS_TRACE_ERROR("WriteMetadata: Failed to write metadata to final location: %s\n",
                    zx_status_get_string(status));
@@ -115,11 +172,11 @@ fit::result<void, zx_status_t> JournalWriter::TrimData(
   return fit::ok();
 }
 
-zx_status_t JournalWriter::WriteOperationToJournal(const storage::BlockBufferView& view) {
+void JournalWriter::AddOperationsToJournal(const storage::BlockBufferView& view,
+                                           std::vector<storage::BufferedOperation>* operations) {
   const uint64_t total_block_count = view.length();
   const uint64_t max_reservation_size = EntriesLength();
   uint64_t written_block_count = 0;
-  std::vector<storage::BufferedOperation> journal_operations;
   storage::BufferedOperation operation;
   operation.vmoid = view.vmoid();
   operation.op.type = storage::OperationType::kWrite;
@@ -137,18 +194,10 @@ zx_status_t JournalWriter::WriteOperationToJournal(const storage::BlockBufferVie
     const uint64_t reservation_block_max = max_reservation_size - operation.op.vmo_offset;
     operation.op.length = std::min(total_block_count - written_block_count,
                                    std::min(journal_block_max, reservation_block_max));
-    journal_operations.push_back(operation);
+    operations->push_back(operation);
     written_block_count += operation.op.length;
     next_entry_start_block_ = (next_entry_start_block_ + operation.op.length) % EntriesLength();
   }
-
-  zx_status_t status = WriteOperations(journal_operations);
-  if (status != ZX_OK) {
-    FS_TRACE_ERROR("JournalWriter::WriteOperationToJournal: Failed to write: %s\n",
-                   zx_status_get_string(status));
-    return status;
-  }
-  return status;
 }
 
 fit::result<void, zx_status_t> JournalWriter::Sync() {
@@ -171,18 +220,31 @@ fit::result<void, zx_status_t> JournalWriter::Sync() {
   return fit::ok();
 }
 
-zx_status_t JournalWriter::WriteMetadataToJournal(JournalWorkItem* work) {
-  FS_TRACE_DEBUG("WriteMetadataToJournal: Writing %zu blocks with sequence_number %zu\n",
-                 work->reservation.length(), next_sequence_number_);
+zx_status_t JournalWriter::WriteMetadataToJournal(std::vector<JournalWorkItem>* group) {
+  std::vector<JournalEntryView> entries;
+  entries.reserve(group->size());
+  std::vector<storage::BufferedOperation> journal_operations;
+  for (auto& work : *group) {
+    FS_TRACE_DEBUG("WriteMetadataToJournal: Writing %zu blocks with sequence_number %zu\n",
+                   work.reservation.length(), next_sequence_number_);
 
-  // Set the header and commit blocks within the journal.
-  JournalEntryView entry(work->reservation.buffer_view(), work->operations,
-                         next_sequence_number_++);
+    // Set the header and commit blocks within the journal.
+    entries.emplace_back(work.reservation.buffer_view(), work.operations, next_sequence_number_++);
+    AddOperationsToJournal(work.reservation.buffer_view(), &journal_operations);
+  }
+
+  // Consecutive entries are adjacent in the journal, so the whole group is issued at once.
+  zx_status_t status = WriteOperations(journal_operations);
+  if (status != ZX_OK) {
+    FS_TRACE_ERROR("JournalWriter::WriteMetadataToJournal: Failed to write: %s\n",
+                   zx_status_get_string(status));
+  }
 
-  zx_status_t status = WriteOperationToJournal(work->reservation.buffer_view());
   // Although the payload may be encoded while written to the journal, it should be decoded
   // when written to the final on-disk location later.
-  entry.DecodePayloadBlocks();
+  for (auto& entry : entries) {
+    entry.DecodePayloadBlocks();
+  }
   return status;
 }
 
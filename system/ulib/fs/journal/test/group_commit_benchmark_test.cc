@@ -0,0 +1,141 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <lib/zx/clock.h>
+#include <lib/zx/time.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <fs/journal/journal.h>
+#include <zxtest/zxtest.h>
+
+namespace fs {
+namespace {
+
+constexpr uint32_t kBlockSize = 8192;
+constexpr size_t kJournalLength = 256;
+constexpr size_t kWritebackLength = 16;
+constexpr uint64_t kJournalStartBlock = 8;
+constexpr uint64_t kMetadataStartBlock = 1024;
+
+// How long the simulated device takes to complete each request, regardless of its size. This
+// stands in for the flush which ends every journal transaction on real hardware.
+constexpr zx::duration kRequestLatency = zx::usec(200);
+
+constexpr int kClientThreads = 4;
+constexpr int kTransactionsPerThread = 64;
+
+class BenchmarkVmoidRegistry : public storage::VmoidRegistry {
+ public:
+  zx_status_t BlockAttachVmo(const zx::vmo& vmo, storage::Vmoid* out) final {
+    *out = storage::Vmoid(next_vmoid_++);
+    return ZX_OK;
+  }
+
+  zx_status_t BlockDetachVmo(storage::Vmoid vmoid) final {
+    [[maybe_unused]] vmoid_t id = vmoid.TakeId();
+    return ZX_OK;
+  }
+
+ private:
+  vmoid_t next_vmoid_ = 1;
+};
+
+// A device which completes every request after a fixed latency.
+class SlowTransactionHandler final : public fs::TransactionHandler {
+ public:
+  uint64_t BlockNumberToDevice(uint64_t block_num) const final { return block_num; }
+
+  zx_status_t RunRequests(const std::vector<storage::BufferedOperation>& requests) final {
+    requests_++;
+    zx::nanosleep(zx::deadline_after(kRequestLatency));
+    return ZX_OK;
+  }
+
+  uint64_t requests() const { return requests_.load(); }
+
+ private:
+  std::atomic<uint64_t> requests_ = 0;
+};
+
+struct BenchmarkResult {
+  uint64_t requests = 0;
+  zx::duration elapsed;
+};
+
+// Commits single-block metadata transactions from several threads at once, and measures how long
+// it takes until all of them have been written.
+void RunMetadataBenchmark(Journal::Options options, BenchmarkResult* result) {
+  BenchmarkVmoidRegistry registry;
+  std::unique_ptr<storage::BlockingRingBuffer> journal_buffer;
+  ASSERT_OK(storage::BlockingRingBuffer::Create(&registry, kJournalLength, kBlockSize,
+                                                "journal-writeback-buffer", &journal_buffer));
+  std::unique_ptr<storage::BlockingRingBuffer> data_buffer;
+  ASSERT_OK(storage::BlockingRingBuffer::Create(&registry, kWritebackLength, kBlockSize,
+                                                "data-writeback-buffer", &data_buffer));
+  auto info_block_buffer = std::make_unique<storage::VmoBuffer>();
+  ASSERT_OK(
+      info_block_buffer->Initialize(&registry, kJournalMetadataBlocks, kBlockSize, "info-block"));
+  JournalSuperblock info_block(std::move(info_block_buffer));
+  info_block.Update(0, 0);
+
+  storage::VmoBuffer metadata;
+  ASSERT_OK(metadata.Initialize(&registry, kClientThreads, kBlockSize, "metadata"));
+
+  SlowTransactionHandler handler;
+  zx::time start = zx::clock::get_monotonic();
+  {
+    Journal journal(&handler, std::move(info_block), std::move(journal_buffer),
+                    std::move(data_buffer), kJournalStartBlock, options);
+    std::vector<std::thread> clients;
+    for (int i = 0; i < kClientThreads; i++) {
+      clients.emplace_back([&journal, &metadata, i]() {
+        for (int j = 0; j < kTransactionsPerThread; j++) {
+          storage::UnbufferedOperation operation = {
+              zx::unowned_vmo(metadata.vmo().get()),
+              {
+                  storage::OperationType::kWrite,
+                  .vmo_offset = static_cast<uint64_t>(i),
+                  .dev_offset = kMetadataStartBlock + i * kTransactionsPerThread + j,
+                  .length = 1,
+              },
+          };
+          journal.schedule_task(journal.WriteMetadata({operation}));
+        }
+      });
+    }
+    for (auto& client : clients) {
+      client.join();
+    }
+  }
+  result->elapsed = zx::clock::get_monotonic() - start;
+  result->requests = handler.requests();
+}
+
+TEST(GroupCommitBenchmark, MetadataTransactions) {
+  BenchmarkResult individual;
+  ASSERT_NO_FAILURES(RunMetadataBenchmark(Journal::Options(), &individual));
+
+  Journal::Options options;
+  options.group_commit_blocks = kJournalLength / 4;
+  BenchmarkResult grouped;
+  ASSERT_NO_FAILURES(RunMetadataBenchmark(options, &grouped));
+
+  constexpr int kTransactions = kClientThreads * kTransactionsPerThread;
+  printf("journal: %d transactions without group commit: %lu requests, %ld us\n", kTransactions,
+         individual.requests, individual.elapsed.to_usecs());
+  printf("journal: %d transactions with group commit: %lu requests, %ld us\n", kTransactions,
+         grouped.requests, grouped.elapsed.to_usecs());
+
+  // Each transaction costs at least a request to the journal and one to its final location.
+  EXPECT_GE(individual.requests, 2 * kTransactions);
+  EXPECT_LE(grouped.requests, individual.requests);
+}
+
+}  // namespace
+}  // namespace fs
@@ -2705,6 +2705,298 @@ TEST_F(JournalTest, PayloadBlocksWithJournalMagicAreEscaped) {
   }
 }
 
+// Returns a promise which blocks the journal's executor until |completion| is signalled, so that
+// work can be queued up behind it.
+fit::promise<void, zx_status_t> BlockExecutor(sync_completion_t* completion) {
+  return fit::make_promise([completion]() -> fit::result<void, zx_status_t> {
+    sync_completion_wait(completion, ZX_TIME_INFINITE);
+    return fit::ok();
+  });
+}
+
+Journal::Options GroupCommitOptions(uint64_t group_commit_blocks) {
+  Journal::Options options;
+  options.group_commit_blocks = group_commit_blocks;
+  return options;
+}
+
+// Tests that metadata operations which are queued at the same time are written with a single
+// request to the journal, and a single request to their final location.
+//
+// Operations 1-3: [ H, 1, C, H, 2, C, H, 3, C, _ ]
+//               : Info block update prompted by termination.
+TEST_F(JournalTest, GroupCommitWritesQueuedMetadataTogether) {
+  storage::VmoBuffer metadata = registry()->InitializeBuffer(3);
+
+  std::vector<storage::UnbufferedOperation> operations;
+  for (uint64_t i = 0; i < 3; i++) {
+    operations.push_back({
+        zx::unowned_vmo(metadata.vmo().get()),
+        {
+            storage::OperationType::kWrite,
+            .vmo_offset = i,
+            .dev_offset = 20 + 10 * i,
+            .length = 1,
+        },
+    });
+  }
+
+  constexpr uint64_t kJournalStartBlock = 55;
+  constexpr uint64_t kEntryLength = 1 + kEntryMetadataBlocks;
+  JournalRequestVerifier verifier(registry()->info(), registry()->journal(),
+                                  registry()->writeback(), kJournalStartBlock);
+  MockTransactionHandler::TransactionCallback callbacks[] = {
+      [&](const std::vector<storage::BufferedOperation>& requests) {
+        EXPECT_EQ(operations.size(), requests.size());
+        for (size_t i = 0; i < requests.size(); i++) {
+          CheckWriteRequest(requests[i], kJournalVmoid,
+                            /* vmo_offset= */ kEntryLength * i,
+                            /* dev_offset= */ kJournalStartBlock + kJournalMetadataBlocks +
+                                kEntryLength * i,
+                            /* length= */ kEntryLength);
+        }
+        registry()->VerifyReplay(operations, 3);
+        return ZX_OK;
+      },
+      [&](const std::vector<storage::BufferedOperation>& requests) {
+        EXPECT_EQ(operations.size(), requests.size());
+        for (size_t i = 0; i < requests.size(); i++) {
+          CheckWriteRequest(requests[i], kJournalVmoid,
+                            /* vmo_offset= */ kEntryLength * i + kJournalEntryHeaderBlocks,
+                            /* dev_offset= */ operations[i].op.dev_offset,
+                            /* length= */ 1);
+        }
+        verifier.ExtendJournalOffset(kEntryLength * operations.size());
+        return ZX_OK;
+      },
+      [&](const std::vector<storage::BufferedOperation>& requests) {
+        uint64_t sequence_number = 3;
+        verifier.VerifyInfoBlockWrite(sequence_number, requests);
+        registry()->VerifyReplay({}, sequence_number);
+        return ZX_OK;
+      },
+  };
+
+  std::vector<int> completed;
+  MockTransactionHandler handler(registry(), callbacks, std::size(callbacks));
+  {
+    Journal journal(&handler, take_info(), take_journal_buffer(), take_data_buffer(),
+                    kJournalStartBlock, GroupCommitOptions(kJournalLength));
+    sync_completion_t completion;
+    journal.schedule_task(BlockExecutor(&completion));
+    for (int i = 0; i < 3; i++) {
+      journal.schedule_task(
+          journal.WriteMetadata({operations[i]}, [&completed, i](zx_status_t status) {
+            EXPECT_OK(status);
+            completed.push_back(i);
+          }));
+    }
+    sync_completion_signal(&completion);
+  }
+  EXPECT_EQ(3, completed.size());
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(i, completed[i]);
+  }
+}
+
+// Tests that if several metadata operations of a group target the same block, only the latest
+// one is written to the final location.
+//
+// Operations 1-2: [ H, 1, C, H, 2, C, _, _, _, _ ]
+//               : Info block update prompted by termination.
+TEST_F(JournalTest, GroupCommitWritesSharedBlockOnce) {
+  storage::VmoBuffer metadata = registry()->InitializeBuffer(2);
+
+  const std::vector<storage::UnbufferedOperation> operations = {
+      {
+          zx::unowned_vmo(metadata.vmo().get()),
+          {
+              storage::OperationType::kWrite,
+              .vmo_offset = 0,
+              .dev_offset = 20,
+              .length = 1,
+          },
+      },
+      {
+          zx::unowned_vmo(metadata.vmo().get()),
+          {
+              storage::OperationType::kWrite,
+              .vmo_offset = 1,
+              .dev_offset = 20,
+              .length = 1,
+          },
+      },
+  };
+
+  constexpr uint64_t kJournalStartBlock = 55;
+  constexpr uint64_t kEntryLength = 1 + kEntryMetadataBlocks;
+  JournalRequestVerifier verifier(registry()->info(), registry()->journal(),
+                                  registry()->writeback(), kJournalStartBlock);
+  MockTransactionHandler::TransactionCallback callbacks[] = {
+      [&](const std::vector<storage::BufferedOperation>& requests) {
+        EXPECT_EQ(operations.size(), requests.size());
+        registry()->VerifyReplay({operations[1]}, 2);
+        return ZX_OK;
+      },
+      [&](const std::vector<storage::BufferedOperation>& requests) {
+        EXPECT_EQ(1, requests.size());
+        CheckWriteRequest(requests[0], kJournalVmoid,
+                          /* vmo_offset= */ kEntryLength + kJournalEntryHeaderBlocks,
+                          /* dev_offset= */ 20,
+                          /* length= */ 1);
+        verifier.ExtendJournalOffset(kEntryLength * operations.size());
+        return ZX_OK;
+      },
+      [&](const std::vector<storage::BufferedOperation>& requests) {
+        uint64_t sequence_number = 2;
+        verifier.VerifyInfoBlockWrite(sequence_number, requests);
+        return ZX_OK;
+      },
+  };
+
+  MockTransactionHandler handler(registry(), callbacks, std::size(callbacks));
+  {
+    Journal journal(&handler, take_info(), take_journal_buffer(), take_data_buffer(),
+                    kJournalStartBlock, GroupCommitOptions(kJournalLength));
+    sync_completion_t completion;
+    journal.schedule_task(BlockExecutor(&completion));
+    journal.schedule_task(journal.WriteMetadata({operations[0]}));
+    journal.schedule_task(journal.WriteMetadata({operations[1]}));
+    sync_completion_signal(&completion);
+  }
+}
+
+// Tests that a group of metadata operations is written once it reaches the configured size, even
+// if more operations are queued.
+//
+// Operation 1: [ H, 1, C, _, _, _, _, _, _, _ ]
+// Operation 2: [ _, _, _, H, 1, C, _, _, _, _ ]
+//            : Info block update prompted by termination.
+TEST_F(JournalTest, GroupCommitRespectsGroupSize) {
+  storage::VmoBuffer metadata = registry()->InitializeBuffer(2);
+
+  const std::vector<storage::UnbufferedOperation> operations = {
+      {
+          zx::unowned_vmo(metadata.vmo().get()),
+          {
+              storage::OperationType::kWrite,
+              .vmo_offset = 0,
+              .dev_offset = 20,
+              .length = 1,
+          },
+      },
+      {
+          zx::unowned_vmo(metadata.vmo().get()),
+          {
+              storage::OperationType::kWrite,
+              .vmo_offset = 1,
+              .dev_offset = 1234,
+              .length = 1,
+          },
+      },
+  };
+
+  constexpr uint64_t kJournalStartBlock = 55;
+  JournalRequestVerifier verifier(registry()->info(), registry()->journal(),
+                                  registry()->writeback(), kJournalStartBlock);
+  MockTransactionHandler::TransactionCallback callbacks[] = {
+      [&](const std::vector<storage::BufferedOperation>& requests) {
+        verifier.VerifyJournalWrite(operations[0], requests);
+        return ZX_OK;
+      },
+      [&](const std::vector<storage::BufferedOperation>& requests) {
+        verifier.VerifyMetadataWrite(operations[0], requests);
+        verifier.ExtendJournalOffset(operations[0].op.length + kEntryMetadataBlocks);
+        return ZX_OK;
+      },
+      [&](const std::vector<storage::BufferedOperation>& requests) {
+        verifier.VerifyJournalWrite(operations[1], requests);
+        return ZX_OK;
+      },
+      [&](const std::vector<storage::BufferedOperation>& requests) {
+        verifier.VerifyMetadataWrite(operations[1], requests);
+        verifier.ExtendJournalOffset(operations[1].op.length + kEntryMetadataBlocks);
+        registry()->VerifyReplay(operations, 2);
+        return ZX_OK;
+      },
+      [&](const std::vector<storage::BufferedOperation>& requests) {
+        uint64_t sequence_number = 2;
+        verifier.VerifyInfoBlockWrite(sequence_number, requests);
+        return ZX_OK;
+      },
+  };
+
+  MockTransactionHandler handler(registry(), callbacks, std::size(callbacks));
+  {
+    Journal journal(&handler, take_info(), take_journal_buffer(), take_data_buffer(),
+                    kJournalStartBlock, GroupCommitOptions(1 + kEntryMetadataBlocks));
+    sync_completion_t completion;
+    journal.schedule_task(BlockExecutor(&completion));
+    journal.schedule_task(journal.WriteMetadata({operations[0]}));
+    journal.schedule_task(journal.WriteMetadata({operations[1]}));
+    sync_completion_signal(&completion);
+  }
+}
+
+// Tests that data operations are not written until a preceding group of metadata operations has
+// been written.
+TEST_F(JournalTest, GroupCommitWritesMetadataBeforeOrderedData) {
+  storage::VmoBuffer buffer = registry()->InitializeBuffer(2);
+  const storage::UnbufferedOperation metadata_operation = {
+      zx::unowned_vmo(buffer.vmo().get()),
+      {
+          storage::OperationType::kWrite,
+          .vmo_offset = 0,
+          .dev_offset = 20,
+          .length = 1,
+      },
+  };
+  const storage::UnbufferedOperation data_operation = {
+      zx::unowned_vmo(buffer.vmo().get()),
+      {
+          storage::OperationType::kWrite,
+          .vmo_offset = 1,
+          .dev_offset = 200,
+          .length = 1,
+      },
+  };
+
+  constexpr uint64_t kJournalStartBlock = 55;
+  JournalRequestVerifier verifier(registry()->info(), registry()->journal(),
+                                  registry()->writeback(), kJournalStartBlock);
+  MockTransactionHandler::TransactionCallback callbacks[] = {
+      [&](const std::vector<storage::BufferedOperation>& requests) {
+        verifier.VerifyJournalWrite(metadata_operation, requests);
+        return ZX_OK;
+      },
+      [&](const std::vector<storage::BufferedOperation>& requests) {
+        verifier.VerifyMetadataWrite(metadata_operation, requests);
+        verifier.ExtendJournalOffset(metadata_operation.op.length + kEntryMetadataBlocks);
+        return ZX_OK;
+      },
+      [&](const std::vector<storage::BufferedOperation>& requests) {
+        verifier.VerifyDataWrite(data_operation, requests);
+        return ZX_OK;
+      },
+      [&](const std::vector<storage::BufferedOperation>& requests) {
+        uint64_t sequence_number = 1;
+        verifier.VerifyInfoBlockWrite(sequence_number, requests);
+        return ZX_OK;
+      },
+  };
+
+  MockTransactionHandler handler(registry(), callbacks, std::size(callbacks));
+  {
+    Journal journal(&handler, take_info(), take_journal_buffer(), take_data_buffer(),
+                    kJournalStartBlock, GroupCommitOptions(kJournalLength));
+    sync_completion_t completion;
+    journal.schedule_task(BlockExecutor(&completion));
+    journal.schedule_task(journal.WriteMetadata({metadata_operation}));
+    journal.schedule_task(journal.WriteData({data_operation}));
+    sync_completion_signal(&completion);
+  }
+}
+
 zx_status_t MakeJournalHelper(uint8_t* dest_buffer, uint64_t blocks, uint64_t block_size) {
   fs::WriteBlockFn write_block_fn = [dest_buffer, blocks, block_size](
                                         fbl::Span<const uint8_t> buffer, uint64_t block_offset) {
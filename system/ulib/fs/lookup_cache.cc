@@ -0,0 +1,151 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <zircon/errors.h>
+
+#include <utility>
+
+#include <fs/lookup_cache.h>
+#include <fs/vnode.h>
+
+namespace fs {
+
+LookupCache::~LookupCache() { Clear(); }
+
+void LookupCache::SetCapacity(size_t capacity, Policy policy) {
+  EntryList evicted;
+  {
+    std::scoped_lock guard(lock_);
+    if (policy != policy_.load()) {
+      // Entries cached under the previous policy may not be valid under the new one.
+      evicted.splice(evicted.end(), entries_);
+      index_.clear();
+    }
+    policy_.store(policy);
+    capacity_.store(capacity);
+    EvictLocked(&evicted);
+  }
+}
+
+bool LookupCache::Lookup(const Vnode& parent, fbl::StringPiece name, fbl::RefPtr<Vnode>* out) {
+  if (!enabled()) {
+    return false;
+  }
+  std::scoped_lock guard(lock_);
+  auto entry = index_.find(Key{&parent, std::string(name.data(), name.length())});
+  if (entry == index_.end()) {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  // Refresh the entry.
+  entries_.splice(entries_.begin(), entries_, entry->second);
+  *out = entry->second->vnode;
+  if (*out) {
+    hits_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    negative_hits_.fetch_add(1, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+void LookupCache::Insert(fbl::RefPtr<Vnode> parent, fbl::StringPiece name, zx_status_t status,
+                         fbl::RefPtr<Vnode> vnode) {
+  if (!enabled()) {
+    return;
+  }
+  if (status == ZX_OK) {
+    if (policy_.load() == Policy::kNegativeOnly || vnode == nullptr) {
+      return;
+    }
+  } else if (status == ZX_ERR_NOT_FOUND) {
+    vnode = nullptr;
+  } else {
+    return;
+  }
+
+  Key key{parent.get(), std::string(name.data(), name.length())};
+  EntryList evicted;
+  fbl::RefPtr<Vnode> stale;
+  {
+    std::scoped_lock guard(lock_);
+    auto existing = index_.find(key);
+    if (existing != index_.end()) {
+      // Another thread raced to fill the same entry.
+      entries_.splice(entries_.begin(), entries_, existing->second);
+      stale = std::move(existing->second->vnode);
+      existing->second->vnode = std::move(vnode);
+      return;
+    }
+    entries_.push_front(Entry{key, std::move(parent), std::move(vnode)});
+    index_.emplace(std::move(key), entries_.begin());
+    EvictLocked(&evicted);
+  }
+}
+
+void LookupCache::Invalidate(const Vnode& parent, fbl::StringPiece name) {
+  if (!enabled()) {
+    return;
+  }
+  EntryList invalidated;
+  {
+    std::scoped_lock guard(lock_);
+    auto entry = index_.find(Key{&parent, std::string(name.data(), name.length())});
+    if (entry == index_.end()) {
+      return;
+    }
+    invalidated.splice(invalidated.end(), entries_, entry->second);
+    index_.erase(entry);
+  }
+  invalidations_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LookupCache::InvalidateChildren(const Vnode& parent) {
+  if (!enabled()) {
+    return;
+  }
+  EntryList invalidated;
+  {
+    std::scoped_lock guard(lock_);
+    for (auto entry = entries_.begin(); entry != entries_.end();) {
+      auto next = std::next(entry);
+      if (entry->key.parent == &parent) {
+        index_.erase(entry->key);
+        invalidated.splice(invalidated.end(), entries_, entry);
+      }
+      entry = next;
+    }
+  }
+  invalidations_.fetch_add(invalidated.size(), std::memory_order_relaxed);
+}
+
+void LookupCache::Clear() {
+  EntryList cleared;
+  {
+    std::scoped_lock guard(lock_);
+    cleared.splice(cleared.end(), entries_);
+    index_.clear();
+  }
+}
+
+LookupCache::Stats LookupCache::GetStats() const {
+  Stats stats;
+  stats.hits = hits_.load(std::memory_order_relaxed);
+  stats.negative_hits = negative_hits_.load(std::memory_order_relaxed);
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  stats.evictions = evictions_.load(std::memory_order_relaxed);
+  stats.invalidations = invalidations_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void LookupCache::EvictLocked(EntryList* evicted) {
+  size_t capacity = capacity_.load();
+  while (entries_.size() > capacity) {
+    auto last = std::prev(entries_.end());
+    index_.erase(last->key);
+    evicted->splice(evicted->end(), entries_, last);
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace fs
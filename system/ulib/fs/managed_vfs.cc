@@ -6,6 +6,8 @@
 #include <lib/sync/completion.h>
 
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <utility>
 
 #include <fbl/auto_lock.h>
@@ -29,6 +31,11 @@ void ManagedVfs::Shutdown(ShutdownCallback handler) {
   ZX_DEBUG_ASSERT(handler);
   zx_status_t status =
       async::PostTask(dispatcher(), [this, closure = std::move(handler)]() mutable {
+        // When served from multiple threads, the message which requested this shutdown may
+        // still be unwinding on another thread. Wait for it to release the dispatch locks
+        // before tearing anything down.
+        { std::unique_lock<std::shared_mutex> fence(dispatch_lock_); }
+
         fbl::AutoLock<fbl::Mutex> lock(&lock_);
         ZX_DEBUG_ASSERT(!shutdown_handler_);
         shutdown_handler_ = std::move(closure);
@@ -71,6 +78,8 @@ void ManagedVfs::OnShutdownComplete(async_dispatcher_t*, async::TaskBase*, zx_st
                 status);
   ZX_DEBUG_ASSERT(shutdown_handler_);
 
+  // Cached vnodes must not outlive the filesystem torn down by the handler.
+  lookup_cache().Clear();
   auto handler = std::move(shutdown_handler_);
   handler(status);
 }
@@ -41,6 +41,17 @@ cobalt_client::HistogramOptions MakeHistogramOptions(const cobalt_client::Histog
   return options;
 }
 
+cobalt_client::MetricOptions MakeLookupCacheOptions(const fbl::String& fs_name,
+                                                    LookupCacheResult result) {
+  cobalt_client::MetricOptions options = {};
+  options.component = fs_name.c_str();
+  options.metric_id = static_cast<uint32_t>(Event::kLookupCache);
+  options.event_codes = {0};
+  options.metric_dimensions = 1;
+  options.event_codes[0] = static_cast<uint32_t>(result);
+  return options;
+}
+
 }  // namespace
 
 VnodeMetrics::VnodeMetrics(cobalt_client::Collector* collector, const fbl::String& fs_name) {
@@ -124,11 +135,27 @@ void CompressionFormatMetrics::IncrementCounter(fs_metrics::CompressionFormat fo
   counters[format]->Increment(size);
 }
 
+LookupCacheMetrics::LookupCacheMetrics(cobalt_client::Collector* collector,
+                                       const fbl::String& fs_name)
+    : hit(MakeLookupCacheOptions(fs_name, LookupCacheResult::kHit), collector),
+      negative_hit(MakeLookupCacheOptions(fs_name, LookupCacheResult::kNegativeHit), collector),
+      miss(MakeLookupCacheOptions(fs_name, LookupCacheResult::kMiss), collector) {}
+
+void LookupCacheMetrics::Update(uint64_t hits, uint64_t negative_hits, uint64_t misses) {
+  hit.Increment(hits - last_hits_);
+  negative_hit.Increment(negative_hits - last_negative_hits_);
+  miss.Increment(misses - last_misses_);
+  last_hits_ = hits;
+  last_negative_hits_ = negative_hits;
+  last_misses_ = misses;
+}
+
 Metrics::Metrics(std::unique_ptr<cobalt_client::Collector> collector, const fbl::String& fs_name,
                  fs_metrics::CompressionSource source)
     : collector_(std::move(collector)),
       vnode_metrics_(collector_.get(), fs_name),
       compression_format_metrics_(collector_.get(), source),
+      lookup_cache_metrics_(collector_.get(), fs_name),
       is_enabled_(false) {}
 
 const VnodeMetrics& Metrics::vnode_metrics() const { return vnode_metrics_; }
@@ -143,6 +170,10 @@ CompressionFormatMetrics* Metrics::mutable_compression_format_metrics() {
   return &compression_format_metrics_;
 }
 
+const LookupCacheMetrics& Metrics::lookup_cache_metrics() const { return lookup_cache_metrics_; }
+
+LookupCacheMetrics* Metrics::mutable_lookup_cache_metrics() { return &lookup_cache_metrics_; }
+
 void Metrics::EnableMetrics(bool should_enable) {
   is_enabled_ = should_enable;
   vnode_metrics_.metrics_enabled = should_enable;
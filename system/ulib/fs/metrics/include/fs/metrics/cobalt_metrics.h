@@ -69,6 +69,24 @@ struct CompressionFormatMetrics {
   fs_metrics::CompressionSource source = fs_metrics::CompressionSource::kUnknown;
 };
 
+// Tracks the effectiveness of the |fs::LookupCache| of a filesystem.
+struct LookupCacheMetrics {
+  LookupCacheMetrics(cobalt_client::Collector* collector, const fbl::String& fs_name);
+
+  // Records the cache statistics. The arguments are the totals since the cache was created; only
+  // the difference since the previous call is logged.
+  void Update(uint64_t hits, uint64_t negative_hits, uint64_t misses);
+
+  cobalt_client::Counter hit;
+  cobalt_client::Counter negative_hit;
+  cobalt_client::Counter miss;
+
+ private:
+  uint64_t last_hits_ = 0;
+  uint64_t last_negative_hits_ = 0;
+  uint64_t last_misses_ = 0;
+};
+
 // Provides a base class for collecting metrics in FS implementations. This is optional, but
 // provides a source of truth of how data is collected for filesystems. Specific filesystem
 // implementations with custom APIs can extend and collect more data, but for basic operations, this
@@ -104,6 +122,9 @@ class Metrics {
   const CompressionFormatMetrics& compression_format_metrics() const;
   CompressionFormatMetrics* mutable_compression_format_metrics();
 
+  const LookupCacheMetrics& lookup_cache_metrics() const;
+  LookupCacheMetrics* mutable_lookup_cache_metrics();
+
  private:
   std::unique_ptr<cobalt_client::Collector> collector_;
 
@@ -111,6 +132,8 @@ class Metrics {
 
   CompressionFormatMetrics compression_format_metrics_;
 
+  LookupCacheMetrics lookup_cache_metrics_;
+
   bool is_enabled_ = false;
 };
 
@@ -32,6 +32,9 @@ enum class Event : uint32_t {
 
   // Distribution of compression formats. Only used by blobfs.
   kCompression = 16,
+
+  // Outcome of the directory entry lookups performed while walking paths.
+  kLookupCache = 17,
 };
 
 enum class CorruptionSource { kUnknown = 0, kFvm = 1, kBlobfs = 2, kMinfs = 3 };
@@ -50,6 +53,13 @@ enum class CompressionFormat {
   kNumFormats = 6
 };
 
+enum class LookupCacheResult {
+  kUnknown = 0,
+  kHit = 1,
+  kNegativeHit = 2,
+  kMiss = 3,
+};
+
 // Collection of Vnode Events.
 constexpr Event kVnodeEvents[] = {
     Event::kClose,   Event::kRead,    Event::kWrite,   Event::kAppend, Event::kTruncate,
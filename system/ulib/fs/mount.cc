@@ -10,6 +10,8 @@
 #include <threads.h>
 
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <utility>
 
 #include <fbl/alloc_checker.h>
@@ -58,6 +60,8 @@ zx_status_t Vfs::InstallRemote(fbl::RefPtr<Vnode> vn, MountChannel h) {
   if (!ac.check()) {
     return ZX_ERR_NO_MEMORY;
   }
+  // Path walks observe whether a vnode is remote, so they must be excluded while it changes.
+  std::unique_lock<std::shared_mutex> topology_lock(topology_lock_);
   zx_status_t status = vn->AttachRemote(std::move(h));
   if (status != ZX_OK) {
     return status;
@@ -93,17 +97,18 @@ zx_status_t Vfs::InstallRemoteLocked(fbl::RefPtr<Vnode> vn, MountChannel h) {
 
 zx_status_t Vfs::MountMkdir(fbl::RefPtr<Vnode> vn, fbl::StringPiece name, MountChannel h,
                             uint32_t flags) {
-  fbl::AutoLock lock(&vfs_lock_);
+  std::unique_lock<std::shared_mutex> topology_lock(topology_lock_);
   return OpenLocked(
              vn, name,
              fs::VnodeConnectionOptions::ReadOnly().set_create().set_directory().set_no_remote(),
              fs::Rights::ReadOnly(), S_IFDIR)
-      .visit([&](auto&& result) FS_TA_REQUIRES(vfs_lock_) {
+      .visit([&](auto&& result) {
         using T = std::decay_t<decltype(result)>;
         using OpenResult = fs::Vfs::OpenResult;
         if constexpr (std::is_same_v<T, OpenResult::Error>) {
           return result;
         } else {
+          fbl::AutoLock lock(&vfs_lock_);
           if (result.vnode->IsRemote()) {
             if (flags & fio::MOUNT_CREATE_FLAG_REPLACE) {
               // There is an old remote handle on this vnode; shut it down and
@@ -123,6 +128,7 @@ zx_status_t Vfs::MountMkdir(fbl::RefPtr<Vnode> vn, fbl::StringPiece name, MountC
 }
 
 zx_status_t Vfs::UninstallRemote(fbl::RefPtr<Vnode> vn, zx::channel* h) {
+  std::unique_lock<std::shared_mutex> topology_lock(topology_lock_);
   fbl::AutoLock lock(&vfs_lock_);
   return UninstallRemoteLocked(std::move(vn), h);
 }
@@ -130,18 +136,29 @@ zx_status_t Vfs::UninstallRemote(fbl::RefPtr<Vnode> vn, zx::channel* h) {
 zx_status_t Vfs::ForwardOpenRemote(fbl::RefPtr<Vnode> vn, zx::channel channel,
                                    fbl::StringPiece path, VnodeConnectionOptions options,
                                    uint32_t mode) {
-  fbl::AutoLock lock(&vfs_lock_);
-  zx_handle_t h = vn->GetRemote();
-  if (h == ZX_HANDLE_INVALID) {
-    return ZX_ERR_NOT_FOUND;
-  }
+  zx_status_t r;
+  zx_handle_t h;
+  {
+    // Forwarding only needs the mount point to stay in place.
+    std::shared_lock<std::shared_mutex> topology_lock(topology_lock_);
+    h = vn->GetRemote();
+    if (h == ZX_HANDLE_INVALID) {
+      return ZX_ERR_NOT_FOUND;
+    }
 
-  auto r = fio::Directory::Call::Open(zx::unowned_channel(h), options.ToIoV1Flags(), mode,
-                                      fidl::unowned_str(path), std::move(channel))
-               .status();
+    r = fio::Directory::Call::Open(zx::unowned_channel(h), options.ToIoV1Flags(), mode,
+                                   fidl::unowned_str(path), std::move(channel))
+            .status();
+  }
   if (r == ZX_ERR_PEER_CLOSED) {
-    zx::channel c;
-    UninstallRemoteLocked(std::move(vn), &c);
+    std::unique_lock<std::shared_mutex> topology_lock(topology_lock_);
+    // The topology lock was dropped in between, so another thread may already have replaced the
+    // remote which failed; only that remote is uninstalled.
+    if (vn->GetRemote() == h) {
+      fbl::AutoLock lock(&vfs_lock_);
+      zx::channel c;
+      UninstallRemoteLocked(std::move(vn), &c);
+    }
   }
   return r;
 }
@@ -166,12 +183,17 @@ zx_status_t Vfs::UninstallRemoteLocked(fbl::RefPtr<Vnode> vn, zx::channel* h) {
 zx_status_t Vfs::UninstallAll(zx::time deadline) {
   std::unique_ptr<MountNode> mount_point;
   for (;;) {
+    zx::channel remote;
     {
+      std::unique_lock<std::shared_mutex> topology_lock(topology_lock_);
       fbl::AutoLock lock(&vfs_lock_);
       mount_point = remote_list_.pop_front();
+      if (mount_point) {
+        remote = mount_point->ReleaseRemote();
+      }
     }
     if (mount_point) {
-      Vfs::UnmountHandle(mount_point->ReleaseRemote(), deadline);
+      Vfs::UnmountHandle(std::move(remote), deadline);
     } else {
       return ZX_OK;
     }
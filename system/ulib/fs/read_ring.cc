@@ -0,0 +1,139 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <zircon/assert.h>
+#include <zircon/rights.h>
+
+#include <utility>
+
+#include <fbl/algorithm.h>
+#include <fs/internal/read_ring.h>
+
+namespace fio = ::llcpp::fuchsia::io;
+
+namespace fs {
+
+namespace internal {
+
+zx_status_t ReadRing::Create(Vfs* vfs, fbl::RefPtr<Vnode> vnode, uint64_t size, ReadFunction read,
+                             zx::vmo* out_buffer, zx::fifo* out_fifo,
+                             std::shared_ptr<ReadRing>* out_ring) {
+  if (size == 0 || size > fio::MAX_READ_RING_SIZE || size % ZX_PAGE_SIZE != 0) {
+    return ZX_ERR_INVALID_ARGS;
+  }
+  std::shared_ptr<ReadRing> ring(new ReadRing(vfs, std::move(vnode), std::move(read)));
+  zx_status_t status = ring->buffer_.CreateAndMap(size, "fs-read-ring");
+  if (status != ZX_OK) {
+    return status;
+  }
+  zx::vmo buffer;
+  status = ring->buffer_.vmo().duplicate(ZX_RIGHTS_BASIC | ZX_RIGHT_READ | ZX_RIGHT_MAP, &buffer);
+  if (status != ZX_OK) {
+    return status;
+  }
+  zx::fifo fifo;
+  status = zx::fifo::create(fio::READ_RING_FIFO_DEPTH, sizeof(fio::ReadRingEntry), 0, &fifo,
+                            &ring->fifo_);
+  if (status != ZX_OK) {
+    return status;
+  }
+
+  {
+    std::lock_guard guard(ring->lock_);
+    ring->wait_.set_object(ring->fifo_.get());
+    ring->wait_.set_trigger(ZX_FIFO_READABLE | ZX_FIFO_PEER_CLOSED);
+    status = ring->wait_.Begin(vfs->dispatcher());
+    if (status != ZX_OK) {
+      return status;
+    }
+    ring->self_ = ring;
+  }
+  *out_buffer = std::move(buffer);
+  *out_fifo = std::move(fifo);
+  *out_ring = std::move(ring);
+  return ZX_OK;
+}
+
+ReadRing::ReadRing(Vfs* vfs, fbl::RefPtr<Vnode> vnode, ReadFunction read)
+    : vfs_(vfs), vnode_(std::move(vnode)), read_(std::move(read)), wait_(this) {}
+
+ReadRing::~ReadRing() = default;
+
+void ReadRing::Detach() {
+  std::lock_guard guard(lock_);
+  read_ = nullptr;
+  if (wait_.Cancel() == ZX_OK) {
+    // The handler will not run, so it cannot release the reference itself. The caller holds
+    // another one, so this does not destroy the ring.
+    self_.reset();
+  }
+}
+
+void ReadRing::HandleSignals(async_dispatcher_t* dispatcher, async::WaitBase* wait,
+                             zx_status_t status, const zx_packet_signal_t* signal) {
+  std::shared_ptr<ReadRing> self;
+  {
+    std::lock_guard guard(lock_);
+    self = std::move(self_);
+  }
+  if (status != ZX_OK || !(signal->observed & ZX_FIFO_READABLE)) {
+    // The client released the ring, or the dispatcher is shutting down.
+    return;
+  }
+
+  Vfs::DispatchGuard dispatch_guard = vfs_->LockForDispatch(vnode_);
+  std::lock_guard guard(lock_);
+  if (!read_) {
+    return;
+  }
+  if (ServeLocked() != ZX_OK) {
+    return;
+  }
+  if (wait_.Begin(dispatcher) == ZX_OK) {
+    self_ = std::move(self);
+  }
+}
+
+zx_status_t ReadRing::ServeLocked() {
+  fio::ReadRingEntry entries[fio::READ_RING_FIFO_DEPTH];
+  size_t count;
+  zx_status_t status = fifo_.read(sizeof(entries[0]), entries, fbl::count_of(entries), &count);
+  if (status == ZX_ERR_SHOULD_WAIT) {
+    return ZX_OK;
+  }
+  if (status != ZX_OK) {
+    return status;
+  }
+
+  auto data = static_cast<uint8_t*>(buffer_.start());
+  for (size_t i = 0; i < count; i++) {
+    fio::ReadRingEntry& entry = entries[i];
+    if (entry.buffer_offset > buffer_.size() || entry.count > buffer_.size() - entry.buffer_offset) {
+      entry.status = ZX_ERR_OUT_OF_RANGE;
+      entry.count = 0;
+    } else {
+      size_t actual = 0;
+      entry.status = read_(entry, data + entry.buffer_offset, &actual);
+      ZX_DEBUG_ASSERT(actual <= entry.count);
+      entry.count = entry.status == ZX_OK ? static_cast<uint32_t>(actual) : 0;
+    }
+
+    // Reply to each entry as soon as it is served, so the client can copy its data out while the
+    // next entry is read. Clients have at most |READ_RING_FIFO_DEPTH| entries outstanding, so the
+    // replies always fit. A client which does not follow this loses its ring.
+    size_t written;
+    status = fifo_.write(sizeof(entry), &entry, 1, &written);
+    if (status != ZX_OK) {
+      return status;
+    }
+    if (written != 1) {
+      return ZX_ERR_BAD_STATE;
+    }
+  }
+  return ZX_OK;
+}
+
+}  // namespace internal
+
+}  // namespace fs
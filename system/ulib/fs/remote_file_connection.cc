@@ -22,6 +22,7 @@
 #include <fbl/string_buffer.h>
 #include <fs/debug.h>
 #include <fs/internal/fidl_transaction.h>
+#include <fs/internal/read_ring.h>
 #include <fs/internal/remote_file_connection.h>
 #include <fs/trace.h>
 #include <fs/vfs_types.h>
@@ -37,6 +38,12 @@ RemoteFileConnection::RemoteFileConnection(fs::Vfs* vfs, fbl::RefPtr<fs::Vnode>
                                            VnodeProtocol protocol, VnodeConnectionOptions options)
     : FileConnection(vfs, std::move(vnode), protocol, options) {}
 
+RemoteFileConnection::~RemoteFileConnection() {
+  if (read_ring_) {
+    read_ring_->Detach();
+  }
+}
+
 void RemoteFileConnection::Read(uint64_t count, ReadCompleter::Sync completer) {
   FS_PRETTY_TRACE_DEBUG("[FileRead] options: ", options());
 
@@ -49,14 +56,16 @@ void RemoteFileConnection::Read(uint64_t count, ReadCompleter::Sync completer) {
   if (count > fio::MAX_BUF) {
     return completer.Reply(ZX_ERR_INVALID_ARGS, fidl::VectorView<uint8_t>());
   }
-  uint8_t data[fio::MAX_BUF];
-  size_t actual = 0;
-  zx_status_t status = vnode()->Read(data, count, offset_, &actual);
-  if (status == ZX_OK) {
-    ZX_DEBUG_ASSERT(actual <= count);
-    offset_ += actual;
-  }
-  completer.Reply(status, fidl::VectorView(fidl::unowned_ptr(data), actual));
+  ReplyWithData<fio::File::ReadResponse>(
+      count, completer, [this](uint8_t* data, size_t capacity, size_t* out_actual) {
+        std::lock_guard guard(offset_lock_);
+        zx_status_t status = vnode()->Read(data, capacity, offset_, out_actual);
+        if (status == ZX_OK) {
+          ZX_DEBUG_ASSERT(*out_actual <= capacity);
+          offset_ += *out_actual;
+        }
+        return status;
+      });
 }
 
 void RemoteFileConnection::ReadAt(uint64_t count, uint64_t offset,
@@ -72,13 +81,10 @@ void RemoteFileConnection::ReadAt(uint64_t count, uint64_t offset,
   if (count > fio::MAX_BUF) {
     return completer.Reply(ZX_ERR_INVALID_ARGS, fidl::VectorView<uint8_t>());
   }
-  uint8_t data[fio::MAX_BUF];
-  size_t actual = 0;
-  zx_status_t status = vnode()->Read(data, count, offset, &actual);
-  if (status == ZX_OK) {
-    ZX_DEBUG_ASSERT(actual <= count);
-  }
-  completer.Reply(status, fidl::VectorView(fidl::unowned_ptr(data), actual));
+  ReplyWithData<fio::File::ReadAtResponse>(
+      count, completer, [this, offset](uint8_t* data, size_t capacity, size_t* out_actual) {
+        return vnode()->Read(data, capacity, offset, out_actual);
+      });
 }
 
 void RemoteFileConnection::Write(fidl::VectorView<uint8_t> data, WriteCompleter::Sync completer) {
@@ -92,6 +98,7 @@ void RemoteFileConnection::Write(fidl::VectorView<uint8_t> data, WriteCompleter:
   }
   size_t actual = 0u;
   zx_status_t status;
+  std::lock_guard guard(offset_lock_);
   if (options().flags.append) {
     size_t end = 0u;
     status = vnode()->Append(data.data(), data.count(), &end, &actual);
@@ -128,6 +135,7 @@ void RemoteFileConnection::Seek(int64_t offset, ::llcpp::fuchsia::io::SeekOrigin
                                 SeekCompleter::Sync completer) {
   FS_PRETTY_TRACE_DEBUG("[FileSeek] options: ", options());
 
+  std::lock_guard guard(offset_lock_);
   if (options().flags.node_reference) {
     return completer.Reply(ZX_ERR_BAD_HANDLE, offset_);
   }
@@ -183,6 +191,48 @@ void RemoteFileConnection::Seek(int64_t offset, ::llcpp::fuchsia::io::SeekOrigin
   completer.Reply(ZX_OK, offset_);
 }
 
+void RemoteFileConnection::GetReadRing(uint64_t size, GetReadRingCompleter::Sync completer) {
+  FS_PRETTY_TRACE_DEBUG("[FileGetReadRing] options: ", options());
+
+  if (options().flags.node_reference) {
+    return completer.Reply(ZX_ERR_BAD_HANDLE, zx::vmo(), zx::fifo());
+  }
+  if (!options().rights.read) {
+    return completer.Reply(ZX_ERR_BAD_HANDLE, zx::vmo(), zx::fifo());
+  }
+  if (read_ring_) {
+    // A ring stays alive until the client closes its FIFO, which it may not have noticed yet.
+    read_ring_->Detach();
+    read_ring_.reset();
+  }
+  zx::vmo buffer;
+  zx::fifo fifo;
+  zx_status_t status = ReadRing::Create(
+      vfs(), vnode(), size,
+      [this](const fio::ReadRingEntry& entry, uint8_t* data, size_t* out_actual) {
+        return ReadForRing(entry, data, out_actual);
+      },
+      &buffer, &fifo, &read_ring_);
+  completer.Reply(status, std::move(buffer), std::move(fifo));
+}
+
+zx_status_t RemoteFileConnection::ReadForRing(const fio::ReadRingEntry& entry, uint8_t* data,
+                                              size_t* out_actual) {
+  if (entry.flags & ~fio::READ_RING_FLAG_SEEK) {
+    return ZX_ERR_INVALID_ARGS;
+  }
+  if (!(entry.flags & fio::READ_RING_FLAG_SEEK)) {
+    return vnode()->Read(data, entry.count, entry.offset, out_actual);
+  }
+  std::lock_guard guard(offset_lock_);
+  zx_status_t status = vnode()->Read(data, entry.count, offset_, out_actual);
+  if (status == ZX_OK) {
+    ZX_DEBUG_ASSERT(*out_actual <= entry.count);
+    offset_ += *out_actual;
+  }
+  return status;
+}
+
 }  // namespace internal
 
 }  // namespace fs
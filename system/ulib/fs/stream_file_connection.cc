@@ -50,15 +50,15 @@ void StreamFileConnection::Read(uint64_t count, ReadCompleter::Sync completer) {
   if (count > fio::MAX_BUF) {
     return completer.Reply(ZX_ERR_INVALID_ARGS, fidl::VectorView<uint8_t>());
   }
-  uint8_t data[fio::MAX_BUF];
-  size_t actual = 0;
-  zx_iovec_t vector = {
-      .buffer = data,
-      .capacity = count,
-  };
-  zx_status_t status = stream_.readv(0, &vector, 1, &actual);
-  ZX_DEBUG_ASSERT(actual <= count);
-  completer.Reply(status, fidl::VectorView(fidl::unowned_ptr(data), actual));
+  // The stream copies straight from the VMO of the vnode into the reply.
+  ReplyWithData<fio::File::ReadResponse>(
+      count, completer, [this](uint8_t* data, size_t capacity, size_t* out_actual) {
+        zx_iovec_t vector = {
+            .buffer = data,
+            .capacity = capacity,
+        };
+        return stream_.readv(0, &vector, 1, out_actual);
+      });
 }
 
 void StreamFileConnection::ReadAt(uint64_t count, uint64_t offset,
@@ -74,16 +74,14 @@ void StreamFileConnection::ReadAt(uint64_t count, uint64_t offset,
   if (count > fio::MAX_BUF) {
     return completer.Reply(ZX_ERR_INVALID_ARGS, fidl::VectorView<uint8_t>());
   }
-  uint8_t data[fio::MAX_BUF];
-  size_t actual = 0;
-
-  zx_iovec_t vector = {
-      .buffer = data,
-      .capacity = count,
-  };
-  zx_status_t status = stream_.readv_at(0, offset, &vector, 1, &actual);
-  ZX_DEBUG_ASSERT(actual <= count);
-  completer.Reply(status, fidl::VectorView(fidl::unowned_ptr(data), actual));
+  ReplyWithData<fio::File::ReadAtResponse>(
+      count, completer, [this, offset](uint8_t* data, size_t capacity, size_t* out_actual) {
+        zx_iovec_t vector = {
+            .buffer = data,
+            .capacity = capacity,
+        };
+        return stream_.readv_at(0, offset, &vector, 1, out_actual);
+      });
 }
 
 void StreamFileConnection::Write(fidl::VectorView<uint8_t> data, WriteCompleter::Sync completer) {
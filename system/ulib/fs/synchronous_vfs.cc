@@ -27,10 +27,14 @@ void SynchronousVfs::Shutdown(ShutdownCallback handler) {
   is_shutting_down_ = true;
 
   UninstallAll(zx::time::infinite());
+  // A SynchronousVfs is served from a single thread, so no message can be dispatched concurrently
+  // with this teardown. Do not take the dispatch locks: |Shutdown| may be invoked from within a
+  // message handler which already holds them.
   while (!connections_.is_empty()) {
-    connections_.front().SyncTeardown();
+    connections_.front().SyncTeardownLocked();
   }
   ZX_ASSERT_MSG(connections_.is_empty(), "Failed to complete VFS shutdown");
+  lookup_cache().Clear();
   if (handler) {
     handler(ZX_OK);
   }
@@ -41,7 +45,7 @@ void SynchronousVfs::CloseAllConnectionsForVnode(const Vnode& node) {
     auto c = connection;
     connection++;
     if (c->vnode().get() == &node) {
-      c->SyncTeardown();
+      c->SyncTeardownLocked();
     }
   }
 }
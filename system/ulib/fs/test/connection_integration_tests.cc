@@ -2,17 +2,25 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <dirent.h>
+#include <fcntl.h>
 #include <fuchsia/io/llcpp/fidl.h>
 #include <lib/async-loop/cpp/loop.h>
 #include <lib/async-loop/default.h>
 #include <lib/fdio/directory.h>
 #include <lib/fdio/fd.h>
 #include <lib/fdio/fdio.h>
+#include <lib/zx/fifo.h>
+#include <lib/zx/vmo.h>
+#include <lib/zx/time.h>
 #include <stdio.h>
+#include <sys/stat.h>
 
 #include <atomic>
 #include <utility>
 
+#include <fbl/string_printf.h>
+#include <fs/dir_test_util.h>
 #include <fs/pseudo_dir.h>
 #include <fs/pseudo_file.h>
 #include <fs/synchronous_vfs.h>
@@ -26,6 +34,15 @@ zx_status_t DummyReader(fbl::String* output) { return ZX_OK; }
 
 zx_status_t DummyWriter(fbl::StringPiece input) { return ZX_OK; }
 
+// Not a multiple of the FIDL alignment, so that replies carrying all of it need padding.
+constexpr char kFileContents[] = "the quick brown fox";
+constexpr size_t kFileContentsSize = sizeof(kFileContents) - 1;
+
+zx_status_t ContentsReader(fbl::String* output) {
+  *output = fbl::String(kFileContents);
+  return ZX_OK;
+}
+
 // Example vnode that supports protocol negotiation.
 // Here the vnode may be opened as a file or a directory.
 class FileOrDirectory : public fs::Vnode {
@@ -61,9 +78,12 @@ class VfsTestSetup : public zxtest::Test {
     root_ = fbl::AdoptRef<fs::PseudoDir>(new fs::PseudoDir());
     dir_ = fbl::AdoptRef<fs::PseudoDir>(new fs::PseudoDir());
     file_ = fbl::AdoptRef<fs::Vnode>(new fs::BufferedPseudoFile(&DummyReader, &DummyWriter));
+    contents_file_ =
+        fbl::AdoptRef<fs::Vnode>(new fs::BufferedPseudoFile(&ContentsReader, &DummyWriter));
     file_or_dir_ = fbl::AdoptRef<FileOrDirectory>(new FileOrDirectory());
     root_->AddEntry("dir", dir_);
     root_->AddEntry("file", file_);
+    root_->AddEntry("contents_file", contents_file_);
     root_->AddEntry("file_or_dir", file_or_dir_);
   }
 
@@ -83,6 +103,7 @@ class VfsTestSetup : public zxtest::Test {
   fbl::RefPtr<fs::PseudoDir> root_;
   fbl::RefPtr<fs::PseudoDir> dir_;
   fbl::RefPtr<fs::Vnode> file_;
+  fbl::RefPtr<fs::Vnode> contents_file_;
   fbl::RefPtr<FileOrDirectory> file_or_dir_;
 };
 
@@ -114,6 +135,208 @@ TEST_F(ConnectionTest, NodeGetSetFlagsOnFile) {
   EXPECT_EQ(fio::OPEN_RIGHT_READABLE | fio::OPEN_FLAG_APPEND, file_get_result.Unwrap()->flags);
 }
 
+TEST_F(ConnectionTest, FileReadAndReadAt) {
+  zx::channel client_end, server_end;
+  ASSERT_OK(zx::channel::create(0u, &client_end, &server_end));
+  ASSERT_OK(ConnectClient(std::move(server_end)));
+
+  zx::channel fc1, fc2;
+  ASSERT_OK(zx::channel::create(0u, &fc1, &fc2));
+  ASSERT_OK(
+      fdio_open_at(client_end.get(), "contents_file", fio::OPEN_RIGHT_READABLE, fc2.release()));
+
+  // Read advances the seek offset.
+  auto read_result = fio::File::Call::Read(zx::unowned_channel(fc1), 4);
+  ASSERT_OK(read_result.status());
+  EXPECT_OK(read_result.Unwrap()->s);
+  ASSERT_EQ(read_result.Unwrap()->data.count(), 4);
+  EXPECT_BYTES_EQ(read_result.Unwrap()->data.data(), kFileContents, 4);
+
+  read_result = fio::File::Call::Read(zx::unowned_channel(fc1), fio::MAX_BUF);
+  ASSERT_OK(read_result.status());
+  EXPECT_OK(read_result.Unwrap()->s);
+  ASSERT_EQ(read_result.Unwrap()->data.count(), kFileContentsSize - 4);
+  EXPECT_BYTES_EQ(read_result.Unwrap()->data.data(), kFileContents + 4, kFileContentsSize - 4);
+
+  // ReadAt does not.
+  auto read_at_result = fio::File::Call::ReadAt(zx::unowned_channel(fc1), 5, 10);
+  ASSERT_OK(read_at_result.status());
+  EXPECT_OK(read_at_result.Unwrap()->s);
+  ASSERT_EQ(read_at_result.Unwrap()->data.count(), 5);
+  EXPECT_BYTES_EQ(read_at_result.Unwrap()->data.data(), kFileContents + 10, 5);
+
+  read_at_result = fio::File::Call::ReadAt(zx::unowned_channel(fc1), 1, kFileContentsSize);
+  ASSERT_OK(read_at_result.status());
+  EXPECT_OK(read_at_result.Unwrap()->s);
+  EXPECT_EQ(read_at_result.Unwrap()->data.count(), 0);
+
+  // Requests larger than the protocol allows are rejected.
+  read_at_result = fio::File::Call::ReadAt(zx::unowned_channel(fc1), fio::MAX_BUF + 1, 0);
+  ASSERT_OK(read_at_result.status());
+  EXPECT_EQ(read_at_result.Unwrap()->s, ZX_ERR_INVALID_ARGS);
+}
+
+// Sends |entry| over the read ring |fifo|, and replaces it with the reply.
+void ReadRingRoundTrip(const zx::fifo& fifo, fio::ReadRingEntry* entry) {
+  ASSERT_OK(fifo.write(sizeof(*entry), entry, 1, nullptr));
+  zx_signals_t observed;
+  ASSERT_OK(
+      fifo.wait_one(ZX_FIFO_READABLE | ZX_FIFO_PEER_CLOSED, zx::time::infinite(), &observed));
+  ASSERT_TRUE(observed & ZX_FIFO_READABLE);
+  ASSERT_OK(fifo.read(sizeof(*entry), entry, 1, nullptr));
+}
+
+TEST_F(ConnectionTest, FileReadRing) {
+  zx::channel client_end, server_end;
+  ASSERT_OK(zx::channel::create(0u, &client_end, &server_end));
+  ASSERT_OK(ConnectClient(std::move(server_end)));
+
+  zx::channel fc1, fc2;
+  ASSERT_OK(zx::channel::create(0u, &fc1, &fc2));
+  ASSERT_OK(fdio_open_at(client_end.get(), "contents_file",
+                         fio::OPEN_RIGHT_READABLE, fc2.release()));
+
+  // The connection advertises read rings once it is open.
+  auto describe_result = fio::File::Call::Describe(zx::unowned_channel(fc1));
+  ASSERT_OK(describe_result.status());
+  zx_signals_t observed = 0;
+  fc1.wait_one(fio::FILE_SIGNAL_READ_RING, zx::time::infinite_past(), &observed);
+  EXPECT_TRUE(observed & fio::FILE_SIGNAL_READ_RING);
+
+  // Sizes must be page-aligned.
+  auto ring_result = fio::File::Call::GetReadRing(zx::unowned_channel(fc1), ZX_PAGE_SIZE + 1);
+  ASSERT_OK(ring_result.status());
+  EXPECT_EQ(ring_result.Unwrap()->s, ZX_ERR_INVALID_ARGS);
+
+  ring_result = fio::File::Call::GetReadRing(zx::unowned_channel(fc1), ZX_PAGE_SIZE);
+  ASSERT_OK(ring_result.status());
+  ASSERT_OK(ring_result.Unwrap()->s);
+  zx::vmo buffer = std::move(ring_result.Unwrap()->buffer);
+  zx::fifo fifo = std::move(ring_result.Unwrap()->fifo);
+  ASSERT_TRUE(buffer.is_valid());
+  ASSERT_TRUE(fifo.is_valid());
+
+  // Reads with READ_RING_FLAG_SEEK advance the seek offset of the connection.
+  fio::ReadRingEntry entry = {.offset = 0, .buffer_offset = 0, .count = 4,
+                              .flags = fio::READ_RING_FLAG_SEEK};
+  ASSERT_NO_FAILURES(ReadRingRoundTrip(fifo, &entry));
+  EXPECT_OK(entry.status);
+  ASSERT_EQ(entry.count, 4);
+  char data[kFileContentsSize];
+  ASSERT_OK(buffer.read(data, 0, entry.count));
+  EXPECT_BYTES_EQ(data, kFileContents, 4);
+
+  auto read_result = fio::File::Call::Read(zx::unowned_channel(fc1), 2);
+  ASSERT_OK(read_result.status());
+  EXPECT_OK(read_result.Unwrap()->s);
+  ASSERT_EQ(read_result.Unwrap()->data.count(), 2);
+  EXPECT_BYTES_EQ(read_result.Unwrap()->data.data(), kFileContents + 4, 2);
+
+  // Reads without it use the offset of the entry.
+  entry = {.offset = 10, .buffer_offset = 16, .count = 5, .flags = 0};
+  ASSERT_NO_FAILURES(ReadRingRoundTrip(fifo, &entry));
+  EXPECT_OK(entry.status);
+  ASSERT_EQ(entry.count, 5);
+  ASSERT_OK(buffer.read(data, 16, entry.count));
+  EXPECT_BYTES_EQ(data, kFileContents + 10, 5);
+
+  entry = {.offset = 0, .buffer_offset = 0, .count = ZX_PAGE_SIZE,
+           .flags = fio::READ_RING_FLAG_SEEK};
+  ASSERT_NO_FAILURES(ReadRingRoundTrip(fifo, &entry));
+  EXPECT_OK(entry.status);
+  ASSERT_EQ(entry.count, kFileContentsSize - 6);
+  ASSERT_OK(buffer.read(data, 0, entry.count));
+  EXPECT_BYTES_EQ(data, kFileContents + 6, kFileContentsSize - 6);
+
+  // Entries which do not fit in the buffer are rejected, without closing the ring.
+  entry = {.offset = 0, .buffer_offset = ZX_PAGE_SIZE - 1, .count = 2, .flags = 0};
+  ASSERT_NO_FAILURES(ReadRingRoundTrip(fifo, &entry));
+  EXPECT_EQ(entry.status, ZX_ERR_OUT_OF_RANGE);
+  EXPECT_EQ(entry.count, 0);
+
+  entry = {.offset = 0, .buffer_offset = 0, .count = 1, .flags = 0x80};
+  ASSERT_NO_FAILURES(ReadRingRoundTrip(fifo, &entry));
+  EXPECT_EQ(entry.status, ZX_ERR_INVALID_ARGS);
+
+  // Closing the connection releases the ring.
+  fc1.reset();
+  ASSERT_OK(fifo.wait_one(ZX_FIFO_PEER_CLOSED, zx::time::infinite(), nullptr));
+}
+
+TEST_F(ConnectionTest, FileReadRingRequiresReadRight) {
+  zx::channel client_end, server_end;
+  ASSERT_OK(zx::channel::create(0u, &client_end, &server_end));
+  ASSERT_OK(ConnectClient(std::move(server_end)));
+
+  zx::channel fc1, fc2;
+  ASSERT_OK(zx::channel::create(0u, &fc1, &fc2));
+  ASSERT_OK(fdio_open_at(client_end.get(), "contents_file",
+                         fio::OPEN_RIGHT_WRITABLE, fc2.release()));
+
+  auto describe_result = fio::File::Call::Describe(zx::unowned_channel(fc1));
+  ASSERT_OK(describe_result.status());
+  zx_signals_t observed = 0;
+  fc1.wait_one(fio::FILE_SIGNAL_READ_RING, zx::time::infinite_past(), &observed);
+  EXPECT_FALSE(observed & fio::FILE_SIGNAL_READ_RING);
+}
+
+TEST_F(ConnectionTest, DirectoryReadDirentsAttributes) {
+  zx::channel client_end, server_end;
+  ASSERT_OK(zx::channel::create(0u, &client_end, &server_end));
+  ASSERT_OK(ConnectClient(std::move(server_end)));
+
+  zx::channel dc1, dc2;
+  ASSERT_OK(zx::channel::create(0u, &dc1, &dc2));
+  ASSERT_OK(fdio_open_at(client_end.get(), ".", fio::OPEN_RIGHT_READABLE, dc2.release()));
+
+  auto describe_result = fio::Directory::Call::Describe(zx::unowned_channel(dc1));
+  ASSERT_OK(describe_result.status());
+  zx_signals_t observed = 0;
+  dc1.wait_one(fio::DIRECTORY_SIGNAL_DIRENT_ATTRIBUTES, zx::time::infinite_past(), &observed);
+  EXPECT_TRUE(observed & fio::DIRECTORY_SIGNAL_DIRENT_ATTRIBUTES);
+
+  auto result = fio::Directory::Call::ReadDirentsAttributes(zx::unowned_channel(dc1), fio::MAX_BUF);
+  ASSERT_OK(result.status());
+  ASSERT_OK(result.Unwrap()->s);
+  const auto& dirents = result.Unwrap()->dirents;
+  fs::DirentChecker dc(dirents.data(), dirents.count());
+  dc.ExpectEntry(".", V_TYPE_DIR);
+  dc.ExpectEntry("dir", V_TYPE_DIR);
+  dc.ExpectEntry("file", V_TYPE_FILE);
+  dc.ExpectEntry("contents_file", V_TYPE_FILE);
+  dc.ExpectEnd();
+
+  // There is one record of attributes for each entry, in the same order.
+  const auto& attributes = result.Unwrap()->attributes;
+  ASSERT_EQ(attributes.count(), 4 * sizeof(fio::DirentAttributes));
+  fio::DirentAttributes records[4];
+  memcpy(records, attributes.data(), sizeof(records));
+  EXPECT_OK(records[0].s);
+  EXPECT_TRUE(S_ISDIR(records[0].attributes.mode));
+  EXPECT_OK(records[1].s);
+  EXPECT_TRUE(S_ISDIR(records[1].attributes.mode));
+  EXPECT_OK(records[3].s);
+  EXPECT_TRUE(S_ISREG(records[3].attributes.mode));
+  EXPECT_EQ(records[3].attributes.content_size, kFileContentsSize);
+
+  auto get_attr_result = fio::Node::Call::GetAttr(zx::unowned_channel(dc1));
+  ASSERT_OK(get_attr_result.status());
+  ASSERT_OK(get_attr_result.Unwrap()->s);
+  EXPECT_EQ(records[0].attributes.id, get_attr_result.Unwrap()->attributes.id);
+
+  // The next call continues from the end of the directory.
+  result = fio::Directory::Call::ReadDirentsAttributes(zx::unowned_channel(dc1), fio::MAX_BUF);
+  ASSERT_OK(result.status());
+  ASSERT_OK(result.Unwrap()->s);
+  EXPECT_EQ(result.Unwrap()->dirents.count(), 0);
+  EXPECT_EQ(result.Unwrap()->attributes.count(), 0);
+
+  // Requests larger than the protocol allows are rejected.
+  result = fio::Directory::Call::ReadDirentsAttributes(zx::unowned_channel(dc1), fio::MAX_BUF + 1);
+  ASSERT_OK(result.status());
+  EXPECT_NOT_OK(result.Unwrap()->s);
+}
+
 TEST_F(ConnectionTest, NodeGetSetFlagsOnDirectory) {
   // Create connection to vfs
   zx::channel client_end, server_end;
@@ -358,4 +581,130 @@ TEST_F(ConnectionClosingTest, ClosingNodeLeadsToClosingServerEndChannel) {
   loop().Shutdown();
 }
 
+// A tree of directories holding small files, walked the way system/uapp/psutils walks /proc-like
+// trees: every entry of every directory is visited and stat'ed.
+class TreeWalkTest : public zxtest::Test {
+ public:
+  static constexpr size_t kDirectories = 64;
+  static constexpr size_t kFilesPerDirectory = 32;
+
+  TreeWalkTest() : loop_(&kAsyncLoopConfigNoAttachToCurrentThread) {
+    vfs_.SetDispatcher(loop_.dispatcher());
+    root_ = fbl::AdoptRef<fs::PseudoDir>(new fs::PseudoDir());
+    for (size_t i = 0; i < kDirectories; i++) {
+      auto dir = fbl::AdoptRef<fs::PseudoDir>(new fs::PseudoDir());
+      for (size_t j = 0; j < kFilesPerDirectory; j++) {
+        dir->AddEntry(fbl::StringPrintf("file%zu", j),
+                      fbl::AdoptRef<fs::Vnode>(
+                          new fs::BufferedPseudoFile(&ContentsReader, &DummyWriter)));
+      }
+      root_->AddEntry(fbl::StringPrintf("dir%zu", i), std::move(dir));
+    }
+  }
+
+ protected:
+  void SetUp() override {
+    loop_.StartThread();
+    zx::channel client_end, server_end;
+    ASSERT_OK(zx::channel::create(0u, &client_end, &server_end));
+    ASSERT_OK(vfs_.ServeDirectory(root_, std::move(server_end)));
+    ASSERT_OK(fdio_fd_create(client_end.release(), &root_fd_));
+  }
+
+  void TearDown() override {
+    close(root_fd_);
+    loop_.Shutdown();
+  }
+
+  // Visits every entry under the root, stat'ing each one with |readdir_stat|. Returns the
+  // number of regular files found.
+  template <typename ReaddirStat>
+  void Walk(ReaddirStat readdir_stat, size_t* out_files, zx::duration* out_elapsed) {
+    size_t files = 0;
+    zx::time start = zx::clock::get_monotonic();
+    int fd = openat(root_fd_, ".", O_RDONLY | O_DIRECTORY);
+    ASSERT_GE(fd, 0);
+    DIR* root = fdopendir(fd);
+    ASSERT_NOT_NULL(root);
+    struct dirent* entry;
+    struct stat s;
+    while ((entry = readdir_stat(root, &s)) != nullptr) {
+      if (!S_ISDIR(s.st_mode) || strcmp(entry->d_name, ".") == 0) {
+        continue;
+      }
+      int child_fd = openat(dirfd(root), entry->d_name, O_RDONLY | O_DIRECTORY);
+      ASSERT_GE(child_fd, 0);
+      DIR* child = fdopendir(child_fd);
+      ASSERT_NOT_NULL(child);
+      struct dirent* child_entry;
+      while ((child_entry = readdir_stat(child, &s)) != nullptr) {
+        if (S_ISREG(s.st_mode)) {
+          EXPECT_EQ(s.st_size, kFileContentsSize);
+          files++;
+        }
+      }
+      closedir(child);
+    }
+    closedir(root);
+    *out_elapsed = zx::clock::get_monotonic() - start;
+    *out_files = files;
+  }
+
+ private:
+  async::Loop loop_;
+  fs::SynchronousVfs vfs_;
+  fbl::RefPtr<fs::PseudoDir> root_;
+  int root_fd_ = -1;
+};
+
+TEST_F(TreeWalkTest, ReaddirStatMatchesFstatat) {
+  size_t files;
+  zx::duration elapsed;
+  ASSERT_NO_FAILURES(Walk(
+      [](DIR* dir, struct stat* s) {
+        struct dirent* entry;
+        EXPECT_EQ(fdio_readdir_stat(dir, &entry, s), 0);
+        if (entry != nullptr) {
+          struct stat expected;
+          EXPECT_EQ(fstatat(dirfd(dir), entry->d_name, &expected, 0), 0);
+          EXPECT_EQ(s->st_mode, expected.st_mode);
+          EXPECT_EQ(s->st_ino, expected.st_ino);
+          EXPECT_EQ(s->st_size, expected.st_size);
+          EXPECT_EQ(s->st_nlink, expected.st_nlink);
+        }
+        return entry;
+      },
+      &files, &elapsed));
+  EXPECT_EQ(files, kDirectories * kFilesPerDirectory);
+}
+
+TEST_F(TreeWalkTest, Benchmark) {
+  size_t files;
+  zx::duration fstatat_elapsed;
+  ASSERT_NO_FAILURES(Walk(
+      [](DIR* dir, struct stat* s) {
+        struct dirent* entry = readdir(dir);
+        if (entry != nullptr) {
+          EXPECT_EQ(fstatat(dirfd(dir), entry->d_name, s, 0), 0);
+        }
+        return entry;
+      },
+      &files, &fstatat_elapsed));
+  EXPECT_EQ(files, kDirectories * kFilesPerDirectory);
+
+  zx::duration readdir_stat_elapsed;
+  ASSERT_NO_FAILURES(Walk(
+      [](DIR* dir, struct stat* s) {
+        struct dirent* entry;
+        EXPECT_EQ(fdio_readdir_stat(dir, &entry, s), 0);
+        return entry;
+      },
+      &files, &readdir_stat_elapsed));
+  EXPECT_EQ(files, kDirectories * kFilesPerDirectory);
+
+  printf("tree walk of %zu entries: readdir+fstatat %ld us, fdio_readdir_stat %ld us\n",
+         kDirectories * (kFilesPerDirectory + 1), fstatat_elapsed.to_usecs(),
+         readdir_stat_elapsed.to_usecs());
+}
+
 }  // namespace
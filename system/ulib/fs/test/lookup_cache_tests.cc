@@ -0,0 +1,122 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <fs/lookup_cache.h>
+#include <fs/pseudo_dir.h>
+#include <zxtest/zxtest.h>
+
+namespace {
+
+using fs::LookupCache;
+
+TEST(LookupCache, DisabledByDefault) {
+  LookupCache cache;
+  auto dir = fbl::MakeRefCounted<fs::PseudoDir>();
+  auto child = fbl::MakeRefCounted<fs::PseudoDir>();
+
+  EXPECT_FALSE(cache.enabled());
+  cache.Insert(dir, "child", ZX_OK, child);
+  fbl::RefPtr<fs::Vnode> out;
+  EXPECT_FALSE(cache.Lookup(*dir, "child", &out));
+  EXPECT_EQ(cache.GetStats().misses, 0);
+}
+
+TEST(LookupCache, PositiveAndNegativeEntries) {
+  LookupCache cache;
+  cache.SetCapacity(16);
+  auto dir = fbl::MakeRefCounted<fs::PseudoDir>();
+  auto child = fbl::MakeRefCounted<fs::PseudoDir>();
+
+  fbl::RefPtr<fs::Vnode> out;
+  EXPECT_FALSE(cache.Lookup(*dir, "child", &out));
+  cache.Insert(dir, "child", ZX_OK, child);
+  cache.Insert(dir, "missing", ZX_ERR_NOT_FOUND, nullptr);
+  // Other errors are never cached.
+  cache.Insert(dir, "broken", ZX_ERR_IO, nullptr);
+
+  ASSERT_TRUE(cache.Lookup(*dir, "child", &out));
+  EXPECT_EQ(out.get(), child.get());
+  ASSERT_TRUE(cache.Lookup(*dir, "missing", &out));
+  EXPECT_NULL(out);
+  EXPECT_FALSE(cache.Lookup(*dir, "broken", &out));
+
+  LookupCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.negative_hits, 1);
+  EXPECT_EQ(stats.misses, 2);
+}
+
+TEST(LookupCache, NegativeOnlyDoesNotRetainVnodes) {
+  LookupCache cache;
+  cache.SetCapacity(16, LookupCache::Policy::kNegativeOnly);
+  auto dir = fbl::MakeRefCounted<fs::PseudoDir>();
+  auto child = fbl::MakeRefCounted<fs::PseudoDir>();
+
+  cache.Insert(dir, "child", ZX_OK, child);
+  cache.Insert(dir, "missing", ZX_ERR_NOT_FOUND, nullptr);
+
+  fbl::RefPtr<fs::Vnode> out;
+  EXPECT_FALSE(cache.Lookup(*dir, "child", &out));
+  EXPECT_TRUE(cache.Lookup(*dir, "missing", &out));
+  EXPECT_EQ(child->ref_count_debug(), 1);
+}
+
+TEST(LookupCache, EvictsLeastRecentlyUsed) {
+  LookupCache cache;
+  cache.SetCapacity(2);
+  auto dir = fbl::MakeRefCounted<fs::PseudoDir>();
+
+  fbl::RefPtr<fs::Vnode> out;
+  cache.Insert(dir, "a", ZX_ERR_NOT_FOUND, nullptr);
+  cache.Insert(dir, "b", ZX_ERR_NOT_FOUND, nullptr);
+  // Touch "a" so that "b" is the oldest entry.
+  EXPECT_TRUE(cache.Lookup(*dir, "a", &out));
+  cache.Insert(dir, "c", ZX_ERR_NOT_FOUND, nullptr);
+
+  EXPECT_TRUE(cache.Lookup(*dir, "a", &out));
+  EXPECT_FALSE(cache.Lookup(*dir, "b", &out));
+  EXPECT_TRUE(cache.Lookup(*dir, "c", &out));
+  EXPECT_EQ(cache.GetStats().evictions, 1);
+}
+
+TEST(LookupCache, InvalidateAndClearReleaseVnodes) {
+  LookupCache cache;
+  cache.SetCapacity(16);
+  auto dir = fbl::MakeRefCounted<fs::PseudoDir>();
+  auto first = fbl::MakeRefCounted<fs::PseudoDir>();
+  auto second = fbl::MakeRefCounted<fs::PseudoDir>();
+
+  cache.Insert(dir, "first", ZX_OK, first);
+  cache.Insert(dir, "second", ZX_OK, second);
+  EXPECT_EQ(first->ref_count_debug(), 2);
+
+  cache.Invalidate(*dir, "first");
+  EXPECT_EQ(first->ref_count_debug(), 1);
+  fbl::RefPtr<fs::Vnode> out;
+  EXPECT_FALSE(cache.Lookup(*dir, "first", &out));
+  EXPECT_EQ(cache.GetStats().invalidations, 1);
+
+  cache.Clear();
+  EXPECT_EQ(second->ref_count_debug(), 1);
+  EXPECT_EQ(dir->ref_count_debug(), 1);
+}
+
+TEST(LookupCache, InvalidateChildrenReleasesParent) {
+  LookupCache cache;
+  cache.SetCapacity(16);
+  auto dir = fbl::MakeRefCounted<fs::PseudoDir>();
+  auto other = fbl::MakeRefCounted<fs::PseudoDir>();
+
+  cache.Insert(dir, "a", ZX_ERR_NOT_FOUND, nullptr);
+  cache.Insert(dir, "b", ZX_ERR_NOT_FOUND, nullptr);
+  cache.Insert(other, "a", ZX_ERR_NOT_FOUND, nullptr);
+
+  cache.InvalidateChildren(*dir);
+  EXPECT_EQ(dir->ref_count_debug(), 1);
+  EXPECT_EQ(cache.GetStats().invalidations, 2);
+  fbl::RefPtr<fs::Vnode> out;
+  EXPECT_TRUE(cache.Lookup(*other, "a", &out));
+}
+
+}  // namespace
@@ -127,7 +127,7 @@ void Vfs::SetDispatcher(async_dispatcher_t* dispatcher) {
 Vfs::OpenResult Vfs::Open(fbl::RefPtr<Vnode> vndir, fbl::StringPiece path,
                           VnodeConnectionOptions options, Rights parent_rights, uint32_t mode) {
 #ifdef __Fuchsia__
-  fbl::AutoLock lock(&vfs_lock_);
+  std::shared_lock<std::shared_mutex> topology_lock(topology_lock_);
 #endif
   return OpenLocked(std::move(vndir), path, options, parent_rights, mode);
 }
@@ -169,7 +169,7 @@ Vfs::OpenResult Vfs::OpenLocked(fbl::RefPtr<Vnode> vndir, fbl::StringPiece path,
       return r;
     }
   } else {
-    if ((r = LookupNode(std::move(vndir), path, &vn)) != ZX_OK) {
+    if ((r = Lookup(std::move(vndir), path, &vn)) != ZX_OK) {
       return r;
     }
   }
@@ -181,7 +181,7 @@ Vfs::OpenResult Vfs::OpenLocked(fbl::RefPtr<Vnode> vndir, fbl::StringPiece path,
   }
 #endif
 
-  if (ReadonlyLocked() && options.rights.write) {
+  if (readonly_.load() && options.rights.write) {
     return ZX_ERR_ACCESS_DENIED;
   }
 
@@ -237,9 +237,13 @@ zx_status_t Vfs::EnsureExists(fbl::RefPtr<Vnode> vndir, fbl::StringPiece path,
     return ZX_ERR_INVALID_ARGS;
   } else if (path == ".") {
     return ZX_ERR_INVALID_ARGS;
-  } else if (ReadonlyLocked()) {
+  } else if (readonly_.load()) {
     return ZX_ERR_ACCESS_DENIED;
   }
+#ifdef __Fuchsia__
+  // Creation and the fallback lookup must observe the same directory contents.
+  std::unique_lock<std::shared_mutex> directory_lock(DirectoryLock(*vndir));
+#endif
   if ((status = vndir->Create(out_vn, path, mode)) != ZX_OK) {
     *did_create = false;
     if ((status == ZX_ERR_ALREADY_EXISTS) && !options.flags.fail_if_exists) {
@@ -252,7 +256,9 @@ zx_status_t Vfs::EnsureExists(fbl::RefPtr<Vnode> vndir, fbl::StringPiece path,
     }
     return status;
   }
+  lookup_cache_.Invalidate(*vndir, path);
 #ifdef __Fuchsia__
+  directory_lock.unlock();
   vndir->Notify(path, fio::WATCH_EVENT_ADDED);
 #endif
   *did_create = true;
@@ -272,12 +278,14 @@ zx_status_t Vfs::Unlink(fbl::RefPtr<Vnode> vndir, fbl::StringPiece path) {
 
   {
 #ifdef __Fuchsia__
-    fbl::AutoLock lock(&vfs_lock_);
+    std::shared_lock<std::shared_mutex> topology_lock(topology_lock_);
+    std::unique_lock<std::shared_mutex> directory_lock(DirectoryLock(*vndir));
 #endif
-    if (ReadonlyLocked()) {
+    if (readonly_.load()) {
       r = ZX_ERR_ACCESS_DENIED;
     } else {
       r = vndir->Unlink(path, must_be_dir);
+      lookup_cache_.Invalidate(*vndir, path);
     }
   }
   if (r != ZX_OK) {
@@ -356,6 +364,23 @@ zx_status_t Vfs::VnodeToToken(fbl::RefPtr<Vnode> vn, zx::event* ios_token, zx::e
   return ZX_OK;
 }
 
+Vfs::DispatchGuard Vfs::LockForDispatch(fbl::RefPtr<Vnode> vnode) {
+  DispatchGuard guard;
+  {
+    // Whether |vnode| tolerates concurrent dispatch may only change during operations holding
+    // the exclusive lock, so it is checked with the shared lock held.
+    std::shared_lock<std::shared_mutex> shared_lock(dispatch_lock_);
+    if (vnode->SupportsConcurrentDispatch()) {
+      guard.shared_lock_ = std::move(shared_lock);
+      guard.vnode_lock_ = std::unique_lock<std::mutex>(vnode->dispatch_lock());
+      guard.vnode_ = std::move(vnode);
+      return guard;
+    }
+  }
+  guard.exclusive_lock_ = std::unique_lock<std::shared_mutex>(dispatch_lock_);
+  return guard;
+}
+
 bool Vfs::IsTokenAssociatedWithVnode(zx::event token) {
   fbl::AutoLock lock(&vfs_lock_);
   return TokenToVnode(std::move(token), nullptr) == ZX_OK;
@@ -396,15 +421,23 @@ zx_status_t Vfs::Rename(zx::event token, fbl::RefPtr<Vnode> oldparent, fbl::Stri
 
   fbl::RefPtr<fs::Vnode> newparent;
   {
-    fbl::AutoLock lock(&vfs_lock_);
-    if (ReadonlyLocked()) {
+    // Rename may move entire subtrees between directories, so it excludes all path walks rather
+    // than taking the locks of both parents.
+    std::unique_lock<std::shared_mutex> topology_lock(topology_lock_);
+    if (readonly_.load()) {
       return ZX_ERR_ACCESS_DENIED;
     }
-    if ((r = TokenToVnode(std::move(token), &newparent)) != ZX_OK) {
-      return r;
+    {
+      fbl::AutoLock lock(&vfs_lock_);
+      if ((r = TokenToVnode(std::move(token), &newparent)) != ZX_OK) {
+        return r;
+      }
     }
 
     r = oldparent->Rename(newparent, oldStr, newStr, old_must_be_dir, new_must_be_dir);
+    // A failed rename may still have replaced the destination, so invalidate unconditionally.
+    lookup_cache_.Invalidate(*oldparent, oldStr);
+    lookup_cache_.Invalidate(*newparent, newStr);
   }
   if (r != ZX_OK) {
     return r;
@@ -416,22 +449,81 @@ zx_status_t Vfs::Rename(zx::event token, fbl::RefPtr<Vnode> oldparent, fbl::Stri
 
 zx_status_t Vfs::Readdir(Vnode* vn, vdircookie_t* cookie, void* dirents, size_t len,
                          size_t* out_actual) {
-  fbl::AutoLock lock(&vfs_lock_);
+  std::shared_lock<std::shared_mutex> topology_lock(topology_lock_);
+  std::shared_lock<std::shared_mutex> directory_lock(DirectoryLock(*vn));
   return vn->Readdir(cookie, dirents, len, out_actual);
 }
 
+zx_status_t Vfs::ReaddirAttributes(Vnode* vn, vdircookie_t* cookie, void* dirents, size_t len,
+                                   size_t* out_actual, fio::DirentAttributes* out_attributes,
+                                   size_t* out_count) {
+  std::shared_lock<std::shared_mutex> topology_lock(topology_lock_);
+  std::shared_lock<std::shared_mutex> directory_lock(DirectoryLock(*vn));
+  size_t actual = 0;
+  zx_status_t status = vn->Readdir(cookie, dirents, len, &actual);
+  if (status != ZX_OK) {
+    return status;
+  }
+
+  // Holding the directory lock keeps the entries from changing between |Readdir| and the
+  // lookups below.
+  auto data = static_cast<const uint8_t*>(dirents);
+  size_t count = 0;
+  for (size_t offset = 0; offset + sizeof(vdirent_t) <= actual;) {
+    auto entry = reinterpret_cast<const vdirent_t*>(data + offset);
+    offset += sizeof(vdirent_t) + entry->size;
+    ZX_DEBUG_ASSERT(offset <= actual);
+    ZX_DEBUG_ASSERT(count < len / kMinDirentSize);
+
+    // The records are sent to the client byte for byte, so the padding is cleared as well as
+    // the fields, and the attributes are filled in member by member rather than copied from a
+    // temporary whose padding is indeterminate.
+    fio::DirentAttributes& attributes = out_attributes[count++];
+    memset(&attributes, 0, sizeof(attributes));
+    fbl::RefPtr<Vnode> child;
+    attributes.s =
+        LookupNode(fbl::RefPtr<Vnode>(vn), fbl::StringPiece(entry->name, entry->size), &child);
+    if (attributes.s != ZX_OK) {
+      continue;
+    }
+    if (child->IsRemote()) {
+      // The attributes of the mount point are not those of the remote filesystem.
+      attributes.s = ZX_ERR_NOT_SUPPORTED;
+      continue;
+    }
+    VnodeAttributes vnode_attributes;
+    attributes.s = child->GetAttributes(&vnode_attributes);
+    if (attributes.s == ZX_OK) {
+      attributes.attributes.mode = vnode_attributes.mode;
+      attributes.attributes.id = vnode_attributes.inode;
+      attributes.attributes.content_size = vnode_attributes.content_size;
+      attributes.attributes.storage_size = vnode_attributes.storage_size;
+      attributes.attributes.link_count = vnode_attributes.link_count;
+      attributes.attributes.creation_time = vnode_attributes.creation_time;
+      attributes.attributes.modification_time = vnode_attributes.modification_time;
+    }
+  }
+  *out_actual = actual;
+  *out_count = count;
+  return ZX_OK;
+}
+
 zx_status_t Vfs::Link(zx::event token, fbl::RefPtr<Vnode> oldparent, fbl::StringPiece oldStr,
                       fbl::StringPiece newStr) {
-  fbl::AutoLock lock(&vfs_lock_);
+  // Like rename, linking touches two directories at once, so it excludes all path walks.
+  std::unique_lock<std::shared_mutex> topology_lock(topology_lock_);
   fbl::RefPtr<fs::Vnode> newparent;
   zx_status_t r;
-  if ((r = TokenToVnode(std::move(token), &newparent)) != ZX_OK) {
-    return r;
+  {
+    fbl::AutoLock lock(&vfs_lock_);
+    if ((r = TokenToVnode(std::move(token), &newparent)) != ZX_OK) {
+      return r;
+    }
   }
   // Local filesystem
   bool old_must_be_dir;
   bool new_must_be_dir;
-  if (ReadonlyLocked()) {
+  if (readonly_.load()) {
     return ZX_ERR_ACCESS_DENIED;
   } else if ((r = TrimName(oldStr, &oldStr, &old_must_be_dir)) != ZX_OK) {
     return r;
@@ -457,6 +549,7 @@ zx_status_t Vfs::Link(zx::event token, fbl::RefPtr<Vnode> oldparent, fbl::String
     return r;
   }
   r = newparent->Link(newStr, target);
+  lookup_cache_.Invalidate(*newparent, newStr);
   if (r != ZX_OK) {
     return r;
   }
@@ -522,6 +615,11 @@ zx_status_t Vfs::Serve(fbl::RefPtr<Vnode> vnode, zx::channel channel,
           return ZX_OK;
         }
         if (status == ZX_ERR_NOT_SUPPORTED) {
+          if (options->rights.read && !options->flags.node_reference) {
+            // Advertise |fuchsia.io/File.GetReadRing|, which only this kind of connection serves.
+            // The client may already have closed the channel, which is not an error here.
+            channel.signal_peer(0, fio::FILE_SIGNAL_READ_RING);
+          }
           connection = std::make_unique<internal::RemoteFileConnection>(this, std::move(vnode),
                                                                         protocol, *options);
           return ZX_OK;
@@ -529,6 +627,10 @@ zx_status_t Vfs::Serve(fbl::RefPtr<Vnode> vnode, zx::channel channel,
         return status;
       }
       case VnodeProtocol::kDirectory:
+        if (!options->flags.node_reference) {
+          // Advertise |fuchsia.io/Directory.ReadDirentsAttributes|.
+          channel.signal_peer(0, fio::DIRECTORY_SIGNAL_DIRENT_ATTRIBUTES);
+        }
         connection = std::make_unique<internal::DirectoryConnection>(this, std::move(vnode),
                                                                      protocol, *options);
         return ZX_OK;
@@ -588,11 +690,22 @@ zx_status_t Vfs::ServeDirectory(fbl::RefPtr<fs::Vnode> vn, zx::channel channel,
 
 #endif  // ifdef __Fuchsia__
 
-void Vfs::SetReadonly(bool value) {
+void Vfs::SetReadonly(bool value) { readonly_.store(value); }
+
+zx_status_t Vfs::Lookup(fbl::RefPtr<Vnode> vn, fbl::StringPiece name, fbl::RefPtr<Vnode>* out) {
 #ifdef __Fuchsia__
-  fbl::AutoLock lock(&vfs_lock_);
+  std::shared_lock<std::shared_mutex> directory_lock(DirectoryLock(*vn));
 #endif
-  readonly_ = value;
+  if (!lookup_cache_.enabled() || name == "." || name == "..") {
+    return LookupNode(std::move(vn), name, out);
+  }
+  if (lookup_cache_.Lookup(*vn, name, out)) {
+    return *out ? ZX_OK : ZX_ERR_NOT_FOUND;
+  }
+  // The directory lock keeps the entry from changing until the result is cached.
+  zx_status_t status = vn->Lookup(out, name);
+  lookup_cache_.Insert(std::move(vn), name, status, *out);
+  return status;
 }
 
 zx_status_t Vfs::Walk(fbl::RefPtr<Vnode> vn, fbl::RefPtr<Vnode>* out_vn, fbl::StringPiece path,
@@ -635,7 +748,7 @@ zx_status_t Vfs::Walk(fbl::RefPtr<Vnode> vn, fbl::RefPtr<Vnode>* out_vn, fbl::St
     if (component.length() > NAME_MAX) {
       return ZX_ERR_BAD_PATH;
     }
-    if ((r = LookupNode(std::move(vn), component, &vn)) != ZX_OK) {
+    if ((r = Lookup(std::move(vn), component, &vn)) != ZX_OK) {
       return r;
     }
     // Traverse to the next segment.
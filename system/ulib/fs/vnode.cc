@@ -200,6 +200,8 @@ zx_handle_t Vnode::GetRemote() const { return ZX_HANDLE_INVALID; }
 
 void Vnode::SetRemote(zx::channel remote) { ZX_DEBUG_ASSERT(false); }
 
+bool Vnode::SupportsConcurrentDispatch() const { return false; }
+
 #endif  // __Fuchsia__
 
 DirentFiller::DirentFiller(void* ptr, size_t len)
@@ -30,6 +30,14 @@ namespace lockdep {
 #define LOCK_DEP_ENABLE_VALIDATION 0
 #endif
 
+// Configures whether lock statistics are collected or not. Defaults to
+// disabled. When enabled every lock class records acquisition and hold times
+// through the runtime hooks in runtime_api.h, independent of whether lock
+// validation is enabled.
+#ifndef LOCK_DEP_ENABLE_STATS
+#define LOCK_DEP_ENABLE_STATS 0
+#endif
+
 // Id type used to identify each lock class.
 using LockClassId = uintptr_t;
 
@@ -80,6 +88,25 @@ template <typename EnabledType, typename DisabledType>
 using IfLockValidationEnabled =
     typename std::conditional<kLockValidationEnabled, EnabledType, DisabledType>::type;
 
+// Whether or not lock statistics are globally enabled.
+constexpr bool kLockStatsEnabled = static_cast<bool>(LOCK_DEP_ENABLE_STATS);
+
+// Utility template alias to simplify selecting different types based whether
+// lock statistics are enabled or disabled.
+template <typename EnabledType, typename DisabledType>
+using IfLockStatsEnabled =
+    typename std::conditional<kLockStatsEnabled, EnabledType, DisabledType>::type;
+
+// Lock classes are instantiated when either validation or statistics need to
+// identify the class of each lock.
+constexpr bool kLockClassesEnabled = kLockValidationEnabled || kLockStatsEnabled;
+
+// Utility template alias to simplify selecting different types based whether
+// lock classes are enabled or disabled.
+template <typename EnabledType, typename DisabledType>
+using IfLockClassesEnabled =
+    typename std::conditional<kLockClassesEnabled, EnabledType, DisabledType>::type;
+
 // Result type that represents whether a lock attempt was successful, or if not
 // which check failed.
 enum class LockResult : uint8_t {
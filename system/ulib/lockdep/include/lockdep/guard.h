@@ -77,6 +77,43 @@ template <typename LockType, typename Option>
 using EnableIfNotShared =
     std::enable_if_t<!IsSharedLockPolicy<LockPolicy<LockType, Option>>::value>;
 
+// Recorder type used when lock statistics are enabled. Measures the time spent
+// waiting for and holding the lock and reports it to the system hooks. Hold
+// times are skipped for lock classes with LockFlagsHoldStatsDisabled.
+class LockStatRecorder {
+ public:
+  LockStatRecorder(LockClassId id) : id_{id} {}
+
+  void BeginAcquire() { timestamp_ = SystemLockStatTimestamp(); }
+  void EndAcquire() {
+    const uint64_t now = SystemLockStatTimestamp();
+    SystemLockStatAcquire(id_, now - timestamp_);
+    timestamp_ = now;
+  }
+  void Release() {
+    if (!LockClassState::IsHoldStatsDisabled(id_)) {
+      SystemLockStatRelease(id_, SystemLockStatTimestamp() - timestamp_);
+    }
+  }
+
+ private:
+  LockClassId id_;
+  // The time the acquisition started while acquiring, then the time the lock
+  // was acquired while it is held.
+  uint64_t timestamp_{0};
+};
+
+// Recorder type used when lock statistics are disabled.
+struct DummyLockStatRecorder {
+  DummyLockStatRecorder(LockClassId) {}
+  void BeginAcquire() {}
+  void EndAcquire() {}
+  void Release() {}
+};
+
+// Alias of the configured statistics recorder.
+using StatRecorder = IfLockStatsEnabled<LockStatRecorder, DummyLockStatRecorder>;
+
 }  // namespace internal
 
 // Assert that the given lock is exclusively held by the current thread.
@@ -130,7 +167,10 @@ class __TA_SCOPED_CAPABILITY
             typename = internal::EnableIfNotNestable<Lockable, LockType>>
   __WARN_UNUSED_CONSTRUCTOR Guard(Lockable* lock, Args&&... state_args) __TA_ACQUIRE(lock)
       __TA_ACQUIRE(lock->capability())
-      : validator_{lock->id()}, lock_{&lock->lock()}, state_{std::forward<Args>(state_args)...} {
+      : validator_{lock->id()},
+        stats_{lock->id()},
+        lock_{&lock->lock()},
+        state_{std::forward<Args>(state_args)...} {
     ValidateAndAcquire();
   }
 
@@ -150,6 +190,7 @@ class __TA_SCOPED_CAPABILITY
   void Release(Args&&... args) __TA_RELEASE() {
     if (lock_ != nullptr) {
       LockPolicy<LockType, Option>::Release(lock_, &state_, std::forward<Args>(args)...);
+      stats_.Release();
       validator_.ValidateRelease();
       lock_ = nullptr;
     }
@@ -186,6 +227,7 @@ class __TA_SCOPED_CAPABILITY
   //
   __WARN_UNUSED_CONSTRUCTOR Guard(AdoptLockTag, Guard&& other) __TA_ACQUIRE(other.lock_)
       : validator_{std::move(other.validator_)},
+        stats_{std::move(other.stats_)},
         lock_{other.lock_},
         state_{std::move(other.state_)} {
     other.lock_ = nullptr;
@@ -212,6 +254,7 @@ class __TA_SCOPED_CAPABILITY
 
     LockPolicy<LockType, Option>::Release(lock_, &state_,
                                           std::forward<ReleaseArgs>(release_args)...);
+    stats_.Release();
     validator_.ValidateRelease();
 
     std::forward<Op>(op)();
@@ -231,9 +274,12 @@ class __TA_SCOPED_CAPABILITY
   // body.
   void ValidateAndAcquire() __TA_NO_THREAD_SAFETY_ANALYSIS {
     validator_.ValidateAcquire();
+    stats_.BeginAcquire();
     if (!LockPolicy<LockType, Option>::Acquire(lock_, &state_)) {
       lock_ = nullptr;
       validator_.ValidateRelease();
+    } else {
+      stats_.EndAcquire();
     }
   }
 
@@ -244,6 +290,7 @@ class __TA_SCOPED_CAPABILITY
                                   Args&&... state_args) __TA_ACQUIRE(lock)
       __TA_ACQUIRE(lock->capability())
       : validator_{lock->id(), order},
+        stats_{lock->id()},
         lock_{&lock->lock()},
         state_{std::forward<Args>(state_args)...} {
     ValidateAndAcquire();
@@ -274,6 +321,9 @@ class __TA_SCOPED_CAPABILITY
   // The validator to use when acquiring and releasing the lock.
   Validator validator_;
 
+  // The statistics recorder to use when acquiring and releasing the lock.
+  internal::StatRecorder stats_;
+
   // Pointer to the acquired lock.
   LockType* lock_;
 
@@ -303,7 +353,10 @@ class __TA_SCOPED_CAPABILITY Guard<LockType, Option, internal::EnableIfShared<Lo
             typename = internal::EnableIfNotNestable<Lockable, LockType>>
   __WARN_UNUSED_CONSTRUCTOR Guard(Lockable* lock, Args&&... state_args) __TA_ACQUIRE_SHARED(lock)
       __TA_ACQUIRE_SHARED(lock->capability())
-      : validator_{lock->id()}, lock_{&lock->lock()}, state_{std::forward<Args>(state_args)...} {
+      : validator_{lock->id()},
+        stats_{lock->id()},
+        lock_{&lock->lock()},
+        state_{std::forward<Args>(state_args)...} {
     ValidateAndAcquire();
   }
 
@@ -323,6 +376,7 @@ class __TA_SCOPED_CAPABILITY Guard<LockType, Option, internal::EnableIfShared<Lo
   void Release(Args&&... args) __TA_RELEASE() {
     if (lock_ != nullptr) {
       LockPolicy<LockType, Option>::Release(lock_, &state_, std::forward<Args>(args)...);
+      stats_.Release();
       validator_.ValidateRelease();
       lock_ = nullptr;
     }
@@ -357,6 +411,7 @@ class __TA_SCOPED_CAPABILITY Guard<LockType, Option, internal::EnableIfShared<Lo
   //
   __WARN_UNUSED_CONSTRUCTOR Guard(AdoptLockTag, Guard&& other) __TA_ACQUIRE_SHARED(other.lock_)
       : validator_{std::move(other.validator_)},
+        stats_{std::move(other.stats_)},
         lock_{other.lock_},
         state_{std::move(other.state_)} {
     other.lock_ = nullptr;
@@ -383,6 +438,7 @@ class __TA_SCOPED_CAPABILITY Guard<LockType, Option, internal::EnableIfShared<Lo
 
     LockPolicy<LockType, Option>::Release(lock_, &state_,
                                           std::forward<ReleaseArgs>(release_args)...);
+    stats_.Release();
     validator_.ValidateRelease();
 
     std::forward<Op>(op)();
@@ -402,9 +458,12 @@ class __TA_SCOPED_CAPABILITY Guard<LockType, Option, internal::EnableIfShared<Lo
   // body.
   void ValidateAndAcquire() __TA_NO_THREAD_SAFETY_ANALYSIS {
     validator_.ValidateAcquire();
+    stats_.BeginAcquire();
     if (!LockPolicy<LockType, Option>::Acquire(lock_, &state_)) {
       lock_ = nullptr;
       validator_.ValidateRelease();
+    } else {
+      stats_.EndAcquire();
     }
   }
 
@@ -415,6 +474,7 @@ class __TA_SCOPED_CAPABILITY Guard<LockType, Option, internal::EnableIfShared<Lo
                                   Args&&... state_args) __TA_ACQUIRE_SHARED(lock)
       __TA_ACQUIRE_SHARED(lock->capability())
       : validator_{lock->id(), order},
+        stats_{lock->id()},
         lock_{&lock->lock()},
         state_{std::forward<Args>(state_args)...} {
     ValidateAndAcquire();
@@ -445,6 +505,9 @@ class __TA_SCOPED_CAPABILITY Guard<LockType, Option, internal::EnableIfShared<Lo
   // The validator to use when acquiring and releasing the lock.
   Validator validator_;
 
+  // The statistics recorder to use when acquiring and releasing the lock.
+  internal::StatRecorder stats_;
+
   // Pointer to the acquired lock.
   LockType* lock_;
 
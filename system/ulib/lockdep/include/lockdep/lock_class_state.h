@@ -5,6 +5,7 @@
 #ifndef LOCKDEP_LOCK_CLASS_STATE_H_
 #define LOCKDEP_LOCK_CLASS_STATE_H_
 
+#include <stddef.h>
 #include <stdint.h>
 #include <zircon/assert.h>
 #include <zircon/compiler.h>
@@ -52,6 +53,9 @@ class LockClassState {
     return Get(id)->dependency_set_->AddLockClass(add_id);
   }
 
+  // Returns the ordinal of the lock class for the given lock class id.
+  static size_t GetOrdinal(LockClassId id) { return Get(id)->ordinal_; }
+
   // Returns true if the given lock class is irq-safe, false otherwise.
   static bool IsIrqSafe(LockClassId id) { return !!(Get(id)->flags_ & LockFlagsIrqSafe); }
 
@@ -81,6 +85,11 @@ class LockClassState {
     return !!(Get(id)->flags_ & LockFlagsTrackingDisabled);
   }
 
+  // Returns true if lock statistics should not record hold times for the lock.
+  static bool IsHoldStatsDisabled(LockClassId id) {
+    return !!(Get(id)->flags_ & LockFlagsHoldStatsDisabled);
+  }
+
   // Iterator type to traverse the set of LockClassState instances.
   class Iterator {
    public:
@@ -113,6 +122,14 @@ class LockClassState {
   // Returns the name of this lock class.
   const char* name() const { return name_; }
 
+  // Returns the ordinal of this lock class. Ordinals are assigned densely from
+  // zero in the order the global initializers run, so they may be used to index
+  // per-lock class tables sized by the total number of lock classes.
+  size_t ordinal() const { return ordinal_; }
+
+  // Returns the total number of lock classes.
+  static size_t Count() { return *Counter(); }
+
   // Return the flags of this lock class.
   LockFlags flags() const { return flags_; }
 
@@ -155,6 +172,15 @@ class LockClassState {
   // list of lock classes.
   LockClassState* next_{InitNext(this)};
 
+  // Ordinal of this lock class, assigned by the global initializer.
+  const size_t ordinal_{(*Counter())++};
+
+  // Returns a pointer to the number of state instances constructed so far.
+  static size_t* Counter() {
+    static size_t count{0};
+    return &count;
+  }
+
   // Returns a pointer to the head pointer of the state linked list.
   static LockClassState** Head() {
     static LockClassState* head{nullptr};
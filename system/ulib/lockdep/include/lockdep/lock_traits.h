@@ -37,6 +37,11 @@ enum LockFlags : uint8_t {
 
   // Do not track this lock.
   LockFlagsTrackingDisabled = (1 << 6),
+
+  // Do not record hold times for this lock. This is required for locks that
+  // are held across context switches, since the guard that releases the lock
+  // is not the one that acquired it.
+  LockFlagsHoldStatsDisabled = (1 << 7),
 };
 
 // Prevent implicit conversion to int of bitwise-or expressions involving
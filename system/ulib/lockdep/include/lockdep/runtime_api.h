@@ -20,6 +20,7 @@ class AcquiredLockEntry;
 class ThreadLockState;
 class LockClassState;
 enum class LockResult : uint8_t;
+using LockClassId = uintptr_t;
 
 // System-defined hook to report detected lock validation failures.
 extern void SystemLockValidationError(AcquiredLockEntry* lock_entry,
@@ -48,4 +49,17 @@ extern void SystemInitThreadLockState(ThreadLockState* state);
 // given time interval.
 extern void SystemTriggerLoopDetection();
 
+// System-defined hook that returns the current time in the units used by the
+// lock statistics hooks below. Only required when lock statistics are enabled.
+extern uint64_t SystemLockStatTimestamp();
+
+// System-defined hook that records an acquisition of the given lock class that
+// waited |wait_time| for the lock. Only required when lock statistics are
+// enabled.
+extern void SystemLockStatAcquire(LockClassId id, uint64_t wait_time);
+
+// System-defined hook that records a release of the given lock class that was
+// held for |hold_time|. Only required when lock statistics are enabled.
+extern void SystemLockStatRelease(LockClassId id, uint64_t hold_time);
+
 }  // namespace lockdep
@@ -61,6 +61,10 @@ void Dnode::Detach() {
   }
 
   auto self = RemoveFromParent();
+  if (IsDirectory()) {
+    // Nothing can be looked up within a removed directory.
+    self->vnode_->vfs()->lookup_cache().InvalidateChildren(*self->vnode_);
+  }
   // Detach from vnode
   self->vnode_->dnode_ = nullptr;
   self->vnode_ = nullptr;
@@ -16,11 +16,12 @@
 #include <zircon/device/vfs.h>
 
 #include <atomic>
+#include <mutex>
+#include <shared_mutex>
 #include <utility>
 
 #include <fbl/algorithm.h>
 #include <fbl/alloc_checker.h>
-#include <fbl/auto_lock.h>
 #include <fbl/ref_ptr.h>
 #include <fs/vfs.h>
 
@@ -31,6 +32,9 @@ namespace {
 
 constexpr size_t kPageSize = static_cast<size_t>(PAGE_SIZE);
 
+// Maximum number of directory entries remembered by the lookup cache.
+constexpr size_t kLookupCacheCapacity = 256;
+
 zx_status_t CreateID(uint64_t* out_id) {
   zx::event id;
   zx_status_t status = zx::event::create(0, &id);
@@ -91,14 +95,22 @@ zx_status_t Vfs::Create(const char* name, std::unique_ptr<memfs::Vfs>* out_vfs,
   return ZX_OK;
 }
 
-Vfs::Vfs(uint64_t id, const char* name) : fs::ManagedVfs(), fs_id_(id) {}
+Vfs::Vfs(uint64_t id, const char* name) : fs::ManagedVfs(), fs_id_(id) {
+  lookup_cache().SetCapacity(kLookupCacheCapacity);
+}
 
-Vfs::~Vfs() = default;
+// Cached vnodes refer back to this object, so they must be released first.
+Vfs::~Vfs() { lookup_cache().Clear(); }
 
 zx_status_t Vfs::CreateFromVmo(VnodeDir* parent, fbl::StringPiece name, zx_handle_t vmo,
                                zx_off_t off, zx_off_t len) {
-  fbl::AutoLock lock(&vfs_lock_);
-  return parent->CreateFromVmo(name, vmo, off, len);
+  std::shared_lock<std::shared_mutex> topology_lock(topology_lock_);
+  std::unique_lock<std::shared_mutex> directory_lock(DirectoryLock(*parent));
+  zx_status_t status = parent->CreateFromVmo(name, vmo, off, len);
+  if (status == ZX_OK) {
+    lookup_cache().Invalidate(*parent, name);
+  }
+  return status;
 }
 
 std::atomic<uint64_t> VnodeMemfs::ino_ctr_ = 0;
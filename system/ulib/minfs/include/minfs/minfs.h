@@ -84,6 +84,9 @@ struct MountOptions {
 
   // Number of slices to preallocate for data when the filesystem is created.
   uint32_t fvm_data_slices = 1;
+  // Number of threads servicing filesystem requests. MinFS vnodes do not opt into concurrent
+  // dispatch, so requests remain serialized by the Vfs.
+  uint32_t serving_threads = 1;
 };
 
 // Format the partition backed by |bc| as MinFS.
@@ -4,6 +4,11 @@
 
 #include <optional>
 
+#ifdef __Fuchsia__
+#include <lib/async/cpp/task.h>
+#include <lib/zx/time.h>
+#endif
+
 #include <minfs/minfs.h>
 
 #include "minfs_private.h"
@@ -13,6 +18,14 @@
 #endif
 
 namespace minfs {
+#ifdef __Fuchsia__
+namespace {
+
+// Time between each Cobalt flush.
+constexpr zx::duration kCobaltFlushTimer = zx::min(5);
+
+}  // namespace
+#endif
 
 #ifdef FS_WITH_METRICS
 MinfsMetrics::MinfsMetrics(const ::llcpp::fuchsia::minfs::Metrics* metrics)
@@ -51,6 +64,32 @@ void MinfsMetrics::Dump(FILE* stream, std::optional<bool> success) const {
 }
 #endif  // FS_WITH_METRICS
 
+void Minfs::SetMetrics(bool enable) {
+#ifdef __Fuchsia__
+  metrics_.SetEnable(enable);
+  cobalt_metrics_.EnableMetrics(enable);
+  if (enable && !flush_started_.exchange(true)) {
+    flush_loop_.StartThread("minfs-metric-flusher");
+    ScheduleMetricFlush();
+  }
+#endif
+}
+
+#ifdef __Fuchsia__
+void Minfs::ScheduleMetricFlush() {
+  async::PostDelayedTask(
+      flush_loop_.dispatcher(),
+      [this]() {
+        fs::LookupCache::Stats stats = lookup_cache().GetStats();
+        cobalt_metrics_.mutable_lookup_cache_metrics()->Update(stats.hits, stats.negative_hits,
+                                                               stats.misses);
+        cobalt_metrics_.mutable_collector()->Flush();
+        ScheduleMetricFlush();
+      },
+      kCobaltFlushTimer);
+}
+#endif
+
 void Minfs::UpdateInitMetrics(uint32_t dnum_count, uint32_t inum_count, uint32_t dinum_count,
                               uint64_t user_data_size, const fs::Duration& duration) {
 #ifdef FS_WITH_METRICS
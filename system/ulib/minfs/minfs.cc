@@ -48,7 +48,18 @@
 namespace minfs {
 namespace {
 
+// Maximum number of directory entries remembered by the lookup cache.
+constexpr size_t kLookupCacheCapacity = 1024;
+
 #ifdef __Fuchsia__
+// Maximum number of journal blocks written by a single group of metadata transactions.
+constexpr uint64_t kJournalGroupCommitBlocks = 64;
+
+// How long a group of metadata transactions waits for others to join it. Minfs only waits for
+// metadata writes to complete in sync, which writes the open group without waiting, so the window
+// delays writeback but not callers.
+constexpr zx_duration_t kJournalGroupCommitWindow = ZX_MSEC(1);
+
 // Deletes all known slices from a MinFS Partition.
 void FreeSlices(const Superblock* info, block_client::BlockDevice* device) {
   if ((info->flags & kMinfsFlagFVM) == 0) {
@@ -634,7 +645,15 @@ Minfs::Minfs(std::unique_ptr<Bcache> bc, std::unique_ptr<SuperblockManager> sb,
       mount_options_(mount_options) {}
 #endif
 
-Minfs::~Minfs() { vnode_hash_.clear(); }
+Minfs::~Minfs() {
+#ifdef __Fuchsia__
+  // The metric flusher reads the lookup cache, so stop it first.
+  flush_loop_.Shutdown();
+#endif
+  // Cached vnodes must be released while the rest of the filesystem is still alive.
+  lookup_cache().Clear();
+  vnode_hash_.clear();
+}
 
 #ifdef __Fuchsia__
 zx_status_t Minfs::FVMQuery(fuchsia_hardware_block_volume_VolumeInfo* info) const {
@@ -1193,6 +1212,7 @@ zx_status_t Minfs::Create(std::unique_ptr<Bcache> bc, const MountOptions& option
     fs->StopWriteback();
   }
   fs->SetReadonly(options.readonly || options.readonly_after_initialization);
+  fs->lookup_cache().SetCapacity(kLookupCacheCapacity);
   fs->mount_state_ = {
       .readonly_after_initialization = options.readonly_after_initialization,
       .collect_metrics = options.metrics,
@@ -1252,7 +1272,11 @@ zx_status_t Minfs::InitializeJournal(fs::JournalSuperblock journal_superblock) {
   journal_ = std::make_unique<fs::Journal>(GetMutableBcache(), std::move(journal_superblock),
                                            std::move(journal_buffer), std::move(writeback_buffer),
                                            JournalStartBlock(sb_->Info()),
-                                           fs::Journal::Options{ .sequence_data_writes = false });
+                                           fs::Journal::Options{
+                                               .sequence_data_writes = false,
+                                               .group_commit_blocks = kJournalGroupCommitBlocks,
+                                               .group_commit_window = kJournalGroupCommitWindow,
+                                           });
   return ZX_OK;
 }
 
@@ -10,18 +10,22 @@
 
 #include <inttypes.h>
 
+#include <atomic>
 #include <memory>
 #include <utility>
 
 #ifdef __Fuchsia__
 #include <fuchsia/io/llcpp/fidl.h>
 #include <fuchsia/minfs/llcpp/fidl.h>
+#include <lib/async-loop/cpp/loop.h>
+#include <lib/async-loop/default.h>
 #include <lib/fzl/resizeable-vmo-mapper.h>
 #include <lib/sync/completion.h>
 #include <lib/zx/vmo.h>
 
 #include <fs/journal/journal.h>
 #include <fs/managed_vfs.h>
+#include <fs/metrics/cobalt_metrics.h>
 #include <fs/remote.h>
 #include <fs/watcher.h>
 #include <minfs/metrics.h>
@@ -291,11 +295,9 @@ class Minfs :
   // functions is preferred.
   zx_status_t ReadDat(blk_t bno, void* data);
 
-  void SetMetrics(bool enable) {
-#ifdef __Fuchsia__
-    metrics_.SetEnable(enable);
-#endif
-  }
+  // Enables or disables metrics collection. On Fuchsia, enabling also starts periodically flushing
+  // the lookup cache counters to Cobalt.
+  void SetMetrics(bool enable);
   fs::Ticker StartTicker() {
 #ifdef __Fuchsia__
     return fs::Ticker(metrics_.Enabled());
@@ -389,6 +391,11 @@ class Minfs :
         BlockOffsets offsets, const MountOptions& mount_options);
 #endif
 
+#ifdef __Fuchsia__
+  // Flushes the lookup cache counters to Cobalt and schedules itself to flush again.
+  void ScheduleMetricFlush();
+#endif
+
   // Internal version of VnodeLookup which may also return unlinked vnodes.
   fbl::RefPtr<VnodeMinfs> VnodeLookupInternal(uint32_t ino) FS_TA_EXCLUDES(hash_lock_);
 
@@ -438,6 +445,15 @@ class Minfs :
 #ifdef __Fuchsia__
   fbl::Closure on_unmount_{};
   MinfsMetrics metrics_ = {};
+  // local_storage project ID as defined in cobalt-analytics projects.yaml.
+  static constexpr uint32_t kCobaltProjectId = 3676913920;
+  // Cobalt metrics, currently only carrying the lookup cache counters.
+  fs_metrics::Metrics cobalt_metrics_ =
+      fs_metrics::Metrics(std::make_unique<cobalt_client::Collector>(kCobaltProjectId), "minfs");
+  // Loop for flushing |cobalt_metrics_| periodically, started the first time metrics are enabled.
+  // Metrics may be enabled from several serving threads at once.
+  async::Loop flush_loop_ = async::Loop(&kAsyncLoopConfigNoAttachToCurrentThread);
+  std::atomic<bool> flush_started_ = false;
   std::unique_ptr<fs::Journal> journal_;
   uint64_t fs_id_ = 0;
   // TODO(fxb/51057): Git rid of MountState.
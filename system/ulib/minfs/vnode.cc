@@ -256,6 +256,10 @@ zx_status_t VnodeMinfs::RemoveInodeLink(Transaction* transaction) {
   }
 
   if (IsUnlinked()) {
+    if (IsDirectory()) {
+      // Nothing can be looked up within a removed directory.
+      fs_->lookup_cache().InvalidateChildren(*this);
+    }
     if (fd_count_ == 0) {
       Purge(transaction);
     } else {
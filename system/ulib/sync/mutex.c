@@ -18,6 +18,48 @@ __NO_INLINE __NO_RETURN void PanicAttemptedToReenterMutex(void) {
   __builtin_trap();
 }
 
+static inline void spin_pause(void) {
+#if defined(__x86_64__)
+  __asm__ __volatile__("pause" : : : "memory");
+#elif defined(__aarch64__)
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#else
+#error Please define spin_pause() for your architecture
+#endif
+}
+
+// Reading the clock costs far more than one spin_pause(), so the spin deadline
+// is only checked once every this many iterations.  Must be a power of two.
+#define SPIN_CLOCK_CHECK_INTERVAL 64u
+
+// Spin while the mutex is held without waiters, for up to the duration hinted
+// by the vDSO, and return the last state observed.
+//
+// Blocking in the kernel costs a round trip through zx_futex_wait and
+// zx_futex_wake_single_owner, which is much longer than most critical
+// sections.  An owner that is still running on another CPU is likely to
+// release the mutex sooner than that, so it pays to wait for it here.  Once
+// the mutex is contested, other threads have already given up and blocked, so
+// we stop spinning and queue up behind them instead of barging ahead.
+static zx_futex_storage_t spin_while_owned(sync_mutex_t* mutex, zx_futex_storage_t old_state) {
+  zx_duration_t spin_duration = _zx_system_get_mutex_spin_duration();
+  if (spin_duration == 0 || libsync_mutex_is_contested(old_state)) {
+    return old_state;
+  }
+  zx_time_t deadline = zx_time_add_duration(_zx_clock_get_monotonic(), spin_duration);
+  for (uint32_t i = 1;; ++i) {
+    spin_pause();
+    old_state = atomic_load_explicit(&mutex->futex, memory_order_relaxed);
+    if ((old_state == LIB_SYNC_MUTEX_UNLOCKED) || libsync_mutex_is_contested(old_state)) {
+      break;
+    }
+    if ((i % SPIN_CLOCK_CHECK_INTERVAL) == 0 && _zx_clock_get_monotonic() >= deadline) {
+      break;
+    }
+  }
+  return old_state;
+}
+
 // On success, this will leave the mutex in the LOCKED_WITH_WAITERS state.
 static zx_status_t lock_slow_path(sync_mutex_t* mutex, zx_time_t deadline,
                                   zx_futex_storage_t owned_and_contested_val,
@@ -96,6 +138,15 @@ zx_status_t sync_mutex_timedlock(sync_mutex_t* mutex, zx_time_t deadline) {
   if (atomic_compare_exchange_strong(&mutex->futex, &old_state, uncontested)) {
     return ZX_OK;
   }
+
+  // Re-entering the mutex would spin for nothing; let the slow path catch it.
+  if (libsync_mutex_make_owner_from_state(old_state) != _zx_thread_self()) {
+    old_state = spin_while_owned(mutex, old_state);
+    if ((old_state == LIB_SYNC_MUTEX_UNLOCKED) &&
+        atomic_compare_exchange_strong(&mutex->futex, &old_state, uncontested)) {
+      return ZX_OK;
+    }
+  }
   return lock_slow_path(mutex, deadline, libsync_mutex_make_contested(uncontested), old_state);
 }
 
@@ -71,6 +71,23 @@
 // Note that the handler is free to save buffers at whatever rate it can
 // manage. The protocol allows for records to be dropped if buffers can't be
 // saved fast enough.
+//
+// Per-thread chunks
+// -----------------
+//
+// With many threads tracing at once, atomically bumping a single allocation
+// pointer for every record makes the threads contend on its cache line. So,
+// when the rolling buffers are large enough, each thread instead reserves a
+// chunk of the current rolling buffer at a time and carves its records out of
+// that chunk without synchronization. The unused remainder of a chunk always
+// holds a padding record, which readers skip, so the buffer can be read up to
+// the allocation pointer as before.
+//
+// A chunk is only good for the rolling buffer it was reserved in: once the
+// buffer is switched or reset, the thread reserves a new chunk. Durable
+// records still come from the shared durable buffer: they are written only
+// when a thread first uses a string or thread, and the string and thread
+// indices they define are shared by the whole provider.
 
 #include <assert.h>
 #include <inttypes.h>
@@ -88,6 +105,30 @@ namespace {
 // The next context generation number.
 std::atomic<uint32_t> g_next_generation{1u};
 
+// The chunk of a rolling buffer which the current thread allocates records from.
+struct ThreadChunk {
+  // Identifies the rolling buffer the chunk belongs to.
+  uint32_t generation{0u};
+  uint32_t epoch{0u};
+  uint32_t wrapped_count{0u};
+
+  uint8_t* current{nullptr};
+  uint8_t* end{nullptr};
+};
+thread_local ThreadChunk tls_thread_chunk{};
+
+// Writes a padding record over |num_bytes| at |ptr|.
+void WritePaddingRecord(uint8_t* ptr, size_t num_bytes) {
+  ZX_DEBUG_ASSERT((num_bytes & 7) == 0);
+  ZX_DEBUG_ASSERT(num_bytes <= RecordFields::kMaxRecordSizeBytes);
+  if (num_bytes != 0) {
+    *reinterpret_cast<uint64_t*>(ptr) =
+        RecordFields::Type::Make(ToUnderlyingType(RecordType::kMetadata)) |
+        RecordFields::RecordSize::Make(BytesToWords(num_bytes)) |
+        MetadataRecordFields::MetadataType::Make(ToUnderlyingType(MetadataType::kPadding));
+  }
+}
+
 }  // namespace
 }  // namespace trace
 
@@ -109,10 +150,44 @@ trace_context::trace_context(void* buffer, size_t buffer_num_bytes,
 trace_context::~trace_context() = default;
 
 uint64_t* trace_context::AllocRecord(size_t num_bytes) {
+  ZX_DEBUG_ASSERT((num_bytes & 7) == 0);
+  if (likely(use_thread_chunks_ && num_bytes <= kMaxThreadChunkRecordSize)) {
+    return AllocThreadChunkRecord(num_bytes);
+  }
+  return AllocSharedRecord(num_bytes, nullptr);
+}
+
+uint64_t* trace_context::AllocThreadChunkRecord(size_t num_bytes) {
+  trace::ThreadChunk& chunk = trace::tls_thread_chunk;
+  uint32_t epoch = rolling_buffer_epoch_.load(std::memory_order_relaxed);
+  if (unlikely(chunk.generation != generation_ || chunk.epoch != epoch ||
+               chunk.wrapped_count != CurrentWrappedCount() ||
+               static_cast<size_t>(chunk.end - chunk.current) < num_bytes)) {
+    // The remainder of the previous chunk, if any, is already covered by a padding record.
+    uint32_t wrapped_count;
+    uint64_t* start = AllocSharedRecord(kThreadChunkSize, &wrapped_count);
+    if (unlikely(!start)) {
+      return nullptr;
+    }
+    chunk.generation = generation_;
+    chunk.epoch = epoch;
+    chunk.wrapped_count = wrapped_count;
+    chunk.current = reinterpret_cast<uint8_t*>(start);
+    chunk.end = chunk.current + kThreadChunkSize;
+  }
+
+  uint8_t* ptr = chunk.current;
+  chunk.current += num_bytes;
+  trace::WritePaddingRecord(chunk.current, chunk.end - chunk.current);
+  return reinterpret_cast<uint64_t*>(ptr);
+}
+
+uint64_t* trace_context::AllocSharedRecord(size_t num_bytes, uint32_t* out_wrapped_count) {
   ZX_DEBUG_ASSERT((num_bytes & 7) == 0);
   if (unlikely(num_bytes > TRACE_ENCODED_INLINE_LARGE_RECORD_MAX_SIZE))
     return nullptr;
   static_assert(TRACE_ENCODED_INLINE_LARGE_RECORD_MAX_SIZE < kMaxRollingBufferSize, "");
+  static_assert(kThreadChunkSize <= TRACE_ENCODED_INLINE_LARGE_RECORD_MAX_SIZE, "");
 
   // For the circular and streaming cases, try at most once for each buffer.
   // Note: Keep the normal case of one successful pass the fast path.
@@ -128,6 +203,9 @@ uint64_t* trace_context::AllocRecord(size_t num_bytes) {
     // Note: There's no worry of an overflow in the calcs here.
     if (likely(buffer_offset + num_bytes <= rolling_buffer_size_)) {
       uint8_t* ptr = rolling_buffer_start_[buffer_number] + buffer_offset;
+      if (out_wrapped_count) {
+        *out_wrapped_count = wrapped_count;
+      }
       return reinterpret_cast<uint64_t*>(ptr);  // success!
     }
 
@@ -364,6 +442,7 @@ void trace_context::ComputeBufferSizes() {
     default:
       __UNREACHABLE;
   }
+  use_thread_chunks_ = rolling_buffer_size_ >= kMinThreadChunksPerBuffer * kThreadChunkSize;
 }
 
 void trace_context::ResetDurableBufferPointers() {
@@ -372,6 +451,7 @@ void trace_context::ResetDurableBufferPointers() {
 }
 
 void trace_context::ResetRollingBufferPointers() {
+  rolling_buffer_epoch_.fetch_add(1u, std::memory_order_relaxed);
   rolling_buffer_current_.store(0);
   rolling_buffer_full_mark_[0].store(0);
   rolling_buffer_full_mark_[1].store(0);
@@ -12,6 +12,7 @@
 
 #include <lib/trace-engine/buffer_internal.h>
 #include <lib/trace-engine/context.h>
+#include <lib/trace-engine/fields.h>
 #include <lib/trace-engine/handler.h>
 #include <lib/zx/event.h>
 
@@ -93,6 +94,9 @@ struct trace_context {
   void ClearRollingBuffers();
   void UpdateBufferHeaderAfterStopped();
 
+  // Records of up to |kMaxThreadChunkRecordSize| bytes are carved out of a chunk of the rolling
+  // buffer reserved by the calling thread, so that threads don't all contend on
+  // |rolling_buffer_current_|. Larger records are allocated from the shared buffer directly.
   uint64_t* AllocRecord(size_t num_bytes);
   uint64_t* AllocDurableRecord(size_t num_bytes);
   bool AllocThreadIndex(trace_thread_index_t* out_index);
@@ -189,6 +193,21 @@ struct trace_context {
                     kMinDurableBufferSize,
                 "");
 
+  // The size of the chunk of the rolling buffer which each thread reserves at a time.
+  static constexpr size_t kThreadChunkSize = 4096;
+
+  // The largest record which is allocated from a thread's chunk. Capping this bounds the space
+  // left unused at the end of chunks.
+  static constexpr size_t kMaxThreadChunkRecordSize = kThreadChunkSize / 8;
+
+  // Threads only reserve chunks when each rolling buffer holds at least this many of them.
+  // Otherwise records of all threads are allocated from the shared buffer, as chunks left
+  // partially used by idle threads would waste too much of a small buffer.
+  static constexpr size_t kMinThreadChunksPerBuffer = 64;
+
+  static_assert(kThreadChunkSize <= trace::RecordFields::kMaxRecordSizeBytes,
+                "the unused part of a chunk must fit in one padding record");
+
   static uintptr_t GetBufferOffset(uint64_t offset_plus_counter) {
     return offset_plus_counter & ((1ul << kBufferOffsetBits) - 1);
   }
@@ -224,6 +243,12 @@ struct trace_context {
 
   void ComputeBufferSizes();
 
+  uint64_t* AllocThreadChunkRecord(size_t num_bytes);
+
+  // Allocates |num_bytes| from the current rolling buffer, switching buffers as necessary.
+  // Returns the wrapped count of the buffer allocated from in |out_wrapped_count|, if non-null.
+  uint64_t* AllocSharedRecord(size_t num_bytes, uint32_t* out_wrapped_count);
+
   void MarkDurableBufferFull(uint64_t last_offset);
 
   void MarkOneshotBufferFull(uint64_t last_offset);
@@ -281,6 +306,12 @@ struct trace_context {
   // The size of both rolling buffers.
   size_t rolling_buffer_size_;
 
+  // True if threads allocate records from chunks they reserve in the rolling buffers.
+  bool use_thread_chunks_;
+
+  // Incremented whenever the rolling buffers are reset, which invalidates all thread chunks.
+  std::atomic<uint32_t> rolling_buffer_epoch_{0u};
+
   // Current allocation pointer for durable records.
   // This only used in circular and streaming modes.
   // Starts at |durable_buffer_start| and grows from there.
@@ -370,6 +370,8 @@ enum class MetadataType {
   kProviderSection = 2,
   kProviderEvent = 3,
   kTraceInfo = 4,
+  // Fills space in a buffer which holds no records. Readers skip it.
+  kPadding = 5,
 };
 
 // Enumerates all provider events.
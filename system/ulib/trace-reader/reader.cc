@@ -179,6 +179,9 @@ bool TraceReader::ReadMetadataRecord(Chunk& record, RecordHeader header) {
       }
       break;
     }
+    case MetadataType::kPadding:
+      // Fills unused space in the buffer.
+      break;
     default: {
       // Ignore unknown metadata types for forward compatibility.
       ReportError(
@@ -278,6 +278,8 @@ void MetadataContent::Destroy() {
     case MetadataType::kTraceInfo:
       trace_info_.~TraceInfo();
       break;
+    case MetadataType::kPadding:
+      break;
   }
 }
 
@@ -296,6 +298,8 @@ void MetadataContent::MoveFrom(MetadataContent&& other) {
     case MetadataType::kTraceInfo:
       new (&trace_info_) TraceInfo(std::move(other.trace_info_));
       break;
+    case MetadataType::kPadding:
+      break;
   }
 }
 
@@ -323,6 +327,9 @@ fbl::String MetadataContent::ToString() const {
     case MetadataType::kTraceInfo: {
       return fbl::StringPrintf("TraceInfo(content: %s)", trace_info_.content.ToString().c_str());
     }
+    case MetadataType::kPadding:
+      // Padding is never reported as a record.
+      break;
   }
   ZX_ASSERT(false);
 }
@@ -8,6 +8,7 @@
 
 #include <fbl/algorithm.h>
 #include <fbl/vector.h>
+#include <trace-engine/fields.h>
 #include <zxtest/zxtest.h>
 
 #include <utility>
@@ -149,6 +150,33 @@ TEST(TraceReader, EmptyBuffer) {
   EXPECT_TRUE(error.empty());
 }
 
+TEST(TraceReader, PaddingIsSkipped) {
+  fbl::Vector<trace::Record> records;
+  fbl::String error;
+  trace::TraceReader reader(test::MakeRecordConsumer(&records), test::MakeErrorHandler(&error));
+
+  uint64_t kData[] = {
+      // A padding record of three words, whose contents are ignored.
+      RecordFields::Type::Make(ToUnderlyingType(RecordType::kMetadata)) |
+          RecordFields::RecordSize::Make(3) |
+          MetadataRecordFields::MetadataType::Make(ToUnderlyingType(MetadataType::kPadding)),
+      0xdeadbeef,
+      0xdeadbeef,
+      // An initialization record.
+      RecordFields::Type::Make(ToUnderlyingType(RecordType::kInitialization)) |
+          RecordFields::RecordSize::Make(2),
+      1000,
+  };
+
+  trace::Chunk chunk(kData, fbl::count_of(kData));
+  EXPECT_TRUE(reader.ReadRecords(chunk));
+  EXPECT_EQ(0u, chunk.remaining_words());
+  ASSERT_EQ(1u, records.size());
+  EXPECT_EQ(RecordType::kInitialization, records[0].type());
+  EXPECT_EQ(1000u, records[0].GetInitialization().ticks_per_second);
+  EXPECT_TRUE(error.empty());
+}
+
 // NOTE: Most of the reader is covered by the libtrace tests.
 
 }  // namespace
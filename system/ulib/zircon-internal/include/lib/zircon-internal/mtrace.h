@@ -16,6 +16,7 @@ __BEGIN_CDECLS
 // interim.
 #define MTRACE_KIND_INSNTRACE 0
 #define MTRACE_KIND_PERFMON 1
+#define MTRACE_KIND_SAMPLER 2
 
 // Actions for instruction tracing control
 
@@ -77,4 +78,29 @@ __BEGIN_CDECLS
 
 #define MTRACE_PERFMON_OPTIONS_CPU(options) ((options)&MTRACE_PERFMON_OPTIONS_CPU_MASK)
 
+// Actions for the sampling profiler control
+
+// Allocate the per-CPU sample buffers.
+// The argument is a sampler::Config struct, see <lib/sampler-abi.h>.
+// Must be called with sampling off.
+#define MTRACE_SAMPLER_INIT 0
+
+// Start taking samples on every CPU.
+// Must be called after INIT.
+#define MTRACE_SAMPLER_START 1
+
+// Stop taking samples.
+// May be called multiple times.
+#define MTRACE_SAMPLER_STOP 2
+
+// Read the sample buffer of the CPU given in options.
+// The argument receives a sampler::BufferHeader struct followed by as many
+// bytes of samples as fit.
+// Must be called with sampling off.
+#define MTRACE_SAMPLER_READ 3
+
+// Free the sample buffers, stopping sampling if needed.
+// May be called multiple times.
+#define MTRACE_SAMPLER_FINI 4
+
 __END_CDECLS
@@ -0,0 +1,14 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <zircon/compiler.h>
+#include <zircon/syscalls.h>
+
+#include "private.h"
+
+__EXPORT zx_duration_t _zx_system_get_mutex_spin_duration(void) {
+  return DATA_CONSTANTS.mutex_spin_duration;
+}
+
+VDSO_INTERFACE_FUNCTION(zx_system_get_mutex_spin_duration);
@@ -0,0 +1,50 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <lib/userabi/thread-stats.h>
+#include <zircon/compiler.h>
+#include <zircon/syscalls.h>
+#include <zircon/syscalls/object.h>
+
+#include "private.h"
+
+__EXPORT zx_status_t _zx_thread_read_stats(const void* stats_page, void* stats) {
+  if (stats_page == nullptr || stats == nullptr) {
+    return ZX_ERR_INVALID_ARGS;
+  }
+
+  auto page = static_cast<const thread_stats_page*>(stats_page);
+  zx_duration_t runtime;
+  zx_time_t running_since;
+  uint64_t context_switches;
+  uint32_t last_cpu;
+  uint64_t sequence;
+  do {
+    sequence = __atomic_load_n(&page->sequence, __ATOMIC_ACQUIRE);
+    if (sequence & 1) {
+      continue;
+    }
+    runtime = __atomic_load_n(&page->runtime, __ATOMIC_RELAXED);
+    running_since = __atomic_load_n(&page->running_since, __ATOMIC_RELAXED);
+    context_switches = __atomic_load_n(&page->context_switches, __ATOMIC_RELAXED);
+    last_cpu = __atomic_load_n(&page->last_cpu, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while ((sequence & 1) || __atomic_load_n(&page->sequence, __ATOMIC_RELAXED) != sequence);
+
+  // The page is only updated on context switches, so account for the time
+  // the thread has been running since it was last switched to.
+  if (running_since != 0) {
+    runtime = zx_duration_add_duration(
+        runtime, zx_time_sub_time(VDSO_zx_clock_get_monotonic(), running_since));
+  }
+
+  auto out = static_cast<zx_thread_stats_t*>(stats);
+  *out = {};
+  out->total_runtime = runtime;
+  out->context_switches = context_switches;
+  out->last_scheduled_cpu = last_cpu;
+  return ZX_OK;
+}
+
+VDSO_INTERFACE_FUNCTION(zx_thread_read_stats);
@@ -26,6 +26,9 @@ __BEGIN_CDECLS
 // |event| handle is an optional event object used with some |fuchsia.io.Node|
 // servers.
 //
+// |read_ring| is managed by zxio, and tracks whether large reads of a file go
+// through a |fuchsia.io.File| read ring.
+//
 // Will eventually be an implementation detail of zxio once fdio completes its
 // transition to the zxio backend.
 typedef struct zxio_remote {
@@ -33,6 +36,7 @@ typedef struct zxio_remote {
   zx_handle_t control;
   zx_handle_t event;
   zx_handle_t stream;
+  uintptr_t read_ring;
 } zxio_remote_t;
 
 static_assert(sizeof(zxio_remote_t) <= sizeof(zxio_storage_t),
@@ -256,6 +256,12 @@ typedef struct zxio_dirent {
   // This string is null terminated. Also, |name_length| is offered
   // as a convenience.
   char* name;
+
+  // The attributes of the entry, if the directory returned them together
+  // with the entry. Otherwise null.
+  //
+  // Valid for as long as |name|.
+  zxio_node_attributes_t* attributes;
 } zxio_dirent_t;
 
 #define ZXIO_DIRENT_SET(attr, field_name, value) \
@@ -4,19 +4,26 @@
 
 #include <dirent.h>
 #include <fuchsia/io/llcpp/fidl.h>
+#include <lib/sync/mutex.h>
 #include <lib/zx/channel.h>
+#include <lib/zx/fifo.h>
+#include <lib/zx/vmar.h>
 #include <lib/zxio/inception.h>
 #include <lib/zxio/null.h>
 #include <lib/zxio/ops.h>
 #include <sys/stat.h>
 #include <zircon/syscalls.h>
 
+#include <memory>
+
 #include "private.h"
 
 namespace fio = llcpp::fuchsia::io;
 
 namespace {
 
+zxio_node_attributes_t ToZxioNodeAttributes(fio::NodeAttributes attr);
+
 // Implementation of |zxio_dirent_iterator_t| for |fuchsia.io| v1.
 class DirentIteratorImpl {
  public:
@@ -24,7 +31,12 @@ class DirentIteratorImpl {
       : io_(reinterpret_cast<zxio_remote_t*>(io)), boxed_(std::make_unique<Boxed>()) {
     static_assert(offsetof(DirentIteratorImpl, io_) == 0,
                   "zxio_dirent_iterator_t requires first field of implementation to be zxio_t");
-    (void)opaque_;
+    zx_signals_t observed = 0;
+    zx::unowned_channel(io_->control)
+        ->wait_one(fio::DIRECTORY_SIGNAL_DIRENT_ATTRIBUTES, zx::time::infinite_past(), &observed);
+    if (observed & fio::DIRECTORY_SIGNAL_DIRENT_ATTRIBUTES) {
+      boxed_->attributes_buffers = std::make_unique<AttributesBuffers>();
+    }
   }
 
   ~DirentIteratorImpl() { fio::Directory::Call::Rewind(zx::unowned_channel(io_->control)); }
@@ -84,6 +96,16 @@ class DirentIteratorImpl {
     boxed_->current_entry.name_length = entry->size;
     memcpy(boxed_->current_entry_name, entry->name, entry->size);
     boxed_->current_entry_name[entry->size] = '\0';
+    if (attributes_index_ < attributes_count_) {
+      fio::DirentAttributes attributes;
+      memcpy(&attributes, attributes_ + attributes_index_ * sizeof(attributes),
+             sizeof(attributes));
+      if (attributes.s == ZX_OK) {
+        boxed_->current_attributes = ToZxioNodeAttributes(attributes.attributes);
+        boxed_->current_entry.attributes = &boxed_->current_attributes;
+      }
+    }
+    attributes_index_++;
     *out_entry = &boxed_->current_entry;
 
     return ZX_OK;
@@ -91,6 +113,9 @@ class DirentIteratorImpl {
 
  private:
   zx_status_t RemoteReadDirents() {
+    if (boxed_->attributes_buffers) {
+      return RemoteReadDirentsAttributes();
+    }
     auto result = fio::Directory::Call::ReadDirents(zx::unowned_channel(io_->control),
                                                     boxed_->request_buffer.view(), kBufferSize,
                                                     boxed_->response_buffer.view());
@@ -110,6 +135,31 @@ class DirentIteratorImpl {
     return ZX_OK;
   }
 
+  zx_status_t RemoteReadDirentsAttributes() {
+    AttributesBuffers& buffers = *boxed_->attributes_buffers;
+    auto result = fio::Directory::Call::ReadDirentsAttributes(
+        zx::unowned_channel(io_->control), buffers.request_buffer.view(), kBufferSize,
+        buffers.response_buffer.view());
+    if (result.status() != ZX_OK) {
+      return result.status();
+    }
+    fio::Directory::ReadDirentsAttributesResponse* response = result.Unwrap();
+    if (response->s != ZX_OK) {
+      return response->s;
+    }
+    const auto& dirents = response->dirents;
+    const auto& attributes = response->attributes;
+    if (dirents.count() > kBufferSize || attributes.count() % sizeof(fio::DirentAttributes) != 0) {
+      return ZX_ERR_IO;
+    }
+    data_ = dirents.data();
+    count_ = dirents.count();
+    attributes_ = attributes.data();
+    attributes_count_ = attributes.count() / sizeof(fio::DirentAttributes);
+    attributes_index_ = 0;
+    return ZX_OK;
+  }
+
   zxio_node_protocols_t DTypeToProtocols(uint8_t type) {
     switch (type) {
       case DT_BLK:
@@ -135,6 +185,13 @@ class DirentIteratorImpl {
   // The maximum buffer size that is supported by |fuchsia.io/Directory.ReadDirents|.
   static constexpr size_t kBufferSize = fio::MAX_BUF;
 
+  // Buffers used by |fuchsia.io/Directory.ReadDirentsAttributes|, allocated
+  // only for directories which support it.
+  struct AttributesBuffers {
+    fidl::Buffer<fio::Directory::ReadDirentsAttributesRequest> request_buffer;
+    fidl::Buffer<fio::Directory::ReadDirentsAttributesResponse> response_buffer;
+  };
+
   // This large structure is heap-allocated once, to be reused by subsequent
   // ReadDirents calls.
   struct Boxed {
@@ -143,12 +200,15 @@ class DirentIteratorImpl {
     // Buffers used by the FIDL calls.
     fidl::Buffer<fio::Directory::ReadDirentsRequest> request_buffer;
     fidl::Buffer<fio::Directory::ReadDirentsResponse> response_buffer;
+    std::unique_ptr<AttributesBuffers> attributes_buffers;
 
     // At each |zxio_dirent_iterator_next| call, we would extract the next
     // dirent segment from |response_buffer|, and populate |current_entry|
-    // and |current_entry_name|.
+    // and |current_entry_name|, and |current_attributes| if the directory
+    // returned attributes.
     zxio_dirent_t current_entry;
     char current_entry_name[fio::MAX_FILENAME + 1] = {};
+    zxio_node_attributes_t current_attributes;
   };
 
   zxio_remote_t* io_;
@@ -156,12 +216,276 @@ class DirentIteratorImpl {
   const uint8_t* data_ = nullptr;
   uint64_t count_ = 0;
   uint64_t index_ = 0;
-  uint64_t opaque_[3];
+  // The |fio::DirentAttributes| records of the current batch of dirents.
+  const uint8_t* attributes_ = nullptr;
+  uint64_t attributes_count_ = 0;
+  uint64_t attributes_index_ = 0;
 };
 
 static_assert(sizeof(zxio_dirent_iterator_t) == sizeof(DirentIteratorImpl),
               "zxio_dirent_iterator_t should match DirentIteratorImpl");
 
+// A position within a vector of buffers.
+class VectorCursor {
+ public:
+  VectorCursor(const zx_iovec_t* vector, size_t vector_count)
+      : vector_(vector), vector_count_(vector_count) {
+    SkipEmpty();
+  }
+
+  bool done() const { return index_ == vector_count_; }
+
+  // The contiguous bytes left in the current buffer.
+  uint8_t* current() const { return static_cast<uint8_t*>(vector_[index_].buffer) + offset_; }
+  size_t current_capacity() const { return vector_[index_].capacity - offset_; }
+
+  // The bytes left in all the buffers, up to |max|.
+  size_t remaining(size_t max) const {
+    size_t total = 0;
+    for (size_t i = index_; i < vector_count_ && total < max; ++i) {
+      total += vector_[i].capacity - (i == index_ ? offset_ : 0);
+    }
+    return std::min(total, max);
+  }
+
+  // Copies |size| bytes starting at the cursor into |buffer|, without advancing.
+  void Gather(uint8_t* buffer, size_t size) const {
+    VectorCursor cursor = *this;
+    cursor.ForEach(size, [&buffer](uint8_t* data, size_t chunk) {
+      memcpy(buffer, data, chunk);
+      buffer += chunk;
+    });
+  }
+
+  // Copies |size| bytes from |buffer| into the buffers starting at the cursor, without advancing.
+  void Scatter(const uint8_t* buffer, size_t size) const {
+    VectorCursor cursor = *this;
+    cursor.ForEach(size, [&buffer](uint8_t* data, size_t chunk) {
+      memcpy(data, buffer, chunk);
+      buffer += chunk;
+    });
+  }
+
+  void Advance(size_t size) { ForEach(size, [](uint8_t* data, size_t chunk) {}); }
+
+ private:
+  // Advances the cursor by |size| bytes, calling |fn| on each contiguous range passed over.
+  template <typename F>
+  void ForEach(size_t size, F fn) {
+    while (size > 0 && !done()) {
+      size_t chunk = std::min(size, current_capacity());
+      fn(current(), chunk);
+      size -= chunk;
+      offset_ += chunk;
+      SkipEmpty();
+    }
+  }
+
+  void SkipEmpty() {
+    while (index_ < vector_count_ && offset_ == vector_[index_].capacity) {
+      index_++;
+      offset_ = 0;
+    }
+  }
+
+  const zx_iovec_t* vector_;
+  size_t vector_count_;
+  size_t index_ = 0;
+  size_t offset_ = 0;
+};
+
+// Client end of a |fuchsia.io/File| read ring.
+//
+// The shared buffer is split into |kSlots| slots, and a read keeps an entry
+// in flight on the FIFO for each of them, so the server reads the next part
+// of the file while the client copies the previous one out of the buffer.
+// Vectored reads are scattered from the shared buffer, so they take no more
+// round trips than plain ones.
+//
+// A round trip costs three syscalls (write, wait and read the FIFO) where a
+// channel read costs one, so the ring only pays off for reads which would
+// take several channel reads.
+//
+// Reads on one ring are serialized, since replies come back in order and are
+// not tagged with their reader.
+//
+// If the FIFO fails, the ring marks itself broken and callers go back to the
+// channel.
+class ReadRing {
+ public:
+  static constexpr uint64_t kSize = 128 * 1024;
+  static constexpr size_t kSlots = 4;
+  static constexpr uint32_t kSlotSize = kSize / kSlots;
+  static_assert(kSlots <= fio::READ_RING_FIFO_DEPTH);
+
+  // Acquires a ring for the file served over |control|. Returns
+  // |ZX_ERR_NOT_SUPPORTED| if the server does not offer read rings.
+  static zx_status_t Create(zx::unowned_channel control, std::unique_ptr<ReadRing>* out_ring) {
+    zx_signals_t observed = 0;
+    control->wait_one(fio::FILE_SIGNAL_READ_RING, zx::time::infinite_past(), &observed);
+    if (!(observed & fio::FILE_SIGNAL_READ_RING)) {
+      return ZX_ERR_NOT_SUPPORTED;
+    }
+    auto result = fio::File::Call::GetReadRing(std::move(control), kSize);
+    zx_status_t status;
+    if ((status = result.status()) != ZX_OK) {
+      return status;
+    }
+    if ((status = result->s) != ZX_OK) {
+      return status;
+    }
+    if (!result->buffer.is_valid() || !result->fifo.is_valid()) {
+      return ZX_ERR_IO;
+    }
+    zx_vaddr_t addr;
+    status = zx::vmar::root_self()->map(0, result->buffer, 0, kSize, ZX_VM_PERM_READ, &addr);
+    if (status != ZX_OK) {
+      return status;
+    }
+    *out_ring = std::unique_ptr<ReadRing>(
+        new ReadRing(std::move(result->fifo), reinterpret_cast<const uint8_t*>(addr)));
+    return ZX_OK;
+  }
+
+  ReadRing(const ReadRing&) = delete;
+  ReadRing& operator=(const ReadRing&) = delete;
+
+  ~ReadRing() { zx::vmar::root_self()->unmap(reinterpret_cast<zx_vaddr_t>(data_), kSize); }
+
+  // Whether the FIFO has failed. A broken ring is never used again.
+  bool broken() const { return __atomic_load_n(&broken_, __ATOMIC_ACQUIRE); }
+
+  // Reads into the buffers of |vector|. |flags| and |offset| are passed
+  // through to the server in each |fio::ReadRingEntry|. Without
+  // |fio::READ_RING_FLAG_SEEK|, |offset| is advanced past the data asked for
+  // by each entry.
+  //
+  // Fails with |broken()| set if the FIFO failed before any data was read; the
+  // read should then be retried over the channel.
+  zx_status_t Read(uint32_t flags, uint64_t offset, const zx_iovec_t* vector, size_t vector_count,
+                   size_t* out_actual) {
+    const bool seek = flags & fio::READ_RING_FLAG_SEEK;
+    sync_mutex_lock(&lock_);
+    VectorCursor cursor(vector, vector_count);
+    // The bytes of |vector| which no entry has asked for yet.
+    size_t unrequested = cursor.remaining(SIZE_MAX);
+    // Entry |i| of this read uses slot |i % kSlots|, and replies come back in order, so the
+    // entries in flight are those from |received| to |sent|.
+    size_t sent = 0;
+    size_t received = 0;
+    uint32_t requested[kSlots];
+    // Set once the read has come up short or failed, after which no more entries are sent.
+    bool stopped = false;
+    size_t total = 0;
+    zx_status_t status = ZX_OK;
+    while (true) {
+      fio::ReadRingEntry entries[kSlots];
+      size_t count = 0;
+      while (!stopped && unrequested > 0 && sent - received < kSlots) {
+        const size_t slot = sent % kSlots;
+        requested[slot] = static_cast<uint32_t>(std::min<size_t>(unrequested, kSlotSize));
+        entries[count++] = {
+            .offset = offset,
+            .buffer_offset = static_cast<uint32_t>(slot * kSlotSize),
+            .count = requested[slot],
+            .flags = flags,
+            .status = ZX_OK,
+        };
+        if (!seek) {
+          offset += requested[slot];
+        }
+        unrequested -= requested[slot];
+        sent++;
+      }
+      zx_status_t io_status = ZX_OK;
+      if (count > 0) {
+        io_status = fifo_.write(sizeof(entries[0]), entries, count, nullptr);
+      }
+      if (io_status == ZX_OK && received != sent) {
+        io_status = Receive(entries, sent - received, &count);
+      }
+      if (io_status != ZX_OK) {
+        __atomic_store_n(&broken_, true, __ATOMIC_RELEASE);
+        status = io_status;
+        break;
+      }
+      if (received == sent) {
+        break;
+      }
+
+      for (size_t i = 0; i < count; i++, received++) {
+        const fio::ReadRingEntry& reply = entries[i];
+        const size_t slot = received % kSlots;
+        if (reply.buffer_offset != slot * kSlotSize || reply.count > requested[slot]) {
+          __atomic_store_n(&broken_, true, __ATOMIC_RELEASE);
+          status = ZX_ERR_IO;
+          break;
+        }
+        // Entries which read at an explicit offset may only be used up to the first one which
+        // came up short. Entries which read at the seek offset each continue where the previous
+        // one ended, so all of their data is used, as the server has moved the seek offset past
+        // it.
+        if (stopped && !seek) {
+          continue;
+        }
+        if (reply.status != ZX_OK) {
+          if (total == 0 && status == ZX_OK) {
+            status = reply.status;
+          }
+          stopped = true;
+          continue;
+        }
+        cursor.Scatter(data_ + reply.buffer_offset, reply.count);
+        cursor.Advance(reply.count);
+        total += reply.count;
+        if (reply.count != requested[slot]) {
+          stopped = true;
+        }
+      }
+      if (broken()) {
+        break;
+      }
+    }
+    sync_mutex_unlock(&lock_);
+    if (total == 0 && status != ZX_OK) {
+      return status;
+    }
+    *out_actual = total;
+    return ZX_OK;
+  }
+
+ private:
+  ReadRing(zx::fifo fifo, const uint8_t* data) : fifo_(std::move(fifo)), data_(data) {}
+
+  // Waits for replies, and reads up to |capacity| of them into |entries|.
+  zx_status_t Receive(fio::ReadRingEntry* entries, size_t capacity, size_t* out_count)
+      __TA_REQUIRES(lock_) {
+    zx_signals_t observed;
+    zx_status_t status = fifo_.wait_one(ZX_FIFO_READABLE | ZX_FIFO_PEER_CLOSED,
+                                        zx::time::infinite(), &observed);
+    if (status != ZX_OK) {
+      return status;
+    }
+    if (!(observed & ZX_FIFO_READABLE)) {
+      return ZX_ERR_PEER_CLOSED;
+    }
+    return fifo_.read(sizeof(entries[0]), entries, capacity, out_count);
+  }
+
+  sync_mutex_t lock_;
+  zx::fifo fifo_ __TA_GUARDED(lock_);
+  const uint8_t* const data_;
+  bool broken_ = false;
+};
+
+// Only reads larger than this go through a read ring: anything smaller takes
+// at most two channel reads, which is cheaper than a ring round trip.
+constexpr size_t kReadRingMinimumRead = 2 * fio::MAX_BUF;
+
+// The value of |zxio_remote_t::read_ring| while a ring is being acquired, or
+// once the server has declined to provide one.
+constexpr uintptr_t kReadRingUnavailable = 1;
+
 // C++ wrapper around zxio_remote_t.
 class Remote {
  public:
@@ -189,6 +513,41 @@ class Remote {
       zx_handle_close(rio_->stream);
       rio_->stream = ZX_HANDLE_INVALID;
     }
+    if (rio_->read_ring > kReadRingUnavailable) {
+      delete reinterpret_cast<ReadRing*>(rio_->read_ring);
+    }
+    rio_->read_ring = 0;
+  }
+
+  // Returns the read ring of the file, or nullptr if reads of |capacity| bytes
+  // should go over the channel.
+  //
+  // Acquires a ring on the first read large enough for it to pay off.
+  // Concurrent callers race to acquire it, and the losers use the channel in
+  // the meantime.
+  ReadRing* read_ring(size_t capacity) {
+    if (capacity <= kReadRingMinimumRead) {
+      return nullptr;
+    }
+    uintptr_t ring = __atomic_load_n(&rio_->read_ring, __ATOMIC_ACQUIRE);
+    if (ring > kReadRingUnavailable) {
+      ReadRing* read_ring = reinterpret_cast<ReadRing*>(ring);
+      return read_ring->broken() ? nullptr : read_ring;
+    }
+    if (ring == kReadRingUnavailable) {
+      return nullptr;
+    }
+    if (!__atomic_compare_exchange_n(&rio_->read_ring, &ring, kReadRingUnavailable, false,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+      return nullptr;
+    }
+    std::unique_ptr<ReadRing> read_ring;
+    if (ReadRing::Create(control(), &read_ring) != ZX_OK) {
+      return nullptr;
+    }
+    __atomic_store_n(&rio_->read_ring, reinterpret_cast<uintptr_t>(read_ring.get()),
+                     __ATOMIC_RELEASE);
+    return read_ring.release();
   }
 
  private:
@@ -351,6 +710,13 @@ zxio_node_attributes_t ToZxioNodeAttributes(fio::NodeAttributes attr, ToZxioAbil
   return zxio_attr;
 }
 
+zxio_node_attributes_t ToZxioNodeAttributes(fio::NodeAttributes attr) {
+  if (S_ISDIR(attr.mode)) {
+    return ToZxioNodeAttributes(attr, ToZxioAbilitiesForDirectory());
+  }
+  return ToZxioNodeAttributes(attr, ToZxioAbilitiesForFile());
+}
+
 template <typename ToIo1ModePermissions>
 fio::NodeAttributes ToNodeAttributes(zxio_node_attributes_t attr, ToIo1ModePermissions to_io1) {
   return fio::NodeAttributes{
@@ -488,31 +854,58 @@ zx_status_t zxio_remote_attr_set(zxio_t* io, const zxio_node_attributes_t* attr)
   return zxio_common_attr_set(rio.control(), ToIo1ModePermissionsForFile(), attr);
 }
 
-template <typename F>
+static size_t zxio_vector_capacity(const zx_iovec_t* vector, size_t vector_count) {
+  size_t capacity = 0;
+  for (size_t i = 0; i < vector_count; ++i) {
+    capacity += vector[i].capacity;
+  }
+  return capacity;
+}
+
+// Performs the I/O described by |vector| with calls to |fn|, each transferring up to
+// |fio::MAX_BUF| bytes. Consecutive buffers smaller than that share a call through a bounce
+// buffer, so that vectored I/O does not cost a round trip per buffer.
+//
+// The bounce buffer is allocated on the heap, and only when some buffers are coalesced: |fn|
+// already puts a |fio::MAX_BUF| message buffer on the stack.
+template <bool kIsRead, typename F>
 static zx_status_t zxio_remote_do_vector(const Remote& rio, const zx_iovec_t* vector,
-                                         size_t vector_count, zxio_flags_t flags,
-                                         size_t* out_actual, F fn) {
-  return zxio_do_vector(vector, vector_count, out_actual,
-                        [&](void* data, size_t capacity, size_t* out_actual) {
-                          auto buffer = static_cast<uint8_t*>(data);
-                          size_t total = 0;
-                          while (capacity > 0) {
-                            size_t chunk = std::min(capacity, fio::MAX_BUF);
-                            size_t actual;
-                            zx_status_t status = fn(rio.control(), buffer, chunk, &actual);
-                            if (status != ZX_OK) {
-                              return status;
-                            }
-                            total += actual;
-                            if (actual != chunk) {
-                              break;
-                            }
-                            buffer += actual;
-                            capacity -= actual;
-                          }
-                          *out_actual = total;
-                          return ZX_OK;
-                        });
+                                         size_t vector_count, size_t* out_actual, F fn) {
+  std::unique_ptr<uint8_t[]> bounce;
+  VectorCursor cursor(vector, vector_count);
+  size_t total = 0;
+  while (!cursor.done()) {
+    size_t chunk = cursor.remaining(fio::MAX_BUF);
+    uint8_t* buffer = cursor.current();
+    bool bounced = chunk > cursor.current_capacity();
+    if (bounced) {
+      if (!bounce) {
+        bounce.reset(new uint8_t[fio::MAX_BUF]);
+      }
+      buffer = bounce.get();
+      if (!kIsRead) {
+        cursor.Gather(buffer, chunk);
+      }
+    }
+    size_t actual;
+    zx_status_t status = fn(rio.control(), buffer, chunk, &actual);
+    if (status != ZX_OK) {
+      if (total > 0) {
+        break;
+      }
+      return status;
+    }
+    if (kIsRead && bounced) {
+      cursor.Scatter(bounce.get(), actual);
+    }
+    cursor.Advance(actual);
+    total += actual;
+    if (actual != chunk) {
+      break;
+    }
+  }
+  *out_actual = total;
+  return ZX_OK;
 }
 
 zx_status_t zxio_remote_readv(zxio_t* io, const zx_iovec_t* vector, size_t vector_count,
@@ -526,8 +919,16 @@ zx_status_t zxio_remote_readv(zxio_t* io, const zx_iovec_t* vector, size_t vecto
     return rio.stream()->readv(0, vector, vector_count, out_actual);
   }
 
-  return zxio_remote_do_vector(
-      rio, vector, vector_count, flags, out_actual,
+  if (ReadRing* ring = rio.read_ring(zxio_vector_capacity(vector, vector_count)); ring != nullptr) {
+    zx_status_t status =
+        ring->Read(fio::READ_RING_FLAG_SEEK, 0, vector, vector_count, out_actual);
+    if (status == ZX_OK || !ring->broken()) {
+      return status;
+    }
+  }
+
+  return zxio_remote_do_vector<true>(
+      rio, vector, vector_count, out_actual,
       [](zx::unowned_channel control, uint8_t* buffer, size_t capacity, size_t* out_actual) {
         // Explicitly allocating message buffers to avoid heap allocation.
         fidl::Buffer<fio::File::ReadRequest> request_buffer;
@@ -563,8 +964,15 @@ zx_status_t zxio_remote_readv_at(zxio_t* io, zx_off_t offset, const zx_iovec_t*
     return rio.stream()->readv_at(0, offset, vector, vector_count, out_actual);
   }
 
-  return zxio_remote_do_vector(
-      rio, vector, vector_count, flags, out_actual,
+  if (ReadRing* ring = rio.read_ring(zxio_vector_capacity(vector, vector_count)); ring != nullptr) {
+    zx_status_t status = ring->Read(0, offset, vector, vector_count, out_actual);
+    if (status == ZX_OK || !ring->broken()) {
+      return status;
+    }
+  }
+
+  return zxio_remote_do_vector<true>(
+      rio, vector, vector_count, out_actual,
       [&offset](zx::unowned_channel control, uint8_t* buffer, size_t capacity, size_t* out_actual) {
         fidl::Buffer<fio::File::ReadAtRequest> request_buffer;
         fidl::Buffer<fio::File::ReadAtResponse> response_buffer;
@@ -600,8 +1008,8 @@ zx_status_t zxio_remote_writev(zxio_t* io, const zx_iovec_t* vector, size_t vect
     return rio.stream()->writev(0, vector, vector_count, out_actual);
   }
 
-  return zxio_remote_do_vector(
-      rio, vector, vector_count, flags, out_actual,
+  return zxio_remote_do_vector<false>(
+      rio, vector, vector_count, out_actual,
       [](zx::unowned_channel control, uint8_t* buffer, size_t capacity, size_t* out_actual) {
         // Explicitly allocating message buffers to avoid heap allocation.
         fidl::Buffer<fio::File::WriteRequest> request_buffer;
@@ -636,8 +1044,8 @@ zx_status_t zxio_remote_writev_at(zxio_t* io, zx_off_t offset, const zx_iovec_t*
     return rio.stream()->writev_at(0, offset, vector, vector_count, out_actual);
   }
 
-  return zxio_remote_do_vector(
-      rio, vector, vector_count, flags, out_actual,
+  return zxio_remote_do_vector<false>(
+      rio, vector, vector_count, out_actual,
       [&offset](zx::unowned_channel control, uint8_t* buffer, size_t capacity, size_t* out_actual) {
         // Explicitly allocating message buffers to avoid heap allocation.
         fidl::Buffer<fio::File::WriteAtRequest> request_buffer;
@@ -839,6 +1247,7 @@ zx_status_t zxio_remote_init(zxio_storage_t* storage, zx_handle_t control, zx_ha
   remote->control = control;
   remote->event = event;
   remote->stream = ZX_HANDLE_INVALID;
+  remote->read_ring = 0;
   return ZX_OK;
 }
 
@@ -908,6 +1317,7 @@ zx_status_t zxio_dir_init(zxio_storage_t* storage, zx_handle_t control) {
   remote->control = control;
   remote->event = ZX_HANDLE_INVALID;
   remote->stream = ZX_HANDLE_INVALID;
+  remote->read_ring = 0;
   return ZX_OK;
 }
 
@@ -981,6 +1391,7 @@ zx_status_t zxio_file_init(zxio_storage_t* storage, zx_handle_t control, zx_hand
   remote->control = control;
   remote->event = event;
   remote->stream = stream;
+  remote->read_ring = 0;
   return ZX_OK;
 }
 
@@ -7,8 +7,11 @@
 #include <stdint.h>
 #include <sys/stat.h>
 
+#include <atomic>
 #include <memory>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include <blobfs/format.h>
 #include <digest/digest.h>
@@ -117,9 +120,10 @@ fbl::String GetNameForOrder(ReadOrder order) {
   return "";
 }
 
-// Creates a an in memory blob.
+// Creates a an in memory blob. If |compressible| is set, the data is drawn from a small alphabet so
+// that blobfs stores the blob compressed.
 bool MakeBlob(fbl::String fs_path, size_t blob_size, unsigned int* seed,
-              std::unique_ptr<BlobInfo>* out) {
+              std::unique_ptr<BlobInfo>* out, bool compressible = false) {
   BEGIN_HELPER;
   // Generate a Blob of random data
   fbl::AllocChecker ac;
@@ -134,6 +138,9 @@ bool MakeBlob(fbl::String fs_path, size_t blob_size, unsigned int* seed,
   unsigned int initial_seed = rand_r(seed);
   for (size_t i = 0; i < blob_size; i++) {
     info->data[i] = static_cast<char>(rand_r(&initial_seed));
+    if (compressible) {
+      info->data[i] = static_cast<char>('a' + (info->data[i] & 0x7));
+    }
   }
   info->size_data = blob_size;
 
@@ -163,6 +170,68 @@ fbl::String GetNegativeLookupPath(const fbl::String& fs_path) {
   return negative_path;
 }
 
+// Measures how long it takes to write a single blob of |blob_size| bytes, from creation until the
+// data has been flushed. Most of this time is spent hashing and compressing the blob, so it scales
+// with the number of write threads blobfs is mounted with.
+bool LargeWriteTest(size_t blob_size, perftest::RepeatState* state, Fixture* fixture) {
+  BEGIN_HELPER;
+  state->DeclareStep("generate_blob");
+  state->DeclareStep("write");
+  state->DeclareStep("unlink");
+
+  std::unique_ptr<BlobInfo> new_blob;
+  while (state->KeepRunning()) {
+    MakeBlob(fixture->fs_path(), blob_size, fixture->mutable_seed(), &new_blob);
+    state->NextStep();
+
+    fbl::unique_fd fd(open(new_blob->path.c_str(), O_CREAT | O_RDWR));
+    ASSERT_TRUE(fd, strerror(errno));
+    ASSERT_EQ(ftruncate(fd.get(), blob_size), 0, strerror(errno));
+    ASSERT_EQ(StreamAll(write, fd.get(), new_blob->data.get(), blob_size), 0,
+              "Failed to write Data");
+    ASSERT_EQ(fsync(fd.get()), 0);
+    ASSERT_EQ(close(fd.release()), 0);
+    state->NextStep();
+
+    ASSERT_EQ(unlink(new_blob->path.c_str()), 0, strerror(errno));
+  }
+  END_HELPER;
+}
+
+// Measures small reads at random offsets into a large compressed blob, the access pattern of
+// database-like assets. Blobfs is mounted with ZSTD_SEEKABLE compression for these tests, and the
+// blob is closed after writing so that its data is dropped; each read then decompresses only the
+// frames under it, unless they are still in blobfs' decompressed frame cache.
+bool RandomReadTest(size_t blob_size, size_t read_size, perftest::RepeatState* state,
+                    Fixture* fixture) {
+  BEGIN_HELPER;
+  std::unique_ptr<BlobInfo> blob;
+  ASSERT_TRUE(MakeBlob(fixture->fs_path(), blob_size, fixture->mutable_seed(), &blob, true));
+  {
+    fbl::unique_fd fd(open(blob->path.c_str(), O_CREAT | O_RDWR));
+    ASSERT_TRUE(fd, strerror(errno));
+    ASSERT_EQ(ftruncate(fd.get(), blob_size), 0, strerror(errno));
+    ASSERT_EQ(StreamAll(write, fd.get(), blob->data.get(), blob_size), 0, "Failed to write Data");
+    ASSERT_EQ(fsync(fd.get()), 0);
+    ASSERT_EQ(close(fd.release()), 0);
+  }
+
+  fbl::unique_fd fd(open(blob->path.c_str(), O_RDONLY));
+  ASSERT_TRUE(fd, strerror(errno));
+  std::unique_ptr<char[]> buffer(new char[read_size]);
+  const size_t read_count = blob_size / read_size;
+  while (state->KeepRunning()) {
+    const off_t offset = (rand_r(fixture->mutable_seed()) % read_count) * read_size;
+    ASSERT_EQ(pread(fd.get(), buffer.get(), read_size, offset), static_cast<ssize_t>(read_size),
+              strerror(errno));
+    ASSERT_EQ(memcmp(buffer.get(), &blob->data[offset], read_size), 0);
+  }
+  fd.reset();
+
+  ASSERT_EQ(unlink(blob->path.c_str()), 0, strerror(errno));
+  END_HELPER;
+}
+
 class BlobfsTest {
  public:
   BlobfsTest(BlobfsInfo&& info) : info_(std::move(info)) {}
@@ -272,6 +341,40 @@ class BlobfsTest {
     END_HELPER;
   }
 
+  // Uses the blobs written by the API test to measure aggregate read throughput when
+  // |reader_count| threads open and read disjoint subsets of the blobs at the same time.
+  bool ConcurrentReadTest(uint32_t reader_count, perftest::RepeatState* state, Fixture* fixture) {
+    BEGIN_HELPER;
+    ASSERT_GT(info_.paths.size(), 0);
+    ASSERT_GT(reader_count, 0);
+
+    fbl::AllocChecker ac;
+    std::unique_ptr<char[]> buffers(new (&ac) char[reader_count * info_.blob_size]);
+    ASSERT_TRUE(ac.check());
+
+    while (state->KeepRunning()) {
+      std::atomic<bool> failed = false;
+      std::vector<std::thread> readers;
+      for (uint32_t reader = 0; reader < reader_count; ++reader) {
+        readers.emplace_back([this, reader, reader_count, &buffers, &failed]() {
+          char* buffer = &buffers[reader * info_.blob_size];
+          for (size_t i = reader; i < info_.paths.size(); i += reader_count) {
+            fbl::unique_fd fd(open(info_.paths[i].c_str(), O_RDONLY));
+            if (!fd || StreamAll(read, fd.get(), buffer, info_.blob_size) != 0) {
+              failed = true;
+              return;
+            }
+          }
+        });
+      }
+      for (auto& reader : readers) {
+        reader.join();
+      }
+      ASSERT_FALSE(failed.load(), "Concurrent read failed");
+    }
+    END_HELPER;
+  }
+
  private:
   void SortPathsByOrder(ReadOrder order, unsigned int* seed) {
     switch (order) {
@@ -324,6 +427,17 @@ bool RunBenchmark(int argc, char** argv) {
       ReadOrder::kSequentialReverse,
       ReadOrder::kRandom,
   };
+  // Concurrent readers only overlap inside blobfs when it is mounted with --serving_threads.
+  const uint32_t reader_counts[] = {1, 2, 4, 8};
+  // Compare runs with different values of --write_threads to see how writes scale.
+  const size_t large_blob_sizes[] = {
+      1024 * 1024,       // 1 MB
+      8 * 1024 * 1024,   // 8 MB
+      32 * 1024 * 1024,  // 32 MB
+  };
+  constexpr uint32_t kLargeWriteSampleCount = 10;
+  constexpr size_t kRandomReadBlobSize = 32 * 1024 * 1024;
+  const size_t random_read_sizes[] = {512, 4096, 64 * 1024};
 
   if (!fs_test_utils::ParseCommandLineArgs(argc, argv, &f_opts, &p_opts)) {
     return false;
@@ -375,13 +489,72 @@ bool RunBenchmark(int argc, char** argv) {
               blob_count * (blob_size + 2 * digest::kDefaultNodeSize + blobfs::kBlobfsInodeSize);
           testcase.tests.push_back(std::move(read_test));
         }
+        for (auto reader_count : reader_counts) {
+          TestInfo concurrent_read_test;
+          concurrent_read_test.name = fbl::StringPrintf(
+              "%s/%s/%luBlobs/ConcurrentRead%uThreads", disk_format_string_[f_opts.fs_type],
+              size.c_str(), blob_count, reader_count);
+          concurrent_read_test.test_fn = [test_index, reader_count, &blobfs_tests](
+                                             perftest::RepeatState* state,
+                                             fs_test_utils::Fixture* fixture) {
+            return blobfs_tests[test_index].ConcurrentReadTest(reader_count, state, fixture);
+          };
+          concurrent_read_test.required_disk_space =
+              blob_count * (blob_size + 2 * digest::kDefaultNodeSize + blobfs::kBlobfsInodeSize);
+          testcase.tests.push_back(std::move(concurrent_read_test));
+        }
       }
       testcases.push_back(std::move(testcase));
       ++test_index;
     }
   }
 
-  return fs_test_utils::RunTestCases(f_opts, p_opts, testcases);
+  TestCaseInfo write_testcase;
+  write_testcase.teardown = false;
+  write_testcase.sample_count = kLargeWriteSampleCount;
+  fbl::String write_threads = f_opts.write_threads > 0
+                                  ? fbl::StringPrintf("%uWriteThreads", f_opts.write_threads)
+                                  : fbl::String("DefaultWriteThreads");
+  for (auto blob_size : large_blob_sizes) {
+    TestInfo write_test;
+    write_test.name =
+        fbl::StringPrintf("%s/%s/LargeWrite/%s", disk_format_string_[f_opts.fs_type],
+                          GetNameForSize(blob_size).c_str(), write_threads.c_str());
+    write_test.test_fn = [blob_size](perftest::RepeatState* state,
+                                     fs_test_utils::Fixture* fixture) {
+      return LargeWriteTest(blob_size, state, fixture);
+    };
+    write_test.required_disk_space =
+        blob_size + 2 * digest::kDefaultNodeSize + blobfs::kBlobfsInodeSize;
+    write_testcase.tests.push_back(std::move(write_test));
+  }
+  testcases.push_back(std::move(write_testcase));
+
+  TestCaseInfo random_read_testcase;
+  random_read_testcase.teardown = false;
+  random_read_testcase.sample_count = kSampleCount;
+  for (auto read_size : random_read_sizes) {
+    TestInfo random_read_test;
+    random_read_test.name = fbl::StringPrintf(
+        "%s/%s/CompressedBlob/RandomRead%s", disk_format_string_[f_opts.fs_type],
+        GetNameForSize(kRandomReadBlobSize).c_str(), GetNameForSize(read_size).c_str());
+    random_read_test.test_fn = [read_size](perftest::RepeatState* state,
+                                           fs_test_utils::Fixture* fixture) {
+      return RandomReadTest(kRandomReadBlobSize, read_size, state, fixture);
+    };
+    random_read_test.required_disk_space =
+        kRandomReadBlobSize + 2 * digest::kDefaultNodeSize + blobfs::kBlobfsInodeSize;
+    random_read_testcase.tests.push_back(std::move(random_read_test));
+  }
+
+  // Random reads only avoid decompressing the whole blob in the zstd-seekable format.
+  FixtureOptions random_read_f_opts = f_opts;
+  random_read_f_opts.write_compression_algorithm = "ZSTD_SEEKABLE";
+  fbl::Vector<TestCaseInfo> random_read_testcases;
+  random_read_testcases.push_back(std::move(random_read_testcase));
+
+  return fs_test_utils::RunTestCases(f_opts, p_opts, testcases) &&
+         fs_test_utils::RunTestCases(random_read_f_opts, p_opts, random_read_testcases);
 }
 
 }  // namespace
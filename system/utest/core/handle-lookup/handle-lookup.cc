@@ -0,0 +1,133 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <lib/zx/channel.h>
+#include <lib/zx/clock.h>
+#include <lib/zx/event.h>
+#include <lib/zx/time.h>
+#include <stdio.h>
+#include <zircon/rights.h>
+#include <zircon/syscalls.h>
+
+#include <thread>
+#include <vector>
+
+#include <zxtest/zxtest.h>
+
+namespace {
+
+// Threads keep the handles they used recently in a cache. These tests check
+// that the cache never answers for a handle after it left the process.
+
+TEST(HandleLookupTest, HandleClosedByAnotherThreadIsInvalid) {
+  zx::event event;
+  ASSERT_OK(zx::event::create(0, &event));
+  ASSERT_OK(event.signal(0, ZX_USER_SIGNAL_0));
+
+  const zx_handle_t value = event.get();
+  std::thread closer([&event] { event.reset(); });
+  closer.join();
+
+  EXPECT_EQ(ZX_ERR_BAD_HANDLE, zx_object_signal(value, 0, ZX_USER_SIGNAL_0));
+}
+
+TEST(HandleLookupTest, ReplacedHandleHasNewRights) {
+  zx::event event;
+  ASSERT_OK(zx::event::create(0, &event));
+  ASSERT_OK(event.signal(0, ZX_USER_SIGNAL_0));
+
+  const zx_handle_t old_value = event.get();
+  zx::event replaced;
+  ASSERT_OK(event.replace(ZX_DEFAULT_EVENT_RIGHTS & ~ZX_RIGHT_SIGNAL, &replaced));
+
+  EXPECT_EQ(ZX_ERR_BAD_HANDLE, zx_object_signal(old_value, 0, ZX_USER_SIGNAL_0));
+  EXPECT_EQ(ZX_ERR_ACCESS_DENIED, replaced.signal(0, ZX_USER_SIGNAL_0));
+}
+
+TEST(HandleLookupTest, DuplicateStaysValidAfterClose) {
+  zx::event event;
+  ASSERT_OK(zx::event::create(0, &event));
+  zx::event duplicate;
+  ASSERT_OK(event.duplicate(ZX_RIGHT_SAME_RIGHTS, &duplicate));
+  ASSERT_OK(event.signal(0, ZX_USER_SIGNAL_0));
+  ASSERT_OK(duplicate.signal(0, ZX_USER_SIGNAL_0));
+
+  event.reset();
+  EXPECT_OK(duplicate.signal(ZX_USER_SIGNAL_0, 0));
+}
+
+// A thread that used a handle and went idle must not keep the object alive
+// after the handle is closed elsewhere.
+TEST(HandleLookupTest, ClosedHandleIsNotKeptAliveByIdleThread) {
+  zx::channel local, remote;
+  ASSERT_OK(zx::channel::create(0, &local, &remote));
+  zx::event used, done;
+  ASSERT_OK(zx::event::create(0, &used));
+  ASSERT_OK(zx::event::create(0, &done));
+
+  std::thread user([&] {
+    EXPECT_OK(local.signal(0, ZX_USER_SIGNAL_0));
+    EXPECT_OK(used.signal(0, ZX_USER_SIGNAL_0));
+    EXPECT_OK(done.wait_one(ZX_USER_SIGNAL_0, zx::time::infinite(), nullptr));
+  });
+  ASSERT_OK(used.wait_one(ZX_USER_SIGNAL_0, zx::time::infinite(), nullptr));
+
+  local.reset();
+  zx_signals_t observed = 0;
+  EXPECT_OK(remote.wait_one(ZX_CHANNEL_PEER_CLOSED, zx::time::infinite_past(), &observed));
+  EXPECT_TRUE(observed & ZX_CHANNEL_PEER_CLOSED);
+
+  ASSERT_OK(done.signal(0, ZX_USER_SIGNAL_0));
+  user.join();
+}
+
+// Measures the cost of a syscall that only looks up a handle, from one or more
+// threads of the same process.
+constexpr int kSignalsPerThread = 100000;
+
+void PrintRate(const char* name, int calls, zx::duration elapsed) {
+  printf("handle-lookup: %s: %d calls in %ld us, %ld ns/call\n", name, calls, elapsed.to_usecs(),
+         elapsed.get() / calls);
+}
+
+void SignalLoop(const zx::event& event) {
+  for (int i = 0; i < kSignalsPerThread; i++) {
+    event.signal(0, ZX_USER_SIGNAL_0);
+  }
+}
+
+TEST(HandleLookupBenchmark, SignalOneThread) {
+  zx::event event;
+  ASSERT_OK(zx::event::create(0, &event));
+
+  zx::time start = zx::clock::get_monotonic();
+  SignalLoop(event);
+  PrintRate("zx_object_signal, 1 thread", kSignalsPerThread, zx::clock::get_monotonic() - start);
+}
+
+// Every thread signals its own event, so the threads only share the handle
+// table of the process.
+TEST(HandleLookupBenchmark, SignalManyThreads) {
+  const uint32_t num_threads = zx_system_get_num_cpus();
+  std::vector<zx::event> events(num_threads);
+  for (auto& event : events) {
+    ASSERT_OK(zx::event::create(0, &event));
+  }
+
+  zx::time start = zx::clock::get_monotonic();
+  std::vector<std::thread> threads;
+  for (const auto& event : events) {
+    threads.emplace_back([&event] { SignalLoop(event); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  zx::duration elapsed = zx::clock::get_monotonic() - start;
+
+  char name[64];
+  snprintf(name, sizeof(name), "zx_object_signal, %u threads", num_threads);
+  PrintRate(name, kSignalsPerThread * num_threads, elapsed);
+}
+
+}  // namespace
@@ -58,6 +58,63 @@ TEST(PortTest, PortTimeout) {
   EXPECT_EQ(port.wait(zx::deadline_after(zx::nsec(1)), &packet), ZX_ERR_TIMED_OUT);
 }
 
+TEST(PortTest, WaitManyReturnsQueuedPacketsInOrder) {
+  zx::port port;
+  ASSERT_OK(zx::port::create(0u, &port));
+
+  constexpr size_t kQueued = 5;
+  for (uint64_t key = 0; key < kQueued; ++key) {
+    const zx_port_packet_t packet = {key, ZX_PKT_TYPE_USER, 0, {{}}};
+    ASSERT_OK(port.queue(&packet));
+  }
+
+  zx_port_packet_t out[kQueued + 3] = {};
+  size_t actual = 0;
+  ASSERT_OK(port.wait_many(zx::time::infinite(), out, fbl::count_of(out), &actual));
+  ASSERT_EQ(actual, kQueued);
+  for (uint64_t key = 0; key < kQueued; ++key) {
+    EXPECT_EQ(out[key].key, key);
+    EXPECT_EQ(out[key].type, ZX_PKT_TYPE_USER);
+  }
+
+  EXPECT_EQ(port.wait_many(zx::time::infinite_past(), out, fbl::count_of(out), &actual),
+            ZX_ERR_TIMED_OUT);
+}
+
+TEST(PortTest, WaitManyLeavesPacketsBeyondCount) {
+  zx::port port;
+  ASSERT_OK(zx::port::create(0u, &port));
+
+  constexpr size_t kQueued = ZX_PORT_WAIT_MANY_MAX_PACKETS + 4;
+  for (uint64_t key = 0; key < kQueued; ++key) {
+    const zx_port_packet_t packet = {key, ZX_PKT_TYPE_USER, 0, {{}}};
+    ASSERT_OK(port.queue(&packet));
+  }
+
+  zx_port_packet_t out[kQueued] = {};
+  size_t actual = 0;
+  ASSERT_OK(port.wait_many(zx::time::infinite(), out, 2, &actual));
+  EXPECT_EQ(actual, 2u);
+  EXPECT_EQ(out[1].key, 1u);
+
+  // Larger requests are clamped to the maximum batch size.
+  ASSERT_OK(port.wait_many(zx::time::infinite(), out, fbl::count_of(out), &actual));
+  EXPECT_EQ(actual, ZX_PORT_WAIT_MANY_MAX_PACKETS);
+  EXPECT_EQ(out[0].key, 2u);
+
+  ASSERT_OK(port.wait_many(zx::time::infinite(), out, fbl::count_of(out), &actual));
+  EXPECT_EQ(actual, kQueued - 2 - ZX_PORT_WAIT_MANY_MAX_PACKETS);
+}
+
+TEST(PortTest, WaitManyZeroPacketsReturnsInvalidArgs) {
+  zx::port port;
+  ASSERT_OK(zx::port::create(0u, &port));
+
+  zx_port_packet_t packet = {};
+  size_t actual = 0;
+  EXPECT_EQ(port.wait_many(zx::time::infinite_past(), &packet, 0, &actual), ZX_ERR_INVALID_ARGS);
+}
+
 TEST(PortTest, QueueAndClose) {
   zx::port port;
   ASSERT_OK(zx::port::create(0u, &port));
@@ -5,12 +5,15 @@
 #include <inttypes.h>
 #include <lib/sync/mutex.h>
 #include <lib/zircon-internal/thread_annotations.h>
+#include <pthread.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <threads.h>
+#include <zircon/process.h>
 #include <zircon/syscalls.h>
+#include <zircon/syscalls/object.h>
 #include <zircon/time.h>
 #include <zircon/types.h>
 
@@ -200,3 +203,84 @@ TEST(SyncMutex, NoRecursion) {
     sync_mutex_lock(&mutex);
   });
 }
+
+TEST(SyncMutex, SpinDurationHint) {
+  zx_duration_t spin_duration = zx_system_get_mutex_spin_duration();
+  EXPECT_GE(spin_duration, 0);
+  if (zx_system_get_num_cpus() == 1) {
+    EXPECT_EQ(spin_duration, 0, "spinning cannot help with a single CPU");
+  }
+}
+
+// Runs |kThreads| threads which repeatedly take |Lock|, hold it for a short
+// critical section, and release it.  Reports the throughput and the CPU time
+// spent, which is where spinning costs show up.  Compare against a boot with
+// vdso.mutex_spin_ns=0 to see what adaptive spinning buys.
+template <typename Lock>
+struct ContentionBenchmark {
+  static constexpr int kThreads = 4;
+  static constexpr int kIterations = 20000;
+
+  Lock lock;
+  uint64_t counter = 0;
+
+  static int Thread(void* arg) {
+    auto self = static_cast<ContentionBenchmark*>(arg);
+    for (int i = 0; i < kIterations; i++) {
+      self->lock.Acquire();
+      // A critical section of a few hundred nanoseconds.
+      for (int j = 0; j < 64; j++) {
+        __atomic_fetch_add(&self->counter, 1, __ATOMIC_RELAXED);
+      }
+      self->lock.Release();
+    }
+    zx_info_thread_stats_t stats;
+    zx_status_t status = zx_object_get_info(zx_thread_self(), ZX_INFO_THREAD_STATS, &stats,
+                                            sizeof(stats), nullptr, nullptr);
+    return status == ZX_OK ? static_cast<int>(stats.total_runtime / ZX_USEC(1)) : -1;
+  }
+
+  void Run(const char* name) {
+    thrd_t threads[kThreads];
+    zx_time_t start = zx_clock_get_monotonic();
+    for (auto& thread : threads) {
+      ASSERT_EQ(thrd_create(&thread, Thread, this), thrd_success);
+    }
+    int64_t cpu_us = 0;
+    for (auto& thread : threads) {
+      int thread_cpu_us;
+      ASSERT_EQ(thrd_join(thread, &thread_cpu_us), thrd_success);
+      ASSERT_GE(thread_cpu_us, 0);
+      cpu_us += thread_cpu_us;
+    }
+    zx_duration_t elapsed = zx_time_sub_time(zx_clock_get_monotonic(), start);
+    EXPECT_EQ(counter, uint64_t{kThreads} * kIterations * 64);
+
+    uint64_t acquisitions = uint64_t{kThreads} * kIterations;
+    printf("%s: %d threads, %" PRIu64 " acquisitions in %" PRId64 " us (%" PRIu64
+           " per ms), %" PRId64 " us of CPU, spin hint %" PRId64 " ns\n",
+           name, kThreads, acquisitions, elapsed / ZX_USEC(1),
+           acquisitions * ZX_MSEC(1) / (elapsed > 0 ? elapsed : 1), cpu_us,
+           zx_system_get_mutex_spin_duration());
+  }
+};
+
+struct SyncMutexLock {
+  sync_mutex_t mutex = {};
+  void Acquire() TA_NO_THREAD_SAFETY_ANALYSIS { sync_mutex_lock(&mutex); }
+  void Release() TA_NO_THREAD_SAFETY_ANALYSIS { sync_mutex_unlock(&mutex); }
+};
+
+struct PthreadMutexLock {
+  pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+  void Acquire() { pthread_mutex_lock(&mutex); }
+  void Release() { pthread_mutex_unlock(&mutex); }
+};
+
+TEST(SyncMutex, ContentionBenchmark) {
+  ContentionBenchmark<SyncMutexLock> sync_benchmark;
+  ASSERT_NO_FATAL_FAILURES(sync_benchmark.Run("sync_mutex_t"));
+
+  ContentionBenchmark<PthreadMutexLock> pthread_benchmark;
+  ASSERT_NO_FATAL_FAILURES(pthread_benchmark.Run("pthread_mutex_t"));
+}
@@ -399,6 +399,59 @@ TEST(Threads, GetLastScheduledCpu) {
   ASSERT_EQ(zx_handle_close(thread_h), ZX_OK);
 }
 
+TEST(Threads, ReadStatsFromStatsVmo) {
+  zx_handle_t vmo;
+  ASSERT_EQ(zx_thread_get_stats_vmo(zx_thread_self(), &vmo), ZX_OK);
+  uintptr_t page;
+  ASSERT_EQ(zx_vmar_map(zx_vmar_root_self(), ZX_VM_PERM_READ, 0, vmo, 0, ZX_PAGE_SIZE, &page),
+            ZX_OK);
+
+  // The page is written by the kernel only.
+  uint8_t byte = 0;
+  ASSERT_EQ(zx_vmo_write(vmo, &byte, 0, sizeof(byte)), ZX_ERR_ACCESS_DENIED);
+
+  ASSERT_EQ(zx_thread_read_stats(nullptr, nullptr), ZX_ERR_INVALID_ARGS);
+
+  // The stats read through the vDSO must agree with, and never run behind, the
+  // stats read through the kernel.
+  zx_info_thread_stats_t info;
+  ASSERT_EQ(zx_object_get_info(zx_thread_self(), ZX_INFO_THREAD_STATS, &info, sizeof(info),
+                               nullptr, nullptr),
+            ZX_OK);
+  zx_thread_stats_t stats;
+  ASSERT_EQ(zx_thread_read_stats(reinterpret_cast<const void*>(page), &stats), ZX_OK);
+  EXPECT_GE(stats.total_runtime, info.total_runtime);
+  EXPECT_GT(stats.context_switches, 0);
+  EXPECT_LT(stats.last_scheduled_cpu, ZX_CPU_SET_MAX_CPUS);
+
+  // Blocking switches the thread away and back again.
+  const uint64_t context_switches = stats.context_switches;
+  ASSERT_EQ(zx_nanosleep(zx_deadline_after(ZX_MSEC(1))), ZX_OK);
+  zx_thread_stats_t later;
+  ASSERT_EQ(zx_thread_read_stats(reinterpret_cast<const void*>(page), &later), ZX_OK);
+  EXPECT_GT(later.context_switches, context_switches);
+  EXPECT_GE(later.total_runtime, stats.total_runtime);
+
+  // Compare the cost of the two ways of reading the stats.
+  constexpr int kIterations = 10000;
+  zx_time_t start = zx_clock_get_monotonic();
+  for (int i = 0; i < kIterations; i++) {
+    zx_thread_read_stats(reinterpret_cast<const void*>(page), &stats);
+  }
+  const zx_duration_t vdso_ns = zx_clock_get_monotonic() - start;
+  start = zx_clock_get_monotonic();
+  for (int i = 0; i < kIterations; i++) {
+    zx_object_get_info(zx_thread_self(), ZX_INFO_THREAD_STATS, &info, sizeof(info), nullptr,
+                       nullptr);
+  }
+  const zx_duration_t syscall_ns = zx_clock_get_monotonic() - start;
+  printf("zx_thread_read_stats: %ld ns/call, ZX_INFO_THREAD_STATS: %ld ns/call\n",
+         vdso_ns / kIterations, syscall_ns / kIterations);
+
+  ASSERT_EQ(zx_vmar_unmap(zx_vmar_root_self(), page, ZX_PAGE_SIZE), ZX_OK);
+  ASSERT_EQ(zx_handle_close(vmo), ZX_OK);
+}
+
 TEST(Threads, GetAffinity) {
   // Create a thread.
   zxr_thread_t thread;
@@ -0,0 +1,190 @@
+// Copyright 2020 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <lib/fidl/coding.h>
+#include <lib/fidl/internal.h>
+#include <stdio.h>
+#include <string.h>
+#include <zircon/syscalls.h>
+
+#include <initializer_list>
+
+#include <unittest/unittest.h>
+
+#include "extra_messages.h"
+
+namespace fidl {
+namespace {
+
+// Compares the coding routines fidlc generates for inline-only structs against
+// the generic walker, which is used when the coding table has no such routines.
+
+constexpr uint32_t kInlineCodingStructSize = 32;
+constexpr uint32_t kIterations = 100000;
+
+// An encoded fidl.test.coding/InlineCodingStruct.
+alignas(FIDL_ALIGNMENT) constexpr uint8_t kEncodedBytes[kInlineCodingStructSize] = {
+    42,   0,    0,    0,  // e, padding
+    0x78, 0x56, 0x34, 0x12,  // a
+    0x11, 0x00, 0,    0,    0, 0, 0, 0,  // bits, padding
+    0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01,  // b
+    0x40, 0x08, 0x00, 0x04,  // more_bits
+    0xff, 0,    0,    0,     // c, padding
+};
+
+// Returns a copy of |type| without its generated coding routines.
+fidl_type_t WalkerOnlyType(const fidl_type_t& type) {
+  const FidlCodedStruct& coded_struct = type.coded_struct;
+  return fidl_type_t{.type_tag = kFidlTypeStruct,
+                     {.coded_struct = {.fields = coded_struct.fields,
+                                       .field_count = coded_struct.field_count,
+                                       .size = coded_struct.size,
+                                       .name = coded_struct.name,
+                                       .encode_inline = nullptr,
+                                       .validate_inline = nullptr}}};
+}
+
+// Fills |bytes| with the encoded struct, with garbage in its padding.
+void FillWithPadding(uint8_t* bytes) {
+  memcpy(bytes, kEncodedBytes, sizeof(kEncodedBytes));
+  for (uint32_t offset : {1u, 2u, 3u, 10u, 11u, 15u, 29u, 31u}) {
+    bytes[offset] = 0xaa;
+  }
+}
+
+bool generated_routines_present() {
+  BEGIN_TEST;
+
+  const FidlCodedStruct& coded_struct = fidl_test_coding_InlineCodingStructTable.coded_struct;
+  EXPECT_EQ(coded_struct.size, kInlineCodingStructSize);
+  EXPECT_NONNULL(coded_struct.encode_inline);
+  EXPECT_NONNULL(coded_struct.validate_inline);
+
+  END_TEST;
+}
+
+bool encode_matches_walker() {
+  BEGIN_TEST;
+
+  const fidl_type_t walker_only_type = WalkerOnlyType(fidl_test_coding_InlineCodingStructTable);
+  for (const fidl_type_t* type : {&fidl_test_coding_InlineCodingStructTable, &walker_only_type}) {
+    alignas(FIDL_ALIGNMENT) uint8_t bytes[kInlineCodingStructSize];
+    FillWithPadding(bytes);
+    uint32_t actual_handles = 1;
+    const char* error = nullptr;
+    EXPECT_EQ(fidl_encode(type, bytes, sizeof(bytes), nullptr, 0, &actual_handles, &error), ZX_OK);
+    EXPECT_NULL(error, error);
+    EXPECT_EQ(actual_handles, 0u);
+    EXPECT_BYTES_EQ(bytes, kEncodedBytes, sizeof(bytes), "padding should be zeroed");
+
+    EXPECT_EQ(fidl_decode(type, bytes, sizeof(bytes), nullptr, 0, &error), ZX_OK);
+    EXPECT_NULL(error, error);
+    EXPECT_EQ(fidl_validate(type, bytes, sizeof(bytes), 0, &error), ZX_OK);
+    EXPECT_NULL(error, error);
+  }
+
+  END_TEST;
+}
+
+bool errors_match_walker() {
+  BEGIN_TEST;
+
+  struct Corruption {
+    uint32_t offset;
+    uint8_t value;
+  };
+  const Corruption corruptions[] = {
+      {1, 0xaa},   // padding after |e|
+      {15, 0xaa},  // padding after |bits|
+      {31, 0xaa},  // trailing padding
+      {0, 43},     // not a member of Int8Enum
+      {8, 0x02},   // not a member of Int16Bits
+      {27, 0x80},  // not a member of Int32Bits
+  };
+  const fidl_type_t walker_only_type = WalkerOnlyType(fidl_test_coding_InlineCodingStructTable);
+  for (const Corruption& corruption : corruptions) {
+    alignas(FIDL_ALIGNMENT) uint8_t bytes[kInlineCodingStructSize];
+    memcpy(bytes, kEncodedBytes, sizeof(bytes));
+    bytes[corruption.offset] = corruption.value;
+
+    const char* generated_error = nullptr;
+    EXPECT_NE(fidl_decode(&fidl_test_coding_InlineCodingStructTable, bytes, sizeof(bytes), nullptr,
+                          0, &generated_error),
+              ZX_OK);
+    const char* walker_error = nullptr;
+    EXPECT_NE(fidl_decode(&walker_only_type, bytes, sizeof(bytes), nullptr, 0, &walker_error),
+              ZX_OK);
+    ASSERT_NONNULL(generated_error);
+    ASSERT_NONNULL(walker_error);
+    EXPECT_STR_EQ(generated_error, walker_error);
+
+    EXPECT_NE(fidl_validate(&fidl_test_coding_InlineCodingStructTable, bytes, sizeof(bytes), 0,
+                            &generated_error),
+              ZX_OK);
+    EXPECT_NE(fidl_validate(&walker_only_type, bytes, sizeof(bytes), 0, &walker_error), ZX_OK);
+    EXPECT_STR_EQ(generated_error, walker_error);
+  }
+
+  END_TEST;
+}
+
+// Runs encode, decode and validate |kIterations| times each, and returns the
+// average time of each in nanoseconds.
+bool MeasureCoding(const fidl_type_t* type, zx_duration_t* out_encode, zx_duration_t* out_decode,
+                   zx_duration_t* out_validate) {
+  BEGIN_HELPER;
+
+  alignas(FIDL_ALIGNMENT) uint8_t bytes[kInlineCodingStructSize];
+  FillWithPadding(bytes);
+  uint32_t actual_handles;
+  const char* error = nullptr;
+  zx_time_t start = zx_clock_get_monotonic();
+  for (uint32_t i = 0; i < kIterations; i++) {
+    ASSERT_EQ(fidl_encode(type, bytes, sizeof(bytes), nullptr, 0, &actual_handles, &error), ZX_OK);
+  }
+  *out_encode = (zx_clock_get_monotonic() - start) / kIterations;
+
+  start = zx_clock_get_monotonic();
+  for (uint32_t i = 0; i < kIterations; i++) {
+    ASSERT_EQ(fidl_decode(type, bytes, sizeof(bytes), nullptr, 0, &error), ZX_OK);
+  }
+  *out_decode = (zx_clock_get_monotonic() - start) / kIterations;
+
+  start = zx_clock_get_monotonic();
+  for (uint32_t i = 0; i < kIterations; i++) {
+    ASSERT_EQ(fidl_validate(type, bytes, sizeof(bytes), 0, &error), ZX_OK);
+  }
+  *out_validate = (zx_clock_get_monotonic() - start) / kIterations;
+
+  END_HELPER;
+}
+
+bool benchmark_inline_struct() {
+  BEGIN_TEST;
+
+  const fidl_type_t walker_only_type = WalkerOnlyType(fidl_test_coding_InlineCodingStructTable);
+  zx_duration_t walker[3];
+  ASSERT_TRUE(MeasureCoding(&walker_only_type, &walker[0], &walker[1], &walker[2]));
+  zx_duration_t generated[3];
+  ASSERT_TRUE(MeasureCoding(&fidl_test_coding_InlineCodingStructTable, &generated[0],
+                            &generated[1], &generated[2]));
+
+  printf("\nInlineCodingStruct (%u bytes), ns/op:\n", kInlineCodingStructSize);
+  printf("  walker:    encode %ld decode %ld validate %ld\n", walker[0], walker[1], walker[2]);
+  printf("  generated: encode %ld decode %ld validate %ld\n", generated[0], generated[1],
+         generated[2]);
+
+  END_TEST;
+}
+
+}  // namespace
+
+BEGIN_TEST_CASE(inline_coding)
+RUN_TEST(generated_routines_present)
+RUN_TEST(encode_matches_walker)
+RUN_TEST(errors_match_walker)
+RUN_TEST_PERFORMANCE(benchmark_inline_struct)
+END_TEST_CASE(inline_coding)
+
+}  // namespace fidl
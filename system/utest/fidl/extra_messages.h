@@ -56,6 +56,7 @@ extern const fidl_type_t fidl_test_coding_LLCPPStyleUnionStructTable;
 
 extern const fidl_type_t fidl_test_coding_Uint32VectorStructTable;
 extern const fidl_type_t fidl_test_coding_StringStructTable;
+extern const fidl_type_t fidl_test_coding_InlineCodingStructTable;
 
 #if defined(__cplusplus)
 }
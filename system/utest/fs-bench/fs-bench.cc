@@ -2,10 +2,13 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <errno.h>
 #include <fcntl.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include <fbl/function.h>
 #include <fbl/string.h>
@@ -18,7 +21,11 @@
 #include <perftest/perftest.h>
 #include <unittest/unittest.h>
 
+#include <atomic>
+#include <memory>
+#include <thread>
 #include <utility>
+#include <vector>
 
 namespace fs_bench {
 namespace {
@@ -159,6 +166,85 @@ class PathWalkOp {
   fbl::StringBuffer<fs_test_utils::kPathSize> path_;
 };
 
+// Number of files each thread opens and stats per iteration of the open/stat stress test.
+constexpr int kOpenStatFilesPerThread = 64;
+
+fbl::String GetOpenStatPath(const Fixture& fixture, int thread, int file) {
+  return fbl::StringPrintf("%s/openstat-%d/file-%d", fixture.fs_path().c_str(), thread, file);
+}
+
+// Populates a private directory for each of |thread_count| threads. Directories left behind by
+// a previous run with fewer threads are reused.
+bool SetupOpenStat(int thread_count, Fixture* fixture) {
+  BEGIN_HELPER;
+  for (int thread = 0; thread < thread_count; ++thread) {
+    fbl::String dir = fbl::StringPrintf("%s/openstat-%d", fixture->fs_path().c_str(), thread);
+    ASSERT_TRUE(mkdir(dir.c_str(), 0666) == 0 || errno == EEXIST, dir.c_str());
+    for (int file = 0; file < kOpenStatFilesPerThread; ++file) {
+      fbl::unique_fd fd(open(GetOpenStatPath(*fixture, thread, file).c_str(), O_CREAT | O_RDWR));
+      ASSERT_TRUE(fd);
+    }
+  }
+  END_HELPER;
+}
+
+// Each of |thread_count| threads repeatedly opens, stats and closes the files in its own
+// directory. Lookups in unrelated directories do not contend on the namespace locks, but the
+// operations are still serialized by the dispatch lock unless the vnodes involved opt into
+// |fs::Vnode::SupportsConcurrentDispatch|. No minfs vnode does, so this measures how the
+// serialized path behaves as clients are added.
+bool OpenStat(int thread_count, perftest::RepeatState* state, Fixture* fixture) {
+  BEGIN_HELPER;
+  ASSERT_TRUE(SetupOpenStat(thread_count, fixture));
+
+  while (state->KeepRunning()) {
+    std::atomic<bool> failed = false;
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < thread_count; ++thread) {
+      threads.emplace_back([thread, fixture, &failed]() {
+        for (int file = 0; file < kOpenStatFilesPerThread; ++file) {
+          fbl::unique_fd fd(open(GetOpenStatPath(*fixture, thread, file).c_str(), O_RDONLY));
+          struct stat buff;
+          if (!fd || fstat(fd.get(), &buff) != 0) {
+            failed = true;
+            return;
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    ASSERT_FALSE(failed.load(), "Concurrent open/stat failed");
+  }
+  END_HELPER;
+}
+
+// Size of the file read by the small read tests.
+constexpr size_t kSmallReadFileSize = 1 << 20;
+
+// Measures the latency of reads of |read_size| bytes at random offsets of a file which has just
+// been written. The data is cached, so the time is dominated by the round trip to the filesystem
+// and the copies of the data along the way rather than by the device.
+bool SmallRead(size_t read_size, perftest::RepeatState* state, Fixture* fixture) {
+  BEGIN_HELPER;
+  fbl::String path = fbl::StringPrintf("%s/smallread.txt", fixture->fs_path().c_str());
+  fbl::unique_fd fd(open(path.c_str(), O_CREAT | O_RDWR));
+  ASSERT_TRUE(fd);
+  std::unique_ptr<uint8_t[]> data(new uint8_t[kSmallReadFileSize]);
+  memset(data.get(), static_cast<uint8_t>(rand_r(fixture->mutable_seed())), kSmallReadFileSize);
+  ASSERT_EQ(pwrite(fd.get(), data.get(), kSmallReadFileSize, 0),
+            static_cast<ssize_t>(kSmallReadFileSize));
+
+  state->DeclareStep("read");
+  const size_t slots = kSmallReadFileSize / read_size;
+  while (state->KeepRunning()) {
+    off_t offset = static_cast<off_t>((rand_r(fixture->mutable_seed()) % slots) * read_size);
+    ASSERT_EQ(pread(fd.get(), data.get(), read_size, offset), static_cast<ssize_t>(read_size));
+  }
+  END_HELPER;
+}
+
 }  // namespace
 
 bool RunBenchmark(int argc, char** argv) {
@@ -234,6 +320,46 @@ bool RunBenchmark(int argc, char** argv) {
     testcases.push_back(std::move(testcase));
   }
 
+  // Open/stat stress tests.
+  const int open_stat_thread_counts[] = {1, 2, 4, 8};
+  {
+    TestCaseInfo testcase;
+    testcase.name =
+        fbl::StringPrintf("%s/OpenStat/%d-Files", disk_format_string_[f_opts.fs_type],
+                          kOpenStatFilesPerThread);
+    testcase.sample_count = 100;
+    testcase.teardown = false;
+    for (int thread_count : open_stat_thread_counts) {
+      TestInfo open_stat_test;
+      open_stat_test.name =
+          fbl::StringPrintf("%s/%d-Threads", testcase.name.c_str(), thread_count);
+      open_stat_test.test_fn = [thread_count](perftest::RepeatState* state, Fixture* fixture) {
+        return OpenStat(thread_count, state, fixture);
+      };
+      testcase.tests.push_back(std::move(open_stat_test));
+    }
+    testcases.push_back(std::move(testcase));
+  }
+
+  // Small read latency tests.
+  const size_t small_read_sizes[] = {512, 4096, 8192};
+  {
+    TestCaseInfo testcase;
+    testcase.name = fbl::StringPrintf("%s/SmallRead", disk_format_string_[f_opts.fs_type]);
+    testcase.sample_count = 1000;
+    testcase.teardown = false;
+    for (size_t read_size : small_read_sizes) {
+      TestInfo small_read_test;
+      small_read_test.name = fbl::StringPrintf("%s/%zu-Bytes", testcase.name.c_str(), read_size);
+      small_read_test.test_fn = [read_size](perftest::RepeatState* state, Fixture* fixture) {
+        return SmallRead(read_size, state, fixture);
+      };
+      small_read_test.required_disk_space = kSmallReadFileSize;
+      testcase.tests.push_back(std::move(small_read_test));
+    }
+    testcases.push_back(std::move(testcase));
+  }
+
   return fs_test_utils::RunTestCases(f_opts, p_opts, testcases);
 }
 }  // namespace fs_bench
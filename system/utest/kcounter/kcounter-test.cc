@@ -7,6 +7,7 @@
 #include <fbl/unique_fd.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <lib/counter-snapshot.h>
 #include <lib/counter-vmo-abi.h>
 #include <lib/fdio/io.h>
 #include <lib/fzl/owned-vmo-mapper.h>
@@ -104,6 +105,58 @@ TEST(Counters, Basic) {
   }
 }
 
+TEST(Counters, SnapshotDeltas) {
+  constexpr size_t kNumCounters = 3;
+  constexpr size_t kMaxCpus = 2;
+  alignas(counters::DescriptorVmo) uint8_t
+      desc_buffer[sizeof(counters::DescriptorVmo) + kNumCounters * sizeof(counters::Descriptor)] =
+          {};
+  auto desc = reinterpret_cast<counters::DescriptorVmo*>(desc_buffer);
+  desc->magic = counters::DescriptorVmo::kMagic;
+  desc->max_cpus = kMaxCpus;
+  desc->descriptor_table_size = kNumCounters * sizeof(counters::Descriptor);
+  desc->descriptor_table[0] = {"test.max", counters::Type::kMax};
+  desc->descriptor_table[1] = {"test.min", counters::Type::kMin};
+  desc->descriptor_table[2] = {"test.sum", counters::Type::kSum};
+
+  int64_t arena[kMaxCpus][kNumCounters] = {
+      {5, 7, 10},
+      {3, 9, 20},
+  };
+
+  counters::Snapshot before;
+  EXPECT_FALSE(before.is_valid());
+  before.Take(*desc, &arena[0][0], kMaxCpus + 1, 1000);
+  ASSERT_TRUE(before.is_valid());
+  EXPECT_EQ(before.num_cpus(), kMaxCpus, "snapshot is limited to max_cpus");
+  EXPECT_EQ(before.num_counters(), kNumCounters);
+  EXPECT_EQ(before.timestamp(), 1000);
+  EXPECT_EQ(before.Value(0), 5);
+  EXPECT_EQ(before.Value(1), 7);
+  EXPECT_EQ(before.Value(2), 30);
+  EXPECT_EQ(before.Value(2, 1), 20);
+
+  // Later updates must not change the copy.
+  arena[0][2] += 4;
+  arena[1][2] += 1;
+  arena[1][0] = 8;
+  EXPECT_EQ(before.Value(2), 30);
+
+  counters::Snapshot after;
+  after.Take(*desc, &arena[0][0], kMaxCpus, 2000);
+  EXPECT_EQ(after.Value(0), 8);
+  EXPECT_EQ(after.Delta(before, 2), 5);
+  EXPECT_EQ(after.Delta(before, 2, 0), 4);
+  EXPECT_EQ(after.Delta(before, 2, 1), 1);
+
+  // A snapshot of only the first CPU ignores the others.
+  counters::Snapshot first_cpu;
+  first_cpu.Take(*desc, &arena[0][0], 1, 3000);
+  EXPECT_EQ(first_cpu.num_cpus(), 1u);
+  EXPECT_EQ(first_cpu.Value(0), 5);
+  EXPECT_EQ(first_cpu.Value(2), 14);
+}
+
 TEST(Counters, CmdlineNormalSuccess) {
   const char* const argv[] = {"self.exe", "-v", "-w", "channel", nullptr};
 
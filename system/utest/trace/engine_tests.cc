@@ -6,6 +6,7 @@
 #include <threads.h>
 
 #include <atomic>
+#include <map>
 #include <utility>
 
 #include <fbl/function.h>
@@ -535,6 +536,53 @@ bool TestEventWithInlineEverything() {
   END_TRACE_TEST;
 }
 
+bool TestMultipleThreadsWriteRecords() {
+  BEGIN_TRACE_TEST;
+
+  fixture_initialize_and_start_tracing();
+
+  // Each thread writes enough records to fill several of the chunks which
+  // threads reserve in the buffer.
+  constexpr size_t kNumThreads = 4;
+  constexpr uint32_t kEventsPerThread = 1000;
+  thrd_t threads[kNumThreads];
+  for (auto& thread : threads) {
+    auto closure = new fbl::Closure([] {
+      for (uint32_t i = 0; i < kEventsPerThread; ++i) {
+        TRACE_INSTANT("+enabled", "name", TRACE_SCOPE_THREAD, "k", TA_UINT32(i));
+      }
+    });
+    ASSERT_EQ(thrd_create(&thread, RunClosure, closure), thrd_success);
+  }
+  for (auto& thread : threads) {
+    ASSERT_EQ(thrd_join(thread, nullptr), thrd_success);
+  }
+
+  fixture_stop_and_terminate_tracing();
+
+  fbl::Vector<trace::Record> records;
+  ASSERT_TRUE(fixture_read_records(&records));
+
+  // Every event is present, in the order each thread wrote them.
+  std::map<zx_koid_t, uint32_t> events_per_thread;
+  for (const auto& record : records) {
+    if (record.type() != trace::RecordType::kEvent) {
+      continue;
+    }
+    const trace::Record::Event& event = record.GetEvent();
+    ASSERT_EQ(event.arguments.size(), 1u);
+    uint32_t& count = events_per_thread[event.process_thread.thread_koid()];
+    EXPECT_EQ(event.arguments[0].value().GetUint32(), count);
+    count++;
+  }
+  EXPECT_EQ(events_per_thread.size(), kNumThreads);
+  for (const auto& entry : events_per_thread) {
+    EXPECT_EQ(entry.second, kEventsPerThread);
+  }
+
+  END_TRACE_TEST;
+}
+
 bool TestCircularMode() {
   const size_t kBufferSize = 4096u;
   BEGIN_TRACE_TEST_ETC(kNoAttachToThread, TRACE_BUFFERING_MODE_CIRCULAR, kBufferSize);
@@ -821,6 +869,7 @@ RUN_TEST(TestRegisterStringLiteralMultipleThreads)
 RUN_TEST(TestRegisterStringLiteralTableOverflow)
 RUN_TEST(TestMaximumRecordLength)
 RUN_TEST(TestEventWithInlineEverything)
+RUN_TEST(TestMultipleThreadsWriteRecords)
 RUN_TEST(TestCircularMode)
 RUN_TEST(TestStreamingMode)
 RUN_TEST(TestShutdownWhenFull)
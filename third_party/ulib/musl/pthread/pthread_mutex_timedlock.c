@@ -1,6 +1,12 @@
+#include <zircon/syscalls.h>
+
 #include "atomic.h"
 #include "threads_impl.h"
 
+// Reading the clock costs far more than one a_spin(), so the spin deadline is
+// only checked once every this many iterations.  Must be a power of two.
+#define SPIN_CLOCK_CHECK_INTERVAL 64u
+
 int pthread_mutex_timedlock(pthread_mutex_t* restrict m, const struct timespec* restrict at) {
   int type = pthread_mutex_get_type(m);
 
@@ -14,9 +20,17 @@ int pthread_mutex_timedlock(pthread_mutex_t* restrict m, const struct timespec*
   if (r != EBUSY)
     return r;
 
-  int spins = 100;
-  while (spins-- && atomic_load(&m->_m_lock) && !atomic_load(&m->_m_waiters))
-    a_spin();
+  // Spin while the owner may still be running, as long as no one else has
+  // given up and blocked. See spin_while_owned in system/ulib/sync/mutex.c.
+  zx_duration_t spin_duration = _zx_system_get_mutex_spin_duration();
+  if (spin_duration > 0) {
+    zx_time_t spin_deadline = zx_time_add_duration(_zx_clock_get_monotonic(), spin_duration);
+    for (unsigned i = 1; atomic_load(&m->_m_lock) && !atomic_load(&m->_m_waiters); ++i) {
+      if ((i % SPIN_CLOCK_CHECK_INTERVAL) == 0 && _zx_clock_get_monotonic() >= spin_deadline)
+        break;
+      a_spin();
+    }
+  }
 
   while ((r = pthread_mutex_trylock(m)) == EBUSY) {
     if (!(r = atomic_load(&m->_m_lock)))
@@ -66,6 +66,12 @@ class TablesGenerator {
   void Generate(const coded::TableField& field);
   void Generate(const coded::XUnionField& field);
 
+  // Generates the specialized coding routines of an inline-only struct or message, and returns
+  // whether it did. They are referenced from the coding table by GenerateInlineCodingFields.
+  bool GenerateInlineCoding(const std::string& coded_name,
+                            const std::vector<coded::StructField>& fields);
+  void GenerateInlineCodingFields(const std::string& coded_name);
+
   void GenerateForward(const coded::EnumType& enum_type);
   void GenerateForward(const coded::BitsType& bits_type);
   void GenerateForward(const coded::StructType& struct_type);
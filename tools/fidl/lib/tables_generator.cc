@@ -4,6 +4,8 @@
 
 #include "fidl/tables_generator.h"
 
+#include <iomanip>
+
 #include "fidl/names.h"
 
 namespace fidl {
@@ -38,6 +40,111 @@ std::string PrimitiveSubtypeToString(fidl::types::PrimitiveSubtype subtype) {
   }
 }
 
+std::string PrimitiveSubtypeToCType(fidl::types::PrimitiveSubtype subtype) {
+  using fidl::types::PrimitiveSubtype;
+  switch (subtype) {
+    case PrimitiveSubtype::kBool:
+      return "bool";
+    case PrimitiveSubtype::kInt8:
+      return "int8_t";
+    case PrimitiveSubtype::kInt16:
+      return "int16_t";
+    case PrimitiveSubtype::kInt32:
+      return "int32_t";
+    case PrimitiveSubtype::kInt64:
+      return "int64_t";
+    case PrimitiveSubtype::kUint8:
+      return "uint8_t";
+    case PrimitiveSubtype::kUint16:
+      return "uint16_t";
+    case PrimitiveSubtype::kUint32:
+      return "uint32_t";
+    case PrimitiveSubtype::kUint64:
+      return "uint64_t";
+    case PrimitiveSubtype::kFloat32:
+      return "float";
+    case PrimitiveSubtype::kFloat64:
+      return "double";
+  }
+}
+
+// Specialized coding routines are only generated for inline-only structs which need at most this
+// many padding words and enum or bits checks, so that large arrays do not blow up the tables file.
+// Other structs are left to the walker.
+constexpr size_t kMaxInlineCodingChecks = 64;
+
+// What the specialized coding routines of an inline-only struct need to check.
+struct InlineCodingChecks {
+  // Masks of the padding bytes, by offset of the 8-byte word which contains them.
+  std::map<uint32_t, uint64_t> padding;
+  // Enum and bits members, with their offsets.
+  std::vector<std::pair<uint32_t, const coded::Type*>> members;
+
+  size_t size() const { return padding.size() + members.size(); }
+
+  void AddPadding(uint32_t offset, uint32_t length) {
+    for (uint32_t i = offset; i < offset + length; i++) {
+      padding[i & ~7u] |= uint64_t{0xff} << ((i & 7u) * 8u);
+    }
+  }
+};
+
+bool CollectInlineCodingChecks(const std::vector<coded::StructField>& fields, uint32_t offset,
+                               InlineCodingChecks* checks);
+
+// Returns false if |type| is not inline-only, or needs too many checks.
+bool CollectInlineCodingChecks(const coded::Type* type, uint32_t offset,
+                               InlineCodingChecks* checks) {
+  if (type == nullptr || !type->coding_needed)
+    return true;
+  switch (type->kind) {
+    case coded::Type::Kind::kEnum:
+    case coded::Type::Kind::kBits:
+      checks->members.emplace_back(offset, type);
+      return checks->size() <= kMaxInlineCodingChecks;
+    case coded::Type::Kind::kStruct:
+      return CollectInlineCodingChecks(static_cast<const coded::StructType*>(type)->fields, offset,
+                                       checks);
+    case coded::Type::Kind::kArray: {
+      const auto* array_type = static_cast<const coded::ArrayType*>(type);
+      for (uint32_t element_offset = 0; element_offset < array_type->size;
+           element_offset += array_type->element_size) {
+        if (!CollectInlineCodingChecks(array_type->element_type, offset + element_offset, checks))
+          return false;
+      }
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+bool CollectInlineCodingChecks(const std::vector<coded::StructField>& fields, uint32_t offset,
+                               InlineCodingChecks* checks) {
+  for (const auto& field : fields) {
+    checks->AddPadding(offset + field.offset + field.size, field.padding);
+    if (checks->size() > kMaxInlineCodingChecks)
+      return false;
+    if (!CollectInlineCodingChecks(field.type, offset + field.offset, checks))
+      return false;
+  }
+  return true;
+}
+
+std::string InlineEncoderName(const std::string& coded_name) {
+  return "InlineEncoderFor_" + coded_name;
+}
+
+std::string InlineValidatorName(const std::string& coded_name) {
+  return "InlineValidatorFor_" + coded_name;
+}
+
+std::string Hex(uint64_t value) {
+  std::ostringstream hex;
+  hex << "0x" << std::hex << std::setw(16) << std::setfill('0') << value << "ul";
+  return hex.str();
+}
+
 // When generating coding tables for containers employing envelopes (xunions & tables),
 // we need to reference coding tables for primitives, in addition to types that need coding.
 // This function handles naming coding tables for both cases.
@@ -163,6 +270,7 @@ void TablesGenerator::Generate(const coded::StructType& struct_type) {
   Emit(&tables_file_, "[] = ");
   GenerateArray(struct_type.fields);
   Emit(&tables_file_, ";\n");
+  bool inline_coding = GenerateInlineCoding(struct_type.coded_name, struct_type.fields);
 
   Emit(&tables_file_, "const fidl_type_t ");
   Emit(&tables_file_, NameTable(struct_type.coded_name));
@@ -174,7 +282,10 @@ void TablesGenerator::Generate(const coded::StructType& struct_type) {
   Emit(&tables_file_, struct_type.size);
   Emit(&tables_file_, ", .name=\"");
   Emit(&tables_file_, struct_type.qname);
-  Emit(&tables_file_, "\"}}};\n\n");
+  Emit(&tables_file_, "\"");
+  if (inline_coding)
+    GenerateInlineCodingFields(struct_type.coded_name);
+  Emit(&tables_file_, "}}};\n\n");
 }
 
 void TablesGenerator::Generate(const coded::TableType& table_type) {
@@ -236,6 +347,7 @@ void TablesGenerator::Generate(const coded::MessageType& message_type) {
   Emit(&tables_file_, "[] = ");
   GenerateArray(message_type.fields);
   Emit(&tables_file_, ";\n");
+  bool inline_coding = GenerateInlineCoding(message_type.coded_name, message_type.fields);
 
   Emit(&tables_file_, "const fidl_type_t ");
   Emit(&tables_file_, NameTable(message_type.coded_name));
@@ -247,7 +359,80 @@ void TablesGenerator::Generate(const coded::MessageType& message_type) {
   Emit(&tables_file_, message_type.size);
   Emit(&tables_file_, ", .name=\"");
   Emit(&tables_file_, message_type.qname);
-  Emit(&tables_file_, "\"}}};\n\n");
+  Emit(&tables_file_, "\"");
+  if (inline_coding)
+    GenerateInlineCodingFields(message_type.coded_name);
+  Emit(&tables_file_, "}}};\n\n");
+}
+
+bool TablesGenerator::GenerateInlineCoding(const std::string& coded_name,
+                                           const std::vector<coded::StructField>& fields) {
+  InlineCodingChecks checks;
+  if (!CollectInlineCodingChecks(fields, 0u, &checks))
+    return false;
+
+  auto emit_member_checks = [&]() {
+    for (const auto& [offset, type] : checks.members) {
+      if (type->kind == coded::Type::Kind::kEnum) {
+        // The enum may be declared in another library, so its validator is not visible here.
+        const auto* enum_type = static_cast<const coded::EnumType*>(type);
+        Emit(&tables_file_, "    { uint64_t v = (uint64_t)*(const ");
+        Emit(&tables_file_, PrimitiveSubtypeToCType(enum_type->subtype));
+        Emit(&tables_file_, "*)(bytes + ");
+        Emit(&tables_file_, offset);
+        Emit(&tables_file_, "); if (!(");
+        for (const auto& member : enum_type->members) {
+          Emit(&tables_file_, "(v == ");
+          Emit(&tables_file_, member);
+          Emit(&tables_file_, ") || ");
+        }
+        Emit(&tables_file_, "false)) return kFidlInlineCoding_InvalidEnum; }\n");
+      } else {
+        const auto* bits_type = static_cast<const coded::BitsType*>(type);
+        Emit(&tables_file_, "    if (*(const ");
+        Emit(&tables_file_, PrimitiveSubtypeToCType(bits_type->subtype));
+        Emit(&tables_file_, "*)(bytes + ");
+        Emit(&tables_file_, offset);
+        Emit(&tables_file_, ") & ~");
+        Emit(&tables_file_, bits_type->mask);
+        Emit(&tables_file_, ") return kFidlInlineCoding_InvalidBits;\n");
+      }
+    }
+  };
+
+  Emit(&tables_file_, "static FidlInlineCodingResult ");
+  Emit(&tables_file_, InlineEncoderName(coded_name));
+  Emit(&tables_file_, "(uint8_t* bytes) {\n");
+  for (const auto& [offset, mask] : checks.padding) {
+    Emit(&tables_file_, "    *(uint64_t*)(bytes + ");
+    Emit(&tables_file_, offset);
+    Emit(&tables_file_, ") &= ");
+    Emit(&tables_file_, Hex(~mask));
+    Emit(&tables_file_, ";\n");
+  }
+  emit_member_checks();
+  Emit(&tables_file_, "    return kFidlInlineCoding_Ok;\n}\n");
+
+  Emit(&tables_file_, "static FidlInlineCodingResult ");
+  Emit(&tables_file_, InlineValidatorName(coded_name));
+  Emit(&tables_file_, "(const uint8_t* bytes) {\n");
+  for (const auto& [offset, mask] : checks.padding) {
+    Emit(&tables_file_, "    if (*(const uint64_t*)(bytes + ");
+    Emit(&tables_file_, offset);
+    Emit(&tables_file_, ") & ");
+    Emit(&tables_file_, Hex(mask));
+    Emit(&tables_file_, ") return kFidlInlineCoding_NonZeroPadding;\n");
+  }
+  emit_member_checks();
+  Emit(&tables_file_, "    return kFidlInlineCoding_Ok;\n}\n");
+  return true;
+}
+
+void TablesGenerator::GenerateInlineCodingFields(const std::string& coded_name) {
+  Emit(&tables_file_, ", .encode_inline=&");
+  Emit(&tables_file_, InlineEncoderName(coded_name));
+  Emit(&tables_file_, ", .validate_inline=&");
+  Emit(&tables_file_, InlineValidatorName(coded_name));
 }
 
 void TablesGenerator::Generate(const coded::HandleType& handle_type) {
@@ -37,6 +37,11 @@ bool AliasWorkaround(const std::string& name, const SyscallLibrary& library, Typ
                  Constness::kMutable);
     return true;
   }
+  if (name == "mutable_vector_PortPacket") {
+    *type = Type(TypeVector(Type(library.TypeFromIdentifier("zx/PortPacket"))),
+                 Constness::kMutable);
+    return true;
+  }
   if (name == "mutable_vector_WaitItem") {
     *type = Type(TypeVector(Type(library.TypeFromIdentifier("zx/WaitItem"))), Constness::kMutable);
     return true;